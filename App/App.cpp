@@ -46,7 +46,7 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance,
 	ReportLiveObjects();
 #endif
 
-	// ϰ msgϰ ٲ Ѵ.   ʿ .
+	//이 리턴값을 msg리턴값으로 바꿔야 한다. 딱히 뭐 필요는 없지만.
 	return 0;
 }
 
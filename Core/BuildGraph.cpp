@@ -0,0 +1,129 @@
+﻿#include "pch.h"
+#include "./BuildGraph.h"
+#include <thread>
+#include <chrono>
+#include "../Include/Types.h"
+
+CBuildGraph::CBuildGraph()
+	: m_tasks{}
+	, m_ready{}
+	, m_times{}
+	, m_finishedCount{ 0u }
+	, m_runningCount{ 0u }
+	, m_maxConcurrency{ 0u }
+{}
+CBuildGraph::~CBuildGraph() = default;
+
+UINT CBuildGraph::AddTask(std::string name, std::function<bool()> work, const std::vector<UINT>& dependencies)
+{
+	const UINT index = static_cast<UINT>(m_tasks.size());
+	for (auto dependency : dependencies)
+	{
+		assert(dependency < index && "depends on a task that is not added yet");
+		m_tasks[dependency].dependents.emplace_back(index);
+	}
+
+	Task& task = m_tasks.emplace_back();
+	task.name = std::move(name);
+	task.work = std::move(work);
+	task.waitCount = static_cast<UINT>(dependencies.size());
+
+	return index;
+}
+
+bool CBuildGraph::Run(UINT threadCount)
+{
+	m_times.assign(m_tasks.size(), {});
+	m_finishedCount = 0u;
+	m_runningCount = 0u;
+	m_maxConcurrency = 0u;
+	for (auto index : std::views::iota(0u, static_cast<UINT>(m_tasks.size())))
+	{
+		m_times[index].name = m_tasks[index].name;
+		if (m_tasks[index].waitCount == 0) m_ready.emplace_back(index);
+	}
+
+	{
+		std::vector<std::jthread> threads{};
+		for (auto i : std::views::iota(0u, std::max(threadCount, 1u)))
+			threads.emplace_back([this]() { Work(); });
+	}
+
+	return std::ranges::all_of(m_times, [](auto& time) { return time.succeeded; });
+}
+
+void CBuildGraph::Work()
+{
+	std::unique_lock lock(m_mutex);
+	while (true)
+	{
+		m_readyCondition.wait(lock, [this]() { return !m_ready.empty() || m_finishedCount == m_tasks.size(); });
+		if (m_ready.empty()) return;
+
+		const UINT index = m_ready.back();
+		m_ready.pop_back();
+		Task& task = m_tasks[index];
+		if (task.dependencyFailed)
+		{
+			Finish(index, false);
+			continue;
+		}
+
+		m_runningCount++;
+		m_maxConcurrency = std::max(m_maxConcurrency, m_runningCount);
+		lock.unlock();
+
+		const auto start = std::chrono::steady_clock::now();
+		const bool succeeded = task.work();
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		lock.lock();
+		m_runningCount--;
+		m_times[index].milliseconds = elapsed.count();
+		Finish(index, succeeded);
+	}
+}
+
+//m_mutex를 잡은 채로 부른다.
+void CBuildGraph::Finish(UINT index, bool succeeded)
+{
+	m_times[index].succeeded = succeeded;
+	m_finishedCount++;
+	for (auto dependent : m_tasks[index].dependents)
+	{
+		Task& task = m_tasks[dependent];
+		task.dependencyFailed |= !succeeded;
+		if (--task.waitCount == 0) m_ready.emplace_back(dependent);
+	}
+
+	m_readyCondition.notify_all();
+}
+
+std::string GetShaderTypeName(ShaderType shaderType)
+{
+	switch (shaderType)
+	{
+	case ShaderType::VS: return "VS";
+	case ShaderType::PS: return "PS";
+	}
+
+	return "";
+}
+
+void AddPipelineTasks(IPipelineBuildSteps* steps,
+	const std::map<GraphicsPSO, std::vector<ShaderType>>& psoShaders, CBuildGraph* outGraph)
+{
+	const UINT rootSignature = outGraph->AddTask("RootSignature", [steps]() { return steps->BuildRootSignatures(); });
+	for (auto& [psoType, shaderTypes] : psoShaders)
+	{
+		const std::string psoName = "PSO " + std::to_string(static_cast<int>(psoType));
+		std::vector<UINT> dependencies{ rootSignature };
+		for (auto shaderType : shaderTypes)
+		{
+			dependencies.emplace_back(outGraph->AddTask(psoName + " " + GetShaderTypeName(shaderType),
+				[steps, psoType, shaderType]() { return steps->CompileShader(psoType, shaderType); }));
+		}
+
+		outGraph->AddTask(psoName, [steps, psoType]() { return steps->CreatePipelineState(psoType); }, dependencies);
+	}
+}
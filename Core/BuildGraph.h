@@ -0,0 +1,72 @@
+﻿#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+enum class GraphicsPSO : int;
+enum class ShaderType : int;
+
+struct BuildTaskTime
+{
+	std::string name{};
+	double milliseconds{ 0.0 };
+	bool succeeded{ false };
+};
+
+//앞에서 넣은 작업에만 의존할 수 있어서 순환이 생기지 않는다.
+//의존하는 작업이 끝나면 작업 스레드가 가져가서 돌리고, 실패하면 그 뒤에 딸린 작업은 돌리지 않고 실패로 둔다.
+class CBuildGraph
+{
+	struct Task
+	{
+		std::string name{};
+		std::function<bool()> work{};
+		std::vector<UINT> dependents{};
+		UINT waitCount{ 0u };
+		bool dependencyFailed{ false };
+	};
+
+public:
+	CBuildGraph();
+	~CBuildGraph();
+
+	CBuildGraph(const CBuildGraph&) = delete;
+	CBuildGraph& operator=(const CBuildGraph&) = delete;
+
+	UINT AddTask(std::string name, std::function<bool()> work, const std::vector<UINT>& dependencies = {});
+	bool Run(UINT threadCount);
+
+	inline const std::vector<BuildTaskTime>& GetTimes() const;
+	inline UINT GetMaxConcurrency() const;
+
+private:
+	void Work();
+	void Finish(UINT index, bool succeeded);
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_readyCondition;
+	std::vector<Task> m_tasks;
+	std::vector<UINT> m_ready;
+	std::vector<BuildTaskTime> m_times;
+	UINT m_finishedCount;
+	UINT m_runningCount;
+	UINT m_maxConcurrency;
+};
+
+inline const std::vector<BuildTaskTime>& CBuildGraph::GetTimes() const { return m_times; }
+inline UINT CBuildGraph::GetMaxConcurrency() const { return m_maxConcurrency; }
+
+//PSO를 만드는 단계들. 렌더러는 장치와 CShader로 하고, 테스트는 가짜 컴파일러로 바꿔 끼운다.
+interface IPipelineBuildSteps
+{
+	virtual ~IPipelineBuildSteps() {};
+	virtual bool BuildRootSignatures() = 0;
+	virtual bool CompileShader(GraphicsPSO psoType, ShaderType shaderType) = 0;
+	virtual bool CreatePipelineState(GraphicsPSO psoType) = 0;
+};
+
+//PSO마다 (PSO, 셰이더 단계)별 컴파일과 루트 시그너쳐가 끝나야 PSO를 만든다. 컴파일끼리는 서로 기다리지 않는다.
+void AddPipelineTasks(IPipelineBuildSteps* steps,
+	const std::map<GraphicsPSO, std::vector<ShaderType>>& psoShaders, CBuildGraph* outGraph);
@@ -0,0 +1,242 @@
+﻿#include "pch.h"
+#include "./CommandStream.h"
+
+CCommandStream::CCommandStream()
+	: m_blocks{}
+	, m_currBlock{ 0 }
+	, m_state{}
+	, m_stats{}
+{}
+CCommandStream::~CCommandStream() = default;
+
+//블럭 메모리는 그대로 두고 처음부터 다시 쓴다.
+void CCommandStream::Reset()
+{
+	for (auto& block : m_blocks)
+		block.used = 0;
+
+	m_currBlock = 0;
+	m_state = {};
+	m_stats = {};
+}
+
+template<typename T>
+bool CCommandStream::IsSame(std::optional<T>& last, const T& value)
+{
+	if (last == value)
+	{
+		m_stats.elidedCount++;
+		return true;
+	}
+
+	last = value;
+	return false;
+}
+
+//패킷이 블럭 경계에 걸치지 않게 남은 자리가 모자라면 다음 블럭으로 넘어간다.
+BYTE* CCommandStream::Allocate(size_t size)
+{
+	if (!m_blocks.empty() && m_blocks[m_currBlock].used + size > BlockSize)
+		m_currBlock++;
+	if (m_currBlock == m_blocks.size())
+		m_blocks.emplace_back(Block{ std::make_unique<BYTE[]>(BlockSize), 0 });
+
+	Block& block = m_blocks[m_currBlock];
+	BYTE* data = block.data.get() + block.used;
+	block.used += size;
+
+	return data;
+}
+
+template<typename... Ts>
+void CCommandStream::Write(CommandType type, const Ts&... values)
+{
+	constexpr size_t size = (sizeof(CommandType) + ... + sizeof(Ts));
+	BYTE* data = Allocate(size);
+	std::memcpy(data, &type, sizeof(CommandType));
+	data += sizeof(CommandType);
+	((std::memcpy(data, &values, sizeof(Ts)), data += sizeof(Ts)), ...);
+
+	m_stats.packetCount++;
+	m_stats.bytes += size;
+}
+
+void CCommandStream::SetRootSignature(RootSignature rootSignature)
+{
+	if (IsSame(m_state.rootSignature, rootSignature)) return;
+
+	m_state.rootArguments = {};
+	Write(CommandType::SetRootSignature, rootSignature);
+}
+
+void CCommandStream::SetPipelineState(GraphicsPSO pso)
+{
+	if (IsSame(m_state.pso, pso)) return;
+	Write(CommandType::SetPipelineState, pso);
+}
+
+void CCommandStream::SetRootArgument(CommandType type, UINT slot, UINT64 value)
+{
+	if (slot < MaxRootSlot && IsSame(m_state.rootArguments[slot], value)) return;
+	Write(type, slot, value);
+}
+
+void CCommandStream::SetRootConstantBuffer(UINT slot, UINT64 address)
+{
+	SetRootArgument(CommandType::SetRootConstantBuffer, slot, address);
+}
+
+void CCommandStream::SetRootShaderResource(UINT slot, UINT64 address)
+{
+	SetRootArgument(CommandType::SetRootShaderResource, slot, address);
+}
+
+void CCommandStream::SetRootDescriptorTable(UINT slot, UINT64 gpuHandle)
+{
+	SetRootArgument(CommandType::SetRootDescriptorTable, slot, gpuHandle);
+}
+
+void CCommandStream::SetVertexBuffer(const CommandVertexBuffer& vertexBuffer)
+{
+	if (IsSame(m_state.vertexBuffer, vertexBuffer)) return;
+	Write(CommandType::SetVertexBuffer, vertexBuffer);
+}
+
+void CCommandStream::SetIndexBuffer(const CommandIndexBuffer& indexBuffer)
+{
+	if (IsSame(m_state.indexBuffer, indexBuffer)) return;
+	Write(CommandType::SetIndexBuffer, indexBuffer);
+}
+
+void CCommandStream::SetPrimitiveTopology(UINT topology)
+{
+	if (IsSame(m_state.topology, topology)) return;
+	Write(CommandType::SetPrimitiveTopology, topology);
+}
+
+void CCommandStream::SetViewport(const CommandViewport& viewport)
+{
+	if (IsSame(m_state.viewport, viewport)) return;
+	Write(CommandType::SetViewport, viewport);
+}
+
+void CCommandStream::SetScissorRect(const CommandRect& rect)
+{
+	if (IsSame(m_state.scissorRect, rect)) return;
+	Write(CommandType::SetScissorRect, rect);
+}
+
+void CCommandStream::SetRenderTarget(UINT64 rtvHandle, UINT64 dsvHandle)
+{
+	if (IsSame(m_state.renderTarget, std::make_pair(rtvHandle, dsvHandle))) return;
+	Write(CommandType::SetRenderTarget, rtvHandle, dsvHandle);
+}
+
+void CCommandStream::ClearRenderTarget(UINT64 rtvHandle, const std::array<float, 4>& color)
+{
+	Write(CommandType::ClearRenderTarget, rtvHandle, color);
+}
+
+void CCommandStream::ClearDepthStencil(UINT64 dsvHandle, float depth, UINT stencil)
+{
+	Write(CommandType::ClearDepthStencil, dsvHandle, depth, stencil);
+}
+
+void CCommandStream::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, int baseVertex, UINT startInstance)
+{
+	Write(CommandType::DrawIndexedInstanced, indexCount, instanceCount, startIndex, baseVertex, startInstance);
+	m_stats.drawCount++;
+}
+
+template<typename T>
+T ReadPacketValue(const BYTE*& data)
+{
+	T value{};
+	std::memcpy(&value, data, sizeof(T));
+	data += sizeof(T);
+
+	return value;
+}
+
+//인자를 읽는 순서가 쓴 순서와 같아야 해서 하나씩 변수로 받아 넘긴다.
+void CCommandStream::Replay(ICommandSink* sink) const
+{
+	for (auto& block : m_blocks | std::views::take(m_currBlock + 1))
+	{
+		const BYTE* data = block.data.get();
+		const BYTE* end = data + block.used;
+		while (data < end)
+		{
+			switch (ReadPacketValue<CommandType>(data))
+			{
+			case CommandType::SetRootSignature:
+				sink->SetRootSignature(ReadPacketValue<RootSignature>(data));
+				break;
+			case CommandType::SetPipelineState:
+				sink->SetPipelineState(ReadPacketValue<GraphicsPSO>(data));
+				break;
+			case CommandType::SetRootConstantBuffer:
+			{
+				const UINT slot = ReadPacketValue<UINT>(data);
+				sink->SetRootConstantBuffer(slot, ReadPacketValue<UINT64>(data));
+				break;
+			}
+			case CommandType::SetRootShaderResource:
+			{
+				const UINT slot = ReadPacketValue<UINT>(data);
+				sink->SetRootShaderResource(slot, ReadPacketValue<UINT64>(data));
+				break;
+			}
+			case CommandType::SetRootDescriptorTable:
+			{
+				const UINT slot = ReadPacketValue<UINT>(data);
+				sink->SetRootDescriptorTable(slot, ReadPacketValue<UINT64>(data));
+				break;
+			}
+			case CommandType::SetVertexBuffer:
+				sink->SetVertexBuffer(ReadPacketValue<CommandVertexBuffer>(data));
+				break;
+			case CommandType::SetIndexBuffer:
+				sink->SetIndexBuffer(ReadPacketValue<CommandIndexBuffer>(data));
+				break;
+			case CommandType::SetPrimitiveTopology:
+				sink->SetPrimitiveTopology(ReadPacketValue<UINT>(data));
+				break;
+			case CommandType::SetViewport:
+				sink->SetViewport(ReadPacketValue<CommandViewport>(data));
+				break;
+			case CommandType::SetScissorRect:
+				sink->SetScissorRect(ReadPacketValue<CommandRect>(data));
+				break;
+			case CommandType::SetRenderTarget:
+			{
+				const UINT64 rtvHandle = ReadPacketValue<UINT64>(data);
+				sink->SetRenderTarget(rtvHandle, ReadPacketValue<UINT64>(data));
+				break;
+			}
+			case CommandType::ClearRenderTarget:
+			{
+				const UINT64 rtvHandle = ReadPacketValue<UINT64>(data);
+				sink->ClearRenderTarget(rtvHandle, ReadPacketValue<std::array<float, 4>>(data));
+				break;
+			}
+			case CommandType::ClearDepthStencil:
+			{
+				const UINT64 dsvHandle = ReadPacketValue<UINT64>(data);
+				const float depth = ReadPacketValue<float>(data);
+				sink->ClearDepthStencil(dsvHandle, depth, ReadPacketValue<UINT>(data));
+				break;
+			}
+			case CommandType::DrawIndexedInstanced:
+			{
+				const UINT indexCount = ReadPacketValue<UINT>(data);
+				const UINT instanceCount = ReadPacketValue<UINT>(data);
+				const UINT startIndex = ReadPacketValue<UINT>(data);
+				const int baseVertex = ReadPacketValue<int>(data);
+				sink->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, ReadPacketValue<UINT>(data));
+				break;
+			}
+			}
+		}
+	}
+}
@@ -0,0 +1,168 @@
+﻿#pragma once
+
+#include <optional>
+
+enum class GraphicsPSO : int;
+enum class RootSignature : int;
+
+//장치에 매이지 않는 값들. 디스크립터와 버퍼는 주소(ptr) 값만 담는다.
+struct CommandViewport
+{
+	float x{ 0.0f };
+	float y{ 0.0f };
+	float width{ 0.0f };
+	float height{ 0.0f };
+	float minDepth{ 0.0f };
+	float maxDepth{ 1.0f };
+
+	bool operator==(const CommandViewport&) const = default;
+};
+
+struct CommandRect
+{
+	int left{ 0 };
+	int top{ 0 };
+	int right{ 0 };
+	int bottom{ 0 };
+
+	bool operator==(const CommandRect&) const = default;
+};
+
+struct CommandVertexBuffer
+{
+	UINT64 location{ 0 };
+	UINT size{ 0u };
+	UINT stride{ 0u };
+
+	bool operator==(const CommandVertexBuffer&) const = default;
+};
+
+struct CommandIndexBuffer
+{
+	UINT64 location{ 0 };
+	UINT size{ 0u };
+	DXGI_FORMAT format{ DXGI_FORMAT_UNKNOWN };
+
+	bool operator==(const CommandIndexBuffer&) const = default;
+};
+
+struct CommandStreamStats
+{
+	UINT packetCount{ 0u };
+	UINT elidedCount{ 0u };		//앞과 같은 상태라서 기록하지 않은 수
+	UINT drawCount{ 0u };
+	size_t bytes{ 0 };
+};
+
+//스트림을 다시 풀어 받는 곳. 렌더러는 D3D12 커맨드 리스트로 옮기고, 테스트는 호출을 센다.
+interface ICommandSink
+{
+	virtual ~ICommandSink() {};
+	virtual void SetRootSignature(RootSignature rootSignature) = 0;
+	virtual void SetPipelineState(GraphicsPSO pso) = 0;
+	virtual void SetRootConstantBuffer(UINT slot, UINT64 address) = 0;
+	virtual void SetRootShaderResource(UINT slot, UINT64 address) = 0;
+	virtual void SetRootDescriptorTable(UINT slot, UINT64 gpuHandle) = 0;
+	virtual void SetVertexBuffer(const CommandVertexBuffer& vertexBuffer) = 0;
+	virtual void SetIndexBuffer(const CommandIndexBuffer& indexBuffer) = 0;
+	virtual void SetPrimitiveTopology(UINT topology) = 0;
+	virtual void SetViewport(const CommandViewport& viewport) = 0;
+	virtual void SetScissorRect(const CommandRect& rect) = 0;
+	virtual void SetRenderTarget(UINT64 rtvHandle, UINT64 dsvHandle) = 0;
+	virtual void ClearRenderTarget(UINT64 rtvHandle, const std::array<float, 4>& color) = 0;
+	virtual void ClearDepthStencil(UINT64 dsvHandle, float depth, UINT stencil) = 0;
+	virtual void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, int baseVertex, UINT startInstance) = 0;
+};
+
+//한 스레드가 한 패스를 기록하는 버퍼. 패킷은 종류 1바이트 뒤에 값을 그대로 붙여 블럭에 이어 쓰고,
+//블럭은 Reset해도 버리지 않고 다음 프레임에 다시 쓴다. 앞과 같은 상태 변경은 기록하지 않는다.
+//스트림마다 상태를 따로 들고 있어서 다른 스레드와 나눠 쓰지 않는다.
+class CCommandStream
+{
+	enum class CommandType : BYTE
+	{
+		SetRootSignature,
+		SetPipelineState,
+		SetRootConstantBuffer,
+		SetRootShaderResource,
+		SetRootDescriptorTable,
+		SetVertexBuffer,
+		SetIndexBuffer,
+		SetPrimitiveTopology,
+		SetViewport,
+		SetScissorRect,
+		SetRenderTarget,
+		ClearRenderTarget,
+		ClearDepthStencil,
+		DrawIndexedInstanced,
+	};
+
+	struct Block
+	{
+		std::unique_ptr<BYTE[]> data{};
+		size_t used{ 0 };
+	};
+
+	static constexpr UINT MaxRootSlot{ 16u };
+	static constexpr size_t BlockSize{ 64 * 1024 };
+
+	//마지막으로 기록한 상태. 루트 시그너쳐가 바뀌면 루트 인자는 다시 넣어야 한다.
+	struct State
+	{
+		std::optional<RootSignature> rootSignature{};
+		std::optional<GraphicsPSO> pso{};
+		std::array<std::optional<UINT64>, MaxRootSlot> rootArguments{};
+		std::optional<CommandVertexBuffer> vertexBuffer{};
+		std::optional<CommandIndexBuffer> indexBuffer{};
+		std::optional<UINT> topology{};
+		std::optional<CommandViewport> viewport{};
+		std::optional<CommandRect> scissorRect{};
+		std::optional<std::pair<UINT64, UINT64>> renderTarget{};
+	};
+
+public:
+	CCommandStream();
+	~CCommandStream();
+
+	CCommandStream(const CCommandStream&) = delete;
+	CCommandStream& operator=(const CCommandStream&) = delete;
+
+	void Reset();
+
+	void SetRootSignature(RootSignature rootSignature);
+	void SetPipelineState(GraphicsPSO pso);
+	void SetRootConstantBuffer(UINT slot, UINT64 address);
+	void SetRootShaderResource(UINT slot, UINT64 address);
+	void SetRootDescriptorTable(UINT slot, UINT64 gpuHandle);
+	void SetVertexBuffer(const CommandVertexBuffer& vertexBuffer);
+	void SetIndexBuffer(const CommandIndexBuffer& indexBuffer);
+	void SetPrimitiveTopology(UINT topology);
+	void SetViewport(const CommandViewport& viewport);
+	void SetScissorRect(const CommandRect& rect);
+	void SetRenderTarget(UINT64 rtvHandle, UINT64 dsvHandle);
+	void ClearRenderTarget(UINT64 rtvHandle, const std::array<float, 4>& color);
+	void ClearDepthStencil(UINT64 dsvHandle, float depth, UINT stencil);
+	void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, int baseVertex, UINT startInstance);
+
+	void Replay(ICommandSink* sink) const;
+
+	inline const CommandStreamStats& GetStats() const;
+	inline size_t GetCapacity() const;
+
+private:
+	template<typename T>
+	bool IsSame(std::optional<T>& last, const T& value);
+	void SetRootArgument(CommandType type, UINT slot, UINT64 value);
+	template<typename... Ts>
+	void Write(CommandType type, const Ts&... values);
+	BYTE* Allocate(size_t size);
+
+private:
+	std::vector<Block> m_blocks;
+	size_t m_currBlock;
+	State m_state;
+	CommandStreamStats m_stats;
+};
+
+inline const CommandStreamStats& CCommandStream::GetStats() const { return m_stats; }
+inline size_t CCommandStream::GetCapacity() const { return m_blocks.size() * BlockSize; }
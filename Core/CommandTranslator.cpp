@@ -0,0 +1,106 @@
+﻿#include "pch.h"
+#include "./CommandTranslator.h"
+#include "./RootSignature.h"
+#include "./PipelineStateObjects.h"
+
+CommandViewport ToCommandViewport(const D3D12_VIEWPORT& viewport)
+{
+	return CommandViewport{ viewport.TopLeftX, viewport.TopLeftY, viewport.Width, viewport.Height, viewport.MinDepth, viewport.MaxDepth };
+}
+
+CommandRect ToCommandRect(const D3D12_RECT& rect)
+{
+	return CommandRect{ static_cast<int>(rect.left), static_cast<int>(rect.top), static_cast<int>(rect.right), static_cast<int>(rect.bottom) };
+}
+
+CCommandTranslator::CCommandTranslator(ID3D12GraphicsCommandList* cmdList, CPipelineStateObjects* pso)
+	: m_cmdList{ cmdList }
+	, m_pso{ pso }
+	, m_rootSignature{ nullptr }
+{}
+CCommandTranslator::~CCommandTranslator() = default;
+
+void CCommandTranslator::Translate(CRootSignature* rootSignature, const CCommandStream& stream)
+{
+	m_rootSignature = rootSignature;
+	stream.Replay(this);
+}
+
+void CCommandTranslator::SetRootSignature(RootSignature rootSignature)
+{
+	m_cmdList->SetGraphicsRootSignature(m_rootSignature->Get(rootSignature));
+}
+
+void CCommandTranslator::SetPipelineState(GraphicsPSO pso)
+{
+	m_cmdList->SetPipelineState(m_pso->GetPso(pso));
+}
+
+void CCommandTranslator::SetRootConstantBuffer(UINT slot, UINT64 address)
+{
+	m_cmdList->SetGraphicsRootConstantBufferView(slot, address);
+}
+
+void CCommandTranslator::SetRootShaderResource(UINT slot, UINT64 address)
+{
+	m_cmdList->SetGraphicsRootShaderResourceView(slot, address);
+}
+
+void CCommandTranslator::SetRootDescriptorTable(UINT slot, UINT64 gpuHandle)
+{
+	m_cmdList->SetGraphicsRootDescriptorTable(slot, D3D12_GPU_DESCRIPTOR_HANDLE{ gpuHandle });
+}
+
+void CCommandTranslator::SetVertexBuffer(const CommandVertexBuffer& vertexBuffer)
+{
+	const D3D12_VERTEX_BUFFER_VIEW view{ vertexBuffer.location, vertexBuffer.size, vertexBuffer.stride };
+	m_cmdList->IASetVertexBuffers(0, 1, &view);
+}
+
+void CCommandTranslator::SetIndexBuffer(const CommandIndexBuffer& indexBuffer)
+{
+	const D3D12_INDEX_BUFFER_VIEW view{ indexBuffer.location, indexBuffer.size, indexBuffer.format };
+	m_cmdList->IASetIndexBuffer(&view);
+}
+
+void CCommandTranslator::SetPrimitiveTopology(UINT topology)
+{
+	m_cmdList->IASetPrimitiveTopology(static_cast<D3D12_PRIMITIVE_TOPOLOGY>(topology));
+}
+
+void CCommandTranslator::SetViewport(const CommandViewport& viewport)
+{
+	const D3D12_VIEWPORT d3dViewport{ viewport.x, viewport.y, viewport.width, viewport.height, viewport.minDepth, viewport.maxDepth };
+	m_cmdList->RSSetViewports(1, &d3dViewport);
+}
+
+void CCommandTranslator::SetScissorRect(const CommandRect& rect)
+{
+	const D3D12_RECT d3dRect{ rect.left, rect.top, rect.right, rect.bottom };
+	m_cmdList->RSSetScissorRects(1, &d3dRect);
+}
+
+//핸들이 0이면 그 자리는 비운다. 그림자맵은 깊이만 쓴다.
+void CCommandTranslator::SetRenderTarget(UINT64 rtvHandle, UINT64 dsvHandle)
+{
+	const D3D12_CPU_DESCRIPTOR_HANDLE rtv{ static_cast<SIZE_T>(rtvHandle) };
+	const D3D12_CPU_DESCRIPTOR_HANDLE dsv{ static_cast<SIZE_T>(dsvHandle) };
+	m_cmdList->OMSetRenderTargets(rtvHandle != 0 ? 1 : 0, rtvHandle != 0 ? &rtv : nullptr,
+		rtvHandle != 0, dsvHandle != 0 ? &dsv : nullptr);
+}
+
+void CCommandTranslator::ClearRenderTarget(UINT64 rtvHandle, const std::array<float, 4>& color)
+{
+	m_cmdList->ClearRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE{ static_cast<SIZE_T>(rtvHandle) }, color.data(), 0, nullptr);
+}
+
+void CCommandTranslator::ClearDepthStencil(UINT64 dsvHandle, float depth, UINT stencil)
+{
+	m_cmdList->ClearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE{ static_cast<SIZE_T>(dsvHandle) },
+		D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, depth, static_cast<UINT8>(stencil), 0, nullptr);
+}
+
+void CCommandTranslator::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, int baseVertex, UINT startInstance)
+{
+	m_cmdList->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
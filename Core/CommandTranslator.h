@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include "./CommandStream.h"
+
+class CRootSignature;
+class CPipelineStateObjects;
+
+CommandViewport ToCommandViewport(const D3D12_VIEWPORT& viewport);
+CommandRect ToCommandRect(const D3D12_RECT& rect);
+
+//기록한 스트림을 D3D12 커맨드 리스트로 옮긴다. PSO와 루트 시그너쳐는 여기서 실제 객체로 바꾼다.
+class CCommandTranslator final : public ICommandSink
+{
+public:
+	CCommandTranslator(ID3D12GraphicsCommandList* cmdList, CPipelineStateObjects* pso);
+	~CCommandTranslator();
+
+	CCommandTranslator() = delete;
+	CCommandTranslator(const CCommandTranslator&) = delete;
+	CCommandTranslator& operator=(const CCommandTranslator&) = delete;
+
+	void Translate(CRootSignature* rootSignature, const CCommandStream& stream);
+
+	virtual void SetRootSignature(RootSignature rootSignature) override;
+	virtual void SetPipelineState(GraphicsPSO pso) override;
+	virtual void SetRootConstantBuffer(UINT slot, UINT64 address) override;
+	virtual void SetRootShaderResource(UINT slot, UINT64 address) override;
+	virtual void SetRootDescriptorTable(UINT slot, UINT64 gpuHandle) override;
+	virtual void SetVertexBuffer(const CommandVertexBuffer& vertexBuffer) override;
+	virtual void SetIndexBuffer(const CommandIndexBuffer& indexBuffer) override;
+	virtual void SetPrimitiveTopology(UINT topology) override;
+	virtual void SetViewport(const CommandViewport& viewport) override;
+	virtual void SetScissorRect(const CommandRect& rect) override;
+	virtual void SetRenderTarget(UINT64 rtvHandle, UINT64 dsvHandle) override;
+	virtual void ClearRenderTarget(UINT64 rtvHandle, const std::array<float, 4>& color) override;
+	virtual void ClearDepthStencil(UINT64 dsvHandle, float depth, UINT stencil) override;
+	virtual void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, int baseVertex, UINT startInstance) override;
+
+private:
+	ID3D12GraphicsCommandList* m_cmdList;
+	CPipelineStateObjects* m_pso;
+	CRootSignature* m_rootSignature;
+};
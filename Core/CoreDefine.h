@@ -1,12 +1,15 @@
 #pragma once
 
 const int gPassCBCount = 2;	//passCB, shadowPassCB
-const int gInstanceBufferCount = 200;
-const int gMaterialBufferCount = 100;
+const int gMaterialBufferCount = 100;	//모자라면 늘린다
+const UINT64 gUploadPageSize = 2 * 1024 * 1024;	//인스턴스, 본 팔레트를 잘라 쓰는 업로드 페이지 크기
+const UINT64 gUploadAlignment = 256;
+const UINT64 gTextureBudgetBytes = 512 * 1024 * 1024;	//넘으면 오래 쓰지 않은 텍스쳐부터 mip tail만 남긴다
+const UINT gMipTailSize = 64;	//가로 세로가 이 이하인 밉은 내리지 않는다
 
-//̴ 빰  ڷᰡ ִٰ Ѵ.
-//Ƽ ġ   ̴ Ϳ   ȵȴ.
-//ؽ  ־ .
+//셰이더의 내용물은 늘 자료가 있다고 가정한다.
+//남아서 넘치는 건 상관없지만 셰이더 데이터에 빈공간이 있으면 안된다.
+//텍스춰는 빈공간이 있어도 상관없다.
 constexpr UINT CubeCount{ 1u };
 constexpr UINT ShadowCount{ 1u };
 constexpr UINT SsaoAmbientMap0Count{ 1u };
@@ -14,9 +17,10 @@ constexpr UINT SsaoAmbientMap1Count{ 1u };
 constexpr UINT SsaoNormalMapCount{ 1u };
 constexpr UINT SsaoDepthMapCount{ 1u };
 constexpr UINT SsaoRandomVectorCount{ 1u };
-constexpr UINT TextureCount{ 60u };
+constexpr UINT TextureCount{ 60u };	//처음 잡는 텍스쳐 구간. 모자라면 descriptor heap이 늘린다.
 constexpr UINT TotalSsaoCount = SsaoAmbientMap0Count + SsaoAmbientMap1Count + SsaoNormalMapCount + SsaoDepthMapCount + SsaoRandomVectorCount;
 constexpr UINT TotalShaderResourceViewHeap = CubeCount + ShadowCount + TotalSsaoCount + TextureCount;
+constexpr UINT TransientSrvCount{ 256u };	//프레임마다 잘라 쓰는 임시 srv
 
 constexpr UINT SwapChainBufferCount{ 2u };
 constexpr UINT SsaoScreenNormalMap{ 1u };
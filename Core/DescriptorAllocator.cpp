@@ -0,0 +1,107 @@
+﻿#include "pch.h"
+#include "./DescriptorAllocator.h"
+
+CDescriptorAllocator::CDescriptorAllocator(UINT persistentCapacity, UINT transientCapacity)
+	: m_persistentCapacity{ persistentCapacity }
+	, m_freeRanges{}
+	, m_transientCapacity{ transientCapacity }
+	, m_transientHead{ 0u }
+	, m_transientUsed{ 0u }
+	, m_frameUsed{ 0u }
+	, m_retiredFrames{}
+{
+	if (persistentCapacity != 0)
+		m_freeRanges.emplace_back(DescriptorRange{ 0u, persistentCapacity });
+}
+CDescriptorAllocator::~CDescriptorAllocator() = default;
+
+bool CDescriptorAllocator::Allocate(UINT count, DescriptorRange* outRange)
+{
+	if (count == 0) return false;
+
+	auto find = std::ranges::find_if(m_freeRanges, [count](auto& range) { return range.count >= count; });
+	if (find == m_freeRanges.end()) return false;
+
+	(*outRange) = DescriptorRange{ find->offset, count };
+	find->offset += count;
+	find->count -= count;
+	if (find->count == 0) m_freeRanges.erase(find);
+
+	return true;
+}
+
+void CDescriptorAllocator::Free(const DescriptorRange& range)
+{
+	if (range.count == 0) return;
+
+	auto next = std::ranges::upper_bound(m_freeRanges, range.offset, {}, &DescriptorRange::offset);
+	auto cur = m_freeRanges.insert(next, range);
+
+	//뒤의 빈 구간과 이어지면 합친다.
+	auto after = std::next(cur);
+	if (after != m_freeRanges.end() && cur->offset + cur->count == after->offset)
+	{
+		cur->count += after->count;
+		cur = std::prev(m_freeRanges.erase(after));
+	}
+
+	//앞의 빈 구간과 이어지면 합친다.
+	if (cur != m_freeRanges.begin())
+	{
+		auto before = std::prev(cur);
+		if (before->offset + before->count == cur->offset)
+		{
+			before->count += cur->count;
+			m_freeRanges.erase(cur);
+		}
+	}
+}
+
+//임시 영역은 늘어난 영역 뒤로 밀린다. 힙을 새로 만든 뒤에 부른다.
+void CDescriptorAllocator::Grow(UINT persistentCapacity)
+{
+	if (persistentCapacity <= m_persistentCapacity) return;
+
+	Free(DescriptorRange{ m_persistentCapacity, persistentCapacity - m_persistentCapacity });
+	m_persistentCapacity = persistentCapacity;
+}
+
+//돌려주는 위치는 힙 전체에서의 위치다. 끝에 들어가지 않으면 끝을 버리고 처음부터 자른다.
+bool CDescriptorAllocator::AllocateTransient(UINT count, UINT* outOffset)
+{
+	if (count == 0 || count > m_transientCapacity) return false;
+
+	UINT offset = m_transientHead;
+	UINT skipped{ 0u };
+	if (offset + count > m_transientCapacity)
+	{
+		skipped = m_transientCapacity - offset;
+		offset = 0u;
+	}
+	if (m_transientUsed + skipped + count > m_transientCapacity) return false;
+
+	m_transientUsed += skipped + count;
+	m_frameUsed += skipped + count;
+	m_transientHead = offset + count;
+	(*outOffset) = m_persistentCapacity + offset;
+
+	return true;
+}
+
+void CDescriptorAllocator::FinishFrame(UINT64 fence)
+{
+	if (m_frameUsed == 0) return;
+
+	m_retiredFrames.emplace_back(fence, m_frameUsed);
+	m_frameUsed = 0u;
+}
+
+//프레임은 쓴 순서대로 물러나서 앞에서부터 펜스를 지난 만큼 돌려받는다.
+void CDescriptorAllocator::Recycle(UINT64 completedFence)
+{
+	while (!m_retiredFrames.empty() && m_retiredFrames.front().first <= completedFence)
+	{
+		m_transientUsed -= m_retiredFrames.front().second;
+		m_retiredFrames.pop_front();
+	}
+}
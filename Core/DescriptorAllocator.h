@@ -0,0 +1,57 @@
+﻿#pragma once
+
+#include <deque>
+
+struct DescriptorRange
+{
+	UINT offset{ 0u };
+	UINT count{ 0u };
+};
+
+//디스크립터 힙 안의 위치만 계산한다. D3D 객체는 만지지 않아서 장치 없이 테스트할 수 있다.
+//힙 앞쪽은 오래 쓰는 디스크립터 영역이고 빈 구간 목록에서 처음 맞는 구간을 잘라 준다.
+//지우면 이웃한 빈 구간과 합친다. 뒤쪽은 프레임마다 이어서 잘라 쓰는 임시 영역이고
+//프레임의 펜스를 GPU가 지나면 다시 쓴다.
+class CDescriptorAllocator
+{
+public:
+	CDescriptorAllocator(UINT persistentCapacity, UINT transientCapacity);
+	~CDescriptorAllocator();
+
+	CDescriptorAllocator() = delete;
+	CDescriptorAllocator(const CDescriptorAllocator&) = delete;
+	CDescriptorAllocator& operator=(const CDescriptorAllocator&) = delete;
+
+	bool Allocate(UINT count, DescriptorRange* outRange);
+	void Free(const DescriptorRange& range);
+	void Grow(UINT persistentCapacity);
+
+	bool AllocateTransient(UINT count, UINT* outOffset);
+	void FinishFrame(UINT64 fence);
+	void Recycle(UINT64 completedFence);
+
+	inline UINT GetCapacity() const;
+	inline UINT GetPersistentCapacity() const;
+	inline UINT GetFreeCount() const;
+	inline UINT GetTransientUsed() const;
+
+private:
+	UINT m_persistentCapacity;
+	std::vector<DescriptorRange> m_freeRanges;	//offset 순서로 정렬해 둔다
+
+	UINT m_transientCapacity;
+	UINT m_transientHead;		//임시 영역에서 다음에 자를 위치
+	UINT m_transientUsed;		//아직 GPU가 쓰고 있을수 있는 수(끝에서 버린 자리 포함)
+	UINT m_frameUsed;			//이번 프레임에 쓴 수
+	std::deque<std::pair<UINT64, UINT>> m_retiredFrames;
+};
+
+inline UINT CDescriptorAllocator::GetCapacity() const { return m_persistentCapacity + m_transientCapacity; }
+inline UINT CDescriptorAllocator::GetPersistentCapacity() const { return m_persistentCapacity; }
+inline UINT CDescriptorAllocator::GetTransientUsed() const { return m_transientUsed; }
+inline UINT CDescriptorAllocator::GetFreeCount() const
+{
+	UINT freeCount{ 0u };
+	for (auto& range : m_freeRanges) freeCount += range.count;
+	return freeCount;
+}
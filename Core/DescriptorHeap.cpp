@@ -1,4 +1,4 @@
-#include "pch.h"
+﻿#include "pch.h"
 #include "./DescriptorHeap.h"
 #include "../Include/types.h"
 #include "./CoreDefine.h"
@@ -7,7 +7,11 @@
 CDescriptorHeap::~CDescriptorHeap() = default;
 CDescriptorHeap::CDescriptorHeap()
 	: m_device{ nullptr }
+	, m_srvCpuHeap{ nullptr }
 	, m_srvDescHeap{ nullptr }
+	, m_srvAllocator{ nullptr }
+	, m_srvRanges{}
+	, m_retiredHeaps{}
 	, m_dsvDescHeap{ nullptr }
 	, m_rtvDescHeap{ nullptr }
 {}
@@ -35,23 +39,149 @@ bool CDescriptorHeap::Build(ID3D12Device* device)
 	m_dsvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
 	m_rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 
-	ReturnIfFalse(CreateDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, TotalShaderResourceViewHeap,
-		D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE, m_srvDescHeap.GetAddressOf()));
+	m_srvAllocator = std::make_unique<CDescriptorAllocator>(TotalShaderResourceViewHeap, TransientSrvCount);
+	ReturnIfFalse(CreateSrvHeaps(TotalShaderResourceViewHeap));
 	ReturnIfFalse(CreateDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_DSV, TotalDepthStencilView,
 		D3D12_DESCRIPTOR_HEAP_FLAG_NONE, m_dsvDescHeap.GetAddressOf()));
 	ReturnIfFalse(CreateDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_RTV, TotalRenderTargetViewHeap,
 		D3D12_DESCRIPTOR_HEAP_FLAG_NONE, m_rtvDescHeap.GetAddressOf()));
 
+	//텍스쳐 구간은 모자라면 더 큰 구간으로 옮긴다.
+	const std::vector<std::pair<SrvOffset, UINT>> srvCounts{
+		{ SrvOffset::ShadowMap, ShadowCount },
+		{ SrvOffset::SsaoAmbientMap0, SsaoAmbientMap0Count },
+		{ SrvOffset::SsaoAmbientMap1, SsaoAmbientMap1Count },
+		{ SrvOffset::SsaoNormalMap, SsaoNormalMapCount },
+		{ SrvOffset::SsaoDepthMap, SsaoDepthMapCount },
+		{ SrvOffset::SsaoRandomVectorMap, SsaoRandomVectorCount },
+		{ SrvOffset::TextureCube, CubeCount },
+		{ SrvOffset::Texture2D, TextureCount } };
+	return std::ranges::all_of(srvCounts, [this](auto& srvCount) {
+		return m_srvAllocator->Allocate(srvCount.second, &m_srvRanges[srvCount.first]); });
+}
+
+//앞쪽은 오래 쓰는 srv, 뒤쪽 TransientSrvCount개는 프레임마다 쓰는 임시 srv 자리다.
+bool CDescriptorHeap::CreateSrvHeaps(UINT persistentCapacity)
+{
+	const UINT capacity = persistentCapacity + TransientSrvCount;
+	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> cpuHeap{ nullptr }, shaderHeap{ nullptr };
+	ReturnIfFalse(CreateDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, capacity,
+		D3D12_DESCRIPTOR_HEAP_FLAG_NONE, cpuHeap.GetAddressOf()));
+	ReturnIfFalse(CreateDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, capacity,
+		D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE, shaderHeap.GetAddressOf()));
+
+	if (m_srvCpuHeap != nullptr)
+	{
+		m_device->CopyDescriptorsSimple(m_srvAllocator->GetPersistentCapacity(),
+			GetCpuSrvHandle(cpuHeap.Get(), 0), GetCpuSrvHandle(m_srvCpuHeap.Get(), 0),
+			D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+		m_retiredHeaps.emplace_back(m_lastFence, std::move(m_srvDescHeap));
+	}
+
+	const UINT copyCount = (m_srvCpuHeap != nullptr) ? m_srvAllocator->GetPersistentCapacity() : 0u;
+	m_srvCpuHeap = std::move(cpuHeap);
+	m_srvDescHeap = std::move(shaderHeap);
+	m_srvAllocator->Grow(persistentCapacity);
+	CopySrvToShaderVisible(0, copyCount);
+
 	return true;
 }
 
-void CDescriptorHeap::CreateShaderResourceView(SrvOffset offset, UINT index,
+//구간을 더 큰 곳으로 옮기고 이미 만든 srv를 따라 옮긴다. 빈 자리가 없으면 힙을 두배로 늘린다.
+bool CDescriptorHeap::GrowSrvRange(SrvOffset offset, UINT minCount)
+{
+	DescriptorRange& range = m_srvRanges[offset];
+	const UINT newCount = std::max(minCount, range.count * 2);
+
+	DescriptorRange newRange{};
+	if (!m_srvAllocator->Allocate(newCount, &newRange))
+	{
+		ReturnIfFalse(CreateSrvHeaps(m_srvAllocator->GetPersistentCapacity() * 2 + newCount));
+		ReturnIfFalse(m_srvAllocator->Allocate(newCount, &newRange));
+	}
+
+	m_device->CopyDescriptorsSimple(range.count,
+		GetCpuSrvHandle(m_srvCpuHeap.Get(), newRange.offset), GetCpuSrvHandle(m_srvCpuHeap.Get(), range.offset),
+		D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	CopySrvToShaderVisible(newRange.offset, range.count);
+
+	m_srvAllocator->Free(range);
+	range = newRange;
+
+	return true;
+}
+
+void CDescriptorHeap::CopySrvToShaderVisible(UINT start, UINT count)
+{
+	if (count == 0) return;
+
+	m_device->CopyDescriptorsSimple(count,
+		GetCpuSrvHandle(m_srvDescHeap.Get(), start), GetCpuSrvHandle(m_srvCpuHeap.Get(), start),
+		D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE CDescriptorHeap::GetCpuSrvHandle(ID3D12DescriptorHeap* heap, UINT index) const
+{
+	CD3DX12_CPU_DESCRIPTOR_HANDLE cpuDesc{ heap->GetCPUDescriptorHandleForHeapStart() };
+	cpuDesc.Offset(index, m_cbvSrvUavDescSize);
+
+	return cpuDesc;
+}
+
+bool CDescriptorHeap::CreateShaderResourceView(SrvOffset offset, UINT index,
 	const D3D12_SHADER_RESOURCE_VIEW_DESC* pDesc, ID3D12Resource* pRes)
 {
-	CD3DX12_CPU_DESCRIPTOR_HANDLE cpuDesc{ m_srvDescHeap->GetCPUDescriptorHandleForHeapStart() };
-	cpuDesc.Offset(EtoV(offset) + index, m_cbvSrvUavDescSize);
+	if (index >= m_srvRanges[offset].count)
+		ReturnIfFalse(GrowSrvRange(offset, index + 1));
 
-	m_device->CreateShaderResourceView(pRes, pDesc, cpuDesc);
+	const UINT heapIndex = m_srvRanges[offset].offset + index;
+	m_device->CreateShaderResourceView(pRes, pDesc, GetCpuSrvHandle(m_srvCpuHeap.Get(), heapIndex));
+	CopySrvToShaderVisible(heapIndex, 1);
+
+	return true;
+}
+
+//이번 프레임에만 쓰는 srv 자리. 셰이더용 힙에 바로 만든다.
+bool CDescriptorHeap::AllocateTransientSrv(UINT count,
+	D3D12_CPU_DESCRIPTOR_HANDLE* outCpuHandle, D3D12_GPU_DESCRIPTOR_HANDLE* outGpuHandle)
+{
+	UINT heapIndex{ 0u };
+	ReturnIfFalse(m_srvAllocator->AllocateTransient(count, &heapIndex));
+
+	(*outCpuHandle) = GetCpuSrvHandle(m_srvDescHeap.Get(), heapIndex);
+	CD3DX12_GPU_DESCRIPTOR_HANDLE gpuDesc{ m_srvDescHeap->GetGPUDescriptorHandleForHeapStart() };
+	(*outGpuHandle) = gpuDesc.Offset(heapIndex, m_cbvSrvUavDescSize);
+
+	return true;
+}
+
+//구간의 srv를 이번 프레임의 임시 자리에 복사한다. 프레임 도중에 텍스쳐 srv를 새로 만들어도
+//GPU가 그리고 있는 프레임은 복사해 둔 것을 읽는다. 자리가 모자라면 원래 구간을 그대로 쓴다.
+D3D12_GPU_DESCRIPTOR_HANDLE CDescriptorHeap::CopyToFrameSrv(SrvOffset offset)
+{
+	const DescriptorRange& range = m_srvRanges.at(offset);
+	D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle{};
+	D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle{};
+	if (!AllocateTransientSrv(range.count, &cpuHandle, &gpuHandle)) return GetGpuSrvHandle(offset);
+
+	m_device->CopyDescriptorsSimple(range.count, cpuHandle, GetCpuSrvHandle(m_srvCpuHeap.Get(), range.offset),
+		D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+	return gpuHandle;
+}
+
+void CDescriptorHeap::FinishFrame(UINT64 fence)
+{
+	m_lastFence = fence;
+	m_srvAllocator->FinishFrame(fence);
+}
+
+//늘리기 전의 힙은 그 힙을 쓴 프레임이 끝나야 놓는다.
+void CDescriptorHeap::Recycle(UINT64 completedFence)
+{
+	m_srvAllocator->Recycle(completedFence);
+	while (!m_retiredHeaps.empty() && m_retiredHeaps.front().first <= completedFence)
+		m_retiredHeaps.pop_front();
 }
 
 void CDescriptorHeap::CreateDepthStencilView(DsvOffset offset,
@@ -80,7 +210,7 @@ void CDescriptorHeap::SwapBackBuffer()
 D3D12_GPU_DESCRIPTOR_HANDLE CDescriptorHeap::GetGpuSrvHandle(SrvOffset offset) const
 {
 	CD3DX12_GPU_DESCRIPTOR_HANDLE gpuDesc{ m_srvDescHeap->GetGPUDescriptorHandleForHeapStart() };
-	gpuDesc.Offset(EtoV(offset), m_cbvSrvUavDescSize);
+	gpuDesc.Offset(m_srvRanges.at(offset).offset, m_cbvSrvUavDescSize);
 
 	return gpuDesc;
 }
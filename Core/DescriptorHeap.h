@@ -1,4 +1,6 @@
-#pragma once
+﻿#pragma once
+
+#include "./DescriptorAllocator.h"
 
 enum class SrvOffset : int;
 enum class DsvOffset : int;
@@ -14,8 +16,13 @@ public:
 	CDescriptorHeap& operator=(const CDescriptorHeap&) = delete;
 
 	bool Build(ID3D12Device* device);
-	void CreateShaderResourceView(SrvOffset offset, UINT index,
+	bool CreateShaderResourceView(SrvOffset offset, UINT index,
 		const D3D12_SHADER_RESOURCE_VIEW_DESC* pDesc, ID3D12Resource* pRes);
+	bool AllocateTransientSrv(UINT count, 
+		D3D12_CPU_DESCRIPTOR_HANDLE* outCpuHandle, D3D12_GPU_DESCRIPTOR_HANDLE* outGpuHandle);
+	D3D12_GPU_DESCRIPTOR_HANDLE CopyToFrameSrv(SrvOffset offset);
+	void FinishFrame(UINT64 fence);
+	void Recycle(UINT64 completedFence);
 	void CreateDepthStencilView(DsvOffset offset, 
 		const D3D12_DEPTH_STENCIL_VIEW_DESC* pDesc, ID3D12Resource* pRes);
 	void CreateRenderTargetView(RtvOffset offset,
@@ -38,6 +45,10 @@ private:
 		UINT numDescriptor,
 		D3D12_DESCRIPTOR_HEAP_FLAGS flags,
 		ID3D12DescriptorHeap** descriptorHeap);
+	bool CreateSrvHeaps(UINT persistentCapacity);
+	bool GrowSrvRange(SrvOffset offset, UINT minCount);
+	void CopySrvToShaderVisible(UINT start, UINT count);
+	D3D12_CPU_DESCRIPTOR_HANDLE GetCpuSrvHandle(ID3D12DescriptorHeap* heap, UINT index) const;
 
 private:
 	ID3D12Device* m_device;
@@ -47,7 +58,13 @@ private:
 
 	int m_currBackBuffer{ 0 };
 
+	//srv는 셰이더에서 안 보이는 힙에 만들고 셰이더용 힙으로 복사한다. 힙을 늘릴때 이 힙에서 옮겨 담는다.
+	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_srvCpuHeap;
 	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_srvDescHeap;
+	std::unique_ptr<CDescriptorAllocator> m_srvAllocator;
+	std::map<SrvOffset, DescriptorRange> m_srvRanges;
+	std::deque<std::pair<UINT64, Microsoft::WRL::ComPtr<ID3D12DescriptorHeap>>> m_retiredHeaps;
+	UINT64 m_lastFence{ 0 };
 	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_dsvDescHeap;
 	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_rtvDescHeap;
 
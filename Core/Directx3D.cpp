@@ -1,8 +1,9 @@
-#include "pch.h"
+﻿#include "pch.h"
 #include "Directx3D.h"
 #include "d3dUtil.h"
 #include "./CoreDefine.h"
 #include "./DescriptorHeap.h"
+#include "./PipelineKey.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -243,6 +244,21 @@ bool CDirectx3D::LoadData(
 	return true;
 }
 
+//기다리지 않고 GPU 복사가 끝났는지 알 수 있는 future를 돌려준다.
+bool CDirectx3D::LoadDataAsync(
+	std::function<bool(ID3D12Device* device, DirectX::ResourceUploadBatch& uploadBatch)> loadGraphicMemory,
+	std::future<void>* outFinished)
+{
+	DirectX::ResourceUploadBatch resourceUpload(m_device.Get());
+	resourceUpload.Begin();
+
+	ReturnIfFalse(loadGraphicMemory(m_device.Get(), resourceUpload));
+
+	(*outFinished) = resourceUpload.End(m_commandQueue.Get());
+
+	return true;
+}
+
 bool CDirectx3D::ResetCommandLists()
 {
 	ReturnIfFailed(m_commandList->Reset(m_cmdListAlloc.Get(), nullptr));
@@ -309,6 +325,22 @@ void CDirectx3D::SetPipelineStateDesc(D3D12_GRAPHICS_PIPELINE_STATE_DESC* inoutD
 	inoutDesc->SampleDesc.Quality = m_4xMsaaState ? (m_4xMsaaQuality - 1) : 0;
 }
 
+//장치를 만든 어댑터의 드라이버(UMD) 버전과 장치 id
+bool CDirectx3D::GetDriverVersion(DriverVersion* outVersion)
+{
+	ComPtr<IDXGIAdapter> adapter{ nullptr };
+	ReturnIfFailed(m_dxgiFactory->EnumAdapterByLuid(m_device->GetAdapterLuid(), IID_PPV_ARGS(&adapter)));
+
+	DXGI_ADAPTER_DESC desc{};
+	ReturnIfFailed(adapter->GetDesc(&desc));
+
+	LARGE_INTEGER umdVersion{};
+	ReturnIfFailed(adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umdVersion));
+
+	(*outVersion) = { static_cast<UINT64>(umdVersion.QuadPart), desc.VendorId, desc.DeviceId };
+	return true;
+}
+
 bool CDirectx3D::Set4xMsaaState(HWND hwnd, int width, int height, bool value)
 {
 	if (m_4xMsaaState == value)
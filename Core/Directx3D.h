@@ -2,6 +2,7 @@
 
 class CWindow;
 class CDescriptorHeap;
+struct DriverVersion;
 
 class CDirectx3D
 {
@@ -20,9 +21,12 @@ public:
 	bool WaitUntilGpuFinished(UINT64 fenceCount);
 	bool OnResize(int width, int height);
 	bool LoadData(std::function<bool(ID3D12Device* device, DirectX::ResourceUploadBatch& uploadBatch)> loadGraphicMemory);
+	bool LoadDataAsync(std::function<bool(ID3D12Device* device, DirectX::ResourceUploadBatch& uploadBatch)> loadGraphicMemory,
+		std::future<void>* outFinished);
 	bool Set4xMsaaState(HWND hwnd, int width, int height, bool value);
 
 	void SetPipelineStateDesc(D3D12_GRAPHICS_PIPELINE_STATE_DESC* inoutDesc) noexcept;
+	bool GetDriverVersion(DriverVersion* outVersion);
 
 	inline ID3D12Device* GetDevice() const;
 	inline ID3D12GraphicsCommandList* GetCommandList() const;
@@ -12,6 +12,14 @@
 #include "./PipelineStateObjects.h"
 #include "./SsaoMap.h"
 #include "./DescriptorHeap.h"
+#include "./FrameGraph.h"
+#include "./FrameGraphBackend.h"
+#include "./CommandTranslator.h"
+#include "./RenderQueue.h"
+#include "./FrameWorkers.h"
+#include <format>
+
+constexpr int gSsaoBlurCount{ 3 };
 
 CDraw::~CDraw() = default;
 CDraw::CDraw(CDirectx3D* directx3D)
@@ -20,25 +28,48 @@ CDraw::CDraw(CDirectx3D* directx3D)
 	, m_cmdList{ nullptr }
 	, m_descHeap{ nullptr }
 	, m_pso{ nullptr }
+	, m_ssaoMap{ nullptr }
 	, m_shadowMap{ nullptr }
+	, m_frameGraph{ nullptr }
+	, m_graphBackend{ nullptr }
+	, m_backBufferId{ 0u }
+	, m_streams{}
+	, m_translator{ nullptr }
+	, m_renderQueue{ nullptr }
+	, m_recorders{ nullptr }
+	, m_rootSignature{ nullptr }
+	, m_frameRes{ nullptr }
+	, m_textureTable{ 0 }
 	, m_screenViewport{}
 	, m_scissorRect{}
 {}
 
-bool CDraw::Initialize(CDescriptorHeap* descHeap, CPipelineStateObjects* pso)
+bool CDraw::Initialize(CDescriptorHeap* descHeap, CPipelineStateObjects* pso, CSsaoMap* ssaoMap)
 {
 	m_descHeap = descHeap;
 	m_device = m_directx3D->GetDevice();
 	m_cmdList = m_directx3D->GetCommandList();
 	m_shadowMap = std::make_unique<CShadowMap>(descHeap);
 	m_pso = pso;
+	m_ssaoMap = ssaoMap;
+	m_frameGraph = std::make_unique<CFrameGraph>();
+	m_graphBackend = std::make_unique<CFrameGraphBackend>(m_device, m_cmdList);
+	m_translator = std::make_unique<CCommandTranslator>(m_cmdList, pso);
+	for (auto pass : std::views::iota(0, EtoV(RecordedPass::Count)))
+		m_streams.emplace_back(std::make_unique<CCommandStream>());
+	m_renderQueue = std::make_unique<CRenderQueue>();
+	m_recorders = std::make_unique<CFrameWorkers>(std::vector<std::function<void()>>{
+		[this]() { RecordPass(RecordedPass::Main); },
+		[this]() { RecordPass(RecordedPass::Shadow); },
+		[this]() { RecordPass(RecordedPass::NormalsAndDepth); } });
 
 	ReturnIfFalse(m_shadowMap->Initialize(m_directx3D));
 
 	return true;
 }
 
-void CDraw::OnResize(int width, int height)
+//크기가 바뀌면 임시 텍스쳐를 다시 만들어야 해서 그래프를 새로 만든다. 디스크립터는 이 뒤에 다시 만든다.
+bool CDraw::OnResize(int width, int height)
 {
 	m_screenViewport.TopLeftX = 0;
 	m_screenViewport.TopLeftY = 0;
@@ -48,152 +79,264 @@ void CDraw::OnResize(int width, int height)
 	m_screenViewport.MaxDepth = 1.0f;
 
 	m_scissorRect = { 0, 0, width, height };
-}
 
-D3D12_GPU_VIRTUAL_ADDRESS GetFrameResourceAddress(CFrameResources* frameRes, eBufferType bufType)
-{
-	return frameRes->GetResource(bufType)->GetGPUVirtualAddress();
+	return BuildFrameGraph();
 }
 
-bool CDraw::Excute(CRootSignature* rootSignature, CFrameResources* frameRes, CSsaoMap* ssaoMap, AllRenderItems& renderItem)
+//패스는 읽고 쓰는 텍스쳐만 적고 barrier는 그래프가 건다.
+bool CDraw::BuildFrameGraph()
 {
-	auto cmdListAlloc = frameRes->GetCurrCmdListAlloc();
-	ReturnIfFailed(cmdListAlloc->Reset());
-	ReturnIfFailed(m_cmdList->Reset(cmdListAlloc, nullptr));
-
-	m_cmdList->SetGraphicsRootSignature(rootSignature->Get(RootSignature::Common));
-
-	m_descHeap->SetSrvDescriptorHeaps(m_cmdList);
+	CFrameGraph& graph = *m_frameGraph;
+	graph.Reset();
+
+	const UINT shadowMap = graph.ImportTexture("ShadowMap", D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_GENERIC_READ);
+	const UINT depth = graph.ImportTexture("Depth", D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+	m_backBufferId = graph.ImportTexture("BackBuffer", D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PRESENT);
+	const UINT normalMap = graph.CreateTexture("NormalMap", m_ssaoMap->GetNormalMapDesc());
+	const UINT ambientMap0 = graph.CreateTexture("AmbientMap0", m_ssaoMap->GetAmbientMapDesc());
+	const UINT ambientMap1 = graph.CreateTexture("AmbientMap1", m_ssaoMap->GetAmbientMapDesc());
+	const D3D12_RESOURCE_STATES depthRead = D3D12_RESOURCE_STATE_DEPTH_READ | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+
+	const UINT shadow = graph.AddPass("Shadow", [this]() { Translate(RecordedPass::Shadow); });
+	graph.Write(shadow, shadowMap, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+
+	const UINT normals = graph.AddPass("NormalsAndDepth", [this]() { Translate(RecordedPass::NormalsAndDepth); });
+	graph.Write(normals, normalMap, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	graph.Write(normals, depth, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+
+	const UINT ssao = graph.AddPass("Ssao", [this]() { ComputeSsao(m_frameRes); });
+	graph.Read(ssao, normalMap, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	graph.Read(ssao, depth, depthRead);
+	graph.Write(ssao, ambientMap0, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+	for (auto i : std::views::iota(0, gSsaoBlurCount))
+	{
+		for (auto horzBlur : { true, false })
+		{
+			const UINT blur = graph.AddPass(horzBlur ? "SsaoBlurH" : "SsaoBlurV", [this, horzBlur]() {
+				m_ssaoMap->BlurAmbientMap(m_cmdList, m_frameRes, horzBlur); });
+			graph.Read(blur, normalMap, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+			graph.Read(blur, depth, depthRead);
+			graph.Read(blur, horzBlur ? ambientMap0 : ambientMap1, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+			graph.Write(blur, horzBlur ? ambientMap1 : ambientMap0, D3D12_RESOURCE_STATE_RENDER_TARGET);
+		}
+	}
 
-	m_cmdList->SetGraphicsRootShaderResourceView(EtoV(MainRegisterType::Material), GetFrameResourceAddress(frameRes, eBufferType::Material));
-	m_cmdList->SetGraphicsRootDescriptorTable(EtoV(MainRegisterType::Diffuse), m_descHeap->GetGpuSrvHandle(SrvOffset::Texture2D));
+	const UINT main = graph.AddPass("Main", [this]() { Translate(RecordedPass::Main); });
+	graph.Read(main, shadowMap, D3D12_RESOURCE_STATE_GENERIC_READ);
+	graph.Read(main, ambientMap0, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	graph.Write(main, depth, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+	graph.Write(main, m_backBufferId, D3D12_RESOURCE_STATE_RENDER_TARGET);
 
-	DrawSceneToShadowMap(frameRes, renderItem);
-	DrawNormalsAndDepth(frameRes, ssaoMap, renderItem);
+	ReturnIfFalse(graph.Compile(m_graphBackend.get()));
 
-	m_cmdList->SetGraphicsRootSignature(rootSignature->Get(RootSignature::Ssao));
-	ssaoMap->ComputeSsao(m_cmdList, frameRes, 3);
+	m_graphBackend->SetResource(shadowMap, m_shadowMap->Resource());
+	m_graphBackend->SetResource(depth, m_directx3D->GetDepthStencilBufferResource());
+	m_ssaoMap->SetMaps(m_graphBackend->GetResource(normalMap),
+		m_graphBackend->GetResource(ambientMap0), m_graphBackend->GetResource(ambientMap1));
+	ReportFrameGraph();
 
-	m_cmdList->SetGraphicsRootSignature(rootSignature->Get(RootSignature::Common));
+	return true;
+}
 
-	m_cmdList->RSSetViewports(1, &m_screenViewport);
-	m_cmdList->RSSetScissorRects(1, &m_scissorRect);
+void CDraw::ReportFrameGraph()
+{
+	const FrameGraphStats& stats = m_frameGraph->GetStats();
+	std::string report = std::format("Frame graph {} barriers in {} batches, {} aliasing, {} passes culled\n",
+		stats.barrierCount, stats.barrierBatchCount, stats.aliasingBarrierCount, stats.culledPassCount);
+	report += std::format("Frame graph transient {} KB in a {} KB heap\n", stats.transientBytes / 1024, stats.heapBytes / 1024);
 
-	m_cmdList->ResourceBarrier(1, &RvToLv(CD3DX12_RESOURCE_BARRIER::Transition(m_directx3D->CurrentBackBuffer(),
-		D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET)));
+	OutputDebugStringA(report.c_str());
+}
 
-	m_cmdList->ClearRenderTargetView(m_descHeap->CurrentBackBufferView(), DirectX::Colors::LightSteelBlue, 0, nullptr);
-	m_cmdList->OMSetRenderTargets(1, &RvToLv(m_descHeap->CurrentBackBufferView()), true, &RvToLv(m_descHeap->GetCpuDsvHandle(DsvOffset::Common)));
+D3D12_GPU_VIRTUAL_ADDRESS GetFrameResourceAddress(CFrameResources* frameRes, eBufferType bufType)
+{
+	return frameRes->GetGpuAddress(bufType);
+}
 
-	m_cmdList->SetGraphicsRootConstantBufferView(EtoV(MainRegisterType::Pass), GetFrameResourceAddress(frameRes, eBufferType::PassCB));
-	m_cmdList->SetGraphicsRootShaderResourceView(EtoV(MainRegisterType::Material), GetFrameResourceAddress(frameRes, eBufferType::Material));
-	m_cmdList->SetGraphicsRootDescriptorTable(EtoV(MainRegisterType::Shadow), m_descHeap->GetGpuSrvHandle(SrvOffset::ShadowMap));
-	m_cmdList->SetGraphicsRootDescriptorTable(EtoV(MainRegisterType::Ssao), m_descHeap->GetGpuSrvHandle(SrvOffset::SsaoAmbientMap0));
-	m_cmdList->SetGraphicsRootDescriptorTable(EtoV(MainRegisterType::Cube), m_descHeap->GetGpuSrvHandle(SrvOffset::TextureCube));
-	m_cmdList->SetGraphicsRootDescriptorTable(EtoV(MainRegisterType::Diffuse), m_descHeap->GetGpuSrvHandle(SrvOffset::Texture2D));
+bool CDraw::Excute(CRootSignature* rootSignature, CFrameResources* frameRes, AllRenderItems& renderItem)
+{
+	auto cmdListAlloc = frameRes->GetCurrCmdListAlloc();
+	ReturnIfFailed(cmdListAlloc->Reset());
+	ReturnIfFailed(m_cmdList->Reset(cmdListAlloc, nullptr));
 
-	std::ranges::for_each(renderItem, [this, frameRes, &renderItem](auto& curRenderItem) {
-		auto pso = curRenderItem.first;
-		m_cmdList->SetPipelineState(m_pso->GetPso(pso));
-		DrawRenderItems(frameRes, pso, renderItem[pso].get()); });
+	m_descHeap->SetSrvDescriptorHeaps(m_cmdList);
 
-	m_cmdList->ResourceBarrier(1, &RvToLv(CD3DX12_RESOURCE_BARRIER::Transition(m_directx3D->CurrentBackBuffer(),
-		D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT)));
+	m_rootSignature = rootSignature;
+	m_frameRes = frameRes;
+	m_textureTable = m_descHeap->CopyToFrameSrv(SrvOffset::Texture2D).ptr;
+	ReturnIfFalse(RecordPasses(frameRes, renderItem));
+	m_graphBackend->SetResource(m_backBufferId, m_directx3D->CurrentBackBuffer());
+	m_frameGraph->Execute(m_graphBackend.get());
 
 	ReturnIfFalse(m_directx3D->ExcuteCommandLists());
 
 	UINT64 curFenceIdx{ 0 };
 	ReturnIfFalse(m_directx3D->ExcuteSwapChain(&curFenceIdx));
 	frameRes->SetFence(curFenceIdx);
+	m_descHeap->FinishFrame(curFenceIdx);
 
 	return true;
 }
 
-void CDraw::DrawSceneToShadowMap(CFrameResources* frameRes, AllRenderItems& renderItem)
+//세 패스의 그리기를 큐 하나에 넣고 정렬한 뒤, 패스마다 스트림을 하나씩 맡아 동시에 기록한다.
+//기록 스레드는 Initialize에서 띄워 둔 것을 매 프레임 깨워 쓴다. Main은 이 스레드가 기록한다.
+//커맨드 리스트로 옮기는 것은 프레임 그래프가 패스 순서대로 한다.
+bool CDraw::RecordPasses(CFrameResources* frameRes, AllRenderItems& renderItem)
 {
-	m_cmdList->RSSetViewports(1, &RvToLv(m_shadowMap->Viewport()));
-	m_cmdList->RSSetScissorRects(1, &RvToLv(m_shadowMap->ScissorRect()));
-
-	m_cmdList->ResourceBarrier(1, &RvToLv(CD3DX12_RESOURCE_BARRIER::Transition(m_shadowMap->Resource(),
-		D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_DEPTH_WRITE)));
-	D3D12_CPU_DESCRIPTOR_HANDLE dsvShadowMap = m_descHeap->GetCpuDsvHandle(DsvOffset::ShadowMap);
-	m_cmdList->ClearDepthStencilView(dsvShadowMap, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
+	ReturnIfFalse(QueueRenderItems(frameRes, renderItem));
+	m_recorders->Run();
 
-	m_cmdList->OMSetRenderTargets(0, nullptr, false, &dsvShadowMap);
+	return true;
+}
 
-	UINT passCBByteSize = frameRes->GetBufferSize(eBufferType::PassCB);
-	//2 cb  ִµ 2°  Լ  . -> + 1 * passCBByteSize;
-	D3D12_GPU_VIRTUAL_ADDRESS passCBAddress = GetFrameResourceAddress(frameRes, eBufferType::PassCB) + 1 * passCBByteSize;
-	m_cmdList->SetGraphicsRootConstantBufferView(EtoV(MainRegisterType::Pass), passCBAddress);
+void CDraw::RecordPass(RecordedPass pass)
+{
+	CCommandStream* stream = m_streams[EtoV(pass)].get();
+	stream->Reset();
 
-	m_cmdList->SetPipelineState(m_pso->GetPso(GraphicsPSO::ShadowMap));
-	DrawRenderItems(frameRes, GraphicsPSO::NormalOpaque, renderItem[GraphicsPSO::NormalOpaque].get());
+	switch (pass)
+	{
+	case RecordedPass::Shadow: DrawSceneToShadowMap(stream, m_frameRes); break;
+	case RecordedPass::NormalsAndDepth: DrawNormalsAndDepth(stream, m_frameRes); break;
+	case RecordedPass::Main: DrawSceneToBackBuffer(stream, m_frameRes); break;
+	}
+}
 
-	m_cmdList->SetPipelineState(m_pso->GetPso(GraphicsPSO::SkinnedShadowOpaque));
-	DrawRenderItems(frameRes, GraphicsPSO::SkinnedOpaque, renderItem[GraphicsPSO::SkinnedOpaque].get());
+void CDraw::Translate(RecordedPass pass)
+{
+	m_translator->Translate(m_rootSignature, *m_streams[EtoV(pass)]);
+}
 
-	m_cmdList->ResourceBarrier(1, &RvToLv(CD3DX12_RESOURCE_BARRIER::Transition(m_shadowMap->Resource(),
-		D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_GENERIC_READ)));
+void CDraw::ComputeSsao(CFrameResources* frameRes)
+{
+	m_cmdList->SetGraphicsRootSignature(m_rootSignature->Get(RootSignature::Ssao));
+	m_ssaoMap->ComputeSsao(m_cmdList, frameRes);
 }
 
-void CDraw::DrawNormalsAndDepth(CFrameResources* frameRes, CSsaoMap* ssaoMap, AllRenderItems& renderItem)
+void CDraw::DrawSceneToBackBuffer(CCommandStream* stream, CFrameResources* frameRes)
 {
-	m_cmdList->RSSetViewports(1, &m_screenViewport);
-	m_cmdList->RSSetScissorRects(1, &m_scissorRect);
+	SetCommonArguments(stream, frameRes);
+	stream->SetViewport(ToCommandViewport(m_screenViewport));
+	stream->SetScissorRect(ToCommandRect(m_scissorRect));
 
-	auto normalMap = ssaoMap->NormalMap();
-	auto normalMapRtv = m_descHeap->GetCpuRtvHandle(RtvOffset::NormalMap);
+	const UINT64 backBufferRtv = m_descHeap->CurrentBackBufferView().ptr;
+	const DirectX::XMVECTORF32& clearColor = DirectX::Colors::LightSteelBlue;
+	stream->ClearRenderTarget(backBufferRtv, { clearColor.f[0], clearColor.f[1], clearColor.f[2], clearColor.f[3] });
+	stream->SetRenderTarget(backBufferRtv, m_descHeap->GetCpuDsvHandle(DsvOffset::Common).ptr);
 
-	m_cmdList->ResourceBarrier(1, &RvToLv(CD3DX12_RESOURCE_BARRIER::Transition(normalMap,
-		D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET)));
+	stream->SetRootConstantBuffer(EtoV(MainRegisterType::Pass), GetFrameResourceAddress(frameRes, eBufferType::PassCB));
+	stream->SetRootDescriptorTable(EtoV(MainRegisterType::Shadow), m_descHeap->GetGpuSrvHandle(SrvOffset::ShadowMap).ptr);
+	stream->SetRootDescriptorTable(EtoV(MainRegisterType::Ssao), m_descHeap->GetGpuSrvHandle(SrvOffset::SsaoAmbientMap0).ptr);
+	stream->SetRootDescriptorTable(EtoV(MainRegisterType::Cube), m_descHeap->GetGpuSrvHandle(SrvOffset::TextureCube).ptr);
 
-	float clearValue[] = { 0.0f, 0.0f, 1.0f, 0.0f };
-	m_cmdList->ClearRenderTargetView(normalMapRtv, clearValue, 0, nullptr);
-	D3D12_CPU_DESCRIPTOR_HANDLE dsvCommon = m_descHeap->GetCpuDsvHandle(DsvOffset::Common);
-	m_cmdList->ClearDepthStencilView(dsvCommon, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
+	SubmitRenderQueue(RecordedPass::Main, stream);
+}
 
-	m_cmdList->OMSetRenderTargets(1, &normalMapRtv, true, &dsvCommon);
-	m_cmdList->SetGraphicsRootConstantBufferView(EtoV(MainRegisterType::Pass), GetFrameResourceAddress(frameRes, eBufferType::PassCB));
+void CDraw::DrawSceneToShadowMap(CCommandStream* stream, CFrameResources* frameRes)
+{
+	SetCommonArguments(stream, frameRes);
+	stream->SetViewport(ToCommandViewport(m_shadowMap->Viewport()));
+	stream->SetScissorRect(ToCommandRect(m_shadowMap->ScissorRect()));
 
-	m_cmdList->SetPipelineState(m_pso->GetPso(GraphicsPSO::DrawNormals));
-	DrawRenderItems(frameRes, GraphicsPSO::NormalOpaque, renderItem[GraphicsPSO::NormalOpaque].get());
+	const UINT64 dsvShadowMap = m_descHeap->GetCpuDsvHandle(DsvOffset::ShadowMap).ptr;
+	stream->ClearDepthStencil(dsvShadowMap, 1.0f, 0);
+	stream->SetRenderTarget(0, dsvShadowMap);
 
-	m_cmdList->SetPipelineState(m_pso->GetPso(GraphicsPSO::SkinnedDrawNormals));
-	DrawRenderItems(frameRes, GraphicsPSO::SkinnedOpaque, renderItem[GraphicsPSO::SkinnedOpaque].get());
+	UINT passCBByteSize = frameRes->GetBufferSize(eBufferType::PassCB);
+	//2개의 cb가 들어가 있는데 2번째를 가져올 함수가 아직 없다. -> + 1 * passCBByteSize;
+	D3D12_GPU_VIRTUAL_ADDRESS passCBAddress = GetFrameResourceAddress(frameRes, eBufferType::PassCB) + 1 * passCBByteSize;
+	stream->SetRootConstantBuffer(EtoV(MainRegisterType::Pass), passCBAddress);
 
-	m_cmdList->ResourceBarrier(1, &RvToLv(CD3DX12_RESOURCE_BARRIER::Transition(normalMap,
-		D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ)));
+	SubmitRenderQueue(RecordedPass::Shadow, stream);
 }
 
-void CDraw::DrawRenderItems(CFrameResources* frameRes, GraphicsPSO pso, RenderItem* renderItem)
+void CDraw::DrawNormalsAndDepth(CCommandStream* stream, CFrameResources* frameRes)
 {
-	ID3D12Resource* instanceRes = frameRes->GetResource(eBufferType::Instance);
+	SetCommonArguments(stream, frameRes);
+	stream->SetViewport(ToCommandViewport(m_screenViewport));
+	stream->SetScissorRect(ToCommandRect(m_scissorRect));
 
-	m_cmdList->IASetVertexBuffers(0, 1, &renderItem->vertexBufferView);
-	m_cmdList->IASetIndexBuffer(&renderItem->indexBufferView);
-	m_cmdList->IASetPrimitiveTopology(renderItem->primitiveType);
+	const UINT64 normalMapRtv = m_descHeap->GetCpuRtvHandle(RtvOffset::NormalMap).ptr;
+	const UINT64 dsvCommon = m_descHeap->GetCpuDsvHandle(DsvOffset::Common).ptr;
+	stream->ClearRenderTarget(normalMapRtv, { 0.0f, 0.0f, 1.0f, 0.0f });
+	stream->ClearDepthStencil(dsvCommon, 1.0f, 0);
 
-	auto skinnedCB = frameRes->GetResource(eBufferType::SkinnedCB);
-	UINT skinnedCBByteSize = frameRes->GetBufferSize(eBufferType::SkinnedCB);
+	stream->SetRenderTarget(normalMapRtv, dsvCommon);
+	stream->SetRootConstantBuffer(EtoV(MainRegisterType::Pass), GetFrameResourceAddress(frameRes, eBufferType::PassCB));
 
-	for (auto& ri : renderItem->subRenderItems)
-	{
-		auto& subRenderItem = ri.second;
-		auto& subItem = subRenderItem.subItem;
+	SubmitRenderQueue(RecordedPass::NormalsAndDepth, stream);
+}
+
+//스트림마다 커맨드 리스트 상태를 따로 모르니 패스 앞에서 공통 인자를 다시 넣는다.
+void CDraw::SetCommonArguments(CCommandStream* stream, CFrameResources* frameRes)
+{
+	stream->SetRootSignature(RootSignature::Common);
+	stream->SetRootShaderResource(EtoV(MainRegisterType::Material), GetFrameResourceAddress(frameRes, eBufferType::Material));
+	stream->SetRootShaderResource(EtoV(MainRegisterType::Bone), GetFrameResourceAddress(frameRes, eBufferType::BonePalette));
+	stream->SetRootDescriptorTable(EtoV(MainRegisterType::Diffuse), m_textureTable);
+}
 
-		m_cmdList->SetGraphicsRootShaderResourceView(EtoV(MainRegisterType::Instance),
-			instanceRes->GetGPUVirtualAddress() +
-			(renderItem->startIndexInstance + subRenderItem.startSubIndexInstance) * sizeof(InstanceBuffer));
+//물체마다 어느 패스에서 어떤 PSO로 그리는지 정해서 큐에 넣는다. 그리는 순서는 키를 정렬해서 정한다.
+bool CDraw::QueueRenderItems(CFrameResources* frameRes, AllRenderItems& renderItem)
+{
+	m_renderQueue->Reset();
 
+	UINT geometry{ 0u };
+	for (auto& [pso, curRenderItem] : renderItem)
+	{
+		RenderItem* item = curRenderItem.get();
+		ReturnIfFalse(QueueRenderItem(RecordedPass::Main, pso, geometry, frameRes, item));
+		if (pso == GraphicsPSO::NormalOpaque)
+		{
+			ReturnIfFalse(QueueRenderItem(RecordedPass::Shadow, GraphicsPSO::ShadowMap, geometry, frameRes, item));
+			ReturnIfFalse(QueueRenderItem(RecordedPass::NormalsAndDepth, GraphicsPSO::DrawNormals, geometry, frameRes, item));
+		}
 		if (pso == GraphicsPSO::SkinnedOpaque)
 		{
-			D3D12_GPU_VIRTUAL_ADDRESS skinnedCBAddress = skinnedCB->GetGPUVirtualAddress();// +1 * skinnedCBByteSize;
-			m_cmdList->SetGraphicsRootConstantBufferView(EtoV(MainRegisterType::Bone), skinnedCBAddress);
+			ReturnIfFalse(QueueRenderItem(RecordedPass::Shadow, GraphicsPSO::SkinnedShadowOpaque, geometry, frameRes, item));
+			ReturnIfFalse(QueueRenderItem(RecordedPass::NormalsAndDepth, GraphicsPSO::SkinnedDrawNormals, geometry, frameRes, item));
 		}
-		else
-			m_cmdList->SetGraphicsRootConstantBufferView(EtoV(MainRegisterType::Bone), 0);
+		geometry++;
+	}
+	m_renderQueue->Sort();
+
+	return true;
+}
+
+bool CDraw::QueueRenderItem(RecordedPass pass, GraphicsPSO pso, UINT geometry, CFrameResources* frameRes, RenderItem* renderItem)
+{
+	D3D12_GPU_VIRTUAL_ADDRESS instanceAddress = frameRes->GetGpuAddress(eBufferType::Instance);
+
+	const D3D12_VERTEX_BUFFER_VIEW& vertexView = renderItem->vertexBufferView;
+	const D3D12_INDEX_BUFFER_VIEW& indexView = renderItem->indexBufferView;
+	RenderDraw draw{};
+	draw.pso = pso;
+	draw.geometry = geometry;
+	draw.vertexBuffer = { vertexView.BufferLocation, vertexView.SizeInBytes, vertexView.StrideInBytes };
+	draw.indexBuffer = { indexView.BufferLocation, indexView.SizeInBytes, indexView.Format };
+	draw.topology = static_cast<UINT>(renderItem->primitiveType);
+
+	for (auto& subRenderItem : renderItem->subRenderItems)
+	{
+		if (subRenderItem.instanceCount == 0) continue;
 
-		m_cmdList->DrawIndexedInstanced(subItem.indexCount, subRenderItem.instanceCount,
-			subItem.startIndexLocation, subItem.baseVertexLocation, 0);
+		auto& subItem = subRenderItem.subItem;
+		draw.instanceAddress = instanceAddress +
+			(renderItem->startIndexInstance + subRenderItem.startSubIndexInstance) * sizeof(InstanceBuffer);
+
+		//스키닝 인스턴스는 InstanceBuffer의 paletteOffset으로 본 팔레트를 찾으므로 서브셋마다 한번만 그린다.
+		draw.indexCount = subItem.indexCount;
+		draw.instanceCount = subRenderItem.instanceCount;
+		draw.startIndex = subItem.startIndexLocation;
+		draw.baseVertex = static_cast<int>(subItem.baseVertexLocation);
+		ReturnIfFalse(m_renderQueue->Add(EtoV(pass), subRenderItem.viewDepth, draw));
 	}
-}
\ No newline at end of file
+
+	return true;
+}
+
+void CDraw::SubmitRenderQueue(RecordedPass pass, CCommandStream* stream)
+{
+	m_renderQueue->Submit(EtoV(pass), EtoV(MainRegisterType::Instance), stream);
+}
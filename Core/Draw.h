@@ -1,4 +1,4 @@
-#pragma once
+﻿#pragma once
 
 class CDirectx3D;
 class CRootSignature;
@@ -7,6 +7,12 @@ class CFrameResources;
 class CShadowMap;
 class CSsaoMap;
 class CDescriptorHeap;
+class CFrameGraph;
+class CFrameGraphBackend;
+class CCommandStream;
+class CCommandTranslator;
+class CRenderQueue;
+class CFrameWorkers;
 struct RenderItem;
 enum class GraphicsPSO : int;
 
@@ -14,6 +20,15 @@ class CDraw
 {
 	using AllRenderItems = std::map<GraphicsPSO, std::unique_ptr<RenderItem>>;
 
+	//스트림에 먼저 기록해 두는 패스
+	enum class RecordedPass : int
+	{
+		Shadow = 0,
+		NormalsAndDepth,
+		Main,
+		Count,
+	};
+
 public:
 	CDraw(CDirectx3D* directx3D);
 	~CDraw();
@@ -22,14 +37,24 @@ public:
 	CDraw(const CDraw&) = delete;
 	CDraw& operator=(const CDraw&) = delete;
 
-	bool Initialize(CDescriptorHeap* descHeap, CPipelineStateObjects* pso);
-	bool Excute(CRootSignature* rootSignature, CFrameResources* frameRes, CSsaoMap* ssaoMap, AllRenderItems& renderItem);
-	void OnResize(int width, int height);
+	bool Initialize(CDescriptorHeap* descHeap, CPipelineStateObjects* pso, CSsaoMap* ssaoMap);
+	bool Excute(CRootSignature* rootSignature, CFrameResources* frameRes, AllRenderItems& renderItem);
+	bool OnResize(int width, int height);
 
 private:
-	void DrawSceneToShadowMap(CFrameResources* frameRes, AllRenderItems& renderItem);
-	void DrawNormalsAndDepth(CFrameResources* frameRes, CSsaoMap* ssaoMap, AllRenderItems& renderItem);
-	void DrawRenderItems(CFrameResources* frameRes, GraphicsPSO pso, RenderItem* renderItem);
+	bool BuildFrameGraph();
+	void ReportFrameGraph();
+	bool RecordPasses(CFrameResources* frameRes, AllRenderItems& renderItem);
+	void RecordPass(RecordedPass pass);
+	void Translate(RecordedPass pass);
+	void DrawSceneToShadowMap(CCommandStream* stream, CFrameResources* frameRes);
+	void DrawNormalsAndDepth(CCommandStream* stream, CFrameResources* frameRes);
+	void ComputeSsao(CFrameResources* frameRes);
+	void DrawSceneToBackBuffer(CCommandStream* stream, CFrameResources* frameRes);
+	void SetCommonArguments(CCommandStream* stream, CFrameResources* frameRes);
+	bool QueueRenderItems(CFrameResources* frameRes, AllRenderItems& renderItem);
+	bool QueueRenderItem(RecordedPass pass, GraphicsPSO pso, UINT geometry, CFrameResources* frameRes, RenderItem* renderItem);
+	void SubmitRenderQueue(RecordedPass pass, CCommandStream* stream);
 
 private:
 	CDirectx3D* m_directx3D;
@@ -37,8 +62,23 @@ private:
 	ID3D12GraphicsCommandList* m_cmdList;
 	CDescriptorHeap* m_descHeap;
 	CPipelineStateObjects* m_pso;
+	CSsaoMap* m_ssaoMap;
 	std::unique_ptr<CShadowMap> m_shadowMap;
 
+	std::unique_ptr<CFrameGraph> m_frameGraph;
+	std::unique_ptr<CFrameGraphBackend> m_graphBackend;
+	UINT m_backBufferId;
+
+	std::vector<std::unique_ptr<CCommandStream>> m_streams;
+	std::unique_ptr<CCommandTranslator> m_translator;
+	std::unique_ptr<CRenderQueue> m_renderQueue;
+	std::unique_ptr<CFrameWorkers> m_recorders;	//스트림보다 먼저 없어져야 해서 뒤에 둔다
+
+	//패스는 Excute 안에서만 돌아서 그 동안만 쓴다.
+	CRootSignature* m_rootSignature;
+	CFrameResources* m_frameRes;
+	UINT64 m_textureTable;		//이번 프레임의 임시 srv 자리에 복사한 텍스쳐 구간
+
 	D3D12_VIEWPORT m_screenViewport;
 	D3D12_RECT m_scissorRect;
 };
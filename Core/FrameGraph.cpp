@@ -0,0 +1,283 @@
+﻿#include "pch.h"
+#include "./FrameGraph.h"
+
+constexpr UINT64 gPlacementAlignment{ D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT };
+constexpr D3D12_RESOURCE_STATES gWriteStates{ D3D12_RESOURCE_STATE_RENDER_TARGET | D3D12_RESOURCE_STATE_UNORDERED_ACCESS |
+	D3D12_RESOURCE_STATE_DEPTH_WRITE | D3D12_RESOURCE_STATE_STREAM_OUT | D3D12_RESOURCE_STATE_COPY_DEST | D3D12_RESOURCE_STATE_RESOLVE_DEST };
+
+CFrameGraph::CFrameGraph()
+	: m_resources{}
+	, m_passes{}
+	, m_order{}
+	, m_lifetimes{}
+	, m_compiledPasses{}
+	, m_finalBarriers{}
+	, m_placements{}
+	, m_stats{}
+{}
+CFrameGraph::~CFrameGraph() = default;
+
+//백버퍼처럼 밖에서 만든 텍스쳐. 프레임이 끝나면 finalState로 돌려 놓는다.
+UINT CFrameGraph::ImportTexture(std::string name, D3D12_RESOURCE_STATES initialState, D3D12_RESOURCE_STATES finalState)
+{
+	m_resources.emplace_back(Resource{ std::move(name), {}, true, initialState, finalState });
+	return static_cast<UINT>(m_resources.size() - 1);
+}
+
+UINT CFrameGraph::CreateTexture(std::string name, const FrameTextureDesc& desc)
+{
+	m_resources.emplace_back(Resource{ std::move(name), desc, false });
+	return static_cast<UINT>(m_resources.size() - 1);
+}
+
+//sideEffect가 없으면 밖으로 가져온 텍스쳐에 쓰거나, 살아남은 패스가 읽는 것을 써야 남는다.
+UINT CFrameGraph::AddPass(std::string name, std::function<void()> execute, bool sideEffect)
+{
+	Pass& pass = m_passes.emplace_back();
+	pass.name = std::move(name);
+	pass.execute = std::move(execute);
+	pass.sideEffect = sideEffect;
+
+	return static_cast<UINT>(m_passes.size() - 1);
+}
+
+void CFrameGraph::Read(UINT pass, UINT resource, D3D12_RESOURCE_STATES state)
+{
+	AddUse(pass, resource, state, false);
+}
+
+void CFrameGraph::Write(UINT pass, UINT resource, D3D12_RESOURCE_STATES state)
+{
+	AddUse(pass, resource, state, true);
+}
+
+//한 패스에서 같은 텍스쳐를 여러번 적으면 상태를 합친다.
+void CFrameGraph::AddUse(UINT pass, UINT resource, D3D12_RESOURCE_STATES state, bool write)
+{
+	auto& uses = m_passes[pass].uses;
+	auto find = std::ranges::find_if(uses, [resource](auto& use) { return use.resource == resource; });
+	if (find == uses.end())
+		find = uses.insert(uses.end(), ResourceUse{ resource, D3D12_RESOURCE_STATE_COMMON, false, false });
+
+	find->state |= state;
+	find->read |= !write;
+	find->write |= write;
+}
+
+bool CFrameGraph::Compile(IFrameGraphBackend* backend)
+{
+	m_order.clear();
+	m_lifetimes.assign(m_resources.size(), {});
+	m_compiledPasses.clear();
+	m_finalBarriers.clear();
+	m_placements.clear();
+	m_stats = {};
+
+	CullPasses();
+	if (!PlaceTransients(backend)) return false;
+
+	//임시 텍스쳐는 프레임이 끝날 때의 상태를 먼저 구해서 그 상태로 만들고 시작한다.
+	std::vector<D3D12_RESOURCE_STATES> states(m_resources.size(), D3D12_RESOURCE_STATE_COMMON);
+	for (auto r : std::views::iota(0u, static_cast<UINT>(m_resources.size())))
+		if (m_resources[r].imported) states[r] = m_resources[r].initialState;
+	if (!BuildBarriers(false, states)) return false;
+
+	for (auto r : std::views::iota(0u, static_cast<UINT>(m_resources.size())))
+	{
+		m_lifetimes[r].endState = states[r];
+		states[r] = m_resources[r].imported ? m_resources[r].initialState : states[r];
+	}
+	BuildBarriers(true, states);
+
+	for (auto r : std::views::iota(0u, static_cast<UINT>(m_resources.size())))
+	{
+		const Resource& resource = m_resources[r];
+		if (resource.imported && states[r] != resource.finalState)
+			m_finalBarriers.emplace_back(FrameBarrier{ FrameBarrier::Type::Transition, r, states[r], resource.finalState });
+	}
+	m_stats.barrierCount += static_cast<UINT>(m_finalBarriers.size());
+	m_stats.barrierBatchCount += m_finalBarriers.empty() ? 0u : 1u;
+
+	for (auto& placement : m_placements)
+		placement.initialState = m_lifetimes[placement.resource].endState;
+
+	return backend->CreateTransients(m_stats.heapBytes, m_placements);
+}
+
+//뒤에서부터 보면서 결과에 닿는 패스만 남긴다. 한 패스가 텍스쳐를 일부만 쓸 수도 있어서
+//살아남은 패스가 쓴 텍스쳐도 앞 패스가 쓴 것을 읽는다고 본다.
+void CFrameGraph::CullPasses()
+{
+	std::vector<bool> needed(m_resources.size(), false);
+	for (auto& pass : m_passes | std::views::reverse)
+	{
+		const bool alive = pass.sideEffect || std::ranges::any_of(pass.uses, [this, &needed](auto& use) {
+			return use.write && (m_resources[use.resource].imported || needed[use.resource]); });
+		pass.culled = !alive;
+		if (!alive)
+		{
+			m_stats.culledPassCount++;
+			continue;
+		}
+
+		for (auto& use : pass.uses)
+			needed[use.resource] = needed[use.resource] || use.read;
+	}
+
+	for (auto index : std::views::iota(0u, static_cast<UINT>(m_passes.size())))
+		if (!m_passes[index].culled) m_order.emplace_back(index);
+}
+
+//큰 텍스쳐부터 살아 있는 구간이 겹치는 텍스쳐를 피해 가장 앞 offset에 놓는다.
+bool CFrameGraph::PlaceTransients(IFrameGraphBackend* backend)
+{
+	for (auto order : std::views::iota(0u, static_cast<UINT>(m_order.size())))
+	{
+		for (auto& use : m_passes[m_order[order]].uses)
+		{
+			Lifetime& lifetime = m_lifetimes[use.resource];
+			lifetime.first = std::min(lifetime.first, order);
+			lifetime.last = std::max(lifetime.last, order);
+		}
+	}
+
+	std::vector<UINT> transients{};
+	for (auto r : std::views::iota(0u, static_cast<UINT>(m_resources.size())))
+	{
+		Lifetime& lifetime = m_lifetimes[r];
+		if (m_resources[r].imported || lifetime.first == UINT_MAX) continue;
+
+		lifetime.size = backend->GetTextureSize(m_resources[r].desc);
+		if (lifetime.size == 0) return false;
+
+		m_stats.transientBytes += lifetime.size;
+		transients.emplace_back(r);
+	}
+	std::ranges::stable_sort(transients, [this](UINT lhs, UINT rhs) { return m_lifetimes[lhs].size > m_lifetimes[rhs].size; });
+
+	std::vector<UINT> placed{};
+	for (auto r : transients)
+	{
+		Lifetime& lifetime = m_lifetimes[r];
+		std::vector<std::pair<UINT64, UINT64>> busy{};
+		for (auto other : placed)
+		{
+			const Lifetime& otherLifetime = m_lifetimes[other];
+			if (otherLifetime.first <= lifetime.last && lifetime.first <= otherLifetime.last)
+				busy.emplace_back(otherLifetime.offset, otherLifetime.offset + otherLifetime.size);
+		}
+		std::ranges::sort(busy);
+
+		UINT64 offset{ 0 };
+		for (auto [begin, end] : busy)
+		{
+			if (offset + lifetime.size <= begin) break;
+			offset = std::max(offset, (end + gPlacementAlignment - 1) / gPlacementAlignment * gPlacementAlignment);
+		}
+
+		lifetime.offset = offset;
+		m_stats.heapBytes = std::max(m_stats.heapBytes, offset + lifetime.size);
+		placed.emplace_back(r);
+	}
+
+	for (auto r : placed)
+	{
+		Lifetime& lifetime = m_lifetimes[r];
+		lifetime.aliased = std::ranges::any_of(placed, [this, r, &lifetime](UINT other) {
+			const Lifetime& otherLifetime = m_lifetimes[other];
+			return other != r && otherLifetime.offset < lifetime.offset + lifetime.size && lifetime.offset < otherLifetime.offset + otherLifetime.size; });
+	}
+
+	std::ranges::sort(placed);
+	for (auto r : placed)
+		m_placements.emplace_back(TransientPlacement{ r, m_resources[r].desc, m_lifetimes[r].offset, m_lifetimes[r].size });
+
+	return true;
+}
+
+//이어서 읽기만 하는 패스들의 상태를 합쳐서, 읽는 상태가 달라도 한번만 바꾼다.
+D3D12_RESOURCE_STATES CFrameGraph::GetReadState(UINT order, UINT resource) const
+{
+	D3D12_RESOURCE_STATES state{ D3D12_RESOURCE_STATE_COMMON };
+	for (auto index : m_order | std::views::drop(order))
+	{
+		const auto& uses = m_passes[index].uses;
+		auto find = std::ranges::find_if(uses, [resource](auto& use) { return use.resource == resource; });
+		if (find == uses.end()) continue;
+		if (find->write) break;
+
+		state |= find->state;
+	}
+
+	return state;
+}
+
+//패스마다 바꿔야 할 상태만 모아 한번에 건다. 겹쳐 놓은 임시 텍스쳐는 처음 쓰는 패스에서
+//aliasing barrier를 걸고 내용을 버린다. 그래서 처음에는 읽지 않고 써야 한다.
+bool CFrameGraph::BuildBarriers(bool record, std::vector<D3D12_RESOURCE_STATES>& inoutStates)
+{
+	for (auto order : std::views::iota(0u, static_cast<UINT>(m_order.size())))
+	{
+		CompiledPass compiled{ m_order[order] };
+		for (auto& use : m_passes[m_order[order]].uses)
+		{
+			const UINT r = use.resource;
+			const Lifetime& lifetime = m_lifetimes[r];
+			if (lifetime.aliased && lifetime.first == order)
+			{
+				if (!use.write) return false;
+				compiled.barriers.emplace_back(FrameBarrier{ FrameBarrier::Type::Aliasing, r });
+				compiled.discards.emplace_back(r);
+			}
+
+			D3D12_RESOURCE_STATES& current = inoutStates[r];
+			const D3D12_RESOURCE_STATES state = use.write ? use.state : GetReadState(order, r);
+			const bool isReadable = !use.write && (current & gWriteStates) == 0 && (current & state) == state;
+			if (current == state || isReadable) continue;
+
+			compiled.barriers.emplace_back(FrameBarrier{ FrameBarrier::Type::Transition, r, current, state });
+			current = state;
+		}
+
+		if (!record) continue;
+
+		m_stats.barrierCount += static_cast<UINT>(compiled.barriers.size());
+		m_stats.barrierBatchCount += compiled.barriers.empty() ? 0u : 1u;
+		m_stats.aliasingBarrierCount += static_cast<UINT>(std::ranges::count_if(compiled.barriers, [](auto& barrier) {
+			return barrier.type == FrameBarrier::Type::Aliasing; }));
+		m_compiledPasses.emplace_back(std::move(compiled));
+	}
+
+	return true;
+}
+
+void CFrameGraph::Execute(IFrameGraphBackend* backend)
+{
+	for (auto& compiled : m_compiledPasses)
+	{
+		if (!compiled.barriers.empty()) backend->ResourceBarriers(compiled.barriers);
+		for (auto resource : compiled.discards)
+			backend->Discard(resource);
+
+		m_passes[compiled.pass].execute();
+	}
+
+	if (!m_finalBarriers.empty()) backend->ResourceBarriers(m_finalBarriers);
+}
+
+void CFrameGraph::Reset()
+{
+	m_resources.clear();
+	m_passes.clear();
+	m_order.clear();
+	m_lifetimes.clear();
+	m_compiledPasses.clear();
+	m_finalBarriers.clear();
+	m_placements.clear();
+	m_stats = {};
+}
+
+bool CFrameGraph::IsCulled(UINT pass) const
+{
+	return pass < m_passes.size() && m_passes[pass].culled;
+}
@@ -0,0 +1,146 @@
+﻿#pragma once
+
+struct FrameTextureDesc
+{
+	UINT width{ 0u };
+	UINT height{ 0u };
+	DXGI_FORMAT format{ DXGI_FORMAT_UNKNOWN };
+	bool depthStencil{ false };
+	std::array<float, 4> clearColor{};
+};
+
+struct FrameBarrier
+{
+	enum class Type : int
+	{
+		Transition,
+		Aliasing,		//같은 메모리를 쓰던 다른 텍스쳐에서 이 텍스쳐로 바뀐다
+	};
+
+	Type type{ Type::Transition };
+	UINT resource{ 0u };
+	D3D12_RESOURCE_STATES before{ D3D12_RESOURCE_STATE_COMMON };
+	D3D12_RESOURCE_STATES after{ D3D12_RESOURCE_STATE_COMMON };
+};
+
+//힙 하나에 놓는 임시 텍스쳐. 살아 있는 구간이 겹치지 않으면 같은 offset을 쓴다.
+struct TransientPlacement
+{
+	UINT resource{ 0u };
+	FrameTextureDesc desc{};
+	UINT64 offset{ 0 };
+	UINT64 size{ 0 };
+	D3D12_RESOURCE_STATES initialState{ D3D12_RESOURCE_STATE_COMMON };	//프레임이 끝날 때의 상태라서 다음 프레임도 이어진다
+};
+
+struct FrameGraphStats
+{
+	UINT culledPassCount{ 0u };
+	UINT barrierCount{ 0u };
+	UINT barrierBatchCount{ 0u };		//ResourceBarrier 호출 수
+	UINT aliasingBarrierCount{ 0u };
+	UINT64 transientBytes{ 0 };			//임시 텍스쳐를 따로 만들었을 때의 크기
+	UINT64 heapBytes{ 0 };
+};
+
+//실제로 메모리를 잡고 barrier를 거는 곳. 렌더러는 D3D12 힙과 커맨드 리스트를 쓰고,
+//테스트는 크기만 계산하고 호출을 기록하는 가짜로 바꿔 끼운다.
+interface IFrameGraphBackend
+{
+	virtual ~IFrameGraphBackend() {};
+	virtual UINT64 GetTextureSize(const FrameTextureDesc& desc) = 0;
+	virtual bool CreateTransients(UINT64 heapBytes, const std::vector<TransientPlacement>& placements) = 0;
+	virtual void ResourceBarriers(const std::vector<FrameBarrier>& barriers) = 0;
+	virtual void Discard(UINT resource) = 0;
+};
+
+//패스는 읽고 쓰는 텍스쳐와 그때의 상태만 적는다. Compile이 결과에 닿지 않는 패스를 빼고,
+//패스마다 필요한 barrier를 한번에 모으고, 임시 텍스쳐를 힙에 겹쳐 놓는다.
+//패스는 넣은 순서대로 돈다. 장치를 쓰지 않는다.
+class CFrameGraph
+{
+	struct Resource
+	{
+		std::string name{};
+		FrameTextureDesc desc{};
+		bool imported{ false };
+		D3D12_RESOURCE_STATES initialState{ D3D12_RESOURCE_STATE_COMMON };
+		D3D12_RESOURCE_STATES finalState{ D3D12_RESOURCE_STATE_COMMON };
+	};
+
+	struct ResourceUse
+	{
+		UINT resource{ 0u };
+		D3D12_RESOURCE_STATES state{ D3D12_RESOURCE_STATE_COMMON };
+		bool read{ false };
+		bool write{ false };
+	};
+
+	struct Pass
+	{
+		std::string name{};
+		std::function<void()> execute{};
+		bool sideEffect{ false };
+		bool culled{ false };
+		std::vector<ResourceUse> uses{};
+	};
+
+	struct CompiledPass
+	{
+		UINT pass{ 0u };
+		std::vector<FrameBarrier> barriers{};
+		std::vector<UINT> discards{};
+	};
+
+	struct Lifetime
+	{
+		UINT first{ UINT_MAX };
+		UINT last{ 0u };
+		UINT64 offset{ 0 };
+		UINT64 size{ 0 };
+		bool aliased{ false };
+		D3D12_RESOURCE_STATES endState{ D3D12_RESOURCE_STATE_COMMON };
+	};
+
+public:
+	CFrameGraph();
+	~CFrameGraph();
+
+	CFrameGraph(const CFrameGraph&) = delete;
+	CFrameGraph& operator=(const CFrameGraph&) = delete;
+
+	UINT ImportTexture(std::string name, D3D12_RESOURCE_STATES initialState, D3D12_RESOURCE_STATES finalState);
+	UINT CreateTexture(std::string name, const FrameTextureDesc& desc);
+	UINT AddPass(std::string name, std::function<void()> execute, bool sideEffect = false);
+	void Read(UINT pass, UINT resource, D3D12_RESOURCE_STATES state);
+	void Write(UINT pass, UINT resource, D3D12_RESOURCE_STATES state);
+
+	bool Compile(IFrameGraphBackend* backend);
+	void Execute(IFrameGraphBackend* backend);
+	void Reset();
+
+	bool IsCulled(UINT pass) const;
+	inline const FrameGraphStats& GetStats() const;
+	inline const std::vector<TransientPlacement>& GetPlacements() const;
+
+private:
+	void AddUse(UINT pass, UINT resource, D3D12_RESOURCE_STATES state, bool write);
+	void CullPasses();
+	bool PlaceTransients(IFrameGraphBackend* backend);
+	bool BuildBarriers(bool record, std::vector<D3D12_RESOURCE_STATES>& inoutStates);
+	D3D12_RESOURCE_STATES GetReadState(UINT order, UINT resource) const;
+
+private:
+	std::vector<Resource> m_resources;
+	std::vector<Pass> m_passes;
+
+	std::vector<UINT> m_order;		//살아남은 패스
+	std::vector<Lifetime> m_lifetimes;
+	std::vector<CompiledPass> m_compiledPasses;
+	std::vector<FrameBarrier> m_finalBarriers;
+	std::vector<TransientPlacement> m_placements;
+	FrameGraphStats m_stats;
+};
+
+inline const FrameGraphStats& CFrameGraph::GetStats() const { return m_stats; }
+inline const std::vector<TransientPlacement>& CFrameGraph::GetPlacements() const { return m_placements; }
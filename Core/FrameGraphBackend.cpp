@@ -0,0 +1,87 @@
+﻿#include "pch.h"
+#include "./FrameGraphBackend.h"
+#include "./d3dUtil.h"
+
+using Microsoft::WRL::ComPtr;
+
+CFrameGraphBackend::CFrameGraphBackend(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList)
+	: m_device{ device }
+	, m_cmdList{ cmdList }
+	, m_heap{ nullptr }
+	, m_transients{}
+	, m_resources{}
+	, m_barriers{}
+{}
+CFrameGraphBackend::~CFrameGraphBackend() = default;
+
+D3D12_RESOURCE_DESC MakeResourceDesc(const FrameTextureDesc& desc)
+{
+	return CD3DX12_RESOURCE_DESC::Tex2D(desc.format, desc.width, desc.height, 1, 1, 1, 0,
+		desc.depthStencil ? D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL : D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+}
+
+UINT64 CFrameGraphBackend::GetTextureSize(const FrameTextureDesc& desc)
+{
+	const D3D12_RESOURCE_DESC resDesc = MakeResourceDesc(desc);
+	return m_device->GetResourceAllocationInfo(0, 1, &resDesc).SizeInBytes;
+}
+
+//앞 프레임 그래프의 임시 텍스쳐는 GPU가 다 쓴 뒤(OnResize에서 flush한 뒤)에 부른다.
+bool CFrameGraphBackend::CreateTransients(UINT64 heapBytes, const std::vector<TransientPlacement>& placements)
+{
+	m_transients.clear();
+	m_heap = nullptr;
+	if (heapBytes == 0) return true;
+
+	CD3DX12_HEAP_DESC heapDesc(heapBytes, D3D12_HEAP_TYPE_DEFAULT, 0, D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES);
+	ReturnIfFailed(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&m_heap)));
+
+	for (auto& placement : placements)
+	{
+		const D3D12_RESOURCE_DESC resDesc = MakeResourceDesc(placement.desc);
+		const CD3DX12_CLEAR_VALUE optClear = placement.desc.depthStencil ?
+			CD3DX12_CLEAR_VALUE(placement.desc.format, placement.desc.clearColor[0], 0) :
+			CD3DX12_CLEAR_VALUE(placement.desc.format, placement.desc.clearColor.data());
+
+		ComPtr<ID3D12Resource> resource{ nullptr };
+		ReturnIfFailed(m_device->CreatePlacedResource(m_heap.Get(), placement.offset, &resDesc,
+			placement.initialState, &optClear, IID_PPV_ARGS(&resource)));
+
+		SetResource(placement.resource, resource.Get());
+		m_transients.emplace_back(std::move(resource));
+	}
+
+	return true;
+}
+
+void CFrameGraphBackend::ResourceBarriers(const std::vector<FrameBarrier>& barriers)
+{
+	m_barriers.clear();
+	for (auto& barrier : barriers)
+	{
+		ID3D12Resource* resource = GetResource(barrier.resource);
+		m_barriers.emplace_back(barrier.type == FrameBarrier::Type::Aliasing ?
+			CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, resource) :
+			CD3DX12_RESOURCE_BARRIER::Transition(resource, barrier.before, barrier.after));
+	}
+
+	m_cmdList->ResourceBarrier(static_cast<UINT>(m_barriers.size()), m_barriers.data());
+}
+
+void CFrameGraphBackend::Discard(UINT resource)
+{
+	m_cmdList->DiscardResource(GetResource(resource), nullptr);
+}
+
+void CFrameGraphBackend::SetResource(UINT resource, ID3D12Resource* d3dResource)
+{
+	if (m_resources.size() <= resource)
+		m_resources.resize(resource + 1, nullptr);
+
+	m_resources[resource] = d3dResource;
+}
+
+ID3D12Resource* CFrameGraphBackend::GetResource(UINT resource) const
+{
+	return resource < m_resources.size() ? m_resources[resource] : nullptr;
+}
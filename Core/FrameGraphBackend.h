@@ -0,0 +1,33 @@
+﻿#pragma once
+
+#include "./FrameGraph.h"
+
+//프레임 그래프의 임시 텍스쳐를 힙 하나에 placed resource로 만들고 barrier를 커맨드 리스트에 건다.
+//밖에서 만든 텍스쳐는 SetResource로 알려 준다. 백버퍼는 프레임마다 바뀐다.
+class CFrameGraphBackend final : public IFrameGraphBackend
+{
+public:
+	CFrameGraphBackend(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList);
+	~CFrameGraphBackend();
+
+	CFrameGraphBackend() = delete;
+	CFrameGraphBackend(const CFrameGraphBackend&) = delete;
+	CFrameGraphBackend& operator=(const CFrameGraphBackend&) = delete;
+
+	virtual UINT64 GetTextureSize(const FrameTextureDesc& desc) override;
+	virtual bool CreateTransients(UINT64 heapBytes, const std::vector<TransientPlacement>& placements) override;
+	virtual void ResourceBarriers(const std::vector<FrameBarrier>& barriers) override;
+	virtual void Discard(UINT resource) override;
+
+	void SetResource(UINT resource, ID3D12Resource* d3dResource);
+	ID3D12Resource* GetResource(UINT resource) const;
+
+private:
+	ID3D12Device* m_device;
+	ID3D12GraphicsCommandList* m_cmdList;
+
+	Microsoft::WRL::ComPtr<ID3D12Heap> m_heap;
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_transients;
+	std::vector<ID3D12Resource*> m_resources;
+	std::vector<D3D12_RESOURCE_BARRIER> m_barriers;
+};
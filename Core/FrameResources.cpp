@@ -2,26 +2,31 @@
 #include "./FrameResources.h"
 #include "./d3dUtil.h"
 #include "./UploadBuffer.h"
+#include "./UploadAllocator.h"
+#include "./StreamCopy.h"
+#include "./CoreDefine.h"
 #include "../Include/RendererDefine.h"
 #include "../Include/FrameResourceData.h"
 
 CFrameResources::Resource::Resource()
 	: passCB{ nullptr }
 	, ssaoCB{ nullptr }
-	, skinnedCB{ nullptr }
-	, instanceBuffer{ nullptr }
 	, materialBuffer{ nullptr }
+	, bonePalette{ std::make_unique<UploadAllocation>() }
+	, instanceBuffer{ std::make_unique<UploadAllocation>() }
 	, cmdListAlloc{ nullptr }
 {}
 CFrameResources::Resource::~Resource() = default;
 
 CFrameResources::CFrameResources()
-	: m_resources{}
+	: m_device{ nullptr }
+	, m_pageBackend{ nullptr }
+	, m_uploadAllocator{ nullptr }
+	, m_resources{}
 {}
 CFrameResources::~CFrameResources() = default;
 
-bool CFrameResources::Resource::CreateUpdateBuffer(
-	ID3D12Device* device, UINT passCount, UINT maxInstanceCount, UINT materialCount)
+bool CFrameResources::Resource::CreateUpdateBuffer(ID3D12Device* device, UINT passCount, UINT materialCount)
 {
 	ReturnIfFailed(device->CreateCommandAllocator(
 		D3D12_COMMAND_LIST_TYPE_DIRECT,
@@ -29,39 +34,109 @@ bool CFrameResources::Resource::CreateUpdateBuffer(
 
 	passCB = std::make_unique<CUploadBuffer>(sizeof(PassConstants), passCount, true);
 	ssaoCB = std::make_unique<CUploadBuffer>(sizeof(SsaoConstants), 1, true);
-	skinnedCB = std::make_unique<CUploadBuffer>(sizeof(SkinnedConstants), 1, true);
-	instanceBuffer = std::make_unique<CUploadBuffer>(sizeof(InstanceBuffer), maxInstanceCount, false);
 	materialBuffer = std::make_unique<CUploadBuffer>(sizeof(MaterialBuffer), materialCount, false);
 
 	ReturnIfFalse(passCB->Initialize(device));
 	ReturnIfFalse(ssaoCB->Initialize(device));
-	ReturnIfFalse(skinnedCB->Initialize(device));
-	ReturnIfFalse(instanceBuffer->Initialize(device));
 	ReturnIfFalse(materialBuffer->Initialize(device));
 
 	return true;
 }
 
-bool CFrameResources::Build(ID3D12Device* device,
-	UINT passCount, UINT instanceCount, UINT matCount)
+bool CFrameResources::Build(ID3D12Device* device, UINT passCount, UINT matCount)
 {
+	m_device = device;
+	m_pageBackend = std::make_unique<CUploadPageBackend>(device);
+	m_uploadAllocator = std::make_unique<CUploadAllocator>(m_pageBackend.get(), gUploadPageSize);
+
 	for (auto i : std::views::iota(0, gFrameResourceCount))
 	{
 		auto frameRes = std::make_unique<Resource>();
-		ReturnIfFalse(frameRes->CreateUpdateBuffer(device, passCount, instanceCount, matCount));
+		ReturnIfFalse(frameRes->CreateUpdateBuffer(device, passCount, matCount));
 		m_resources.emplace_back(std::move(frameRes));
 	}
 
 	return true;
 }
 
+UINT GetElementByteSize(eBufferType bufferType)
+{
+	switch (bufferType)
+	{
+	case eBufferType::BonePalette:	return sizeof(DirectX::XMFLOAT4X4);
+	case eBufferType::Instance:		return sizeof(InstanceBuffer);
+	}
+
+	return 0u;
+}
+
 bool CFrameResources::SetUploadBuffer(eBufferType bufferType, const void* bufferData, size_t dataSize)
 {
 	if (dataSize == 0)
 		return false;
 
+	UploadAllocation* allocation = GetUploadAllocation(bufferType);
+	if (allocation != nullptr)
+	{
+		const UINT64 byteSize = static_cast<UINT64>(GetElementByteSize(bufferType)) * dataSize;
+		ReturnIfFalse(m_uploadAllocator->Allocate(byteSize, gUploadAlignment, allocation));
+		StreamCopy(allocation->cpuAddress, bufferData, byteSize);
+		m_uploadedBytes += byteSize;
+		return true;
+	}
+
 	CUploadBuffer* uploadBuffer = GetUploadBuffer(bufferType);
+	if (uploadBuffer == nullptr)
+		return false;
+
+	ReturnIfFalse(uploadBuffer->Reserve(m_device, static_cast<UINT>(dataSize)));
 	uploadBuffer->CopyDataList(bufferData, dataSize);
+	m_uploadedBytes += static_cast<UINT64>(uploadBuffer->GetByteSize()) * dataSize;
+
+	return true;
+}
+
+//원소마다 버전을 같이 받아서 이번 프레임 리소스의 버퍼에 올린 뒤로 바뀐 구간만 복사한다.
+//프레임 리소스가 gFrameResourceCount개라서 한번 바뀐 원소는 각 버퍼에 한번씩 올라간다.
+bool CFrameResources::UpdateUploadBuffer(eBufferType bufferType, const void* bufferData, const UINT64* versions, size_t dataSize)
+{
+	if (dataSize == 0)
+		return false;
+
+	CUploadBuffer* uploadBuffer = GetUploadBuffer(bufferType);
+	if (uploadBuffer == nullptr)
+		return false;
+
+	ReturnIfFalse(uploadBuffer->Reserve(m_device, static_cast<UINT>(dataSize)));
+	m_uploadedBytes += uploadBuffer->CopyChangedData(bufferData, versions, dataSize);
+
+	return true;
+}
+
+//복사용 임시 배열 없이 이번 프레임 업로드 버퍼에 바로 쓴다. 
+//상수 버퍼는 원소마다 256바이트로 맞춰야 해서 SetUploadBuffer로만 쓴다.
+bool CFrameResources::MapUploadBuffer(eBufferType bufferType, size_t dataSize, void** outData)
+{
+	if (dataSize == 0)
+		return false;
+
+	UploadAllocation* allocation = GetUploadAllocation(bufferType);
+	if (allocation != nullptr)
+	{
+		const UINT64 byteSize = static_cast<UINT64>(GetElementByteSize(bufferType)) * dataSize;
+		ReturnIfFalse(m_uploadAllocator->Allocate(byteSize, gUploadAlignment, allocation));
+		(*outData) = allocation->cpuAddress;
+		m_uploadedBytes += byteSize;
+		return true;
+	}
+
+	CUploadBuffer* uploadBuffer = GetUploadBuffer(bufferType);
+	if (uploadBuffer == nullptr || !uploadBuffer->IsPacked())
+		return false;
+
+	ReturnIfFalse(uploadBuffer->Reserve(m_device, static_cast<UINT>(dataSize)));
+	(*outData) = uploadBuffer->GetMappedData();
+	m_uploadedBytes += static_cast<UINT64>(uploadBuffer->GetByteSize()) * dataSize;
 
 	return true;
 }
@@ -69,12 +144,32 @@ bool CFrameResources::SetUploadBuffer(eBufferType bufferType, const void* buffer
 UINT64 CFrameResources::ForwardFrame()
 {
 	m_frameResIdx = (m_frameResIdx + 1) % gFrameResourceCount;
+	m_uploadedBytes = 0;
 	return m_fenceCount;
 }
 
-ID3D12Resource* CFrameResources::GetResource(eBufferType bufferType)
+//GPU가 completedFence까지 끝냈으면 그 전에 쓴 업로드 페이지를 다시 쓴다.
+void CFrameResources::Recycle(UINT64 completedFence)
+{
+	m_uploadAllocator->Recycle(completedFence);
+}
+
+void CFrameResources::SetFence(UINT64 fenceIdx)
 {
-	return GetUploadBuffer(bufferType)->Resource();
+	m_fenceCount = fenceIdx;
+	m_uploadAllocator->FinishFrame(fenceIdx);
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS CFrameResources::GetGpuAddress(eBufferType bufferType)
+{
+	UploadAllocation* allocation = GetUploadAllocation(bufferType);
+	if (allocation != nullptr)
+		return allocation->gpuAddress;
+
+	CUploadBuffer* buffer = GetUploadBuffer(bufferType);
+	if (buffer == nullptr) return 0;
+
+	return buffer->Resource()->GetGPUVirtualAddress();
 }
 
 UINT CFrameResources::GetBufferSize(eBufferType bufferType)
@@ -94,10 +189,22 @@ CUploadBuffer* CFrameResources::GetUploadBuffer(eBufferType bufferType)
 	{
 	case eBufferType::PassCB:			return resource->passCB.get();
 	case eBufferType::SsaoCB:			return resource->ssaoCB.get();
-	case eBufferType::SkinnedCB:	return resource->skinnedCB.get();
-	case eBufferType::Instance:		return resource->instanceBuffer.get();
 	case eBufferType::Material:		return resource->materialBuffer.get();
 	}
 
 	return nullptr;
-}
\ No newline at end of file
+}
+
+UploadAllocation* CFrameResources::GetUploadAllocation(eBufferType bufferType)
+{
+	Resource* resource = m_resources[m_frameResIdx].get();
+	if (resource == nullptr) return nullptr;
+
+	switch (bufferType)
+	{
+	case eBufferType::BonePalette:	return resource->bonePalette.get();
+	case eBufferType::Instance:		return resource->instanceBuffer.get();
+	}
+
+	return nullptr;
+}
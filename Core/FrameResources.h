@@ -1,6 +1,9 @@
 ﻿#pragma once
 
 class CUploadBuffer;
+class CUploadAllocator;
+struct UploadAllocation;
+interface IUploadPageBackend;
 enum class eBufferType;
 
 class CFrameResources
@@ -9,13 +12,14 @@ class CFrameResources
 	{
 		Resource();
 		~Resource();
-		bool CreateUpdateBuffer(ID3D12Device* device, UINT passCount, UINT maxInstanceCount, UINT materialCount);
+		bool CreateUpdateBuffer(ID3D12Device* device, UINT passCount, UINT materialCount);
 
 		std::unique_ptr<CUploadBuffer> passCB;
 		std::unique_ptr<CUploadBuffer> ssaoCB;
-		std::unique_ptr<CUploadBuffer> skinnedCB;
-		std::unique_ptr<CUploadBuffer> instanceBuffer;
 		std::unique_ptr<CUploadBuffer> materialBuffer;
+		//인스턴스와 본 팔레트는 매 프레임 새로 쓰므로 업로드 페이지에서 잘라 쓴다.
+		std::unique_ptr<UploadAllocation> bonePalette;
+		std::unique_ptr<UploadAllocation> instanceBuffer;
 		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> cmdListAlloc;
 	};
 
@@ -26,22 +30,29 @@ public:
 	CFrameResources(const CFrameResources&) = delete;
 	CFrameResources& operator=(const CFrameResources&) = delete;
 
-	bool Build(ID3D12Device* device,
-		UINT passCount, UINT instanceCount, UINT matCount);
+	bool Build(ID3D12Device* device, UINT passCount, UINT matCount);
 	UINT64 ForwardFrame();
+	void Recycle(UINT64 completedFence);
+	void SetFence(UINT64 fenceIdx);
 	bool SetUploadBuffer(eBufferType bufferType, const void* bufferData, size_t dataSize);
+	bool MapUploadBuffer(eBufferType bufferType, size_t dataSize, void** outData);
+	bool UpdateUploadBuffer(eBufferType bufferType, const void* bufferData, const UINT64* versions, size_t dataSize);
 
 	inline ID3D12CommandAllocator* GetCurrCmdListAlloc() { return m_resources[m_frameResIdx]->cmdListAlloc.Get();	}
-	inline void SetFence(UINT64 fenceIdx)	{ m_fenceCount = fenceIdx; }
-	ID3D12Resource* GetResource(eBufferType bufferType);
+	D3D12_GPU_VIRTUAL_ADDRESS GetGpuAddress(eBufferType bufferType);
 	UINT GetBufferSize(eBufferType bufferType);
+	inline UINT64 GetUploadedBytes() const { return m_uploadedBytes; };
 
 private:
 	CUploadBuffer* GetUploadBuffer(eBufferType bufferType);
+	UploadAllocation* GetUploadAllocation(eBufferType bufferType);
 
 private:
+	ID3D12Device* m_device;
+	std::unique_ptr<IUploadPageBackend> m_pageBackend;
+	std::unique_ptr<CUploadAllocator> m_uploadAllocator;
 	std::vector<std::unique_ptr<Resource>> m_resources;
 	UINT m_frameResIdx{ 0 };
 	UINT64 m_fenceCount{ 0 };
+	UINT64 m_uploadedBytes{ 0 };		//ForwardFrame 이후에 업로드 버퍼에 쓴 바이트 수
 };
-
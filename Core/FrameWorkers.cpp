@@ -0,0 +1,54 @@
+﻿#include "pch.h"
+#include "./FrameWorkers.h"
+
+CFrameWorkers::CFrameWorkers(std::vector<std::function<void()>> jobs)
+	: m_jobs{ std::move(jobs) }
+	, m_runCount{ 0 }
+	, m_workingCount{ 0 }
+	, m_threads{}
+{
+	for (auto job : std::views::iota(size_t{ 1 }, std::max(m_jobs.size(), size_t{ 1 })))
+		m_threads.emplace_back([this, job](std::stop_token stopToken) { Work(stopToken, job); });
+}
+
+//jthread가 소멸하면서 stop을 요청하고 join한다.
+CFrameWorkers::~CFrameWorkers() = default;
+
+void CFrameWorkers::Run()
+{
+	if (m_jobs.empty()) return;
+
+	{
+		std::lock_guard lock(m_mutex);
+		m_runCount++;
+		m_workingCount = m_threads.size();
+	}
+	m_startCondition.notify_all();
+
+	m_jobs[0]();
+
+	std::unique_lock lock(m_mutex);
+	m_doneCondition.wait(lock, [this]() { return m_workingCount == 0; });
+}
+
+//Run이 올린 횟수가 마지막으로 한 횟수와 다르면 깨어나서 맡은 일을 한번 한다.
+void CFrameWorkers::Work(std::stop_token stopToken, size_t job)
+{
+	UINT64 doneCount{ 0 };
+	while (true)
+	{
+		{
+			std::unique_lock lock(m_mutex);
+			if (!m_startCondition.wait(lock, stopToken, [this, doneCount]() { return m_runCount != doneCount; })) return;
+			doneCount = m_runCount;
+		}
+
+		m_jobs[job]();
+
+		{
+			std::lock_guard lock(m_mutex);
+			m_workingCount--;
+		}
+		m_doneCondition.notify_one();
+	}
+}
@@ -0,0 +1,34 @@
+﻿#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+//프레임마다 같은 일들을 나눠 하는 작업 스레드. 스레드는 만들 때 한번만 띄워 두고
+//Run이 깨워서 모두 끝날 때까지 기다린다. 0번 일은 Run을 부른 스레드가 직접 한다.
+class CFrameWorkers
+{
+public:
+	CFrameWorkers(std::vector<std::function<void()>> jobs);
+	~CFrameWorkers();
+
+	CFrameWorkers() = delete;
+	CFrameWorkers(const CFrameWorkers&) = delete;
+	CFrameWorkers& operator=(const CFrameWorkers&) = delete;
+
+	void Run();
+
+private:
+	void Work(std::stop_token stopToken, size_t job);
+
+private:
+	std::vector<std::function<void()>> m_jobs;
+	std::mutex m_mutex;
+	std::condition_variable_any m_startCondition;
+	std::condition_variable m_doneCondition;
+	UINT64 m_runCount;
+	size_t m_workingCount;		//이번 Run에서 아직 끝나지 않은 작업 스레드 수
+
+	std::vector<std::jthread> m_threads;	//멤버 중 마지막에 있어야 먼저 멈추고 join한다
+};
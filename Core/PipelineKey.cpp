@@ -0,0 +1,208 @@
+﻿#include "pch.h"
+#include "./PipelineKey.h"
+#include "./ShaderCache.h"
+
+constexpr UINT gPipelineLibraryMagic{ 0x4C505350u };	//"PSPL"
+constexpr UINT gPipelineLibraryVersion{ 1u };
+
+struct PipelineLibraryHeader
+{
+	UINT magic{ 0u };
+	UINT version{ 0u };
+	UINT64 umdVersion{ 0 };
+	UINT vendorId{ 0u };
+	UINT deviceId{ 0u };
+	UINT64 blobSize{ 0 };
+};
+
+//구조체 안의 빈 공간은 값이 정해져 있지 않아서 멤버 하나씩 넣는다.
+template<typename T>
+UINT64 HashValue(const T& value, UINT64 hash)
+{
+	static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+	return HashBytes(&value, sizeof(value), hash);
+}
+
+UINT64 HashShader(const D3D12_SHADER_BYTECODE& shader, UINT64 hash)
+{
+	hash = HashValue(shader.BytecodeLength, hash);
+	return (shader.pShaderBytecode == nullptr) ? hash : HashBytes(shader.pShaderBytecode, shader.BytecodeLength, hash);
+}
+
+UINT64 HashBlend(const D3D12_BLEND_DESC& blend, UINT64 hash)
+{
+	hash = HashValue(blend.AlphaToCoverageEnable, hash);
+	hash = HashValue(blend.IndependentBlendEnable, hash);
+	for (auto& rt : blend.RenderTarget)
+	{
+		hash = HashValue(rt.BlendEnable, hash);
+		hash = HashValue(rt.LogicOpEnable, hash);
+		hash = HashValue(rt.SrcBlend, hash);
+		hash = HashValue(rt.DestBlend, hash);
+		hash = HashValue(rt.BlendOp, hash);
+		hash = HashValue(rt.SrcBlendAlpha, hash);
+		hash = HashValue(rt.DestBlendAlpha, hash);
+		hash = HashValue(rt.BlendOpAlpha, hash);
+		hash = HashValue(rt.LogicOp, hash);
+		hash = HashValue(rt.RenderTargetWriteMask, hash);
+	}
+	return hash;
+}
+
+UINT64 HashRasterizer(const D3D12_RASTERIZER_DESC& raster, UINT64 hash)
+{
+	hash = HashValue(raster.FillMode, hash);
+	hash = HashValue(raster.CullMode, hash);
+	hash = HashValue(raster.FrontCounterClockwise, hash);
+	hash = HashValue(raster.DepthBias, hash);
+	hash = HashValue(raster.DepthBiasClamp, hash);
+	hash = HashValue(raster.SlopeScaledDepthBias, hash);
+	hash = HashValue(raster.DepthClipEnable, hash);
+	hash = HashValue(raster.MultisampleEnable, hash);
+	hash = HashValue(raster.AntialiasedLineEnable, hash);
+	hash = HashValue(raster.ForcedSampleCount, hash);
+	return HashValue(raster.ConservativeRaster, hash);
+}
+
+UINT64 HashStencilOp(const D3D12_DEPTH_STENCILOP_DESC& op, UINT64 hash)
+{
+	hash = HashValue(op.StencilFailOp, hash);
+	hash = HashValue(op.StencilDepthFailOp, hash);
+	hash = HashValue(op.StencilPassOp, hash);
+	return HashValue(op.StencilFunc, hash);
+}
+
+UINT64 HashDepthStencil(const D3D12_DEPTH_STENCIL_DESC& depth, UINT64 hash)
+{
+	hash = HashValue(depth.DepthEnable, hash);
+	hash = HashValue(depth.DepthWriteMask, hash);
+	hash = HashValue(depth.DepthFunc, hash);
+	hash = HashValue(depth.StencilEnable, hash);
+	hash = HashValue(depth.StencilReadMask, hash);
+	hash = HashValue(depth.StencilWriteMask, hash);
+	hash = HashStencilOp(depth.FrontFace, hash);
+	return HashStencilOp(depth.BackFace, hash);
+}
+
+UINT64 HashInputLayout(const D3D12_INPUT_LAYOUT_DESC& layout, UINT64 hash)
+{
+	hash = HashValue(layout.NumElements, hash);
+	for (auto i : std::views::iota(0u, layout.NumElements))
+	{
+		const D3D12_INPUT_ELEMENT_DESC& element = layout.pInputElementDescs[i];
+		hash = HashString(element.SemanticName, hash);
+		hash = HashValue(element.SemanticIndex, hash);
+		hash = HashValue(element.Format, hash);
+		hash = HashValue(element.InputSlot, hash);
+		hash = HashValue(element.AlignedByteOffset, hash);
+		hash = HashValue(element.InputSlotClass, hash);
+		hash = HashValue(element.InstanceDataStepRate, hash);
+	}
+	return hash;
+}
+
+//StreamOutput과 CachedPSO는 쓰지 않는다.
+UINT64 HashPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, UINT rootSignatureId)
+{
+	UINT64 hash = HashValue(gPipelineLibraryVersion, gFnvOffsetBasis);
+	hash = HashValue(rootSignatureId, hash);
+	for (auto shader : { &desc.VS, &desc.PS, &desc.DS, &desc.HS, &desc.GS })
+		hash = HashShader(*shader, hash);
+	hash = HashBlend(desc.BlendState, hash);
+	hash = HashValue(desc.SampleMask, hash);
+	hash = HashRasterizer(desc.RasterizerState, hash);
+	hash = HashDepthStencil(desc.DepthStencilState, hash);
+	hash = HashInputLayout(desc.InputLayout, hash);
+	hash = HashValue(desc.IBStripCutValue, hash);
+	hash = HashValue(desc.PrimitiveTopologyType, hash);
+	hash = HashValue(desc.NumRenderTargets, hash);
+	for (auto i : std::views::iota(0u, std::min(desc.NumRenderTargets, 8u)))
+		hash = HashValue(desc.RTVFormats[i], hash);
+	hash = HashValue(desc.DSVFormat, hash);
+	hash = HashValue(desc.SampleDesc.Count, hash);
+	hash = HashValue(desc.SampleDesc.Quality, hash);
+	hash = HashValue(desc.NodeMask, hash);
+
+	return HashValue(desc.Flags, hash);
+}
+
+//파일이 없거나 다른 드라이버가 만든 것이면 false. 빈 라이브러리로 새로 시작한다.
+bool ReadPipelineLibraryFile(const std::wstring& filename, const DriverVersion& driver, std::vector<BYTE>* outBlob)
+{
+	std::ifstream fin(filename, std::ios::binary);
+	if (fin.fail()) return false;
+
+	PipelineLibraryHeader header{};
+	fin.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (fin.fail()) return false;
+
+	if (header.magic != gPipelineLibraryMagic || header.version != gPipelineLibraryVersion) return false;
+	if (header.umdVersion != driver.umdVersion || header.vendorId != driver.vendorId || header.deviceId != driver.deviceId) return false;
+
+	outBlob->resize(static_cast<size_t>(header.blobSize));
+	fin.read(reinterpret_cast<char*>(outBlob->data()), static_cast<std::streamsize>(outBlob->size()));
+	if (fin.gcount() != static_cast<std::streamsize>(outBlob->size()))
+	{
+		outBlob->clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool WritePipelineLibraryFile(const std::wstring& filename, const DriverVersion& driver, const void* data, size_t size)
+{
+	std::ofstream fout(filename, std::ios::binary | std::ios::trunc);
+	if (fout.fail()) return false;
+
+	const PipelineLibraryHeader header{ gPipelineLibraryMagic, gPipelineLibraryVersion,
+		driver.umdVersion, driver.vendorId, driver.deviceId, size };
+	fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	fout.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+
+	return !fout.fail();
+}
+
+CPipelineKeyTable::CPipelineKeyTable()
+	: m_states{}
+	, m_duplicateCount{ 0u }
+{}
+CPipelineKeyTable::~CPipelineKeyTable() = default;
+
+bool CPipelineKeyTable::Claim(UINT64 key)
+{
+	std::lock_guard lock(m_mutex);
+	if (m_states.try_emplace(key, State::Creating).second) return true;
+
+	m_duplicateCount++;
+	return false;
+}
+
+void CPipelineKeyTable::Publish(UINT64 key, bool succeeded)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_states[key] = succeeded ? State::Created : State::Failed;
+	}
+	m_publishCondition.notify_all();
+}
+
+bool CPipelineKeyTable::Wait(UINT64 key)
+{
+	std::unique_lock lock(m_mutex);
+	m_publishCondition.wait(lock, [this, key]() { return m_states.at(key) != State::Creating; });
+
+	return m_states.at(key) == State::Created;
+}
+
+UINT CPipelineKeyTable::GetKeyCount()
+{
+	std::lock_guard lock(m_mutex);
+	return static_cast<UINT>(m_states.size());
+}
+
+UINT CPipelineKeyTable::GetDuplicateCount()
+{
+	std::lock_guard lock(m_mutex);
+	return m_duplicateCount;
+}
@@ -0,0 +1,51 @@
+﻿#pragma once
+
+#include <condition_variable>
+#include <mutex>
+
+//파이프라인 라이브러리를 만든 드라이버. 하나라도 다르면 저장해 둔 라이브러리를 쓰지 않는다.
+struct DriverVersion
+{
+	UINT64 umdVersion{ 0 };
+	UINT vendorId{ 0u };
+	UINT deviceId{ 0u };
+};
+
+//PSO 설명에서 결과가 달라지는 값만 해시한다. 포인터 대신 셰이더 바이트코드와 입력 레이아웃의 내용을 넣고,
+//루트 시그너쳐는 실행마다 주소가 바뀌므로 번호로 받는다. 같은 키면 같은 PSO다.
+UINT64 HashPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, UINT rootSignatureId);
+
+bool ReadPipelineLibraryFile(const std::wstring& filename, const DriverVersion& driver, std::vector<BYTE>* outBlob);
+bool WritePipelineLibraryFile(const std::wstring& filename, const DriverVersion& driver, const void* data, size_t size);
+
+//키마다 슬롯을 하나 두고, 같은 키를 처음 Claim한 쪽만 PSO를 만든다.
+//나중에 온 쪽은 Wait로 만든 결과를 기다렸다가 같이 쓴다. 여러 스레드에서 불러도 된다.
+class CPipelineKeyTable
+{
+	enum class State : int
+	{
+		Creating,
+		Created,
+		Failed,
+	};
+
+public:
+	CPipelineKeyTable();
+	~CPipelineKeyTable();
+
+	CPipelineKeyTable(const CPipelineKeyTable&) = delete;
+	CPipelineKeyTable& operator=(const CPipelineKeyTable&) = delete;
+
+	bool Claim(UINT64 key);
+	void Publish(UINT64 key, bool succeeded);
+	bool Wait(UINT64 key);
+
+	UINT GetKeyCount();
+	UINT GetDuplicateCount();
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_publishCondition;
+	std::unordered_map<UINT64, State> m_states;
+	UINT m_duplicateCount;
+};
@@ -0,0 +1,107 @@
+﻿#include "pch.h"
+#include "./PipelineLibrary.h"
+#include "./ShaderCache.h"
+#include "./d3dUtil.h"
+#include <filesystem>
+
+using Microsoft::WRL::ComPtr;
+
+CPipelineLibrary::CPipelineLibrary(std::wstring filename)
+	: m_filename{ std::move(filename) }
+	, m_driver{}
+	, m_blob{}
+	, m_library{ nullptr }
+	, m_changed{ false }
+	, m_keys{}
+	, m_pipelines{}
+	, m_loadCount{ 0u }
+	, m_createCount{ 0u }
+{}
+CPipelineLibrary::~CPipelineLibrary() = default;
+
+//저장한 라이브러리가 없거나 드라이버가 바뀌었으면 빈 라이브러리로 시작한다.
+bool CPipelineLibrary::Load(ID3D12Device* device, const DriverVersion& driver)
+{
+	m_driver = driver;
+
+	ComPtr<ID3D12Device1> device1{ nullptr };
+	if (FAILED(device->QueryInterface(IID_PPV_ARGS(&device1)))) return true;
+
+	if (ReadPipelineLibraryFile(m_filename, m_driver, &m_blob) &&
+		SUCCEEDED(device1->CreatePipelineLibrary(m_blob.data(), m_blob.size(), IID_PPV_ARGS(&m_library))))
+		return true;
+
+	m_blob.clear();
+	m_library = nullptr;
+	if (FAILED(device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&m_library))))
+		m_library = nullptr;
+
+	return true;
+}
+
+//같은 키를 여러 스레드가 동시에 요청하면 하나만 만들고 나머지는 그 PSO를 같이 쓴다.
+bool CPipelineLibrary::GetOrCreate(ID3D12Device* device, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, UINT rootSignatureId,
+	ComPtr<ID3D12PipelineState>* outPso)
+{
+	const UINT64 key = HashPipelineDesc(desc, rootSignatureId);
+	if (!m_keys.Claim(key))
+	{
+		ReturnIfFalse(m_keys.Wait(key));
+
+		std::lock_guard lock(m_mutex);
+		(*outPso) = m_pipelines.at(key);
+		return true;
+	}
+
+	ComPtr<ID3D12PipelineState> pso{ nullptr };
+	const bool result = Create(device, key, desc, &pso);
+	{
+		std::lock_guard lock(m_mutex);
+		m_pipelines[key] = pso;
+	}
+	m_keys.Publish(key, result);
+
+	(*outPso) = std::move(pso);
+	return result;
+}
+
+bool CPipelineLibrary::Create(ID3D12Device* device, UINT64 key, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+	ComPtr<ID3D12PipelineState>* outPso)
+{
+	//LoadGraphicsPipeline은 여러 스레드에서 불러도 된다. 같은 이름은 Claim한 스레드 하나만 부른다.
+	const std::wstring name = GetHashName(key);
+	if (m_library != nullptr &&
+		SUCCEEDED(m_library->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(outPso->ReleaseAndGetAddressOf()))))
+	{
+		m_loadCount++;
+		return true;
+	}
+
+	ReturnIfFailed(device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(outPso->ReleaseAndGetAddressOf())));
+	m_createCount++;
+
+	if (m_library != nullptr)
+	{
+		std::lock_guard lock(m_mutex);
+		m_changed |= SUCCEEDED(m_library->StorePipeline(name.c_str(), outPso->Get()));
+	}
+
+	return true;
+}
+
+//새로 넣은 PSO가 있을 때만 파일을 다시 쓴다.
+bool CPipelineLibrary::Save()
+{
+	std::lock_guard lock(m_mutex);
+	if (m_library == nullptr || !m_changed) return true;
+
+	std::vector<BYTE> data(m_library->GetSerializedSize());
+	ReturnIfFailed(m_library->Serialize(data.data(), data.size()));
+
+	std::error_code ec{};
+	std::filesystem::create_directories(std::filesystem::path(m_filename).parent_path(), ec);
+	ReturnIfFalse(WritePipelineLibraryFile(m_filename, m_driver, data.data(), data.size()));
+	m_changed = false;
+
+	return true;
+}
@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#include "./PipelineKey.h"
+
+//만든 PSO를 ID3D12PipelineLibrary에 키 이름으로 넣어 두고 파일로 저장한다.
+//다음 실행에서 같은 드라이버면 라이브러리에서 꺼내고, 없으면 새로 만든다.
+//라이브러리를 지원하지 않는 장치면 매번 새로 만든다.
+class CPipelineLibrary
+{
+public:
+	CPipelineLibrary(std::wstring filename);
+	~CPipelineLibrary();
+
+	CPipelineLibrary() = delete;
+	CPipelineLibrary(const CPipelineLibrary&) = delete;
+	CPipelineLibrary& operator=(const CPipelineLibrary&) = delete;
+
+	bool Load(ID3D12Device* device, const DriverVersion& driver);
+	bool GetOrCreate(ID3D12Device* device, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, UINT rootSignatureId,
+		Microsoft::WRL::ComPtr<ID3D12PipelineState>* outPso);
+	bool Save();
+
+	inline UINT GetLoadCount() const;
+	inline UINT GetCreateCount() const;
+	inline UINT GetDuplicateCount();
+
+private:
+	bool Create(ID3D12Device* device, UINT64 key, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+		Microsoft::WRL::ComPtr<ID3D12PipelineState>* outPso);
+
+private:
+	std::wstring m_filename;
+	DriverVersion m_driver;
+	std::vector<BYTE> m_blob;	//라이브러리가 살아 있는 동안 지우면 안된다
+	Microsoft::WRL::ComPtr<ID3D12PipelineLibrary> m_library;
+	bool m_changed;
+
+	std::mutex m_mutex;
+	CPipelineKeyTable m_keys;
+	std::unordered_map<UINT64, Microsoft::WRL::ComPtr<ID3D12PipelineState>> m_pipelines;
+	std::atomic<UINT> m_loadCount;
+	std::atomic<UINT> m_createCount;
+};
+
+inline UINT CPipelineLibrary::GetLoadCount() const { return m_loadCount.load(); }
+inline UINT CPipelineLibrary::GetCreateCount() const { return m_createCount.load(); }
+inline UINT CPipelineLibrary::GetDuplicateCount() { return m_keys.GetDuplicateCount(); }
@@ -1,4 +1,4 @@
-#include "pch.h"
+﻿#include "pch.h"
 #include "PipelineStateObjects.h"
 #include "../Include/Types.h"
 #include "./Shader.h"
@@ -6,10 +6,17 @@
 #include "./Directx3D.h"
 #include "./RootSignature.h"
 #include "./SsaoMap.h"
+#include "./PipelineLibrary.h"
+#include <chrono>
+#include <format>
+#include <thread>
 
 CPipelineStateObjects::~CPipelineStateObjects() = default;
-CPipelineStateObjects::CPipelineStateObjects(CDirectx3D* directx3D)
+CPipelineStateObjects::CPipelineStateObjects(CDirectx3D* directx3D, const std::wstring& resPath)
 	: m_directx3D{ directx3D }
+	, m_rootSignature{ nullptr }
+	, m_shader{ nullptr }
+	, m_library{ std::make_unique<CPipelineLibrary>(resPath + L"ShaderCache/Pipelines.bin") }
 	, m_psoList{}
 {}
 
@@ -22,34 +29,81 @@ ID3D12PipelineState* CPipelineStateObjects::GetPso(GraphicsPSO type) noexcept
 	return find->second.Get();
 }
 
+//여러 스레드가 m_psoList에 쓰므로 원소는 미리 만들어 둔다.
 bool CPipelineStateObjects::Build(CRootSignature* rootSignature, CShader* shader)
 {
-	return (std::ranges::all_of(shader->GetPSOList(), [this, rootSignature, shader](auto pso) {
-		return CreatePipelineState(rootSignature, shader, pso);
-		}));
+	m_rootSignature = rootSignature;
+	m_shader = shader;
+
+	std::map<GraphicsPSO, std::vector<ShaderType>> psoShaders{};
+	for (auto pso : shader->GetPSOList())
+	{
+		psoShaders[pso] = shader->GetShaderTypes(pso);
+		m_psoList[pso] = nullptr;
+	}
+
+	DriverVersion driver{};
+	ReturnIfFalse(m_directx3D->GetDriverVersion(&driver));
+	ReturnIfFalse(m_library->Load(m_directx3D->GetDevice(), driver));
+
+	CBuildGraph graph{};
+	AddPipelineTasks(this, psoShaders, &graph);
+
+	const auto start = std::chrono::steady_clock::now();
+	const bool result = graph.Run(std::max(std::thread::hardware_concurrency(), 1u));
+	const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	//만들다 실패한 PSO가 있어도 만든 것은 저장해 둔다. 다음 실행을 빠르게 할 뿐이라 저장하지 못해도 계속한다.
+	const bool saved = m_library->Save();
+	ReportTimes(graph, elapsed.count(), saved);
+
+	return result;
 }
 
-void SetRootSignature(CRootSignature* rootSignature, GraphicsPSO psoType, D3D12_GRAPHICS_PIPELINE_STATE_DESC* psoDesc)
+void CPipelineStateObjects::ReportTimes(const CBuildGraph& graph, double totalMilliseconds, bool librarySaved)
+{
+	std::string report{};
+	for (auto& time : graph.GetTimes())
+		report += std::format("{:<24}{:>10.2f} ms{}\n", time.name, time.milliseconds, time.succeeded ? "" : "  failed");
+	report += std::format("PSO build total {:.2f} ms, {} tasks at most {} at once\n",
+		totalMilliseconds, graph.GetTimes().size(), graph.GetMaxConcurrency());
+	report += std::format("PSO library {} loaded, {} created, {} merged\n",
+		m_library->GetLoadCount(), m_library->GetCreateCount(), m_library->GetDuplicateCount());
+	if (!librarySaved) report += "PSO library save failed\n";
+
+	OutputDebugStringA(report.c_str());
+}
+
+bool CPipelineStateObjects::BuildRootSignatures()
+{
+	return m_rootSignature->Build(m_directx3D->GetDevice());
+}
+
+bool CPipelineStateObjects::CompileShader(GraphicsPSO psoType, ShaderType shaderType)
+{
+	return m_shader->CompileShader(psoType, shaderType);
+}
+
+RootSignature GetRootSignatureType(GraphicsPSO psoType)
 {
 	if (psoType == GraphicsPSO::SsaoMap || psoType == GraphicsPSO::SsaoBlur)
-	{
-		psoDesc->pRootSignature = rootSignature->Get(RootSignature::Ssao);
-		return;
-	}
+		return RootSignature::Ssao;
 
-	psoDesc->pRootSignature = rootSignature->Get(RootSignature::Common);
+	return RootSignature::Common;
 }
 
-bool CPipelineStateObjects::CreatePipelineState(CRootSignature* rootSignature, CShader* shader, GraphicsPSO psoType)
+bool CPipelineStateObjects::CreatePipelineState(GraphicsPSO psoType)
 {
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc{};
 
-	ReturnIfFalse(shader->SetPipelineStateDesc(psoType, &psoDesc));
-	SetRootSignature(rootSignature, psoType, &psoDesc);
+	ReturnIfFalse(m_shader->SetPipelineStateDesc(psoType, &psoDesc));
+	const RootSignature rootSignatureType = GetRootSignatureType(psoType);
+	psoDesc.pRootSignature = m_rootSignature->Get(rootSignatureType);
 	MakePSOPipelineState(psoType, &psoDesc);
 
+	//설명이 같은 PSO는 하나를 같이 쓴다
 	ID3D12Device* device = m_directx3D->GetDevice();
-	ReturnIfFailed(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_psoList[psoType])));
+	ReturnIfFalse(m_library->GetOrCreate(device, psoDesc, static_cast<UINT>(rootSignatureType), &m_psoList.at(psoType)));
 
 	return true;
 }
@@ -1,14 +1,18 @@
-#pragma once
+﻿#pragma once
+
+#include "./BuildGraph.h"
 
 class CShader;
 class CDirectx3D;
 class CRootSignature;
+class CPipelineLibrary;
 enum class GraphicsPSO : int;
 
-class CPipelineStateObjects
+//루트 시그너쳐, (PSO, 셰이더 단계)별 컴파일, PSO 생성을 CBuildGraph에 넣어 여러 스레드로 만든다.
+class CPipelineStateObjects final : public IPipelineBuildSteps
 {
 public:
-	CPipelineStateObjects(CDirectx3D* directx3D);
+	CPipelineStateObjects(CDirectx3D* directx3D, const std::wstring& resPath);
 	~CPipelineStateObjects();
 
 	CPipelineStateObjects() = delete;
@@ -19,9 +23,13 @@ public:
 
 	ID3D12PipelineState* GetPso(GraphicsPSO type) noexcept;
 
+	virtual bool BuildRootSignatures() override;
+	virtual bool CompileShader(GraphicsPSO psoType, ShaderType shaderType) override;
+	virtual bool CreatePipelineState(GraphicsPSO psoType) override;
+
 private:
 	void MakePSOPipelineState(GraphicsPSO psoType, D3D12_GRAPHICS_PIPELINE_STATE_DESC* psoDesc) noexcept;
-	bool CreatePipelineState(CRootSignature* rootSignature, CShader* shader, GraphicsPSO psoType);
+	void ReportTimes(const CBuildGraph& graph, double totalMilliseconds, bool librarySaved);
 
 	void MakeBasicDesc(D3D12_GRAPHICS_PIPELINE_STATE_DESC* psoDesc) noexcept;
 	void MakeSkyDesc(D3D12_GRAPHICS_PIPELINE_STATE_DESC* psoDesc) noexcept;
@@ -38,5 +46,8 @@ private:
 
 private:
 	CDirectx3D* m_directx3D;
+	CRootSignature* m_rootSignature;
+	CShader* m_shader;
+	std::unique_ptr<CPipelineLibrary> m_library;
 	std::map<GraphicsPSO, Microsoft::WRL::ComPtr<ID3D12PipelineState>> m_psoList;
 };
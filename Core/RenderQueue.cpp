@@ -0,0 +1,134 @@
+﻿#include "pch.h"
+#include "./RenderQueue.h"
+#include <bit>
+#include <execution>
+
+constexpr UINT gPassShift{ 60u };
+constexpr UINT gPsoShift{ 52u };
+constexpr UINT gGeometryShift{ 40u };
+constexpr UINT gDepthShift{ 16u };
+constexpr size_t gSortChunkSize{ 4096 };
+constexpr size_t gParallelSortCount{ 16384 };	//이보다 적으면 스레드에 나누는 비용이 더 커서 한 스레드로 정렬한다
+constexpr UINT gBindsPerDraw{ 4u };		//PSO, 정점 버퍼, 인덱스 버퍼, 토폴로지
+
+CRenderQueue::CRenderQueue()
+	: m_draws{}
+	, m_keys{}
+	, m_sortBuffer{}
+	, m_sortChunks{}
+	, m_stats{}
+{}
+CRenderQueue::~CRenderQueue() = default;
+
+void CRenderQueue::Reset()
+{
+	m_draws.clear();
+	m_keys.clear();
+	m_stats = {};
+}
+
+UINT64 CRenderQueue::MakeKey(UINT pass, GraphicsPSO pso, UINT geometry, float depth, UINT draw)
+{
+	const UINT depthBits = std::bit_cast<UINT>(std::max(depth, 0.0f)) >> 7;
+	return (static_cast<UINT64>(pass & 0xF) << gPassShift) |
+		(static_cast<UINT64>(static_cast<UINT>(pso) & 0xFF) << gPsoShift) |
+		(static_cast<UINT64>(geometry & 0xFFF) << gGeometryShift) |
+		(static_cast<UINT64>(depthBits & 0xFFFFFF) << gDepthShift) |
+		static_cast<UINT64>(draw & 0xFFFF);
+}
+
+bool CRenderQueue::Add(UINT pass, float depth, const RenderDraw& draw)
+{
+	if (pass >= MaxPass || m_draws.size() >= MaxDraw) return false;
+
+	m_keys.emplace_back(MakeKey(pass, draw.pso, draw.geometry, depth, static_cast<UINT>(m_draws.size())));
+	m_draws.emplace_back(draw);
+
+	return true;
+}
+
+//8비트씩 LSD 기수 정렬을 한다. 덩어리마다 따로 세고, 앞 덩어리 뒤에 이어지게 자리를 정해서
+//흩뿌리기도 덩어리마다 동시에 한다. 모든 키가 같은 값인 자리는 건너뛴다.
+void CRenderQueue::Sort()
+{
+	const size_t count = m_keys.size();
+	m_sortBuffer.resize(count);
+	m_sortChunks.resize(std::max((count + gSortChunkSize - 1) / gSortChunkSize, size_t{ 1 }));
+	for (auto index : std::views::iota(size_t{ 0 }, m_sortChunks.size()))
+	{
+		m_sortChunks[index].begin = std::min(index * gSortChunkSize, count);
+		m_sortChunks[index].end = std::min(m_sortChunks[index].begin + gSortChunkSize, count);
+	}
+
+	for (auto shift : std::views::iota(0u, 8u))
+		SortDigit(shift * 8);
+}
+
+template<typename Chunks, typename Func>
+void ForEachChunk(bool parallel, Chunks& chunks, Func&& func)
+{
+	if (parallel)
+		std::for_each(std::execution::par, chunks.begin(), chunks.end(), func);
+	else
+		std::for_each(std::execution::seq, chunks.begin(), chunks.end(), func);
+}
+
+void CRenderQueue::SortDigit(UINT shift)
+{
+	const bool parallel = m_keys.size() >= gParallelSortCount;
+	ForEachChunk(parallel, m_sortChunks, [this, shift](SortChunk& chunk) {
+		chunk.counts.fill(0);
+		for (auto index : std::views::iota(chunk.begin, chunk.end))
+			chunk.counts[(m_keys[index] >> shift) & 0xFF]++; });
+
+	size_t offset{ 0 };
+	for (auto digit : std::views::iota(0, 256))
+	{
+		const size_t digitOffset = offset;
+		for (auto& chunk : m_sortChunks)
+		{
+			const size_t chunkCount = chunk.counts[digit];
+			chunk.counts[digit] = offset;
+			offset += chunkCount;
+		}
+		if (offset - digitOffset == m_keys.size()) return;
+	}
+
+	ForEachChunk(parallel, m_sortChunks, [this, shift](SortChunk& chunk) {
+		for (auto index : std::views::iota(chunk.begin, chunk.end))
+		{
+			const UINT64 key = m_keys[index];
+			m_sortBuffer[chunk.counts[(key >> shift) & 0xFF]++] = key;
+		} });
+	std::swap(m_keys, m_sortBuffer);
+}
+
+//정렬한 순서대로 PSO와 버퍼가 바뀔 때만 넣는다. 인스턴스 주소는 그리기마다 달라서 매번 넣는다.
+void CRenderQueue::Submit(UINT pass, UINT instanceSlot, CCommandStream* stream)
+{
+	auto range = std::ranges::equal_range(m_keys, static_cast<UINT64>(pass), {}, [](UINT64 key) { return key >> gPassShift; });
+	RenderQueueStats& stats = m_stats[pass];
+	const RenderDraw* last{ nullptr };
+	for (auto key : range)
+	{
+		const RenderDraw& draw = m_draws[key & 0xFFFF];
+		if (last == nullptr || last->pso != draw.pso)
+		{
+			stream->SetPipelineState(draw.pso);
+			stats.bindCount++;
+		}
+		if (last == nullptr || last->geometry != draw.geometry)
+		{
+			stream->SetVertexBuffer(draw.vertexBuffer);
+			stream->SetIndexBuffer(draw.indexBuffer);
+			stream->SetPrimitiveTopology(draw.topology);
+			stats.bindCount += 3;
+		}
+
+		stream->SetRootShaderResource(instanceSlot, draw.instanceAddress);
+		stream->DrawIndexedInstanced(draw.indexCount, draw.instanceCount, draw.startIndex, draw.baseVertex, 0);
+		stats.drawCount++;
+		last = &draw;
+	}
+	stats.elidedBindCount = stats.drawCount * gBindsPerDraw - stats.bindCount;
+}
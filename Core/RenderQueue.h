@@ -0,0 +1,70 @@
+﻿#pragma once
+
+#include "./CommandStream.h"
+
+//그리기 하나에 필요한 값. 버퍼와 디스크립터는 스트림처럼 주소만 담는다.
+struct RenderDraw
+{
+	GraphicsPSO pso{};
+	UINT geometry{ 0u };		//정점, 인덱스 버퍼를 같이 쓰는 묶음 번호
+	CommandVertexBuffer vertexBuffer{};
+	CommandIndexBuffer indexBuffer{};
+	UINT topology{ 0u };
+	UINT64 instanceAddress{ 0 };
+	UINT indexCount{ 0u };
+	UINT instanceCount{ 0u };
+	UINT startIndex{ 0u };
+	int baseVertex{ 0 };
+};
+
+struct RenderQueueStats
+{
+	UINT drawCount{ 0u };
+	UINT bindCount{ 0u };
+	UINT elidedBindCount{ 0u };		//그릴 때마다 PSO와 버퍼를 다시 넣었다면 더 들었을 수
+};
+
+//키는 위에서부터 패스 4, PSO 8, 지오메트리 12, 깊이 24, 그리기 번호 16비트다.
+//바꾸는 비용이 큰 상태일수록 위에 두어서 정렬하면 같은 상태끼리 모이고, 같은 버퍼 안에서는 가까운 것부터 그린다.
+//깊이는 음수가 아닌 float의 비트 순서가 값 순서와 같아서 위쪽 24비트만 잘라 쓴다.
+class CRenderQueue
+{
+	struct SortChunk
+	{
+		size_t begin{ 0 };
+		size_t end{ 0 };
+		std::array<size_t, 256> counts{};
+	};
+
+public:
+	static constexpr UINT MaxPass{ 16u };
+	static constexpr UINT MaxDraw{ 1u << 16 };
+
+	CRenderQueue();
+	~CRenderQueue();
+
+	CRenderQueue(const CRenderQueue&) = delete;
+	CRenderQueue& operator=(const CRenderQueue&) = delete;
+
+	void Reset();
+	bool Add(UINT pass, float depth, const RenderDraw& draw);
+	void Sort();
+	void Submit(UINT pass, UINT instanceSlot, CCommandStream* stream);
+
+	static UINT64 MakeKey(UINT pass, GraphicsPSO pso, UINT geometry, float depth, UINT draw);
+	inline const std::vector<UINT64>& GetKeys() const;
+	inline const RenderQueueStats& GetStats(UINT pass) const;
+
+private:
+	void SortDigit(UINT shift);
+
+private:
+	std::vector<RenderDraw> m_draws;
+	std::vector<UINT64> m_keys;
+	std::vector<UINT64> m_sortBuffer;
+	std::vector<SortChunk> m_sortChunks;
+	std::array<RenderQueueStats, MaxPass> m_stats;		//패스마다 다른 스레드가 Submit해도 겹치지 않는다
+};
+
+inline const std::vector<UINT64>& CRenderQueue::GetKeys() const { return m_keys; }
+inline const RenderQueueStats& CRenderQueue::GetStats(UINT pass) const { return m_stats[pass]; }
@@ -49,15 +49,17 @@ bool CRenderer::Initialize(const std::wstring& resPath, HWND hwnd, int width, in
 	m_texture = std::make_unique<CTexture>(resPath);
 	m_draw = std::make_unique<CDraw>(m_directx3D.get());
 	m_ssaoMap = std::make_unique<CSsaoMap>(m_descHeap.get());
-	m_pso = std::make_unique<CPipelineStateObjects>(m_directx3D.get());
+	m_pso = std::make_unique<CPipelineStateObjects>(m_directx3D.get(), resPath);
 	m_frameResources = std::make_unique<CFrameResources>();
 	
 	ID3D12Device* device = m_directx3D->GetDevice();
-	ReturnIfFalse(m_rootSignature->Build(device));
 	ReturnIfFalse(m_pso->Build(m_rootSignature.get(), m_shader.get()));
-	ReturnIfFalse(m_frameResources->Build(device, gPassCBCount, gInstanceBufferCount, gMaterialBufferCount));
-	ReturnIfFalse(m_draw->Initialize(m_descHeap.get(), m_pso.get()));
+	ReturnIfFalse(m_frameResources->Build(device, gPassCBCount, gMaterialBufferCount));
 	ReturnIfFalse(m_ssaoMap->Initialize(m_directx3D.get(), width, height));
+	ReturnIfFalse(m_draw->Initialize(m_descHeap.get(), m_pso.get(), m_ssaoMap.get()));
+	ReturnIfFalse(m_draw->OnResize(width, height));
+	m_ssaoMap->RebuildDescriptors(m_directx3D->GetDepthStencilBufferResource());
+	ReturnIfFalse(m_texture->Initialize(m_directx3D.get()));
 
 	m_ssaoMap->SetPSOs(m_pso->GetPso(GraphicsPSO::SsaoMap), m_pso->GetPso(GraphicsPSO::SsaoBlur));
 
@@ -69,12 +71,13 @@ bool CRenderer::Initialize(const std::wstring& resPath, HWND hwnd, int width, in
 bool CRenderer::OnResize(int width, int height)
 {
 	ReturnIfFalse(m_directx3D->OnResize(width, height));
-	m_draw->OnResize(width, height);
 
 	if (m_ssaoMap == nullptr)
 		return true;
 
-	ReturnIfFalse(m_ssaoMap->OnResize(m_directx3D.get(), width, height));
+	//노멀맵과 ambient맵은 draw의 프레임 그래프가 새 크기로 다시 만든다.
+	m_ssaoMap->OnResize(width, height);
+	ReturnIfFalse(m_draw->OnResize(width, height));
 	m_ssaoMap->RebuildDescriptors(m_directx3D->GetDepthStencilBufferResource());
 	
 	return true;
@@ -109,7 +112,7 @@ bool CRenderer::LoadMesh(ID3D12Device* device, DirectX::ResourceUploadBatch& upl
 bool CRenderer::LoadMesh(GraphicsPSO pso, const void* verticesData, const void* indicesData, RenderItem* renderItem)
 {
 	if (m_pso->GetPso(pso) == nullptr)
-		return false;	//renderer PSO غ ʾҴ.
+		return false;	//renderer에서 PSO가 준비되지 않았다.
 
 	return m_directx3D->LoadData([&, this](ID3D12Device* device, DirectX::ResourceUploadBatch& uploadBatch)->bool {
 		return LoadMesh(device, uploadBatch, verticesData, indicesData, renderItem); });
@@ -117,11 +120,8 @@ bool CRenderer::LoadMesh(GraphicsPSO pso, const void* verticesData, const void*
 
 bool CRenderer::LoadTexture(const TextureList& textureList, std::vector<std::wstring>* srvFilename)
 {
-	ReturnIfFalse(m_directx3D->LoadData(
-		[this, &textureList](ID3D12Device* device, DirectX::ResourceUploadBatch& uploadBatch)->bool {
-			return (m_texture->Upload(device, uploadBatch, textureList)); }));
-
-	m_texture->CreateShaderResourceView(m_descHeap.get());
+	//srv 번호는 바로 정해지고, 다 올라갈 때까지는 placeholder 텍스쳐를 쓴다.
+	ReturnIfFalse(m_texture->Request(m_descHeap.get(), textureList));
 	(*srvFilename) = m_texture->GetListSrvTexture2D();
 
 	return true;
@@ -132,14 +132,49 @@ bool CRenderer::SetUploadBuffer(eBufferType bufferType, const void* bufferData,
 	return m_frameResources->SetUploadBuffer(bufferType, bufferData, dataSize);
 }
 
-bool CRenderer::PrepareFrame()
+bool CRenderer::MapUploadBuffer(eBufferType bufferType, size_t dataSize, void** outData)
 {
-	UINT64 fenceCount = m_frameResources->ForwardFrame();
-	if (fenceCount == 0) return true;
+	return m_frameResources->MapUploadBuffer(bufferType, dataSize, outData);
+}
+
+bool CRenderer::UpdateUploadBuffer(eBufferType bufferType, const void* bufferData, const UINT64* versions, size_t dataSize)
+{
+	return m_frameResources->UpdateUploadBuffer(bufferType, bufferData, versions, dataSize);
+}
 
-	ReturnIfFalse(WaitUntilGpuFinished(fenceCount));
+UINT64 CRenderer::GetUploadedBytes()
+{
+	return m_frameResources->GetUploadedBytes();
+}
 
-	return true;
+void CRenderer::AddTextureRefs(const std::vector<UINT>& srvIndices)
+{
+	m_texture->AddRef(srvIndices);
+}
+
+void CRenderer::ReleaseTextureRefs(const std::vector<UINT>& srvIndices)
+{
+	m_texture->Release(srvIndices);
+}
+
+void CRenderer::UseTextures(const std::vector<UINT>& srvIndices)
+{
+	m_texture->Use(srvIndices);
+}
+
+bool CRenderer::PrepareFrame()
+{
+	UINT64 fenceCount = m_frameResources->ForwardFrame();
+	if (fenceCount != 0)
+	{
+		ReturnIfFalse(WaitUntilGpuFinished(fenceCount));
+		m_frameResources->Recycle(fenceCount);
+		m_descHeap->Recycle(fenceCount);
+	}
+
+	//읽기를 마친 텍스쳐를 올리고, 다 올라간 텍스쳐는 srv를 바꾼다.
+	//GPU가 앞 프레임을 끝낸 뒤라서 예산을 넘어 내린 텍스쳐도 여기서 지운다.
+	return m_texture->Update(m_directx3D.get(), m_descHeap.get());
 }
 
 bool CRenderer::Draw(AllRenderItems& renderItem)
@@ -147,7 +182,6 @@ bool CRenderer::Draw(AllRenderItems& renderItem)
 	return m_draw->Excute(
 		m_rootSignature.get(),
 		m_frameResources.get(), 
-		m_ssaoMap.get(), 
 		renderItem);
 }
 
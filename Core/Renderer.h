@@ -25,6 +25,12 @@ public:
 	virtual bool LoadMesh(GraphicsPSO pso, const void* verticesData, const void* indicesData, RenderItem* renderItem) override;
 	virtual bool LoadTexture(const TextureList& textureList, std::vector<std::wstring>* srvFilename) override;
 	virtual bool SetUploadBuffer(eBufferType bufferType, const void* bufferData, size_t dataSize) override;
+	virtual bool MapUploadBuffer(eBufferType bufferType, size_t dataSize, void** outData) override;
+	virtual bool UpdateUploadBuffer(eBufferType bufferType, const void* bufferData, const UINT64* versions, size_t dataSize) override;
+	virtual UINT64 GetUploadedBytes() override;
+	virtual void AddTextureRefs(const std::vector<UINT>& srvIndices) override;
+	virtual void ReleaseTextureRefs(const std::vector<UINT>& srvIndices) override;
+	virtual void UseTextures(const std::vector<UINT>& srvIndices) override;
 	virtual bool PrepareFrame() override;
 	virtual bool Draw(AllRenderItems& renderItem) override;
 	virtual void Set4xMsaaState(HWND hwnd, int widht, int height, bool value) override;
@@ -35,11 +35,11 @@ bool CRootSignature::BuildMain(ID3D12Device* device)
 	shadowTexTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, ShadowCount, 0, 0); //t0
 	ssaoTexTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, SsaoAmbientMap0Count, 1, 0); //t1
 	cubeTexTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, CubeCount, 2, 0);	//t2
-	texTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, TextureCount, 3, 0);	//t3...t10(°)
+	texTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 3, 0);	//t3...(크기가 정해지지 않은 배열. 텍스쳐 구간이 늘어나도 그대로 쓴다)
 
 	std::vector<CD3DX12_ROOT_PARAMETER> rp{};
 	GetRootParameter(rp, Pass)->InitAsConstantBufferView(0);
-	GetRootParameter(rp, Bone)->InitAsConstantBufferView(1);
+	GetRootParameter(rp, Bone)->InitAsShaderResourceView(2, 1);
 	GetRootParameter(rp, Material)->InitAsShaderResourceView(0, 1);
 	GetRootParameter(rp, Instance)->InitAsShaderResourceView(1, 1);
 	GetRootParameter(rp, Shadow)->InitAsDescriptorTable(1, &shadowTexTable, D3D12_SHADER_VISIBILITY_PIXEL);
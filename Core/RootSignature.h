@@ -1,10 +1,6 @@
 #pragma once
 
-enum class RootSignature : int
-{
-	Common = 0,
-	Ssao,
-};
+#include "../Include/Types.h"
 
 class CRootSignature
 {
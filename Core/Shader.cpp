@@ -1,18 +1,60 @@
 #include "pch.h"
 #include "Shader.h"
 #include "../Core/d3dUtil.h"
+#include "./ShaderCache.h"
 #include "../Include/RendererDefine.h"
 #include "../Include/Types.h"
 
 using Microsoft::WRL::ComPtr;
 using enum ShaderType;
 
+bool IsSkinned(GraphicsPSO psoType)
+{
+	switch (psoType)
+	{
+	case GraphicsPSO::SkinnedOpaque:
+	case GraphicsPSO::SkinnedDrawNormals:	
+	case GraphicsPSO::SkinnedShadowOpaque:
+		return true;
+	}
+	return false;
+}
+
+std::vector<D3D12_INPUT_ELEMENT_DESC> GetLayout(GraphicsPSO psoType)
+{
+	std::vector<D3D12_INPUT_ELEMENT_DESC> layout =
+	{
+		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 32, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+	};
+
+	if(IsSkinned(psoType))
+	{
+		layout.emplace_back(D3D12_INPUT_ELEMENT_DESC("WEIGHTS", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 44, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0));
+		layout.emplace_back(D3D12_INPUT_ELEMENT_DESC("BONEINDICES", 0, DXGI_FORMAT_R8G8B8A8_UINT, 0, 56, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0));
+	}
+
+	return layout; 
+}
+
+//PSO마다 여러 스레드가 컴파일하므로 map의 원소는 미리 다 만들어 두고 나중에는 값만 바꾼다.
 CShader::CShader(const std::wstring& resPath, const ShaderFileList& shaderFileList)
 	: m_resPath(resPath)
+	, m_includeCache{ std::make_unique<CIncludeCache>() }
+	, m_shaderCache{ std::make_unique<CShaderCache>(resPath + L"ShaderCache/") }
 	, m_shaderFileList(shaderFileList)
 	, m_shaderList{}
-	, m_inputLayout{}
-{}
+	, m_inputLayouts{}
+{
+	for (auto& [psoType, fileList] : m_shaderFileList)
+	{
+		for (auto& file : fileList)
+			m_shaderList[psoType][file.first] = nullptr;
+		m_inputLayouts[psoType] = GetLayout(psoType);
+	}
+}
 CShader::~CShader() = default;
 
 bool CShader::IsShadowMap()
@@ -28,6 +70,18 @@ std::vector<GraphicsPSO> CShader::GetPSOList()
 	return psoList;
 }
 
+std::vector<ShaderType> CShader::GetShaderTypes(GraphicsPSO psoType)
+{
+	std::vector<ShaderType> shaderTypes{};
+	auto findPso = m_shaderFileList.find(psoType);
+	if (findPso == m_shaderFileList.end()) return shaderTypes;
+
+	for (auto& [shaderType, filename] : findPso->second)
+		if (!filename.empty()) shaderTypes.emplace_back(shaderType);
+
+	return shaderTypes;
+}
+
 std::string GetShaderVersion(ShaderType shaderType)
 {
 	switch (shaderType)
@@ -39,28 +93,49 @@ std::string GetShaderVersion(ShaderType shaderType)
 	return "";
 }
 
-bool CShader::InsertShaderList(GraphicsPSO psoType, ShaderType shaderType, std::wstring&& filename)
+//캐시에서 읽으면 컴파일하지 않는다. 읽지 못하면 컴파일하고, 캐시에 쓰지 못해도 컴파일한 결과는 쓴다.
+bool CShader::CompileShader(GraphicsPSO psoType, ShaderType shaderType)
 {
-	Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob{ nullptr };
+	ShaderCompileDesc desc{ GetShaderFilename(psoType, shaderType), nullptr, "main", GetShaderVersion(shaderType), CoreUtil::GetShaderCompileFlags() };
+	UINT64 key{ 0 };
+	ReturnIfFalse(m_shaderCache->MakeKey(m_includeCache.get(), desc, &key));
 
-	ReturnIfFalse(CoreUtil::CompileShader(
-		std::move(filename), nullptr, "main", GetShaderVersion(shaderType),
-		&shaderBlob));
+	Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob = m_shaderCache->Load(key);
+	if (shaderBlob == nullptr)
+	{
+		ReturnIfFalse(CoreUtil::CompileShader(
+			desc.filename, desc.defines, desc.entrypoint, desc.target,
+			m_includeCache.get(), &shaderBlob));
+		m_shaderCache->Store(key, shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize());
+	}
 
-	m_shaderList[psoType][shaderType] = std::move(shaderBlob);
+	m_shaderList.at(psoType).at(shaderType) = std::move(shaderBlob);
 
 	return true;
 }
 
 inline D3D12_SHADER_BYTECODE CShader::GetShaderBytecode(GraphicsPSO psoType, ShaderType shaderType) 
 {
-	const auto& shader = m_shaderList[psoType][shaderType];
+	const auto& shader = m_shaderList.at(psoType).at(shaderType);
 	return { shader->GetBufferPointer(), shader->GetBufferSize() };
 }
 
+bool CShader::IsCompiled(GraphicsPSO psoType, ShaderType shaderType)
+{
+	auto findPso = m_shaderList.find(psoType);
+	if (findPso == m_shaderList.end()) return false;
+
+	auto findShader = findPso->second.find(shaderType);
+	return findShader != findPso->second.end() && findShader->second != nullptr;
+}
+
+//작업 스레드에서 동시에 부르므로 operator[]로 맵에 넣지 않고 찾기만 한다.
 std::wstring CShader::GetShaderFilename(GraphicsPSO psoType, ShaderType shaderType)
 {
-	const auto& psoFileList = m_shaderFileList[psoType];
+	auto findPso = m_shaderFileList.find(psoType);
+	if (findPso == m_shaderFileList.end()) return {};
+
+	const auto& psoFileList = findPso->second;
 	auto find = std::ranges::find_if(psoFileList, [shaderType](auto& file) {
 		return file.first == shaderType; });
 	if (find == psoFileList.end()) return {};
@@ -68,54 +143,24 @@ std::wstring CShader::GetShaderFilename(GraphicsPSO psoType, ShaderType shaderTy
 	return m_resPath + m_filePath + find->second;
 }
 
-bool IsSkinned(GraphicsPSO psoType)
-{
-	switch (psoType)
-	{
-	case GraphicsPSO::SkinnedOpaque:
-	case GraphicsPSO::SkinnedDrawNormals:	
-	case GraphicsPSO::SkinnedShadowOpaque:
-		return true;
-	}
-	return false;
-}
-
-std::vector<D3D12_INPUT_ELEMENT_DESC> GetLayout(GraphicsPSO psoType)
-{
-	std::vector<D3D12_INPUT_ELEMENT_DESC> layout =
-	{
-		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 32, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
-	};
-
-	if(IsSkinned(psoType))
-	{
-		layout.emplace_back(D3D12_INPUT_ELEMENT_DESC("WEIGHTS", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 44, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0));
-		layout.emplace_back(D3D12_INPUT_ELEMENT_DESC("BONEINDICES", 0, DXGI_FORMAT_R8G8B8A8_UINT, 0, 56, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0));
-	}
-
-	return layout; 
-}
-
 bool CShader::SetPipelineStateDesc(GraphicsPSO psoType, D3D12_GRAPHICS_PIPELINE_STATE_DESC* inoutDesc)
 {
-	auto count = std::ranges::count_if(m_shaderFileList[psoType], [](auto& fileList) {
+	auto findPso = m_shaderFileList.find(psoType);
+	if (findPso == m_shaderFileList.end()) return false;
+
+	auto count = std::ranges::count_if(findPso->second, [](auto& fileList) {
 		auto isVS = fileList.first == VS && !fileList.second.empty();
 		auto isPS = fileList.first == PS && !fileList.second.empty();
 		return isVS || isPS; });
 
-	if (count < 2) return false;	//vs, ps   pipeline  ʴ´.
-
-	ReturnIfFalse(InsertShaderList(psoType, VS, GetShaderFilename(psoType, VS)));
-	ReturnIfFalse(InsertShaderList(psoType, PS, GetShaderFilename(psoType, PS)));
+	if (count < 2) return false;	//vs, ps가 없는 경우는 pipeline을 만들지 않는다.
 
-	m_inputLayout = GetLayout(psoType);
+	if (!IsCompiled(psoType, VS) || !IsCompiled(psoType, PS)) return false;	//CompileShader가 먼저 끝나야 한다
 
+	const auto& inputLayout = m_inputLayouts.at(psoType);
 	inoutDesc->VS = GetShaderBytecode(psoType, VS);
 	inoutDesc->PS = GetShaderBytecode(psoType, PS);
-	inoutDesc->InputLayout = { m_inputLayout.data(), static_cast<UINT>(m_inputLayout.size()) };
+	inoutDesc->InputLayout = { inputLayout.data(), static_cast<UINT>(inputLayout.size()) };
 
 	return true;
 }
\ No newline at end of file
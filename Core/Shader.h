@@ -2,6 +2,8 @@
 
 enum class GraphicsPSO : int;
 enum class ShaderType : int;
+class CIncludeCache;
+class CShaderCache;
 
 class CShader
 {
@@ -17,10 +19,12 @@ public:
 
 	bool IsShadowMap();
 	std::vector<GraphicsPSO> GetPSOList();
+	std::vector<ShaderType> GetShaderTypes(GraphicsPSO psoType);
+	bool CompileShader(GraphicsPSO psoType, ShaderType shaderType);
 	bool SetPipelineStateDesc(GraphicsPSO psoType, D3D12_GRAPHICS_PIPELINE_STATE_DESC* inoutDesc);
 
 private:
-	bool InsertShaderList(GraphicsPSO psoType, ShaderType shaderType, std::wstring&& filename);
+	bool IsCompiled(GraphicsPSO psoType, ShaderType shaderType);
 	inline D3D12_SHADER_BYTECODE GetShaderBytecode(GraphicsPSO psoType, ShaderType shaderType);
 	std::wstring GetShaderFilename(GraphicsPSO psoType, ShaderType shaderType);
 
@@ -29,8 +33,10 @@ private:
 
 	std::wstring m_resPath{};
 	std::wstring m_filePath{ L"Shaders/" };
+	std::unique_ptr<CIncludeCache> m_includeCache;
+	std::unique_ptr<CShaderCache> m_shaderCache;
 
 	ShaderFileList m_shaderFileList;
 	std::map<GraphicsPSO, ShaderList> m_shaderList;
-	std::vector<D3D12_INPUT_ELEMENT_DESC> m_inputLayout;
+	std::map<GraphicsPSO, std::vector<D3D12_INPUT_ELEMENT_DESC>> m_inputLayouts;
 };
\ No newline at end of file
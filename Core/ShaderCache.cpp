@@ -0,0 +1,184 @@
+﻿#include "pch.h"
+#include "./ShaderCache.h"
+#include "./d3dUtil.h"
+#include <filesystem>
+#include <thread>
+
+constexpr UINT gShaderCacheVersion{ 1u };	//바이트코드 파일 형식이 바뀌면 올려서 예전 캐시를 쓰지 않게 한다
+constexpr UINT gMaxIncludeDepth{ 32u };
+constexpr UINT64 gFnvPrime{ 1099511628211ull };
+
+CIncludeCache::CIncludeCache()
+	: m_files{}
+	, m_fileReadCount{ 0u }
+{}
+CIncludeCache::~CIncludeCache() = default;
+
+//"../Register.hlsli"처럼 돌아가는 경로도 같은 파일이면 한번만 읽는다.
+const std::string* CIncludeCache::Read(const std::wstring& filename)
+{
+	const std::wstring normalName = std::filesystem::path(filename).lexically_normal().wstring();
+
+	std::lock_guard lock(m_mutex);
+	auto find = m_files.find(normalName);
+	if (find != m_files.end()) return &find->second;
+
+	std::ifstream fin(normalName, std::ios::binary);
+	if (fin.fail()) return nullptr;
+
+	std::string contents((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+	m_fileReadCount++;
+
+	return &m_files.emplace(normalName, std::move(contents)).first->second;
+}
+
+UINT CIncludeCache::GetFileReadCount()
+{
+	std::lock_guard lock(m_mutex);
+	return m_fileReadCount;
+}
+
+//해시에 쓸 소스. #include 줄을 그 파일 내용으로 바꾼다. 경로는 include하는 파일의 폴더 기준이다.
+bool CIncludeCache::ExpandIncludes(const std::wstring& filename, std::string* outSource)
+{
+	outSource->clear();
+	return Expand(filename, 0, outSource);
+}
+
+bool CIncludeCache::Expand(const std::wstring& filename, UINT depth, std::string* outSource)
+{
+	if (depth > gMaxIncludeDepth) return false;
+
+	const std::string* source = Read(filename);
+	if (source == nullptr) return false;
+
+	const std::filesystem::path directory = std::filesystem::path(filename).parent_path();
+	std::string_view remain{ *source };
+	while (!remain.empty())
+	{
+		const size_t lineEnd = remain.find('\n');
+		const std::string_view line = remain.substr(0, lineEnd);
+		remain = (lineEnd == std::string_view::npos) ? std::string_view{} : remain.substr(lineEnd + 1);
+
+		const size_t begin = line.find_first_not_of(" \t");
+		const bool isInclude = (begin != std::string_view::npos) && line.substr(begin).starts_with("#include");
+		const size_t nameBegin = isInclude ? line.find_first_of("\"<", begin) : std::string_view::npos;
+		const size_t nameEnd = (nameBegin != std::string_view::npos) ? line.find_first_of("\">", nameBegin + 1) : std::string_view::npos;
+		if (nameEnd == std::string_view::npos)
+		{
+			outSource->append(line);
+			outSource->push_back('\n');
+			continue;
+		}
+
+		const std::string_view includeName = line.substr(nameBegin + 1, nameEnd - nameBegin - 1);
+		if (!Expand((directory / includeName).wstring(), depth + 1, outSource)) return false;
+	}
+
+	return true;
+}
+
+UINT64 HashBytes(const void* data, size_t size, UINT64 hash)
+{
+	const BYTE* bytes = static_cast<const BYTE*>(data);
+	for (auto i : std::views::iota(size_t{ 0 }, size))
+		hash = (hash ^ bytes[i]) * gFnvPrime;
+
+	return hash;
+}
+
+//끝의 0까지 넣어서 "ab" + "c"와 "a" + "bc"가 다르게 나온다.
+UINT64 HashString(const char* str, UINT64 hash)
+{
+	return (str == nullptr) ? HashBytes("", 1, hash) : HashBytes(str, std::strlen(str) + 1, hash);
+}
+
+//파일 이름이나 라이브러리 이름으로 쓰는 16자리 hex
+std::wstring GetHashName(UINT64 key)
+{
+	constexpr wchar_t hexDigits[]{ L"0123456789abcdef" };
+	std::wstring name(16, L'0');
+	for (auto i : std::views::iota(0u, 16u))
+		name[15 - i] = hexDigits[(key >> (i * 4)) & 0xf];
+
+	return name;
+}
+
+CShaderCache::CShaderCache(std::wstring directory)
+	: m_directory{ std::move(directory) }
+	, m_hitCount{ 0u }
+	, m_missCount{ 0u }
+	, m_storeCount{ 0u }
+{}
+CShaderCache::~CShaderCache() = default;
+
+bool CShaderCache::MakeKey(CIncludeCache* includeCache, const ShaderCompileDesc& desc, UINT64* outKey)
+{
+	std::string source{};
+	if (!includeCache->ExpandIncludes(desc.filename, &source)) return false;
+
+	UINT64 hash = HashBytes(&gShaderCacheVersion, sizeof(gShaderCacheVersion), gFnvOffsetBasis);
+	hash = HashBytes(source.data(), source.size(), hash);
+	for (auto define = desc.defines; define != nullptr && define->Name != nullptr; ++define)
+	{
+		hash = HashString(define->Name, hash);
+		hash = HashString(define->Definition, hash);
+	}
+	hash = HashString(desc.entrypoint.c_str(), hash);
+	hash = HashString(desc.target.c_str(), hash);
+	(*outKey) = HashBytes(&desc.flags, sizeof(desc.flags), hash);
+
+	return true;
+}
+
+std::wstring CShaderCache::GetFilename(UINT64 key) const
+{
+	return m_directory + GetHashName(key) + L".cso";
+}
+
+//파일이 없거나 다 읽지 못하면 없는 것으로 세고, 부르는 쪽이 다시 컴파일한다.
+Microsoft::WRL::ComPtr<ID3DBlob> CShaderCache::Load(UINT64 key)
+{
+	const std::wstring filename = GetFilename(key);
+	std::error_code ec{};
+	Microsoft::WRL::ComPtr<ID3DBlob> blob{ nullptr };
+	if (std::filesystem::exists(filename, ec))
+		blob = CoreUtil::LoadBinary(filename);
+
+	if (blob == nullptr)
+	{
+		m_missCount++;
+		return nullptr;
+	}
+
+	m_hitCount++;
+	return blob;
+}
+
+//다른 스레드나 다음 실행이 쓰다 만 파일을 읽지 않도록 임시 파일에 다 쓴 뒤 이름을 바꾼다.
+bool CShaderCache::Store(UINT64 key, const void* data, size_t size)
+{
+	std::error_code ec{};
+	std::filesystem::create_directories(m_directory, ec);
+	if (ec) return false;
+
+	const std::wstring filename = GetFilename(key);
+	const std::wstring tempFilename = filename + L"." + std::to_wstring(std::hash<std::thread::id>{}(std::this_thread::get_id())) + L".tmp";
+	{
+		std::ofstream fout(tempFilename, std::ios::binary | std::ios::trunc);
+		if (fout.fail()) return false;
+
+		fout.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+		if (fout.fail()) return false;
+	}
+
+	std::filesystem::rename(tempFilename, filename, ec);
+	if (ec)
+	{
+		std::filesystem::remove(tempFilename, ec);
+		return false;
+	}
+
+	m_storeCount++;
+	return true;
+}
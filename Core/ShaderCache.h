@@ -0,0 +1,74 @@
+﻿#pragma once
+
+#include <mutex>
+
+//include 파일은 한번만 읽어서 이번 실행의 모든 컴파일이 같이 쓴다. 여러 스레드에서 불러도 된다.
+class CIncludeCache
+{
+public:
+	CIncludeCache();
+	~CIncludeCache();
+
+	CIncludeCache(const CIncludeCache&) = delete;
+	CIncludeCache& operator=(const CIncludeCache&) = delete;
+
+	const std::string* Read(const std::wstring& filename);
+	bool ExpandIncludes(const std::wstring& filename, std::string* outSource);
+	UINT GetFileReadCount();
+
+private:
+	bool Expand(const std::wstring& filename, UINT depth, std::string* outSource);
+
+private:
+	std::mutex m_mutex;
+	std::unordered_map<std::wstring, std::string> m_files;	//원소 주소는 rehash해도 그대로라서 포인터로 돌려준다
+	UINT m_fileReadCount;
+};
+
+//값이 다르면 다른 바이트코드가 나오는 것들
+struct ShaderCompileDesc
+{
+	std::wstring filename{};
+	const D3D_SHADER_MACRO* defines{ nullptr };
+	std::string entrypoint{};
+	std::string target{};
+	UINT flags{ 0u };
+};
+
+constexpr UINT64 gFnvOffsetBasis{ 14695981039346656037ull };	//HashBytes에 처음 넣는 값
+
+UINT64 HashBytes(const void* data, size_t size, UINT64 hash);
+UINT64 HashString(const char* str, UINT64 hash);
+std::wstring GetHashName(UINT64 key);
+
+//include를 모두 펼친 소스, define, 진입점, 타겟, 플래그의 해시를 이름으로 바이트코드를 파일에 둔다.
+//찾으면 컴파일하지 않고 파일을 읽는다. 파일을 읽고 쓰는 것만 해서 장치 없이 돌릴 수 있다.
+class CShaderCache
+{
+public:
+	CShaderCache(std::wstring directory);
+	~CShaderCache();
+
+	CShaderCache() = delete;
+	CShaderCache(const CShaderCache&) = delete;
+	CShaderCache& operator=(const CShaderCache&) = delete;
+
+	bool MakeKey(CIncludeCache* includeCache, const ShaderCompileDesc& desc, UINT64* outKey);
+	Microsoft::WRL::ComPtr<ID3DBlob> Load(UINT64 key);
+	bool Store(UINT64 key, const void* data, size_t size);
+	std::wstring GetFilename(UINT64 key) const;
+
+	inline UINT GetHitCount() const;
+	inline UINT GetMissCount() const;
+	inline UINT GetStoreCount() const;
+
+private:
+	std::wstring m_directory;
+	std::atomic<UINT> m_hitCount;
+	std::atomic<UINT> m_missCount;
+	std::atomic<UINT> m_storeCount;
+};
+
+inline UINT CShaderCache::GetHitCount() const { return m_hitCount.load(); }
+inline UINT CShaderCache::GetMissCount() const { return m_missCount.load(); }
+inline UINT CShaderCache::GetStoreCount() const { return m_storeCount.load(); }
@@ -1,4 +1,4 @@
-#include "pch.h"
+﻿#include "pch.h"
 #include "./SsaoMap.h"
 #include "../Include/FrameResourceData.h"
 #include "../Include/types.h"
@@ -7,6 +7,7 @@
 #include "./FrameResources.h"
 #include "./DescriptorHeap.h"
 #include "./CoreDefine.h"
+#include "./FrameGraph.h"
 
 using namespace DirectX;
 using namespace DirectX::PackedVector;
@@ -26,21 +27,27 @@ CSsaoMap::CSsaoMap(CDescriptorHeap* descHeap)
 
 bool CSsaoMap::Initialize(CDirectx3D* directx3D, UINT width, UINT height)
 {
-	ReturnIfFalse(OnResize(directx3D, width, height));
+	OnResize(width, height);
 	ReturnIfFalse(BuildRandomVectorTexture(directx3D));
-	RebuildDescriptors(directx3D->GetDepthStencilBufferResource());
 
 	return true;
 }
 
-ID3D12Resource* CSsaoMap::NormalMap()
+FrameTextureDesc CSsaoMap::GetNormalMapDesc() const
 {
-	return m_normalMap.Get();
+	return FrameTextureDesc{ m_renderTargetWidth, m_renderTargetHeight, NormalMapFormat, false, { 0.0f, 0.0f, 1.0f, 0.0f } };
 }
 
-ID3D12Resource* CSsaoMap::AmbientMap()
+FrameTextureDesc CSsaoMap::GetAmbientMapDesc() const
 {
-	return m_ambientMap0.Get();
+	return FrameTextureDesc{ m_renderTargetWidth / 2, m_renderTargetHeight / 2, AmbientMapFormat, false, { 1.0f, 1.0f, 1.0f, 1.0f } };
+}
+
+void CSsaoMap::SetMaps(ID3D12Resource* normalMap, ID3D12Resource* ambientMap0, ID3D12Resource* ambientMap1)
+{
+	m_normalMap = normalMap;
+	m_ambientMap0 = ambientMap0;
+	m_ambientMap1 = ambientMap1;
 }
 
 void CSsaoMap::RebuildDescriptors(ID3D12Resource* depthStencilBuffer)
@@ -51,7 +58,7 @@ void CSsaoMap::RebuildDescriptors(ID3D12Resource* depthStencilBuffer)
 	srvDesc.Format = NormalMapFormat;
 	srvDesc.Texture2D.MostDetailedMip = 0;
 	srvDesc.Texture2D.MipLevels = 1;
-	m_descHeap->CreateShaderResourceView(SrvOffset::SsaoNormalMap, 0, &srvDesc, m_normalMap.Get());
+	m_descHeap->CreateShaderResourceView(SrvOffset::SsaoNormalMap, 0, &srvDesc, m_normalMap);
 
 	srvDesc.Format = DXGI_FORMAT_R24_UNORM_X8_TYPELESS;
 	m_descHeap->CreateShaderResourceView(SrvOffset::SsaoDepthMap, 0, &srvDesc, depthStencilBuffer);
@@ -60,8 +67,8 @@ void CSsaoMap::RebuildDescriptors(ID3D12Resource* depthStencilBuffer)
 	m_descHeap->CreateShaderResourceView(SrvOffset::SsaoRandomVectorMap, 0, &srvDesc, m_randomVectorMap.Get());
 
 	srvDesc.Format = AmbientMapFormat;
-	m_descHeap->CreateShaderResourceView(SrvOffset::SsaoAmbientMap0, 0, &srvDesc, m_ambientMap0.Get());
-	m_descHeap->CreateShaderResourceView(SrvOffset::SsaoAmbientMap1, 0, &srvDesc, m_ambientMap1.Get());
+	m_descHeap->CreateShaderResourceView(SrvOffset::SsaoAmbientMap0, 0, &srvDesc, m_ambientMap0);
+	m_descHeap->CreateShaderResourceView(SrvOffset::SsaoAmbientMap1, 0, &srvDesc, m_ambientMap1);
 
 	D3D12_RENDER_TARGET_VIEW_DESC rtvDesc{};
 	rtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
@@ -69,11 +76,11 @@ void CSsaoMap::RebuildDescriptors(ID3D12Resource* depthStencilBuffer)
 	rtvDesc.Texture2D.MipSlice = 0;
 	rtvDesc.Texture2D.PlaneSlice = 0;
 
-	m_descHeap->CreateRenderTargetView(RtvOffset::NormalMap, &rtvDesc, m_normalMap.Get());
+	m_descHeap->CreateRenderTargetView(RtvOffset::NormalMap, &rtvDesc, m_normalMap);
 
 	rtvDesc.Format = AmbientMapFormat;
-	m_descHeap->CreateRenderTargetView(RtvOffset::AmbientMap0, &rtvDesc, m_ambientMap0.Get());
-	m_descHeap->CreateRenderTargetView(RtvOffset::AmbientMap1, &rtvDesc, m_ambientMap1.Get());
+	m_descHeap->CreateRenderTargetView(RtvOffset::AmbientMap0, &rtvDesc, m_ambientMap0);
+	m_descHeap->CreateRenderTargetView(RtvOffset::AmbientMap1, &rtvDesc, m_ambientMap1);
 }
 
 void CSsaoMap::SetPSOs(ID3D12PipelineState* ssaoPso, ID3D12PipelineState* ssaoBlurPso)
@@ -82,11 +89,8 @@ void CSsaoMap::SetPSOs(ID3D12PipelineState* ssaoPso, ID3D12PipelineState* ssaoBl
 	m_blurPso = ssaoBlurPso;
 }
 
-bool CSsaoMap::OnResize(CDirectx3D* directx3D, UINT newWidth, UINT newHeight)
+void CSsaoMap::OnResize(UINT newWidth, UINT newHeight)
 {
-	if (m_renderTargetWidth == newWidth && m_renderTargetHeight == newHeight)
-		return true;
-	
 	m_renderTargetWidth = newWidth;
 	m_renderTargetHeight = newHeight;
 
@@ -98,27 +102,19 @@ bool CSsaoMap::OnResize(CDirectx3D* directx3D, UINT newWidth, UINT newHeight)
 	m_viewport.MaxDepth = 1.0f;
 
 	m_scissorRect = { 0, 0, static_cast<int>(m_renderTargetWidth / 2), static_cast<int>(m_renderTargetHeight / 2) };
-
-	return BuildResources(directx3D);
 }
 
-void CSsaoMap::ComputeSsao(
-	ID3D12GraphicsCommandList* cmdList,
-	CFrameResources* currFrame,
-	int blurCount)
+void CSsaoMap::ComputeSsao(ID3D12GraphicsCommandList* cmdList, CFrameResources* currFrame)
 {
 	cmdList->RSSetViewports(1, &m_viewport);
 	cmdList->RSSetScissorRects(1, &m_scissorRect);
 
-	cmdList->ResourceBarrier(1, &RvToLv(CD3DX12_RESOURCE_BARRIER::Transition(m_ambientMap0.Get(),
-		D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET)));
-
 	D3D12_CPU_DESCRIPTOR_HANDLE ambientMap0Rtv = m_descHeap->GetCpuRtvHandle(RtvOffset::AmbientMap0);
 	float clearValue[] = { 1.0f, 1.0f, 1.0f, 1.0f };
 	cmdList->ClearRenderTargetView(ambientMap0Rtv, clearValue, 0, nullptr);
 	cmdList->OMSetRenderTargets(1, &ambientMap0Rtv, true, nullptr);
 
-	auto ssaoCBAddress = currFrame->GetResource(eBufferType::SsaoCB)->GetGPUVirtualAddress();
+	auto ssaoCBAddress = currFrame->GetGpuAddress(eBufferType::SsaoCB);
 	cmdList->SetGraphicsRootConstantBufferView(EtoV(SsaoRegisterType::Pass), ssaoCBAddress);
 	cmdList->SetGraphicsRoot32BitConstant(EtoV(SsaoRegisterType::Constants), 0, 0);
 
@@ -132,127 +128,46 @@ void CSsaoMap::ComputeSsao(
 	cmdList->IASetIndexBuffer(nullptr);
 	cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	cmdList->DrawInstanced(6, 1, 0, 0);
-
-	cmdList->ResourceBarrier(1, &RvToLv(CD3DX12_RESOURCE_BARRIER::Transition(m_ambientMap0.Get(),
-		D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ)));
-
-	BlurAmbientMap(cmdList, currFrame, blurCount);
 }
 
-void CSsaoMap::BlurAmbientMap(ID3D12GraphicsCommandList* cmdList, CFrameResources* currFrame, int blurCount)
+//가로, 세로 한번씩이 한 벌이다. 프레임 그래프가 패스마다 따로 부르고 barrier도 건다.
+void CSsaoMap::BlurAmbientMap(ID3D12GraphicsCommandList* cmdList, CFrameResources* currFrame, bool horzBlur)
 {
+	cmdList->RSSetViewports(1, &m_viewport);
+	cmdList->RSSetScissorRects(1, &m_scissorRect);
 	cmdList->SetPipelineState(m_blurPso);
 
-	auto ssaoCBAddress = currFrame->GetResource(eBufferType::SsaoCB)->GetGPUVirtualAddress();
-	cmdList->SetGraphicsRootConstantBufferView(0, ssaoCBAddress);
-
-	for (auto i : std::views::iota(0, blurCount))
-	{
-		BlurAmbientMap(cmdList, true);
-		BlurAmbientMap(cmdList, false);
-	}
-}
+	auto ssaoCBAddress = currFrame->GetGpuAddress(eBufferType::SsaoCB);
+	cmdList->SetGraphicsRootConstantBufferView(EtoV(SsaoRegisterType::Pass), ssaoCBAddress);
 
-void CSsaoMap::BlurAmbientMap(ID3D12GraphicsCommandList* cmdList, bool horzBlur)
-{
-	ID3D12Resource* output = nullptr;
 	CD3DX12_GPU_DESCRIPTOR_HANDLE inputSrv{};
 	CD3DX12_CPU_DESCRIPTOR_HANDLE outputRtv{};
 
 	if (horzBlur == true)
 	{
-		output = m_ambientMap1.Get();
 		inputSrv = m_descHeap->GetGpuSrvHandle(SrvOffset::SsaoAmbientMap0);
 		outputRtv = m_descHeap->GetCpuRtvHandle(RtvOffset::AmbientMap1);
 		cmdList->SetGraphicsRoot32BitConstant(EtoV(SsaoRegisterType::Constants), 1, 0);
 	}
 	else
 	{
-		output = m_ambientMap0.Get();
 		inputSrv = m_descHeap->GetGpuSrvHandle(SrvOffset::SsaoAmbientMap1);
 		outputRtv = m_descHeap->GetCpuRtvHandle(RtvOffset::AmbientMap0);
 		cmdList->SetGraphicsRoot32BitConstant(EtoV(SsaoRegisterType::Constants), 0, 0);
 	}
 
-	cmdList->ResourceBarrier(1, &RvToLv(CD3DX12_RESOURCE_BARRIER::Transition(output,
-		D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET)));
-
 	float clearValue[] = { 1.0f, 1.0f, 1.0f, 1.0f };
 	cmdList->ClearRenderTargetView(outputRtv, clearValue, 0, nullptr);
 	cmdList->OMSetRenderTargets(1, &outputRtv, true, nullptr);
 
 	cmdList->SetGraphicsRootDescriptorTable(EtoV(SsaoRegisterType::Normal), m_descHeap->GetGpuSrvHandle(SrvOffset::SsaoNormalMap));
+	cmdList->SetGraphicsRootDescriptorTable(EtoV(SsaoRegisterType::Depth), m_descHeap->GetGpuSrvHandle(SrvOffset::SsaoDepthMap));
 	cmdList->SetGraphicsRootDescriptorTable(EtoV(SsaoRegisterType::SsaoAmbientMap0), inputSrv);
 
 	cmdList->IASetVertexBuffers(0, 0, nullptr);
 	cmdList->IASetIndexBuffer(nullptr);
 	cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	cmdList->DrawInstanced(6, 1, 0, 0);
-
-	cmdList->ResourceBarrier(1, &RvToLv(CD3DX12_RESOURCE_BARRIER::Transition(output,
-		D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ)));
-}
-
-bool CSsaoMap::BuildResources(CDirectx3D* directx3D)
-{
-	return (directx3D->LoadData([this](ID3D12Device* device, DirectX::ResourceUploadBatch& uploadBatch)->bool {
-		return CreateResources(device); }));
-}
-
-bool CSsaoMap::CreateResources(ID3D12Device* device)
-{
-	m_normalMap = nullptr;
-	m_ambientMap0 = nullptr;
-	m_ambientMap1 = nullptr;
-
-	D3D12_RESOURCE_DESC texDesc{};
-	ZeroMemory(&texDesc, sizeof(D3D12_RESOURCE_DESC));
-	texDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-	texDesc.Alignment = 0;
-	texDesc.Width = m_renderTargetWidth;
-	texDesc.Height = m_renderTargetHeight;
-	texDesc.DepthOrArraySize = 1;
-	texDesc.MipLevels = 1;
-	texDesc.Format = CSsaoMap::NormalMapFormat;
-	texDesc.SampleDesc.Count = 1;
-	texDesc.SampleDesc.Quality = 0;
-	texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
-	texDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
-
-	float normalClearColor[] = { 0.0f, 0.0f, 1.0f, 0.0f };
-	CD3DX12_CLEAR_VALUE optClear(NormalMapFormat, normalClearColor);
-	ReturnIfFailed(device->CreateCommittedResource(
-		&RvToLv(CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT)),
-		D3D12_HEAP_FLAG_NONE,
-		&texDesc,
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		&optClear,
-		IID_PPV_ARGS(&m_normalMap)));
-
-	texDesc.Width = m_renderTargetWidth / 2;
-	texDesc.Height = m_renderTargetHeight / 2;
-	texDesc.Format = CSsaoMap::AmbientMapFormat;
-
-	float ambientClearColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-	optClear = CD3DX12_CLEAR_VALUE(AmbientMapFormat, ambientClearColor);
-
-	ReturnIfFailed(device->CreateCommittedResource(
-		&RvToLv(CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT)),
-		D3D12_HEAP_FLAG_NONE,
-		&texDesc,
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		&optClear,
-		IID_PPV_ARGS(&m_ambientMap0)));
-
-	ReturnIfFailed(device->CreateCommittedResource(
-		&RvToLv(CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT)),
-		D3D12_HEAP_FLAG_NONE,
-		&texDesc,
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		&optClear,
-		IID_PPV_ARGS(&m_ambientMap1)));
-
-	return true;
 }
 
 bool CSsaoMap::BuildRandomVectorTexture(CDirectx3D* directx3D)
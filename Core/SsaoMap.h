@@ -1,8 +1,9 @@
-#pragma once
+﻿#pragma once
 
 class CDirectx3D;
 class CDescriptorHeap;
 class CFrameResources;
+struct FrameTextureDesc;
 
 enum class SsaoRegisterType : int
 {
@@ -30,24 +31,19 @@ public:
 	UINT SsaoMapWidth() const;
 	UINT SsaoMapHeight() const;
 
-	ID3D12Resource* NormalMap();
-	ID3D12Resource* AmbientMap();
+	//노멀맵과 ambient맵은 프레임 그래프가 임시 텍스쳐로 만들어서 넘겨 준다.
+	FrameTextureDesc GetNormalMapDesc() const;
+	FrameTextureDesc GetAmbientMapDesc() const;
+	void SetMaps(ID3D12Resource* normalMap, ID3D12Resource* ambientMap0, ID3D12Resource* ambientMap1);
 
 	void RebuildDescriptors(ID3D12Resource* depthStencilBuffer);
 	void SetPSOs(ID3D12PipelineState* ssaoPso, ID3D12PipelineState* ssaoBlurPso);
-	bool OnResize(CDirectx3D* directx3D, UINT newWidth, UINT newHeight);
-	void ComputeSsao(
-		ID3D12GraphicsCommandList* cmdList,
-		CFrameResources* currFrame,
-		int blurCount);
+	void OnResize(UINT newWidth, UINT newHeight);
+	void ComputeSsao(ID3D12GraphicsCommandList* cmdList, CFrameResources* currFrame);
+	void BlurAmbientMap(ID3D12GraphicsCommandList* cmdList, CFrameResources* currFrame, bool horzBlur);
 
 private:
-	void BlurAmbientMap(ID3D12GraphicsCommandList* cmdList, CFrameResources* currFrame, int blurCount);
-	void BlurAmbientMap(ID3D12GraphicsCommandList* cmdList, bool horzBlur);
-
-	bool BuildResources(CDirectx3D* directx3D);
 	bool BuildRandomVectorTexture(CDirectx3D* directx3D);
-	bool CreateResources(ID3D12Device* device);
 	bool CreateRandomVectorTexture(ID3D12Device* device, DirectX::ResourceUploadBatch& uploadBatch);
 
 private:
@@ -59,9 +55,9 @@ private:
 	ID3D12PipelineState* m_blurPso;
 
 	Microsoft::WRL::ComPtr<ID3D12Resource> m_randomVectorMap;
-	Microsoft::WRL::ComPtr<ID3D12Resource> m_normalMap;
-	Microsoft::WRL::ComPtr<ID3D12Resource> m_ambientMap0;
-	Microsoft::WRL::ComPtr<ID3D12Resource> m_ambientMap1;
+	ID3D12Resource* m_normalMap;
+	ID3D12Resource* m_ambientMap0;
+	ID3D12Resource* m_ambientMap1;
 
 	UINT m_renderTargetWidth{ 0 };
 	UINT m_renderTargetHeight{ 0 };
@@ -0,0 +1,103 @@
+﻿#include "pch.h"
+#include "./StreamCopy.h"
+#include <immintrin.h>
+#include <intrin.h>
+
+bool IsAvx2Supported()
+{
+	static const bool supported = []() {
+		int info[4]{};
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+
+		//OS가 YMM 레지스터를 저장해 주는지도 봐야 한다.
+		__cpuid(info, 1);
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0; }();
+
+	return supported;
+}
+
+size_t AlignHead(const BYTE* dst, size_t alignment, size_t byteSize)
+{
+	const size_t misaligned = reinterpret_cast<std::uintptr_t>(dst) & (alignment - 1);
+	return std::min(byteSize, (alignment - misaligned) & (alignment - 1));
+}
+
+void StreamBlockAvx2(BYTE* dst, const BYTE* src, size_t byteSize)
+{
+	const size_t head = AlignHead(dst, 32, byteSize);
+	std::memcpy(dst, src, head);
+	dst += head; src += head; byteSize -= head;
+
+	for (; byteSize >= 128; dst += 128, src += 128, byteSize -= 128)
+	{
+		const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+		const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+		const __m256i v2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 64));
+		const __m256i v3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 96));
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(dst), v0);
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 32), v1);
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 64), v2);
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 96), v3);
+	}
+	for (; byteSize >= 32; dst += 32, src += 32, byteSize -= 32)
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(dst), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)));
+	_mm256_zeroupper();
+
+	std::memcpy(dst, src, byteSize);
+}
+
+void StreamBlockSse2(BYTE* dst, const BYTE* src, size_t byteSize)
+{
+	const size_t head = AlignHead(dst, 16, byteSize);
+	std::memcpy(dst, src, head);
+	dst += head; src += head; byteSize -= head;
+
+	for (; byteSize >= 64; dst += 64, src += 64, byteSize -= 64)
+	{
+		const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+		const __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+		const __m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 48));
+		_mm_stream_si128(reinterpret_cast<__m128i*>(dst), v0);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(dst + 16), v1);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(dst + 32), v2);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(dst + 48), v3);
+	}
+	for (; byteSize >= 16; dst += 16, src += 16, byteSize -= 16)
+		_mm_stream_si128(reinterpret_cast<__m128i*>(dst), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+
+	std::memcpy(dst, src, byteSize);
+}
+
+void StreamCopy(void* dst, const void* src, size_t byteSize)
+{
+	StreamCopyStrided(dst, byteSize, src, byteSize, byteSize, 1);
+}
+
+//스트리밍 저장은 순서가 보장되지 않아서 끝에 sfence로 GPU에 넘기기 전에 다 쓰이게 한다.
+void StreamCopyStrided(void* dst, size_t dstStride, const void* src, size_t srcStride, size_t elementSize, size_t count)
+{
+	if (count == 0 || elementSize == 0) return;
+
+	BYTE* dstBytes = static_cast<BYTE*>(dst);
+	const BYTE* srcBytes = static_cast<const BYTE*>(src);
+
+	//빈틈없이 이어져 있으면 한 덩어리로 쓴다.
+	if (dstStride == elementSize && srcStride == elementSize)
+	{
+		elementSize *= count;
+		count = 1;
+	}
+
+	auto StreamBlock = IsAvx2Supported() ? StreamBlockAvx2 : StreamBlockSse2;
+	for (auto i : std::views::iota(size_t{ 0 }, count))
+		StreamBlock(dstBytes + i * dstStride, srcBytes + i * srcStride, elementSize);
+
+	_mm_sfence();
+}
@@ -0,0 +1,10 @@
+﻿#pragma once
+
+//업로드 힙은 write-combined 메모리라서 캐시를 거치지 않는 스트리밍 저장으로 채운다.
+//AVX2가 있으면 32바이트, 없으면 SSE2로 16바이트씩 쓰고 정렬되지 않은 앞뒤는 memcpy로 채운다.
+void StreamCopy(void* dst, const void* src, size_t byteSize);
+
+//원소를 하나씩 dstStride 간격으로 펼쳐 쓴다. 상수 버퍼처럼 256바이트로 맞춰야 할때 쓴다.
+void StreamCopyStrided(void* dst, size_t dstStride, const void* src, size_t srcStride, size_t elementSize, size_t count);
+
+bool IsAvx2Supported();
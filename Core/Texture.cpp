@@ -1,75 +1,336 @@
-#include "pch.h"
+﻿#include "pch.h"
 #include "Texture.h"
 #include "./d3dUtil.h"
 #include "./Directx3D.h"
 #include "./Renderer.h"
+#include "./CoreDefine.h"
 #include "../Include/Types.h"
 #include "./DescriptorHeap.h"
+#include "./TextureFile.h"
+#include "./TextureLoader.h"
+#include <filesystem>
 
 using namespace DirectX;
 
 CTexture::TextureMemory::TextureMemory()
-	: resource{ nullptr }
-	, uploadHeap{ nullptr }
+	: type{}
+	, resource{ nullptr }
+	, tailResource{ nullptr }
+	, layout{ nullptr }
 {}
 CTexture::TextureMemory::~TextureMemory() = default;
 
 CTexture::CTexture(std::wstring resPath)
 	: m_resPath(std::move(resPath))
 	, m_filePath{ L"Textures/" }
-	, m_textureMemories{}
+	, m_loader{ std::make_unique<CTextureLoader>(std::max(std::thread::hardware_concurrency() / 2, 1u)) }
+	, m_residency{ std::make_unique<CTextureResidency>(this, gTextureBudgetBytes) }
+	, m_textures{}
+	, m_loadingTextures{}
+	, m_uploadingBatches{}
+	, m_texture2Ds{}
+	, m_evictedTextures{}
+	, m_placeholder2D{ nullptr }
+	, m_placeholderCube{ nullptr }
 {}
 CTexture::~CTexture() = default;
 
-bool CTexture::Upload(ID3D12Device* device, DirectX::ResourceUploadBatch& uploadBatch, const TextureList& textureList)
+//1x1 흰색. 면이 6개면 큐브맵 자리에 쓴다.
+TextureData MakePlaceholderData(UINT arraySize, bool isCube)
 {
-	return std::ranges::all_of(textureList, [this, device, &uploadBatch](auto& tex) {
-		auto& type = tex.first;
-		auto& filename = tex.second;
-		auto texMemory = std::make_unique<TextureMemory>();
+	TextureData data{};
+	data.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	data.width = 1u;
+	data.height = 1u;
+	data.arraySize = arraySize;
+	data.isCube = isCube;
+	data.bytes.assign(static_cast<size_t>(arraySize) * 4, 0xff);
+	for (auto slice : std::views::iota(0u, arraySize))
+		data.subresources.emplace_back(TextureSubresource{ slice * 4ull, 4u, 4u, 1u, 1u });
 
-		texMemory->path = m_resPath + m_filePath;
-		texMemory->filename = filename;
-		std::wstring fullFilename = texMemory->path + texMemory->filename;
-		
-		ReturnIfFailed(CreateDDSTextureFromFile(device, uploadBatch,
-			fullFilename.c_str(), texMemory->resource.GetAddressOf()));
+	return data;
+}
+
+bool CTexture::Initialize(CDirectx3D* directx3D)
+{
+	return directx3D->LoadData([this](ID3D12Device* device, ResourceUploadBatch& uploadBatch)->bool {
+		ReturnIfFalse(CreateTexture(device, uploadBatch, MakePlaceholderData(1, false), m_placeholder2D.GetAddressOf()));
+		ReturnIfFalse(CreateTexture(device, uploadBatch, MakePlaceholderData(6, true), m_placeholderCube.GetAddressOf()));
+		return true; });
+}
+
+bool CTexture::CreateTexture(ID3D12Device* device, ResourceUploadBatch& uploadBatch,
+	const TextureData& data, ID3D12Resource** outResource)
+{
+	const CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_DEFAULT);
+	const CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Tex2D(data.format, data.width, data.height,
+		static_cast<UINT16>(data.arraySize), static_cast<UINT16>(data.mipCount));
+	ReturnIfFailed(device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &desc,
+		D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(outResource)));
+
+	UploadMips(uploadBatch, data, *outResource);
+	uploadBatch.Transition(*outResource, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	return true;
+}
+
+//data에 읽혀 있는 밉만 올린다. 배열 조각마다 밉이 이어져 있어서 조각별로 올린다.
+//Upload에서 업로드 힙으로 복사해 두기 때문에 data는 바로 지워도 된다.
+void CTexture::UploadMips(ResourceUploadBatch& uploadBatch, const TextureData& data, ID3D12Resource* resource)
+{
+	std::vector<D3D12_SUBRESOURCE_DATA> subresources{};
+	for (auto slice : std::views::iota(0u, data.arraySize))
+	{
+		const UINT first = slice * data.mipCount + data.firstLoadedMip;
+		subresources.clear();
+		for (auto index : std::views::iota(first, first + data.loadedMipCount))
+		{
+			const TextureSubresource& sub = data.subresources[index];
+			subresources.emplace_back(D3D12_SUBRESOURCE_DATA{ GetSubresourceData(data, sub), sub.rowPitch, sub.slicePitch });
+		}
+		uploadBatch.Upload(resource, first, subresources.data(), data.loadedMipCount);
+	}
+}
+
+//처음 올릴 때는 mip tail을 따로 만들어 둔다. 다시 올릴 때는 모든 밉이 든 리소스만 새로 만든다.
+//작은 밉만 읽혀 왔으면 리소스는 모든 밉 크기로 만들고 나머지는 한 단계씩 읽어 온다.
+bool CTexture::UploadTexture(ID3D12Device* device, ResourceUploadBatch& uploadBatch,
+	const TextureData& data, TextureMemory* texture)
+{
+	ReturnIfFalse(CreateTexture(device, uploadBatch, data, texture->resource.ReleaseAndGetAddressOf()));
+	texture->fullBytes = GetTextureBytes(data);
+	texture->uploadingMip = data.firstLoadedMip;
+	if (data.firstLoadedMip != 0 && texture->layout == nullptr)
+		texture->layout = std::make_unique<TextureData>(MakeLayout(data));
+
+	TextureData tail{};
+	if (texture->type == SrvOffset::Texture2D && texture->tailResource == nullptr && MakeMipTail(data, gMipTailSize, &tail))
+	{
+		ReturnIfFalse(CreateTexture(device, uploadBatch, tail, texture->tailResource.GetAddressOf()));
+		texture->tailBytes = GetTextureBytes(tail);
+	}
+
+	return true;
+}
+
+//이미 그리고 있는 리소스라서 복사하는 동안만 COPY_DEST로 바꾼다. 같은 큐라서 앞 프레임이
+//끝난 뒤에 복사하고, srv는 올라온 밉까지만 쓰도록 clamp되어 있어서 새 밉은 아직 읽히지 않는다.
+void CTexture::UploadStreamedMips(ResourceUploadBatch& uploadBatch, const TextureData& data, TextureMemory* texture)
+{
+	ID3D12Resource* resource = texture->resource.Get();
+	uploadBatch.Transition(resource, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_DEST);
+	UploadMips(uploadBatch, data, resource);
+	uploadBatch.Transition(resource, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	texture->uploadingMip = data.firstLoadedMip;
+}
+
+//한번에 한 단계씩 큰 밉을 읽는다. 헤더는 layout에 계산해 둔 것을 쓴다.
+void CTexture::RequestNextMip(TextureMemory* texture)
+{
+	if (texture->layout == nullptr || texture->residentMip <= texture->requestedMip) return;
+
+	const UINT mip = texture->residentMip - 1;
+	texture->ticket = m_loader->RequestMips(*texture->layout, mip, mip);
+	m_loadingTextures.emplace(texture->ticket, texture);
+	texture->state = TextureState::Streaming;
+}
+
+bool CTexture::CreateShaderResourceView(CDescriptorHeap* descHeap, TextureMemory* texture, ID3D12Resource* resource)
+{
+	const D3D12_RESOURCE_DESC resDesc = resource->GetDesc();
+	//모든 밉이 든 리소스는 올라온 밉까지만 쓴다.
+	const float minLod = (resource == texture->resource.Get()) ? static_cast<float>(texture->residentMip) : 0.0f;
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+	srvDesc.Format = resDesc.Format;
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Texture2D.MipLevels = resDesc.MipLevels;
+	srvDesc.Texture2D.MostDetailedMip = 0;
+	srvDesc.Texture2D.ResourceMinLODClamp = minLod;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+
+	if (texture->type == SrvOffset::TextureCube)
+	{
+		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+		srvDesc.TextureCube.MostDetailedMip = 0;
+		srvDesc.TextureCube.MipLevels = resDesc.MipLevels;
+		srvDesc.TextureCube.ResourceMinLODClamp = minLod;
+	}
+
+	//텍스쳐 구간이 모자라면 descHeap이 구간을 늘려서 옮긴다.
+	return descHeap->CreateShaderResourceView(texture->type, texture->srvIndex, &srvDesc, resource);
+}
+
+//srv 번호는 요청하는 순간 정해지고 다 올라갈 때까지 placeholder를 가리킨다.
+//파일은 작업 스레드가 읽고 Update에서 올린다.
+bool CTexture::Request(CDescriptorHeap* descHeap, const TextureList& textureList)
+{
+	for (auto& [type, filename] : textureList)
+	{
+		auto find = std::ranges::find_if(m_textures, [&filename](auto& tex) { return tex->filename == filename; });
+		if (find != m_textures.end()) continue;
+
+		const std::wstring fullFilename = m_resPath + m_filePath + filename;
+		if (!std::filesystem::exists(fullFilename)) return false;
+
+		auto texture = std::make_unique<TextureMemory>();
+		texture->type = type;
+		texture->filename = filename;
+		texture->srvIndex = (type == SrvOffset::Texture2D) ? static_cast<UINT>(m_srvTexture2DFilename.size()) : 0u;
+
+		ID3D12Resource* placeholder = (type == SrvOffset::TextureCube) ? m_placeholderCube.Get() : m_placeholder2D.Get();
+		ReturnIfFalse(CreateShaderResourceView(descHeap, texture.get(), placeholder));
 
-		m_textureMemories.emplace_back(std::make_pair(type, std::move(texMemory)));
+		if (type == SrvOffset::Texture2D)
+		{
+			m_srvTexture2DFilename.emplace_back(filename);
+			m_texture2Ds.emplace_back(texture.get());
+		}
 
-		return true; 
-		});
+		//Texture2D는 작은 밉만 먼저 읽어서 바로 보이게 하고 큰 밉은 나중에 채운다.
+		texture->ticket = (type == SrvOffset::Texture2D) ?
+			m_loader->RequestTail(fullFilename, gMipTailSize) : m_loader->Request(fullFilename);
+		m_loadingTextures.emplace(texture->ticket, texture.get());
+		m_textures.emplace_back(std::move(texture));
+	}
+
+	return true;
 }
 
-void CTexture::CreateShaderResourceView(CDescriptorHeap* descHeap)
+//프레임마다 불러서 GPU 복사가 끝난 텍스쳐는 srv를 바꾸고, 새로 읽힌 텍스쳐는 한 배치로 올린다.
+//GPU가 앞 프레임을 끝낸 뒤에 불리기 때문에 srv를 바꾸거나 리소스를 지워도 된다.
+bool CTexture::Update(CDirectx3D* directx3D, CDescriptorHeap* descHeap)
 {
-	std::ranges::for_each(m_textureMemories,
-		[descHeap, this](auto& curTex) mutable {
-			auto& type = curTex.first;
-			auto& curTexMemory = curTex.second;
-			auto& curTexRes = curTexMemory->resource;
+	m_residency->NextFrame();
+	while (!m_uploadingBatches.empty() &&
+		m_uploadingBatches.front().finished.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		for (auto texture : m_uploadingBatches.front().textures)
+		{
+			if (texture->state != TextureState::Uploading) continue;	//올리는 사이 내려갔다
+
+			texture->residentMip = texture->uploadingMip;
+			ReturnIfFalse(CreateShaderResourceView(descHeap, texture, texture->resource.Get()));
+			texture->state = TextureState::Resident;
+			if (texture->type == SrvOffset::Texture2D)
+				m_residency->Admit(texture->srvIndex, texture->fullBytes, texture->tailBytes);
+			RequestNextMip(texture);
+		}
+		m_uploadingBatches.pop_front();
+	}
+	ReturnIfFalse(EvictTextures(descHeap));
 
-			D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
-			srvDesc.Format = curTexRes->GetDesc().Format;
-			srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-			srvDesc.Texture2D.MipLevels = curTexRes->GetDesc().MipLevels;
-			srvDesc.Texture2D.MostDetailedMip = 0;
-			srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
-			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	std::vector<LoadedTexture> loadedTextures = m_loader->TakeLoaded();
+	if (loadedTextures.empty()) return true;
 
-			if (type == SrvOffset::TextureCube)
+	UploadingBatch batch{};
+	ReturnIfFalse(directx3D->LoadDataAsync([this, &loadedTextures, &batch](ID3D12Device* device, ResourceUploadBatch& uploadBatch)->bool {
+		for (auto& loaded : loadedTextures)
+		{
+			TextureMemory* texture = m_loadingTextures[loaded.ticket];
+			m_loadingTextures.erase(loaded.ticket);
+			if (loaded.ticket != texture->ticket) continue;
+			if (loaded.data == nullptr)
 			{
-				srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
-				srvDesc.TextureCube.MostDetailedMip = 0;
-				srvDesc.TextureCube.MipLevels = curTexRes->GetDesc().MipLevels;
-				srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
-				srvDesc.Format = curTexRes->GetDesc().Format;
+				//큰 밉을 못 읽었으면 올라온 밉까지만 쓴다.
+				texture->state = (texture->state == TextureState::Streaming) ? TextureState::Resident : TextureState::Failed;
+				continue;
 			}
 
-			UINT index = static_cast<UINT>(m_srvTexture2DFilename.size());
-			descHeap->CreateShaderResourceView(type, index, &srvDesc, curTexRes.Get());
+			if (texture->state == TextureState::Streaming)
+				UploadStreamedMips(uploadBatch, *loaded.data, texture);
+			else if (texture->state == TextureState::Loading)
+				ReturnIfFalse(UploadTexture(device, uploadBatch, *loaded.data, texture));
+			else
+				continue;	//읽는 사이 내려갔다
+			texture->state = TextureState::Uploading;
+			batch.textures.emplace_back(texture);
+		}
+		return true; }, &batch.finished));
+	m_uploadingBatches.emplace_back(std::move(batch));
+
+	return true;
+}
+
+//srv를 tail로 돌린 뒤 모든 밉이 든 리소스를 지운다.
+//내리자마자 다시 읽기 시작한 텍스쳐도 새 리소스가 올라올 때까지 tail을 쓴다.
+bool CTexture::EvictTextures(CDescriptorHeap* descHeap)
+{
+	for (auto texture : m_evictedTextures)
+	{
+		if (texture->state != TextureState::Evicted && texture->state != TextureState::Loading) continue;
+
+		ID3D12Resource* tail = (texture->tailResource != nullptr) ? texture->tailResource.Get() : m_placeholder2D.Get();
+		ReturnIfFalse(CreateShaderResourceView(descHeap, texture, tail));
+		texture->resource.Reset();
+	}
+	m_evictedTextures.clear();
+
+	return true;
+}
+
+//머터리얼이 텍스쳐를 쓰기 시작하거나 그만 쓸 때 부른다. 참조가 없는 텍스쳐부터 내린다.
+void CTexture::AddRef(const std::vector<UINT>& srvIndices)
+{
+	for (auto srvIndex : srvIndices)
+		if (srvIndex < m_texture2Ds.size()) m_residency->AddRef(srvIndex);
+}
+
+void CTexture::Release(const std::vector<UINT>& srvIndices)
+{
+	for (auto srvIndex : srvIndices)
+		if (srvIndex < m_texture2Ds.size()) m_residency->Release(srvIndex);
+}
+
+//이번 프레임에 그리는 텍스쳐. 내려가 있던 것은 다시 읽기 시작한다.
+void CTexture::Use(const std::vector<UINT>& srvIndices)
+{
+	for (auto srvIndex : srvIndices)
+		if (srvIndex < m_texture2Ds.size()) m_residency->Use(srvIndex);
+}
 
-			if(type == SrvOffset::Texture2D)
-				m_srvTexture2DFilename.emplace_back(curTexMemory->filename);
-		});
-}
\ No newline at end of file
+void CTexture::SetBudget(UINT64 budgetBytes)
+{
+	m_residency->SetBudget(budgetBytes);
+}
+
+//멀리 있는 텍스쳐는 큰 밉을 읽지 않게 한다. 이미 올라온 밉은 그대로 둔다.
+void CTexture::SetRequestedMip(UINT srvIndex, UINT mip)
+{
+	if (srvIndex >= m_texture2Ds.size()) return;
+
+	TextureMemory* texture = m_texture2Ds[srvIndex];
+	texture->requestedMip = mip;
+	if (texture->state == TextureState::Resident)
+		RequestNextMip(texture);
+}
+
+bool CTexture::MakeResident(UINT srvIndex)
+{
+	TextureMemory* texture = m_texture2Ds[srvIndex];
+	if (texture->state != TextureState::Evicted) return false;
+
+	//나눠 읽는 텍스쳐는 헤더를 다시 읽지 않고 tail부터 다시 올린다.
+	const TextureData* layout = texture->layout.get();
+	texture->ticket = (layout != nullptr) ?
+		m_loader->RequestMips(*layout, GetMipTailStart(*layout, gMipTailSize), layout->mipCount - 1) :
+		m_loader->Request(m_resPath + m_filePath + texture->filename);
+	m_loadingTextures.emplace(texture->ticket, texture);
+	texture->state = TextureState::Loading;
+
+	return true;
+}
+
+//지금 그리는 중일 수 있어서 표시만 해 두고 다음 Update에서 지운다.
+void CTexture::Evict(UINT srvIndex)
+{
+	TextureMemory* texture = m_texture2Ds[srvIndex];
+	texture->state = TextureState::Evicted;
+	m_evictedTextures.emplace_back(texture);
+}
+
+UINT CTexture::GetResidentCount() const
+{
+	return static_cast<UINT>(std::ranges::count_if(m_textures, [](auto& tex) {
+		return tex->state == TextureState::Resident || tex->state == TextureState::Streaming; }));
+}
@@ -1,12 +1,29 @@
-#pragma once
+﻿#pragma once
+
+#include <deque>
+#include <future>
+#include "./TextureResidency.h"
 
 class CDescriptorHeap;
+class CDirectx3D;
+class CTextureLoader;
+struct TextureData;
 enum class SrvOffset : int;
 
-class CTexture
+class CTexture final : public ITextureResidencyBackend
 {
 	using TextureList = std::vector<std::pair<SrvOffset, std::wstring>>;
 
+	enum class TextureState : int
+	{
+		Loading,		//작업 스레드가 읽는 중. srv는 placeholder를 가리킨다
+		Uploading,
+		Resident,
+		Streaming,		//더 큰 밉을 읽는 중. srv는 올라온 밉까지만 쓰도록 clamp되어 있다
+		Evicted,		//큰 밉을 버리고 mip tail(없으면 placeholder)을 가리킨다
+		Failed,			//읽지 못해서 placeholder를 계속 쓴다
+	};
+
 public:
 	CTexture(std::wstring resPath);
 	~CTexture();
@@ -15,30 +32,78 @@ public:
 	CTexture(const CTexture&) = delete;
 	CTexture& operator=(const CTexture&) = delete;
 
-	void CreateShaderResourceView(CDescriptorHeap* descHeap);
-	bool Upload(ID3D12Device* device, DirectX::ResourceUploadBatch& uploadBatch, const TextureList& textureList);
+	bool Initialize(CDirectx3D* directx3D);
+	bool Request(CDescriptorHeap* descHeap, const TextureList& textureList);
+	bool Update(CDirectx3D* directx3D, CDescriptorHeap* descHeap);
+	void AddRef(const std::vector<UINT>& srvIndices);
+	void Release(const std::vector<UINT>& srvIndices);
+	void Use(const std::vector<UINT>& srvIndices);
+	void SetBudget(UINT64 budgetBytes);
+	void SetRequestedMip(UINT srvIndex, UINT mip);
+
+	virtual bool MakeResident(UINT srvIndex) override;
+	virtual void Evict(UINT srvIndex) override;
+
 	inline std::vector<std::wstring> GetListSrvTexture2D();
+	inline const CTextureResidency* GetResidency() const;
+	UINT GetResidentCount() const;
+
 private:
 	struct TextureMemory
 	{
 		TextureMemory();
 		~TextureMemory();
 
-		//std::string name{};// Unique material name for lookup.
-		std::wstring path{};
+		SrvOffset type;
+		UINT srvIndex{ 0u };
 		std::wstring filename{};
+		TextureState state{ TextureState::Loading };
+		UINT64 fullBytes{ 0 };
+		UINT64 tailBytes{ 0 };
+		UINT ticket{ 0u };				//기다리는 loader 번호. 내린 뒤에 도착한 예전 밉은 버린다
+		UINT residentMip{ 0u };			//srv가 쓰는 가장 큰 밉
+		UINT uploadingMip{ 0u };
+		UINT requestedMip{ 0u };		//이 밉까지 읽어 온다
+		std::unique_ptr<TextureData> layout;	//나눠 읽는 텍스쳐의 헤더. 밉 위치를 다시 계산하지 않는다
 
 		Microsoft::WRL::ComPtr<ID3D12Resource> resource;
-		Microsoft::WRL::ComPtr<ID3D12Resource> uploadHeap;
+		Microsoft::WRL::ComPtr<ID3D12Resource> tailResource;	//처음 올릴 때 같이 만들고 내려도 남긴다
 	};
 
+	//한번에 올린 텍스쳐들. GPU 복사가 끝나면 srv를 진짜 리소스로 바꾼다.
+	struct UploadingBatch
+	{
+		std::future<void> finished{};
+		std::vector<TextureMemory*> textures{};
+	};
+
+	bool CreateShaderResourceView(CDescriptorHeap* descHeap, TextureMemory* texture, ID3D12Resource* resource);
+	bool CreateTexture(ID3D12Device* device, DirectX::ResourceUploadBatch& uploadBatch,
+		const TextureData& data, ID3D12Resource** outResource);
+	void UploadMips(DirectX::ResourceUploadBatch& uploadBatch, const TextureData& data, ID3D12Resource* resource);
+	bool UploadTexture(ID3D12Device* device, DirectX::ResourceUploadBatch& uploadBatch,
+		const TextureData& data, TextureMemory* texture);
+	void UploadStreamedMips(DirectX::ResourceUploadBatch& uploadBatch, const TextureData& data, TextureMemory* texture);
+	void RequestNextMip(TextureMemory* texture);
+	bool EvictTextures(CDescriptorHeap* descHeap);
+
 private:
 	std::wstring m_resPath{};
 	const std::wstring m_filePath;
 
-	std::vector<std::pair<SrvOffset, std::unique_ptr<TextureMemory>>> m_textureMemories;
+	std::unique_ptr<CTextureLoader> m_loader;
+	std::unique_ptr<CTextureResidency> m_residency;	//Texture2D만 srv 번호로 센다
+	std::vector<std::unique_ptr<TextureMemory>> m_textures;
+	std::unordered_map<UINT, TextureMemory*> m_loadingTextures;	//loader 번호로 찾는다
+	std::deque<UploadingBatch> m_uploadingBatches;
+	std::vector<TextureMemory*> m_texture2Ds;		//srv 번호 순서
+	std::vector<TextureMemory*> m_evictedTextures;	//다음 Update에서 srv를 tail로 바꾸고 리소스를 지운다
+
+	Microsoft::WRL::ComPtr<ID3D12Resource> m_placeholder2D;
+	Microsoft::WRL::ComPtr<ID3D12Resource> m_placeholderCube;
+
 	std::vector<std::wstring> m_srvTexture2DFilename{};
 };
 
 inline std::vector<std::wstring> CTexture::GetListSrvTexture2D() {	return m_srvTexture2DFilename; }
-
+inline const CTextureResidency* CTexture::GetResidency() const { return m_residency.get(); }
@@ -0,0 +1,434 @@
+﻿#include "pch.h"
+#include "./TextureFile.h"
+#include <filesystem>
+
+namespace Dds
+{
+	constexpr UINT Magic{ 0x20534444 };	//"DDS "
+	constexpr UINT FourCC{ 0x4 };
+	constexpr UINT Rgb{ 0x40 };
+	constexpr UINT AlphaPixels{ 0x1 };
+	constexpr UINT CubeMap{ 0x200 };
+	constexpr UINT Volume{ 0x200000 };
+	constexpr UINT MiscTextureCube{ 0x4 };
+	constexpr UINT DimensionTexture2D{ 3u };
+
+	struct PixelFormat
+	{
+		UINT size, flags, fourCC, rgbBitCount, rMask, gMask, bMask, aMask;
+	};
+
+	struct Header
+	{
+		UINT size, flags, height, width, pitchOrLinearSize, depth, mipMapCount;
+		UINT reserved1[11];
+		PixelFormat pixelFormat;
+		UINT caps, caps2, caps3, caps4, reserved2;
+	};
+
+	struct HeaderDX10
+	{
+		UINT dxgiFormat, resourceDimension, miscFlag, arraySize, miscFlags2;
+	};
+}
+
+constexpr UINT MakeFourCC(char c0, char c1, char c2, char c3)
+{
+	return static_cast<UINT>(c0) | (static_cast<UINT>(c1) << 8) |
+		(static_cast<UINT>(c2) << 16) | (static_cast<UINT>(c3) << 24);
+}
+
+template<typename T>
+T ReadAt(const std::vector<BYTE>& bytes, size_t offset)
+{
+	T value{};
+	std::memcpy(&value, bytes.data() + offset, sizeof(T));
+	return value;
+}
+
+//예전 dds 헤더의 픽셀 포맷을 dxgi 포맷으로 바꾼다. 여기 없는 포맷은 읽지 않는다.
+DXGI_FORMAT GetLegacyFormat(const Dds::PixelFormat& pf)
+{
+	if (pf.flags & Dds::FourCC)
+	{
+		switch (pf.fourCC)
+		{
+		case MakeFourCC('D', 'X', 'T', '1'): return DXGI_FORMAT_BC1_UNORM;
+		case MakeFourCC('D', 'X', 'T', '2'):
+		case MakeFourCC('D', 'X', 'T', '3'): return DXGI_FORMAT_BC2_UNORM;
+		case MakeFourCC('D', 'X', 'T', '4'):
+		case MakeFourCC('D', 'X', 'T', '5'): return DXGI_FORMAT_BC3_UNORM;
+		case MakeFourCC('A', 'T', 'I', '1'):
+		case MakeFourCC('B', 'C', '4', 'U'): return DXGI_FORMAT_BC4_UNORM;
+		case MakeFourCC('A', 'T', 'I', '2'):
+		case MakeFourCC('B', 'C', '5', 'U'): return DXGI_FORMAT_BC5_UNORM;
+		}
+		return DXGI_FORMAT_UNKNOWN;
+	}
+
+	if ((pf.flags & Dds::Rgb) && pf.rgbBitCount == 32)
+	{
+		const bool hasAlpha = (pf.flags & Dds::AlphaPixels) != 0;
+		if (pf.rMask == 0x000000ff && pf.gMask == 0x0000ff00 && pf.bMask == 0x00ff0000)
+			return DXGI_FORMAT_R8G8B8A8_UNORM;
+		if (pf.rMask == 0x00ff0000 && pf.gMask == 0x0000ff00 && pf.bMask == 0x000000ff)
+			return hasAlpha ? DXGI_FORMAT_B8G8R8A8_UNORM : DXGI_FORMAT_B8G8R8X8_UNORM;
+	}
+
+	return DXGI_FORMAT_UNKNOWN;
+}
+
+UINT GetBlockBytes(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_BC1_TYPELESS: case DXGI_FORMAT_BC1_UNORM: case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS: case DXGI_FORMAT_BC4_UNORM: case DXGI_FORMAT_BC4_SNORM:
+		return 8u;
+	case DXGI_FORMAT_BC2_TYPELESS: case DXGI_FORMAT_BC2_UNORM: case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_TYPELESS: case DXGI_FORMAT_BC3_UNORM: case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC5_TYPELESS: case DXGI_FORMAT_BC5_UNORM: case DXGI_FORMAT_BC5_SNORM:
+	case DXGI_FORMAT_BC6H_TYPELESS: case DXGI_FORMAT_BC6H_UF16: case DXGI_FORMAT_BC6H_SF16:
+	case DXGI_FORMAT_BC7_TYPELESS: case DXGI_FORMAT_BC7_UNORM: case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return 16u;
+	}
+	return 0u;
+}
+
+UINT GetBitsPerPixel(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_R32G32B32A32_FLOAT: case DXGI_FORMAT_R32G32B32A32_UINT:
+		return 128u;
+	case DXGI_FORMAT_R16G16B16A16_FLOAT: case DXGI_FORMAT_R16G16B16A16_UNORM:
+	case DXGI_FORMAT_R32G32_FLOAT:
+		return 64u;
+	case DXGI_FORMAT_R8G8B8A8_TYPELESS: case DXGI_FORMAT_R8G8B8A8_UNORM: case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8A8_TYPELESS: case DXGI_FORMAT_B8G8R8A8_UNORM: case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8X8_UNORM: case DXGI_FORMAT_R10G10B10A2_UNORM: case DXGI_FORMAT_R11G11B10_FLOAT:
+	case DXGI_FORMAT_R16G16_FLOAT: case DXGI_FORMAT_R16G16_UNORM: case DXGI_FORMAT_R32_FLOAT:
+		return 32u;
+	case DXGI_FORMAT_R8G8_UNORM: case DXGI_FORMAT_R16_FLOAT: case DXGI_FORMAT_R16_UNORM:
+	case DXGI_FORMAT_B5G6R5_UNORM: case DXGI_FORMAT_B5G5R5A1_UNORM:
+		return 16u;
+	case DXGI_FORMAT_R8_UNORM: case DXGI_FORMAT_A8_UNORM:
+		return 8u;
+	}
+	return 0u;
+}
+
+bool GetSurfaceInfo(DXGI_FORMAT format, UINT width, UINT height, UINT* outRowPitch, UINT* outRowCount)
+{
+	const UINT blockBytes = GetBlockBytes(format);
+	if (blockBytes != 0)
+	{
+		(*outRowPitch) = std::max(1u, (width + 3) / 4) * blockBytes;
+		(*outRowCount) = std::max(1u, (height + 3) / 4);
+		return true;
+	}
+
+	const UINT bitsPerPixel = GetBitsPerPixel(format);
+	if (bitsPerPixel == 0) return false;
+
+	(*outRowPitch) = (width * bitsPerPixel + 7) / 8;
+	(*outRowCount) = height;
+	return true;
+}
+
+bool ParseDds(std::vector<BYTE> bytes, TextureData* outData)
+{
+	if (!ParseDdsHeader(bytes, bytes.size(), outData)) return false;
+
+	outData->firstLoadedMip = 0u;
+	outData->loadedMipCount = outData->mipCount;
+	outData->bytesOffset = 0;
+	outData->bytes = std::move(bytes);
+	return true;
+}
+
+//밉과 배열 조각의 파일 위치를 헤더에서 한번에 계산해 두고, 파일 크기를 넘는지 검사한다.
+//bytes에는 헤더만 있어도 된다.
+bool ParseDdsHeader(const std::vector<BYTE>& bytes, UINT64 fileSize, TextureData* outData)
+{
+	constexpr size_t headerOffset = sizeof(UINT);
+	if (bytes.size() < headerOffset + sizeof(Dds::Header)) return false;
+	if (ReadAt<UINT>(bytes, 0) != Dds::Magic) return false;
+
+	const auto header = ReadAt<Dds::Header>(bytes, headerOffset);
+	if (header.size != sizeof(Dds::Header) || header.pixelFormat.size != sizeof(Dds::PixelFormat)) return false;
+	if (header.caps2 & Dds::Volume) return false;
+
+	TextureData& data = *outData;
+	data.width = header.width;
+	data.height = header.height;
+	data.mipCount = std::max(1u, header.mipMapCount);
+	data.arraySize = 1u;
+
+	size_t dataOffset = headerOffset + sizeof(Dds::Header);
+	if ((header.pixelFormat.flags & Dds::FourCC) && header.pixelFormat.fourCC == MakeFourCC('D', 'X', '1', '0'))
+	{
+		if (bytes.size() < dataOffset + sizeof(Dds::HeaderDX10)) return false;
+
+		const auto dx10 = ReadAt<Dds::HeaderDX10>(bytes, dataOffset);
+		if (dx10.resourceDimension != Dds::DimensionTexture2D) return false;
+
+		data.format = static_cast<DXGI_FORMAT>(dx10.dxgiFormat);
+		data.arraySize = dx10.arraySize;
+		data.isCube = (dx10.miscFlag & Dds::MiscTextureCube) != 0;
+		dataOffset += sizeof(Dds::HeaderDX10);
+	}
+	else
+	{
+		data.format = GetLegacyFormat(header.pixelFormat);
+		data.isCube = (header.caps2 & Dds::CubeMap) != 0;
+	}
+	if (data.isCube) data.arraySize *= 6;
+
+	if (data.format == DXGI_FORMAT_UNKNOWN || data.width == 0 || data.height == 0 || data.arraySize == 0) return false;
+	if (data.width > D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION || data.height > D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION) return false;
+	if (data.mipCount > D3D12_REQ_MIP_LEVELS || data.arraySize > D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION) return false;
+
+	data.subresources.clear();
+	data.subresources.reserve(static_cast<size_t>(data.arraySize) * data.mipCount);
+	UINT64 offset = dataOffset;
+	for (auto slice : std::views::iota(0u, data.arraySize))
+	{
+		UINT width = data.width, height = data.height;
+		for (auto mip : std::views::iota(0u, data.mipCount))
+		{
+			UINT rowPitch{ 0u }, rowCount{ 0u };
+			if (!GetSurfaceInfo(data.format, width, height, &rowPitch, &rowCount)) return false;
+
+			//16384 크기에 128비트 포맷이면 4GB라서 UINT를 넘는다.
+			const UINT64 slicePitch = static_cast<UINT64>(rowPitch) * rowCount;
+			if (slicePitch > UINT_MAX) return false;
+
+			TextureSubresource sub{};
+			sub.offset = offset;
+			sub.rowPitch = rowPitch;
+			sub.slicePitch = static_cast<UINT>(slicePitch);
+			sub.width = width;
+			sub.height = height;
+			data.subresources.emplace_back(sub);
+
+			offset += sub.slicePitch;
+			width = std::max(1u, width / 2);
+			height = std::max(1u, height / 2);
+		}
+	}
+	if (offset > fileSize) return false;
+
+	data.firstLoadedMip = data.mipCount;
+	data.loadedMipCount = 0u;
+	data.bytes.clear();
+	data.bytesOffset = 0;
+	return true;
+}
+
+//24, 32비트 무압축 bmp만 읽는다. 아래에서 위로 저장된 줄을 뒤집어서 RGBA8로 푼다.
+bool DecodeBmp(const std::vector<BYTE>& bytes, TextureData* outData)
+{
+	constexpr size_t infoOffset{ 14 };
+	if (bytes.size() < infoOffset + 40 || bytes[0] != 'B' || bytes[1] != 'M') return false;
+
+	const UINT pixelOffset = ReadAt<UINT>(bytes, 10);
+	const int width = ReadAt<int>(bytes, infoOffset + 4);
+	const int height = ReadAt<int>(bytes, infoOffset + 8);
+	const auto bitCount = ReadAt<std::uint16_t>(bytes, infoOffset + 14);
+	const UINT compression = ReadAt<UINT>(bytes, infoOffset + 16);
+	if (width <= 0 || height == 0 || compression != 0 || (bitCount != 24 && bitCount != 32)) return false;
+
+	const UINT absHeight = static_cast<UINT>(std::abs(height));
+	const UINT pixelBytes = bitCount / 8u;
+	const size_t srcPitch = (static_cast<size_t>(width) * pixelBytes + 3) & ~size_t{ 3 };
+	if (pixelOffset + srcPitch * absHeight > bytes.size()) return false;
+
+	TextureData& data = *outData;
+	data.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	data.width = static_cast<UINT>(width);
+	data.height = absHeight;
+	data.arraySize = 1u;
+	data.mipCount = 1u;
+	data.isCube = false;
+	data.firstLoadedMip = 0u;
+	data.loadedMipCount = 1u;
+	data.bytesOffset = 0;
+	data.bytes.resize(static_cast<size_t>(data.width) * data.height * 4);
+
+	for (auto y : std::views::iota(0u, absHeight))
+	{
+		const UINT srcRow = (height > 0) ? absHeight - 1 - y : y;
+		const BYTE* src = bytes.data() + pixelOffset + srcPitch * srcRow;
+		BYTE* dst = data.bytes.data() + static_cast<size_t>(y) * data.width * 4;
+		for (auto x : std::views::iota(0u, data.width))
+		{
+			dst[x * 4 + 0] = src[x * pixelBytes + 2];
+			dst[x * 4 + 1] = src[x * pixelBytes + 1];
+			dst[x * 4 + 2] = src[x * pixelBytes + 0];
+			dst[x * 4 + 3] = (pixelBytes == 4) ? src[x * pixelBytes + 3] : 0xff;
+		}
+	}
+
+	TextureSubresource sub{};
+	sub.rowPitch = data.width * 4;
+	sub.slicePitch = sub.rowPitch * data.height;
+	sub.width = data.width;
+	sub.height = data.height;
+	data.subresources.assign(1, sub);
+
+	return true;
+}
+
+//가로 세로가 maxSize 이하인 첫 밉. 없으면 mipCount
+UINT GetMipTailStart(const TextureData& data, UINT maxSize)
+{
+	auto mips = std::views::iota(0u, data.mipCount);
+	auto tailMip = std::ranges::find_if(mips, [&data, maxSize](UINT mip) {
+		const TextureSubresource& sub = data.subresources[mip];
+		return sub.width <= maxSize && sub.height <= maxSize; });
+	return tailMip == std::ranges::end(mips) ? data.mipCount : *tailMip;
+}
+
+//배열이 아니고 maxSize보다 큰 밉과 작은 밉이 다 있으면 작은 밉부터 나눠 올릴 수 있다.
+bool IsStreamable(const TextureData& data, UINT maxSize)
+{
+	if (data.arraySize != 1 || data.isCube) return false;
+
+	const UINT tailMip = GetMipTailStart(data, maxSize);
+	return tailMip != 0 && tailMip != data.mipCount;
+}
+
+//가로 세로가 maxSize 이하인 밉만 골라서 따로 담는다. 텍스쳐를 내려도 이것만은 남겨 둔다.
+//가장 큰 밉부터 작거나 밉이 하나뿐이면 남길 tail이 없다. data에 그 밉들이 읽혀 있어야 한다.
+bool MakeMipTail(const TextureData& data, UINT maxSize, TextureData* outTail)
+{
+	const UINT tailMip = GetMipTailStart(data, maxSize);
+	if (tailMip == 0 || tailMip == data.mipCount || tailMip < data.firstLoadedMip) return false;
+
+	TextureData& tail = *outTail;
+	tail.filename = data.filename;
+	tail.format = data.format;
+	tail.width = data.subresources[tailMip].width;
+	tail.height = data.subresources[tailMip].height;
+	tail.arraySize = data.arraySize;
+	tail.mipCount = data.mipCount - tailMip;
+	tail.isCube = data.isCube;
+	tail.firstLoadedMip = 0u;
+	tail.loadedMipCount = tail.mipCount;
+	tail.bytesOffset = 0;
+	tail.bytes.clear();
+	tail.subresources.clear();
+	for (auto slice : std::views::iota(0u, data.arraySize))
+	{
+		for (auto mip : std::views::iota(tailMip, data.mipCount))
+		{
+			TextureSubresource sub = data.subresources[slice * data.mipCount + mip];
+			const BYTE* src = GetSubresourceData(data, sub);
+			sub.offset = tail.bytes.size();
+			tail.bytes.insert(tail.bytes.end(), src, src + sub.slicePitch);
+			tail.subresources.emplace_back(sub);
+		}
+	}
+
+	return true;
+}
+
+UINT64 GetTextureBytes(const TextureData& data)
+{
+	UINT64 bytes{ 0 };
+	for (auto& sub : data.subresources)
+		bytes += sub.slicePitch;
+
+	return bytes;
+}
+
+//bytes를 빼고 헤더에서 계산한 값만 옮긴다. 남은 밉을 읽을 때 헤더를 다시 해석하지 않는다.
+TextureData MakeLayout(const TextureData& data)
+{
+	TextureData layout{};
+	layout.filename = data.filename;
+	layout.format = data.format;
+	layout.width = data.width;
+	layout.height = data.height;
+	layout.arraySize = data.arraySize;
+	layout.mipCount = data.mipCount;
+	layout.isCube = data.isCube;
+	layout.firstLoadedMip = data.mipCount;
+	layout.loadedMipCount = 0u;
+	layout.subresources = data.subresources;
+
+	return layout;
+}
+
+bool ReadTextureFile(const std::wstring& filename, TextureData* outData)
+{
+	std::error_code ec{};
+	const auto fileSize = std::filesystem::file_size(filename, ec);
+	if (ec) return false;
+
+	std::ifstream fin(filename, std::ios::binary);
+	if (fin.fail()) return false;
+
+	std::vector<BYTE> bytes(static_cast<size_t>(fileSize));
+	fin.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(fileSize));
+	if (fin.gcount() != static_cast<std::streamsize>(fileSize)) return false;
+
+	outData->filename = filename;
+	const std::wstring extension = std::filesystem::path(filename).extension().wstring();
+	if (extension == L".bmp" || extension == L".BMP")
+		return DecodeBmp(bytes, outData);
+
+	return ParseDds(std::move(bytes), outData);
+}
+
+//dds 헤더와 maxSize 이하의 밉만 읽는다. 나눠 올릴 수 없는 텍스쳐는 통째로 읽는다.
+bool ReadTextureTail(const std::wstring& filename, UINT maxSize, TextureData* outData)
+{
+	const std::wstring extension = std::filesystem::path(filename).extension().wstring();
+	if (extension != L".dds" && extension != L".DDS")
+		return ReadTextureFile(filename, outData);
+
+	std::error_code ec{};
+	const auto fileSize = std::filesystem::file_size(filename, ec);
+	if (ec) return false;
+
+	std::ifstream fin(filename, std::ios::binary);
+	if (fin.fail()) return false;
+
+	constexpr size_t headerSize = sizeof(UINT) + sizeof(Dds::Header) + sizeof(Dds::HeaderDX10);
+	std::vector<BYTE> header(static_cast<size_t>(std::min<UINT64>(fileSize, headerSize)));
+	fin.read(reinterpret_cast<char*>(header.data()), static_cast<std::streamsize>(header.size()));
+	if (fin.gcount() != static_cast<std::streamsize>(header.size())) return false;
+
+	outData->filename = filename;
+	if (!ParseDdsHeader(header, fileSize, outData)) return false;
+	if (!IsStreamable(*outData, maxSize))
+		return ReadTextureFile(filename, outData);
+
+	return ReadDdsMips(filename, GetMipTailStart(*outData, maxSize), outData->mipCount - 1, outData);
+}
+
+//헤더에서 계산해 둔 위치로 firstMip부터 lastMip까지 한번에 읽는다. 배열이 아니면 이어져 있다.
+bool ReadDdsMips(const std::wstring& filename, UINT firstMip, UINT lastMip, TextureData* inoutData)
+{
+	TextureData& data = *inoutData;
+	if (data.arraySize != 1 || firstMip > lastMip || lastMip >= data.mipCount) return false;
+
+	const TextureSubresource& first = data.subresources[firstMip];
+	const TextureSubresource& last = data.subresources[lastMip];
+	const UINT64 size = last.offset + last.slicePitch - first.offset;
+
+	std::ifstream fin(filename, std::ios::binary);
+	if (fin.fail()) return false;
+
+	data.bytes.resize(static_cast<size_t>(size));
+	fin.seekg(static_cast<std::streamoff>(first.offset));
+	fin.read(reinterpret_cast<char*>(data.bytes.data()), static_cast<std::streamsize>(size));
+	if (fin.gcount() != static_cast<std::streamsize>(size)) return false;
+
+	data.bytesOffset = first.offset;
+	data.firstLoadedMip = firstMip;
+	data.loadedMipCount = lastMip - firstMip + 1;
+	return true;
+}
@@ -0,0 +1,49 @@
+﻿#pragma once
+
+//파일에서 서브리소스(밉, 배열 조각)가 시작하는 위치와 피치
+struct TextureSubresource
+{
+	UINT64 offset{ 0 };
+	UINT rowPitch{ 0u };
+	UINT slicePitch{ 0u };
+	UINT width{ 0u };
+	UINT height{ 0u };
+};
+
+//GPU에 올리기 전까지의 텍스쳐. 장치 없이 만들 수 있어서 작업 스레드에서 읽고 해석한다.
+//dds는 파일 그대로, bmp는 RGBA8로 풀어서 bytes에 담는다. 밉을 나눠 읽으면 subresources는
+//모든 밉의 파일 위치를 갖고 bytes에는 firstLoadedMip부터 loadedMipCount개만 들어 있다.
+struct TextureData
+{
+	std::wstring filename{};
+	DXGI_FORMAT format{ DXGI_FORMAT_UNKNOWN };
+	UINT width{ 0u };
+	UINT height{ 0u };
+	UINT arraySize{ 1u };
+	UINT mipCount{ 1u };
+	bool isCube{ false };
+	UINT firstLoadedMip{ 0u };
+	UINT loadedMipCount{ 1u };
+
+	std::vector<BYTE> bytes{};
+	UINT64 bytesOffset{ 0 };		//bytes[0]의 파일 위치
+	std::vector<TextureSubresource> subresources{};	//배열 조각마다 밉이 이어진다
+};
+
+inline const BYTE* GetSubresourceData(const TextureData& data, const TextureSubresource& sub)
+{
+	return data.bytes.data() + (sub.offset - data.bytesOffset);
+}
+
+bool ReadTextureFile(const std::wstring& filename, TextureData* outData);
+bool ReadTextureTail(const std::wstring& filename, UINT maxSize, TextureData* outData);
+bool ReadDdsMips(const std::wstring& filename, UINT firstMip, UINT lastMip, TextureData* inoutData);
+bool ParseDds(std::vector<BYTE> bytes, TextureData* outData);
+bool ParseDdsHeader(const std::vector<BYTE>& bytes, UINT64 fileSize, TextureData* outData);
+bool DecodeBmp(const std::vector<BYTE>& bytes, TextureData* outData);
+bool GetSurfaceInfo(DXGI_FORMAT format, UINT width, UINT height, UINT* outRowPitch, UINT* outRowCount);
+bool MakeMipTail(const TextureData& data, UINT maxSize, TextureData* outTail);
+UINT GetMipTailStart(const TextureData& data, UINT maxSize);
+bool IsStreamable(const TextureData& data, UINT maxSize);
+UINT64 GetTextureBytes(const TextureData& data);
+TextureData MakeLayout(const TextureData& data);
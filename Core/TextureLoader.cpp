@@ -0,0 +1,123 @@
+﻿#include "pch.h"
+#include "./TextureLoader.h"
+#include "./TextureFile.h"
+
+LoadedTexture::LoadedTexture()
+	: ticket{ 0u }
+	, data{ nullptr }
+{}
+LoadedTexture::~LoadedTexture() = default;
+LoadedTexture::LoadedTexture(LoadedTexture&&) noexcept = default;
+LoadedTexture& LoadedTexture::operator=(LoadedTexture&&) noexcept = default;
+
+CTextureLoader::CTextureLoader(UINT threadCount)
+	: m_requests{}
+	, m_loaded{}
+	, m_nextTicket{ 0u }
+	, m_pendingCount{ 0u }
+	, m_threads{}
+{
+	for (auto i : std::views::iota(0u, std::max(threadCount, 1u)))
+		m_threads.emplace_back([this](std::stop_token stopToken) { Work(stopToken); });
+}
+
+//jthread가 소멸하면서 stop을 요청하고 join한다. 남은 요청은 버린다.
+CTextureLoader::~CTextureLoader() = default;
+
+UINT CTextureLoader::Request(const std::wstring& filename)
+{
+	TextureRequest request{};
+	request.filename = filename;
+	return Push(std::move(request));
+}
+
+//처음에는 maxMipSize 이하의 밉만 읽는다. 나눠 올릴 수 없는 텍스쳐는 통째로 읽힌다.
+UINT CTextureLoader::RequestTail(const std::wstring& filename, UINT maxMipSize)
+{
+	TextureRequest request{};
+	request.type = ReadType::Tail;
+	request.filename = filename;
+	request.maxMipSize = maxMipSize;
+	return Push(std::move(request));
+}
+
+//헤더는 다시 해석하지 않고 layout에 계산해 둔 위치에서 밉 구간만 읽는다.
+UINT CTextureLoader::RequestMips(const TextureData& layout, UINT firstMip, UINT lastMip)
+{
+	TextureRequest request{};
+	request.type = ReadType::Mips;
+	request.filename = layout.filename;
+	request.firstMip = firstMip;
+	request.lastMip = lastMip;
+	request.layout = std::make_unique<TextureData>(MakeLayout(layout));
+	return Push(std::move(request));
+}
+
+UINT CTextureLoader::Push(TextureRequest request)
+{
+	std::lock_guard lock(m_mutex);
+	request.ticket = m_nextTicket++;
+	const UINT ticket = request.ticket;
+	m_requests.emplace_back(std::move(request));
+	m_pendingCount++;
+	m_requestCondition.notify_one();
+
+	return ticket;
+}
+
+std::vector<LoadedTexture> CTextureLoader::TakeLoaded()
+{
+	std::lock_guard lock(m_mutex);
+	return std::exchange(m_loaded, {});
+}
+
+void CTextureLoader::WaitAll()
+{
+	std::unique_lock lock(m_mutex);
+	m_idleCondition.wait(lock, [this]() { return m_pendingCount == 0; });
+}
+
+UINT CTextureLoader::GetPendingCount()
+{
+	std::lock_guard lock(m_mutex);
+	return m_pendingCount;
+}
+
+bool CTextureLoader::Read(TextureRequest& request, TextureData* outData)
+{
+	switch (request.type)
+	{
+	case ReadType::Tail: return ReadTextureTail(request.filename, request.maxMipSize, outData);
+	case ReadType::Mips:
+		(*outData) = std::move(*request.layout);
+		return ReadDdsMips(request.filename, request.firstMip, request.lastMip, outData);
+	default: return ReadTextureFile(request.filename, outData);
+	}
+}
+
+void CTextureLoader::Work(std::stop_token stopToken)
+{
+	while (true)
+	{
+		TextureRequest request{};
+		{
+			std::unique_lock lock(m_mutex);
+			if (!m_requestCondition.wait(lock, stopToken, [this]() { return !m_requests.empty(); }))
+				return;
+
+			request = std::move(m_requests.front());
+			m_requests.pop_front();
+		}
+
+		//락 밖에서 읽고 해석한다.
+		LoadedTexture loaded{};
+		loaded.ticket = request.ticket;
+		loaded.data = std::make_unique<TextureData>();
+		if (!Read(request, loaded.data.get()))
+			loaded.data = nullptr;
+
+		std::lock_guard lock(m_mutex);
+		m_loaded.emplace_back(std::move(loaded));
+		if (--m_pendingCount == 0) m_idleCondition.notify_all();
+	}
+}
@@ -0,0 +1,74 @@
+﻿#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+struct TextureData;
+
+//읽기를 마친 텍스쳐. 읽거나 해석하지 못했으면 data가 nullptr이다.
+struct LoadedTexture
+{
+	LoadedTexture();
+	~LoadedTexture();
+	LoadedTexture(LoadedTexture&&) noexcept;
+	LoadedTexture& operator=(LoadedTexture&&) noexcept;
+
+	UINT ticket{ 0u };
+	std::unique_ptr<TextureData> data;
+};
+
+//파일 읽기와 헤더 해석은 작업 스레드가 하고, 끝난 텍스쳐는 큐에 쌓아 둔다.
+//업로드하는 쪽(한 스레드)이 TakeLoaded로 모아서 한번에 올린다. 장치를 쓰지 않는다.
+class CTextureLoader
+{
+	enum class ReadType : int
+	{
+		Whole,
+		Tail,		//헤더와 작은 밉만
+		Mips,		//헤더를 읽어 둔 텍스쳐의 밉 구간
+	};
+
+	struct TextureRequest
+	{
+		UINT ticket{ 0u };
+		ReadType type{ ReadType::Whole };
+		std::wstring filename{};
+		UINT maxMipSize{ 0u };
+		UINT firstMip{ 0u };
+		UINT lastMip{ 0u };
+		std::unique_ptr<TextureData> layout{};
+	};
+
+public:
+	CTextureLoader(UINT threadCount);
+	~CTextureLoader();
+
+	CTextureLoader() = delete;
+	CTextureLoader(const CTextureLoader&) = delete;
+	CTextureLoader& operator=(const CTextureLoader&) = delete;
+
+	UINT Request(const std::wstring& filename);
+	UINT RequestTail(const std::wstring& filename, UINT maxMipSize);
+	UINT RequestMips(const TextureData& layout, UINT firstMip, UINT lastMip);
+	std::vector<LoadedTexture> TakeLoaded();
+	void WaitAll();
+	UINT GetPendingCount();
+
+private:
+	UINT Push(TextureRequest request);
+	bool Read(TextureRequest& request, TextureData* outData);
+	void Work(std::stop_token stopToken);
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable_any m_requestCondition;
+	std::condition_variable m_idleCondition;
+	std::deque<TextureRequest> m_requests;
+	std::vector<LoadedTexture> m_loaded;
+	UINT m_nextTicket;
+	UINT m_pendingCount;		//요청했지만 아직 m_loaded에 들어가지 않은 수
+
+	std::vector<std::jthread> m_threads;	//멤버 중 마지막에 있어야 먼저 멈추고 join한다
+};
@@ -0,0 +1,127 @@
+﻿#include "pch.h"
+#include "./TextureResidency.h"
+
+CTextureResidency::CTextureResidency(ITextureResidencyBackend* backend, UINT64 budgetBytes)
+	: m_backend{ backend }
+	, m_budgetBytes{ budgetBytes }
+	, m_frame{ 0 }
+	, m_entries{}
+	, m_lru{}
+	, m_stats{}
+{}
+CTextureResidency::~CTextureResidency() = default;
+
+CTextureResidency::Entry& CTextureResidency::GetEntry(UINT id)
+{
+	if (id >= m_entries.size()) m_entries.resize(id + 1);
+	return m_entries[id];
+}
+
+void CTextureResidency::AddRef(UINT id)
+{
+	GetEntry(id).refCount++;
+}
+
+//참조가 없어져도 바로 내리지 않는다. 예산이 모자랄 때 먼저 내릴 뿐이다.
+void CTextureResidency::Release(UINT id)
+{
+	Entry& entry = GetEntry(id);
+	assert(entry.refCount > 0 && "texture released more than referenced");
+	if (entry.refCount > 0) entry.refCount--;
+}
+
+void CTextureResidency::Use(UINT id)
+{
+	Entry& entry = GetEntry(id);
+	entry.lastUsedFrame = m_frame;
+	switch (entry.state)
+	{
+	case State::Resident:
+		m_stats.hits++;
+		m_lru.splice(m_lru.end(), m_lru, entry.lruIter);
+		break;
+	case State::Evicted:
+		m_stats.misses++;
+		if (m_backend->MakeResident(id)) entry.state = State::Streaming;
+		break;
+	default:
+		break;	//올리는 중이면 기다린다
+	}
+}
+
+//모든 밉이 GPU에 올라왔다. 크기를 다시 적고 예산을 넘으면 다른 텍스쳐를 내린다.
+void CTextureResidency::Admit(UINT id, UINT64 fullBytes, UINT64 tailBytes)
+{
+	Entry& entry = GetEntry(id);
+	if (entry.state == State::Resident) return;
+
+	m_stats.residentBytes -= (entry.state == State::Evicted || entry.state == State::Streaming) ? entry.tailBytes : 0;
+	entry.fullBytes = fullBytes;
+	entry.tailBytes = tailBytes;
+	entry.state = State::Resident;
+	entry.lastUsedFrame = m_frame;
+	entry.lruIter = m_lru.insert(m_lru.end(), id);
+	m_stats.residentBytes += fullBytes + tailBytes;
+	m_stats.peakBytes = std::max(m_stats.peakBytes, m_stats.residentBytes);
+
+	EvictUntilFits(id);
+}
+
+void CTextureResidency::NextFrame()
+{
+	m_frame++;
+}
+
+void CTextureResidency::SetBudget(UINT64 budgetBytes)
+{
+	m_budgetBytes = budgetBytes;
+	EvictUntilFits(UINT_MAX);
+}
+
+//이번 프레임에 쓴 텍스쳐는 내리지 않는다. 그것만으로 예산을 넘으면 넘은 채로 둔다.
+void CTextureResidency::EvictUntilFits(UINT keepId)
+{
+	auto CanEvict = [this, keepId](UINT id, bool referenced) {
+		const Entry& entry = m_entries[id];
+		return id != keepId && entry.lastUsedFrame < m_frame && (entry.refCount > 0) == referenced; };
+
+	for (auto referenced : { false, true })
+	{
+		for (auto iter = m_lru.begin(); iter != m_lru.end() && m_stats.residentBytes > m_budgetBytes;)
+		{
+			const UINT id = *iter++;
+			if (CanEvict(id, referenced)) Evict(id);
+		}
+	}
+}
+
+void CTextureResidency::Evict(UINT id)
+{
+	Entry& entry = m_entries[id];
+	m_lru.erase(entry.lruIter);
+	entry.state = State::Evicted;
+	entry.evictions++;
+	m_stats.residentBytes -= entry.fullBytes;
+	m_stats.evictions++;
+
+	m_backend->Evict(id);
+}
+
+UINT64 CTextureResidency::GetBytes(UINT id) const
+{
+	if (id >= m_entries.size()) return 0;
+
+	const Entry& entry = m_entries[id];
+	switch (entry.state)
+	{
+	case State::Resident: return entry.fullBytes + entry.tailBytes;
+	case State::Evicted:
+	case State::Streaming: return entry.tailBytes;
+	default: return 0;
+	}
+}
+
+bool CTextureResidency::IsResident(UINT id) const
+{
+	return id < m_entries.size() && m_entries[id].state == State::Resident;
+}
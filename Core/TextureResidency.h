@@ -0,0 +1,88 @@
+﻿#pragma once
+
+#include <list>
+
+//텍스쳐 메모리를 실제로 잡고 놓는 곳. 렌더러는 CTexture가 리소스를 만들고 지우고,
+//테스트는 호출만 기록하는 가짜로 바꿔 끼운다.
+interface ITextureResidencyBackend
+{
+	virtual ~ITextureResidencyBackend() {};
+	virtual bool MakeResident(UINT textureId) = 0;	//버렸던 밉을 다시 읽어 올린다. 끝나면 Admit이 불린다
+	virtual void Evict(UINT textureId) = 0;			//큰 밉을 버리고 mip tail만 남긴다
+};
+
+struct TextureResidencyStats
+{
+	UINT64 residentBytes{ 0 };
+	UINT64 peakBytes{ 0 };
+	UINT hits{ 0u };
+	UINT misses{ 0u };
+	UINT evictions{ 0u };
+};
+
+//텍스쳐마다 바이트 수, 머터리얼 참조 수, 마지막으로 쓴 프레임을 센다.
+//예산을 넘으면 이번 프레임에 쓰지 않은 텍스쳐를 오래된 순서로 내리는데,
+//참조하는 머터리얼이 없는 것부터 내린다. 내린 텍스쳐는 mip tail만 남아 있다가
+//다시 쓰일 때 backend에 올려 달라고 한다. 장치를 쓰지 않는다.
+class CTextureResidency
+{
+	enum class State : int
+	{
+		Unknown,		//아직 처음 올리는 중이라 크기를 모른다
+		Resident,
+		Evicted,
+		Streaming,		//다시 올리는 중
+	};
+
+	struct Entry
+	{
+		State state{ State::Unknown };
+		UINT64 fullBytes{ 0 };		//모든 밉
+		UINT64 tailBytes{ 0 };		//내려도 남는 mip tail
+		UINT refCount{ 0u };
+		UINT64 lastUsedFrame{ 0 };
+		UINT evictions{ 0u };
+		std::list<UINT>::iterator lruIter{};
+	};
+
+public:
+	CTextureResidency(ITextureResidencyBackend* backend, UINT64 budgetBytes);
+	~CTextureResidency();
+
+	CTextureResidency() = delete;
+	CTextureResidency(const CTextureResidency&) = delete;
+	CTextureResidency& operator=(const CTextureResidency&) = delete;
+
+	void AddRef(UINT id);
+	void Release(UINT id);
+	void Use(UINT id);
+	void Admit(UINT id, UINT64 fullBytes, UINT64 tailBytes);
+	void NextFrame();
+	void SetBudget(UINT64 budgetBytes);
+
+	UINT64 GetBytes(UINT id) const;
+	bool IsResident(UINT id) const;
+	inline UINT GetRefCount(UINT id) const;
+	inline UINT GetEvictionCount(UINT id) const;
+	inline UINT64 GetBudget() const;
+	inline const TextureResidencyStats& GetStats() const;
+
+private:
+	Entry& GetEntry(UINT id);
+	void EvictUntilFits(UINT keepId);
+	void Evict(UINT id);
+
+private:
+	ITextureResidencyBackend* m_backend;
+	UINT64 m_budgetBytes;
+	UINT64 m_frame;
+
+	std::vector<Entry> m_entries;
+	std::list<UINT> m_lru;		//올라와 있는 텍스쳐. 앞이 가장 오래전에 쓴 것
+	TextureResidencyStats m_stats;
+};
+
+inline UINT CTextureResidency::GetRefCount(UINT id) const { return id < m_entries.size() ? m_entries[id].refCount : 0u; }
+inline UINT CTextureResidency::GetEvictionCount(UINT id) const { return id < m_entries.size() ? m_entries[id].evictions : 0u; }
+inline UINT64 CTextureResidency::GetBudget() const { return m_budgetBytes; }
+inline const TextureResidencyStats& CTextureResidency::GetStats() const { return m_stats; }
@@ -0,0 +1,100 @@
+﻿#include "pch.h"
+#include "./UploadAllocator.h"
+#include "./d3dUtil.h"
+
+CUploadPageBackend::CUploadPageBackend(ID3D12Device* device)
+	: m_device{ device }
+{}
+CUploadPageBackend::~CUploadPageBackend() = default;
+
+//업로드 힙은 계속 Map해 둔 채로 써도 된다. 페이지를 지울 때 같이 풀린다.
+bool CUploadPageBackend::CreatePage(UINT64 size, UploadPage* outPage)
+{
+	CD3DX12_HEAP_PROPERTIES heapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	CD3DX12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+	ReturnIfFailed(m_device->CreateCommittedResource(
+		&heapProp,
+		D3D12_HEAP_FLAG_NONE,
+		&resourceDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&outPage->resource)));
+
+	ReturnIfFailed(outPage->resource->Map(0, nullptr, reinterpret_cast<void**>(&outPage->mappedData)));
+	outPage->gpuAddress = outPage->resource->GetGPUVirtualAddress();
+	outPage->size = size;
+
+	return true;
+}
+
+CUploadAllocator::CUploadAllocator(IUploadPageBackend* backend, UINT64 pageSize)
+	: m_backend{ backend }
+	, m_pageSize{ pageSize }
+	, m_offset{ 0 }
+	, m_pageCount{ 0u }
+	, m_usedPages{}
+	, m_freePages{}
+	, m_retiredPages{}
+{}
+CUploadAllocator::~CUploadAllocator() = default;
+
+bool CUploadAllocator::Allocate(UINT64 size, UINT64 alignment, UploadAllocation* outAllocation)
+{
+	if (size == 0) return false;
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0 && "alignment must be a power of two");
+
+	UINT64 offset = (m_offset + alignment - 1) & ~(alignment - 1);
+	if (m_usedPages.empty() || offset + size > m_usedPages.back()->size)
+	{
+		ReturnIfFalse(NextPage(size));
+		offset = 0;
+	}
+
+	UploadPage* page = m_usedPages.back().get();
+	outAllocation->cpuAddress = page->mappedData + offset;
+	outAllocation->gpuAddress = page->gpuAddress + offset;
+	outAllocation->size = size;
+	m_offset = offset + size;
+
+	return true;
+}
+
+//쉬고 있는 페이지 중 크기가 맞는 것을 먼저 쓰고, 없으면 새로 만든다.
+bool CUploadAllocator::NextPage(UINT64 size)
+{
+	auto find = std::ranges::find_if(m_freePages, [size](auto& page) {
+		return page->size >= size; });
+	if (find != m_freePages.end())
+	{
+		m_usedPages.emplace_back(std::move(*find));
+		m_freePages.erase(find);
+	}
+	else
+	{
+		auto page = std::make_unique<UploadPage>();
+		ReturnIfFalse(m_backend->CreatePage(std::max(size, m_pageSize), page.get()));
+		m_usedPages.emplace_back(std::move(page));
+		m_pageCount++;
+	}
+	m_offset = 0;
+
+	return true;
+}
+
+//이번 프레임에 쓴 페이지는 이 펜스를 GPU가 지날 때까지 건드리지 않는다.
+void CUploadAllocator::FinishFrame(UINT64 fence)
+{
+	for (auto& page : m_usedPages)
+		m_retiredPages.emplace_back(fence, std::move(page));
+	m_usedPages.clear();
+	m_offset = 0;
+}
+
+void CUploadAllocator::Recycle(UINT64 completedFence)
+{
+	while (!m_retiredPages.empty() && m_retiredPages.front().first <= completedFence)
+	{
+		m_freePages.emplace_back(std::move(m_retiredPages.front().second));
+		m_retiredPages.pop_front();
+	}
+}
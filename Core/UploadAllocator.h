@@ -0,0 +1,80 @@
+﻿#pragma once
+
+#include <deque>
+
+struct UploadPage
+{
+	Microsoft::WRL::ComPtr<ID3D12Resource> resource{ nullptr };
+	BYTE* mappedData{ nullptr };
+	D3D12_GPU_VIRTUAL_ADDRESS gpuAddress{ 0 };
+	UINT64 size{ 0 };
+};
+
+struct UploadAllocation
+{
+	BYTE* cpuAddress{ nullptr };
+	D3D12_GPU_VIRTUAL_ADDRESS gpuAddress{ 0 };
+	UINT64 size{ 0 };
+};
+
+//페이지를 실제로 만드는 곳. 렌더러는 업로드 힙 버퍼를 쓰고, 테스트는 CPU 메모리로 바꿔 끼운다.
+interface IUploadPageBackend
+{
+	virtual ~IUploadPageBackend() {};
+	virtual bool CreatePage(UINT64 size, UploadPage* outPage) = 0;
+};
+
+class CUploadPageBackend final : public IUploadPageBackend
+{
+public:
+	CUploadPageBackend(ID3D12Device* device);
+	~CUploadPageBackend();
+
+	CUploadPageBackend() = delete;
+	CUploadPageBackend(const CUploadPageBackend&) = delete;
+	CUploadPageBackend& operator=(const CUploadPageBackend&) = delete;
+
+	virtual bool CreatePage(UINT64 size, UploadPage* outPage) override;
+
+private:
+	ID3D12Device* m_device;
+};
+
+//한 프레임에 쓸 업로드 메모리를 Map해 둔 큰 페이지에서 앞에서부터 잘라 준다.
+//페이지가 모자라면 새로 만들고, 다 쓴 페이지는 프레임의 펜스 값과 함께 물러났다가
+//GPU가 그 펜스를 지나면 다시 쓴다. 페이지보다 큰 요청은 그 크기만한 페이지를 따로 만든다.
+class CUploadAllocator
+{
+	using Page = std::unique_ptr<UploadPage>;
+
+public:
+	CUploadAllocator(IUploadPageBackend* backend, UINT64 pageSize);
+	~CUploadAllocator();
+
+	CUploadAllocator() = delete;
+	CUploadAllocator(const CUploadAllocator&) = delete;
+	CUploadAllocator& operator=(const CUploadAllocator&) = delete;
+
+	bool Allocate(UINT64 size, UINT64 alignment, UploadAllocation* outAllocation);
+	void FinishFrame(UINT64 fence);
+	void Recycle(UINT64 completedFence);
+
+	inline UINT GetPageCount() const;
+	inline UINT GetFreePageCount() const;
+
+private:
+	bool NextPage(UINT64 size);
+
+private:
+	IUploadPageBackend* m_backend;
+	UINT64 m_pageSize;
+	UINT64 m_offset;
+	UINT m_pageCount;
+
+	std::vector<Page> m_usedPages;		//이번 프레임에 쓰는 페이지. 마지막이 지금 자르는 페이지
+	std::vector<Page> m_freePages;
+	std::deque<std::pair<UINT64, Page>> m_retiredPages;
+};
+
+inline UINT CUploadAllocator::GetPageCount() const { return m_pageCount; }
+inline UINT CUploadAllocator::GetFreePageCount() const { return static_cast<UINT>(m_freePages.size()); }
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "./UploadBuffer.h"
 #include "./d3dUtil.h"
+#include "./StreamCopy.h"
 
 CUploadBuffer::CUploadBuffer(size_t typeSize, UINT elementCount, bool isConstantBuffer) 
     : m_uploadBuffer{ nullptr }
@@ -48,6 +49,25 @@ bool CUploadBuffer::Initialize(ID3D12Device* device)
     return true;
 }
 
+//원소가 모자라면 두배 이상 큰 버퍼를 새로 만들고 예전 내용을 옮긴다.
+//이 프레임 자원을 쓰던 GPU 작업은 끝난 뒤라서 예전 버퍼는 바로 놓아도 된다.
+bool CUploadBuffer::Reserve(ID3D12Device* device, UINT elementCount)
+{
+    if (elementCount <= m_elementCount) return true;
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> oldBuffer = m_uploadBuffer;
+    BYTE* oldData = m_mappedData;
+    const UINT oldCount = m_elementCount;
+
+    m_elementCount = std::max(elementCount, m_elementCount * 2);
+    ReturnIfFalse(Initialize(device));
+
+    memcpy(m_mappedData, oldData, static_cast<size_t>(oldCount) * m_elementByteSize);
+    oldBuffer->Unmap(0, nullptr);
+
+    return true;
+}
+
 ID3D12Resource* CUploadBuffer::Resource() const
 {
     return m_uploadBuffer.Get();
@@ -55,20 +75,36 @@ ID3D12Resource* CUploadBuffer::Resource() const
 
 void CUploadBuffer::CopyDataList(const void* data, size_t size)
 {
-    if (m_elementByteSize == m_typeSize)
-    {
-        memcpy(&m_mappedData[0], data, size * m_elementByteSize);
-        return;
-    }
-
-    //|-------------|--------------|-------|         1, 2,  
-    //|-----------------|------------------|         1(Ǿ  ִ), 2
-    //Constant buffer   Ͱ ؿó  ϴµ 
-    // vector   ó ´. ׷ ϳ ڷḦ 鼭 ũ⸦ ߾ָ鼭 ־ش.
-    for (auto i : std::views::iota(0, static_cast<int>(size)))
-    {
-        unsigned char* curData = (unsigned char*)data;
-        curData += m_typeSize * i;
-        memcpy(&m_mappedData[m_elementByteSize * i], (void*)curData, m_typeSize);
-    }
+    //버전 없이 통째로 쓰면 예전 버전은 믿을 수 없다.
+    m_versions.clear();
+    CopyDataRange(data, 0, size);
+}
+
+void CUploadBuffer::CopyDataRange(const void* data, size_t startIndex, size_t count)
+{
+    assert(startIndex + count <= m_elementCount && "upload buffer overrun");
+
+    //|-------------|--------------|-------|        데이터 1, 데이터2, 남는 공간
+    //|-----------------|------------------|        데이터 1(계산되어서 빈공간이 합쳐있는), 데이터2
+    //Constant buffer와 같은 경우는 데이터가 밑에처럼 들어가야 하는데 
+    // vector형식으로 넣으면 위에것 처럼 들어온다. 그래서 원소 간격을 넓히면서 스트리밍 저장으로 한번에 쓴다.
+    // 간격이 같으면 한 덩어리로 쓴다.
+    StreamCopyStrided(&m_mappedData[startIndex * m_elementByteSize], m_elementByteSize,
+        static_cast<const BYTE*>(data) + startIndex * m_typeSize, m_typeSize, m_typeSize, count);
+}
+
+//프레임 리소스마다 버퍼가 따로 있어서 버퍼마다 어느 버전까지 올렸는지 기억해 둔다.
+//바뀐 원소 구간만 복사하고, 바뀐게 없으면 아무것도 하지 않는다. 복사한 바이트 수를 돌려준다.
+UINT64 CUploadBuffer::CopyChangedData(const void* data, const UINT64* versions, size_t size)
+{
+    //0은 아직 한번도 올리지 않은 상태라서 버전은 1부터 쓴다.
+    if (m_versions.size() != size)
+        m_versions.resize(size, 0);
+
+    UINT64 copiedBytes{ 0 };
+    ForEachChangedRange(versions, m_versions.data(), size, [this, data, &copiedBytes](size_t begin, size_t end) {
+        CopyDataRange(data, begin, end - begin);
+        copiedBytes += static_cast<UINT64>(end - begin) * m_elementByteSize; });
+
+    return copiedBytes;
 }
\ No newline at end of file
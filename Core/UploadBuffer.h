@@ -1,5 +1,22 @@
 ﻿#pragma once
 
+//versions와 지난번에 올린 stored를 비교해서 바뀐 원소가 이어진 구간 [begin, end)마다 func를 부른다.
+//부른 뒤에는 stored를 versions로 맞춘다.
+template<typename Func>
+void ForEachChangedRange(const UINT64* versions, UINT64* stored, size_t size, Func&& func)
+{
+    size_t i{ 0 };
+    while (i < size)
+    {
+        if (versions[i] == stored[i]) { ++i; continue; }
+
+        const size_t begin = i;
+        for (; i < size && versions[i] != stored[i]; ++i)
+            stored[i] = versions[i];
+        func(begin, i);
+    }
+}
+
 class CUploadBuffer
 {
 public:
@@ -11,9 +28,15 @@ public:
     CUploadBuffer& operator=(const CUploadBuffer& rhs) = delete;
 
     bool Initialize(ID3D12Device* device);
+    bool Reserve(ID3D12Device* device, UINT elementCount);
     ID3D12Resource* Resource()const;
     void CopyDataList(const void* data, size_t size);
+    void CopyDataRange(const void* data, size_t startIndex, size_t count);
+    UINT64 CopyChangedData(const void* data, const UINT64* versions, size_t size);
     inline UINT GetByteSize() { return m_elementByteSize; }; 
+    inline UINT GetElementCount() { return m_elementCount; };
+    inline bool IsPacked() { return m_elementByteSize == m_typeSize; };
+    inline BYTE* GetMappedData() { return m_mappedData; };
 
     template<typename T>
     void CopyData(int elementIndex, const T& data)
@@ -29,4 +52,6 @@ private:
     UINT m_elementByteSize{ 0u };
     UINT m_typeSize{ 0u };
     UINT m_elementCount{ 0u };
+
+    std::vector<UINT64> m_versions;     //이 버퍼에 마지막으로 올린 원소별 버전
 };
\ No newline at end of file
@@ -1,6 +1,8 @@
 ﻿#include "pch.h"
 #include "./d3dUtil.h"
+#include "./ShaderCache.h"
 #include <stack>
+#include <filesystem>
 #include "../DirectXTK12/Inc/WICTextureLoader.h"
 
 using Microsoft::WRL::ComPtr;
@@ -95,18 +97,20 @@ bool CoreUtil::IsKeyDown(int vkeyCode)
 
 ComPtr<ID3DBlob> CoreUtil::LoadBinary(const std::wstring& filename)
 {
-    std::ifstream fin(filename, std::ios::binary);
+    std::ifstream fin(filename, std::ios::binary | std::ios::ate);
+    if (fin.fail()) return nullptr;
 
-    fin.seekg(0, std::ios_base::end);
-    std::ifstream::pos_type size = (int)fin.tellg();
+    const std::streamoff size = fin.tellg();
+    if (size <= 0) return nullptr;
     fin.seekg(0, std::ios_base::beg);
 
     ComPtr<ID3DBlob> blob{ nullptr };
     HRESULT hResult = D3DCreateBlob(static_cast<SIZE_T>(size), blob.GetAddressOf());
     if (FAILED(hResult)) return nullptr;
 
+    //다 읽지 못했으면 쓰레기 값이 남으므로 돌려주지 않는다.
     fin.read((char*)blob->GetBufferPointer(), size);
-    fin.close();
+    if (fin.gcount() != size) return nullptr;
 
     return blob;
 }
@@ -185,10 +189,12 @@ std::wstring SplitPath(const std::wstring& fullFilename)
     return fullname.substr(0, find + 1);
 }
 
+//include 파일은 CIncludeCache에서 받는다. 내용은 캐시가 갖고 있어서 Close에서 지우지 않는다.
 class IncludeProcessor : public ID3DInclude
 {
 public:
-    IncludeProcessor(const std::wstring path)
+    IncludeProcessor(const std::wstring path, CIncludeCache* includeCache)
+        : m_includeCache{ includeCache }
     {
         m_stackPath.push(path);
     }
@@ -201,60 +207,59 @@ public:
 
 private:
     std::stack<std::wstring> m_stackPath{};
+    CIncludeCache* m_includeCache;
 
 public:
     HRESULT STDMETHODCALLTYPE Open(D3D_INCLUDE_TYPE IncludeType, LPCSTR pFileName, LPCVOID pParentData, LPCVOID* ppData, UINT* pBytes) noexcept override
     {
         std::wstring path = m_stackPath.top();
         std::wstring fullFilename = path + GetWstring(pFileName);
-        std::wstring parentPath = SplitPath(fullFilename);
-        m_stackPath.push(parentPath);
+        const std::string* contents = m_includeCache->Read(fullFilename);
+        if (contents == nullptr) return E_FAIL;
 
-        std::ifstream ifs(fullFilename);
-        if (ifs.fail()) return E_FAIL;
-
-        std::string str((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-        ifs.close();
-
-        UINT numBytes = static_cast<UINT>(str.size());
-
-        char* pData;
-        pData = new char[numBytes + 1]; // (char*)malloc( numBytes+1 ); // Add 1 for the null terminator that is appended by strncpy_s.
-        strncpy_s(pData, numBytes + 1, str.data(), str.size());
-
-        *ppData = (LPCVOID)pData;
-        *pBytes = numBytes;
+        m_stackPath.push(SplitPath(fullFilename));
+        *ppData = contents->data();
+        *pBytes = static_cast<UINT>(contents->size());
 
         return S_OK;
     }
 
     HRESULT STDMETHODCALLTYPE Close(LPCVOID pData) noexcept override
     {
-        delete[](char*)pData;
         m_stackPath.pop();
         return S_OK;
     }
 };
 
+UINT CoreUtil::GetShaderCompileFlags()
+{
+	UINT compileFlags = 0;
+#if defined(DEBUG) || defined(_DEBUG)  
+	compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+	return compileFlags;
+}
+
+//소스와 include 모두 includeCache에서 받아서 한번 읽은 파일은 다시 읽지 않는다.
 bool CoreUtil::CompileShader(
 	const std::wstring& filename,
 	const D3D_SHADER_MACRO* defines,
 	const std::string& entrypoint,
 	const std::string& target,
+    CIncludeCache* includeCache,
     ComPtr<ID3DBlob>* outBlob)
 {
-	UINT compileFlags = 0;
-#if defined(DEBUG) || defined(_DEBUG)  
-	compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
-
 	HRESULT hr = S_OK;
     
-    IncludeProcessor includeProcessor(SplitPath(filename));
+    const std::string* source = includeCache->Read(filename);
+    if (source == nullptr) return false;
+
+    const std::string sourceName = std::filesystem::path(filename).string();
+    IncludeProcessor includeProcessor(SplitPath(filename), includeCache);
 	ComPtr<ID3DBlob> byteCode{ nullptr };
     ComPtr<ID3DBlob> errors{ nullptr };
-	hr = D3DCompileFromFile(filename.c_str(), defines, &includeProcessor,
-		entrypoint.c_str(), target.c_str(), compileFlags, 0, &byteCode, &errors);
+	hr = D3DCompile(source->data(), source->size(), sourceName.c_str(), defines, &includeProcessor,
+		entrypoint.c_str(), target.c_str(), GetShaderCompileFlags(), 0, &byteCode, &errors);
 
 	if(errors != nullptr)
 		OutputDebugStringA((char*)errors->GetBufferPointer());
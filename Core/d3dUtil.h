@@ -8,6 +8,7 @@
 #include <D3Dcompiler.h>
 
 extern const int gNumFrameResources;
+class CIncludeCache;
 
 inline void d3dSetDebugName(IDXGIObject* obj, const char* name)
 {
@@ -99,11 +100,13 @@ public:
         Microsoft::WRL::ComPtr<ID3D12Resource>& uploadBuffer,
         Microsoft::WRL::ComPtr<ID3D12Resource>* outDefaultBuffer);
 
+	static UINT GetShaderCompileFlags();
 	static bool CompileShader(
 		const std::wstring& filename,
 		const D3D_SHADER_MACRO* defines,
 		const std::string& entrypoint,
 		const std::string& target,
+        CIncludeCache* includeCache,
         Microsoft::WRL::ComPtr<ID3DBlob>* outBlob);
 
     static HRESULT LoadTextureFromFile(
@@ -0,0 +1,261 @@
+﻿#include "pch.h"
+#include <ranges>
+#include <algorithm>
+#include "../Include/Types.h"
+#include "../Core/CommandStream.h"
+#include "../Core/RenderQueue.h"
+#include "../Core/FrameWorkers.h"
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include <random>
+
+//기록 계층(CommandStream, RenderQueue, FrameWorkers)만 쓰는 테스트. 창, 장치, Windows 헤더 없이
+//gtest와 UINT 같은 기본 타입만 있으면 빌드되어서 리눅스에서도 벤치마크를 돌릴 수 있다.
+namespace Core
+{
+	using enum GraphicsPSO;
+
+	//커맨드 리스트 대신 호출 수와 몇 가지 값만 모아 둔다.
+	class FakeCommandSink : public ICommandSink
+	{
+	public:
+		virtual void SetRootSignature(RootSignature rootSignature) override { Call(); m_rootSignatures.emplace_back(rootSignature); }
+		virtual void SetPipelineState(GraphicsPSO pso) override { Call(); }
+		virtual void SetRootConstantBuffer(UINT slot, UINT64 address) override { Call(); m_addressSum += address; }
+		virtual void SetRootShaderResource(UINT slot, UINT64 address) override { Call(); m_addressSum += address; }
+		virtual void SetRootDescriptorTable(UINT slot, UINT64 gpuHandle) override { Call(); m_addressSum += gpuHandle; }
+		virtual void SetVertexBuffer(const CommandVertexBuffer& vertexBuffer) override { Call(); }
+		virtual void SetIndexBuffer(const CommandIndexBuffer& indexBuffer) override { Call(); }
+		virtual void SetPrimitiveTopology(UINT topology) override { Call(); }
+		virtual void SetViewport(const CommandViewport& viewport) override { Call(); m_viewport = viewport; }
+		virtual void SetScissorRect(const CommandRect& rect) override { Call(); }
+		virtual void SetRenderTarget(UINT64 rtvHandle, UINT64 dsvHandle) override { Call(); }
+		virtual void ClearRenderTarget(UINT64 rtvHandle, const std::array<float, 4>& color) override { Call(); m_clearColor = color; }
+		virtual void ClearDepthStencil(UINT64 dsvHandle, float depth, UINT stencil) override { Call(); }
+		virtual void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, int baseVertex, UINT startInstance) override
+		{
+			Call();
+			m_drawCount++;
+			m_indexCountSum += indexCount;
+			m_baseVertex = baseVertex;
+		}
+
+		void Call() { m_callCount++; }
+
+		UINT m_callCount{ 0u };
+		UINT m_drawCount{ 0u };
+		UINT64 m_indexCountSum{ 0 };
+		UINT64 m_addressSum{ 0 };
+		int m_baseVertex{ 0 };
+		CommandViewport m_viewport{};
+		std::array<float, 4> m_clearColor{};
+		std::vector<RootSignature> m_rootSignatures{};
+	};
+
+	TEST(CCommandStream, ElideAndReplay)
+	{
+		const CommandViewport viewport{ 0.0f, 0.0f, 800.0f, 600.0f, 0.0f, 1.0f };
+		CCommandStream stream{};
+		stream.SetRootSignature(RootSignature::Common);
+		stream.SetRootConstantBuffer(0, 0x100);
+		stream.SetRootConstantBuffer(0, 0x100);
+		stream.SetPipelineState(GraphicsPSO::Opaque);
+		stream.SetPipelineState(GraphicsPSO::Opaque);
+		stream.SetViewport(viewport);
+		stream.SetViewport(viewport);
+		stream.SetRenderTarget(0x10, 0x20);
+		stream.ClearRenderTarget(0x10, { 1.0f, 0.5f, 0.25f, 1.0f });
+		stream.ClearRenderTarget(0x10, { 1.0f, 0.5f, 0.25f, 1.0f });	//지우기와 그리기는 빼지 않는다
+		stream.DrawIndexedInstanced(36, 2, 3, -4, 0);
+		stream.SetRootSignature(RootSignature::Common);
+		stream.SetRootSignature(RootSignature::Ssao);
+		stream.SetRootConstantBuffer(0, 0x100);	//루트 시그너쳐가 바뀌면 같은 값이라도 다시 넣는다
+
+		const CommandStreamStats& stats = stream.GetStats();
+		EXPECT_EQ(stats.packetCount, 10u);
+		EXPECT_EQ(stats.elidedCount, 4u);
+		EXPECT_EQ(stats.drawCount, 1u);
+
+		FakeCommandSink sink{};
+		stream.Replay(&sink);
+		EXPECT_EQ(sink.m_callCount, 10u);
+		EXPECT_EQ(sink.m_rootSignatures, (std::vector<RootSignature>{ RootSignature::Common, RootSignature::Ssao }));
+		EXPECT_EQ(sink.m_addressSum, 0x200u);
+		EXPECT_EQ(sink.m_baseVertex, -4);
+		EXPECT_EQ(sink.m_viewport, viewport);
+		EXPECT_EQ(sink.m_clearColor[2], 0.25f);
+
+		//블럭을 넘겨 써도 순서대로 풀리고, Reset 뒤에는 있던 블럭을 다시 쓴다.
+		stream.Reset();
+		for (auto i : std::views::iota(0u, 10000u))
+			stream.DrawIndexedInstanced(i, 1, 0, 0, 0);
+		const size_t capacity = stream.GetCapacity();
+		EXPECT_GT(capacity, 64u * 1024u);
+
+		FakeCommandSink spill{};
+		stream.Replay(&spill);
+		EXPECT_EQ(spill.m_drawCount, 10000u);
+		EXPECT_EQ(spill.m_indexCountSum, 9999ull * 10000ull / 2ull);
+
+		stream.Reset();
+		for (auto i : std::views::iota(0u, 10000u))
+			stream.DrawIndexedInstanced(i, 1, 0, 0, 0);
+		EXPECT_EQ(stream.GetCapacity(), capacity);
+	}
+
+	//16개씩 같은 메쉬를 쓰는 물체를 그리는 패스
+	void RecordTestPass(CCommandStream* stream, GraphicsPSO pso, UINT itemCount)
+	{
+		stream->SetRootSignature(RootSignature::Common);
+		stream->SetRootShaderResource(1, 0x1000);
+		stream->SetViewport({ 0.0f, 0.0f, 800.0f, 600.0f, 0.0f, 1.0f });
+		stream->SetScissorRect({ 0, 0, 800, 600 });
+		stream->SetRenderTarget(0x10, 0x20);
+		stream->SetPipelineState(pso);
+		for (auto item : std::views::iota(0u, itemCount))
+		{
+			const UINT64 mesh = item / 16;
+			stream->SetVertexBuffer({ 0x100000 + mesh * 0x1000, 0x1000, 32 });
+			stream->SetIndexBuffer({ 0x200000 + mesh * 0x1000, 0x1000, DXGI_FORMAT_R32_UINT });
+			stream->SetPrimitiveTopology(4);
+			stream->SetRootShaderResource(0, 0x300000 + item * 64);
+			stream->DrawIndexedInstanced(36, 1, 0, 0, 0);
+		}
+	}
+
+	//그림자, 노멀, 메인 세 패스를 한 스레드에서 차례로 기록할 때와 스트림을 나눠 동시에 기록할 때를 잰다.
+	TEST(CCommandStream, Benchmark)
+	{
+		constexpr UINT itemCount = 20000;
+		const std::vector<GraphicsPSO> passes{ GraphicsPSO::ShadowMap, GraphicsPSO::DrawNormals, GraphicsPSO::Opaque };
+		std::vector<std::unique_ptr<CCommandStream>> streams{};
+		for (auto pass : passes)
+			streams.emplace_back(std::make_unique<CCommandStream>());
+
+		constexpr int loopCount = 20;
+		auto Measure = [loopCount](auto&& work) {
+			auto start = std::chrono::steady_clock::now();
+			for (auto loop : std::views::iota(0, loopCount)) work();
+			std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+			return time.count() / loopCount; };
+		auto Record = [&streams, &passes](size_t index) {
+			streams[index]->Reset();
+			RecordTestPass(streams[index].get(), passes[index], itemCount); };
+
+		const double serialTime = Measure([&]() {
+			for (auto index : std::views::iota(size_t{ 0 }, passes.size())) Record(index); });
+		//CDraw처럼 스레드는 한번만 띄워 두고 매번 깨우기만 한다
+		std::vector<std::function<void()>> jobs{};
+		for (auto index : std::views::iota(size_t{ 0 }, passes.size()))
+			jobs.emplace_back([&Record, index]() { Record(index); });
+		CFrameWorkers workers(std::move(jobs));
+		const double parallelTime = Measure([&workers]() { workers.Run(); });
+
+		FakeCommandSink sink{};
+		const double replayTime = Measure([&]() {
+			for (auto& stream : streams) stream->Replay(&sink); });
+		EXPECT_EQ(sink.m_drawCount, itemCount * passes.size() * loopCount);
+
+		const CommandStreamStats& stats = streams[0]->GetStats();
+		EXPECT_EQ(stats.drawCount, itemCount);
+		EXPECT_GT(stats.elidedCount, itemCount * 2);	//같은 메쉬의 버퍼와 토폴로지는 한번만 넣는다
+
+		std::cout << "CommandStream " << passes.size() << " passes x " << itemCount << " draws : record serial " << serialTime
+			<< " ms, parallel " << parallelTime << " ms, replay " << replayTime << " ms, "
+			<< stats.packetCount << " packets " << stats.elidedCount << " elided " << stats.bytes / 1024 << " KB" << std::endl;
+	}
+
+	TEST(CFrameWorkers, Run)
+	{
+		constexpr int runCount = 100;
+		const std::thread::id callerId = std::this_thread::get_id();
+		std::array<int, 3> counts{};
+		std::array<std::thread::id, 3> threadIds{};
+		std::vector<std::function<void()>> jobs{};
+		for (auto job : std::views::iota(size_t{ 0 }, counts.size()))
+			jobs.emplace_back([&counts, &threadIds, job]() { counts[job]++; threadIds[job] = std::this_thread::get_id(); });
+
+		CFrameWorkers workers(std::move(jobs));
+		for (auto run : std::views::iota(0, runCount))
+		{
+			workers.Run();
+			EXPECT_EQ(counts[2], run + 1);	//Run이 돌아오면 모든 일이 끝나 있다
+		}
+
+		EXPECT_TRUE(std::ranges::all_of(counts, [](int count) { return count == runCount; }));
+		EXPECT_EQ(threadIds[0], callerId);
+		EXPECT_NE(threadIds[1], callerId);
+		EXPECT_NE(threadIds[1], threadIds[2]);
+	}
+
+	//PSO와 인스턴스 주소를 넣은 순서대로 남긴다.
+	class OrderCommandSink : public FakeCommandSink
+	{
+	public:
+		virtual void SetPipelineState(GraphicsPSO pso) override { Call(); m_psos.emplace_back(pso); }
+		virtual void SetRootShaderResource(UINT slot, UINT64 address) override { Call(); m_addresses.emplace_back(address); }
+
+		std::vector<GraphicsPSO> m_psos{};
+		std::vector<UINT64> m_addresses{};
+	};
+
+	RenderDraw MakeTestDraw(GraphicsPSO pso, UINT geometry, UINT64 instanceAddress)
+	{
+		RenderDraw draw{};
+		draw.pso = pso;
+		draw.geometry = geometry;
+		draw.vertexBuffer = { 0x10000ull * (geometry + 1), 0x1000, 32 };
+		draw.indexBuffer = { 0x20000ull * (geometry + 1), 0x1000, DXGI_FORMAT_R32_UINT };
+		draw.topology = 4;
+		draw.instanceAddress = instanceAddress;
+		draw.indexCount = 36;
+		draw.instanceCount = 1;
+		return draw;
+	}
+
+	TEST(CRenderQueue, SortAndSubmit)
+	{
+		EXPECT_LT(CRenderQueue::MakeKey(0, GraphicsPSO::Opaque, 0, 1.5f, 0), CRenderQueue::MakeKey(0, GraphicsPSO::Opaque, 0, 2.0f, 0));
+		EXPECT_EQ(CRenderQueue::MakeKey(0, GraphicsPSO::Opaque, 0, -1.0f, 0), CRenderQueue::MakeKey(0, GraphicsPSO::Opaque, 0, 0.0f, 0));
+
+		//패스, PSO, 지오메트리, 깊이 순이 되도록 섞어서 넣는다
+		CRenderQueue queue{};
+		EXPECT_TRUE(queue.Add(1, 30.0f, MakeTestDraw(GraphicsPSO::Opaque, 1, 0x300)));
+		EXPECT_TRUE(queue.Add(0, 5.0f, MakeTestDraw(GraphicsPSO::ShadowMap, 1, 0x100)));
+		EXPECT_TRUE(queue.Add(1, 10.0f, MakeTestDraw(GraphicsPSO::Opaque, 1, 0x200)));
+		EXPECT_TRUE(queue.Add(1, 20.0f, MakeTestDraw(GraphicsPSO::Sky, 0, 0x400)));
+		EXPECT_TRUE(queue.Add(1, 0.0f, MakeTestDraw(GraphicsPSO::Opaque, 2, 0x500)));
+		EXPECT_TRUE(queue.Add(1, 15.0f, MakeTestDraw(GraphicsPSO::Opaque, 1, 0x600)));
+		EXPECT_FALSE(queue.Add(CRenderQueue::MaxPass, 0.0f, RenderDraw{}));
+		queue.Sort();
+		EXPECT_TRUE(std::ranges::is_sorted(queue.GetKeys()));
+
+		CCommandStream stream{};
+		queue.Submit(1, 3, &stream);
+		OrderCommandSink sink{};
+		stream.Replay(&sink);
+		EXPECT_EQ(sink.m_psos, (std::vector<GraphicsPSO>{ GraphicsPSO::Sky, GraphicsPSO::Opaque }));
+		EXPECT_EQ(sink.m_addresses, (std::vector<UINT64>{ 0x400, 0x200, 0x600, 0x300, 0x500 }));
+
+		//그릴 때마다 4개씩 넣으면 20개인데 PSO 2번, 지오메트리 3번만 바뀐다.
+		const RenderQueueStats& stats = queue.GetStats(1);
+		EXPECT_EQ(stats.drawCount, 5u);
+		EXPECT_EQ(stats.bindCount, 11u);
+		EXPECT_EQ(stats.elidedBindCount, 9u);
+		EXPECT_EQ(queue.GetStats(0).drawCount, 0u);
+
+		//덩어리 여러개로 나눠 정렬해도 std::sort와 같다.
+		CRenderQueue large{};
+		std::mt19937 random{ 7 };
+		for (auto i : std::views::iota(0u, 50000u))
+		{
+			const RenderDraw draw = MakeTestDraw(static_cast<GraphicsPSO>(random() % 8), random() % 100, 0);
+			EXPECT_TRUE(large.Add(random() % 3, static_cast<float>(random() % 1000), draw));
+		}
+		std::vector<UINT64> expected = large.GetKeys();
+		std::ranges::sort(expected);
+		large.Sort();
+		EXPECT_EQ(large.GetKeys(), expected);
+	}
+}
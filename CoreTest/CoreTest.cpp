@@ -1,4 +1,4 @@
-#include "pch.h"
+﻿#include "pch.h"
 #include <ranges>
 #include <algorithm>
 #include "../Include/Types.h"
@@ -7,6 +7,22 @@
 #include "../Core/Renderer.h"
 #include "../SecondPage/Window.h"
 #include "../Core/PipelineStateObjects.h"
+#include "../Core/UploadAllocator.h"
+#include "../Core/UploadBuffer.h"
+#include "../Core/StreamCopy.h"
+#include "../Core/DescriptorAllocator.h"
+#include "../Core/TextureFile.h"
+#include "../Core/TextureLoader.h"
+#include "../Core/TextureResidency.h"
+#include "../Core/ShaderCache.h"
+#include "../Core/BuildGraph.h"
+#include "../Core/PipelineKey.h"
+#include "../Core/FrameGraph.h"
+#include <filesystem>
+#include "../Include/FrameResourceData.h"
+#include <chrono>
+#include <thread>
+#include <iostream>
 
 namespace Core
 {
@@ -70,4 +86,682 @@ namespace Core
 		D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc{};
 		EXPECT_TRUE(shader->SetPipelineStateDesc(NormalOpaque, &psoDesc));
 	}
+
+	//GPU 없이 CPU 메모리로 페이지를 만들고 주소는 페이지마다 겹치지 않게 준다.
+	class CFakeUploadPageBackend : public IUploadPageBackend
+	{
+	public:
+		virtual bool CreatePage(UINT64 size, UploadPage* outPage) override
+		{
+			auto& memory = m_memory.emplace_back(std::make_unique<BYTE[]>(size));
+			outPage->mappedData = memory.get();
+			outPage->gpuAddress = m_nextAddress;
+			outPage->size = size;
+			m_nextAddress += size;
+			return true;
+		}
+
+		std::vector<std::unique_ptr<BYTE[]>> m_memory{};
+		D3D12_GPU_VIRTUAL_ADDRESS m_nextAddress{ 0x10000 };
+	};
+
+	TEST(CUploadAllocator, RingPages)
+	{
+		CFakeUploadPageBackend backend{};
+		CUploadAllocator allocator(&backend, 1024);
+
+		//같은 페이지 안에서는 정렬만 맞추어 이어서 잘라 준다.
+		UploadAllocation first{}, second{};
+		EXPECT_TRUE(allocator.Allocate(100, 256, &first));
+		EXPECT_TRUE(allocator.Allocate(100, 256, &second));
+		EXPECT_EQ(second.gpuAddress - first.gpuAddress, 256u);
+		EXPECT_EQ(second.cpuAddress - first.cpuAddress, 256);
+		EXPECT_EQ(second.gpuAddress % 256, 0u);
+
+		//남은 공간이 모자라면 새 페이지, 페이지보다 크면 그 크기의 페이지를 만든다.
+		UploadAllocation overflow{}, large{};
+		EXPECT_TRUE(allocator.Allocate(800, 256, &overflow));
+		EXPECT_TRUE(allocator.Allocate(4000, 256, &large));
+		EXPECT_EQ(allocator.GetPageCount(), 3u);
+		std::memset(large.cpuAddress, 0xff, large.size);
+
+		//펜스를 GPU가 지나기 전에는 새 페이지를 만든다.
+		allocator.FinishFrame(1);
+		UploadAllocation nextFrame{};
+		EXPECT_TRUE(allocator.Allocate(100, 256, &nextFrame));
+		EXPECT_EQ(allocator.GetPageCount(), 4u);
+		allocator.FinishFrame(2);
+
+		//지난 페이지를 다시 쓰고 더는 만들지 않는다.
+		allocator.Recycle(1);
+		EXPECT_EQ(allocator.GetFreePageCount(), 3u);
+		UploadAllocation recycled{};
+		EXPECT_TRUE(allocator.Allocate(2000, 256, &recycled));
+		EXPECT_EQ(recycled.gpuAddress, large.gpuAddress);
+		EXPECT_EQ(allocator.GetPageCount(), 4u);
+
+		allocator.FinishFrame(3);
+		allocator.Recycle(3);
+		EXPECT_EQ(allocator.GetFreePageCount(), 4u);
+		EXPECT_FALSE(allocator.Allocate(0, 256, &recycled));
+	}
+
+	TEST(CUploadBuffer, ChangedRange)
+	{
+		std::vector<UINT64> versions{ 1, 2, 3, 4, 5, 6 };
+		std::vector<UINT64> stored(versions.size(), 0);
+		std::vector<std::pair<size_t, size_t>> ranges{};
+		auto Collect = [&ranges](size_t begin, size_t end) { ranges.emplace_back(begin, end); };
+
+		//처음에는 전부 한 구간으로 올린다.
+		ForEachChangedRange(versions.data(), stored.data(), versions.size(), Collect);
+		EXPECT_EQ(ranges, (std::vector<std::pair<size_t, size_t>>{ { 0, 6 } }));
+		EXPECT_EQ(stored, versions);
+
+		//바뀐게 없으면 복사할 구간도 없다.
+		ranges.clear();
+		ForEachChangedRange(versions.data(), stored.data(), versions.size(), Collect);
+		EXPECT_TRUE(ranges.empty());
+
+		//이어진 원소는 한 구간으로 묶는다.
+		versions[1] = 7; versions[2] = 8; versions[5] = 9;
+		ForEachChangedRange(versions.data(), stored.data(), versions.size(), Collect);
+		EXPECT_EQ(ranges, (std::vector<std::pair<size_t, size_t>>{ { 1, 3 }, { 5, 6 } }));
+	}
+
+	//업로드 힙과 같은 write-combined 메모리에 예전 원소별 memcpy와 스트리밍 복사를 해 본다.
+	template<typename T>
+	void BenchmarkStreamCopy(const char* name, size_t dstStride, size_t count)
+	{
+		std::vector<T> src(count);
+		for (auto i : std::views::iota(size_t{ 0 }, src.size() * sizeof(T)))
+			reinterpret_cast<BYTE*>(src.data())[i] = static_cast<BYTE>(i * 7 + 1);
+
+		const size_t byteSize = dstStride * count;
+		BYTE* dst = static_cast<BYTE*>(VirtualAlloc(nullptr, byteSize,
+			MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE | PAGE_WRITECOMBINE));
+		ASSERT_NE(dst, nullptr);
+
+		constexpr int loopCount = 100;
+		auto Measure = [loopCount](auto&& copy) {
+			auto start = std::chrono::steady_clock::now();
+			for (auto loop : std::views::iota(0, loopCount)) copy();
+			std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+			return time.count() / loopCount; };
+
+		const double memcpyTime = Measure([&]() {
+			for (auto i : std::views::iota(size_t{ 0 }, count))
+				memcpy(&dst[dstStride * i], &src[i], sizeof(T)); });
+		const double streamTime = Measure([&]() {
+			StreamCopyStrided(dst, dstStride, src.data(), sizeof(T), sizeof(T), count); });
+
+		for (auto i : std::views::iota(size_t{ 0 }, count))
+			EXPECT_EQ(0, std::memcmp(&dst[dstStride * i], &src[i], sizeof(T)));
+		VirtualFree(dst, 0, MEM_RELEASE);
+
+		std::cout << name << " x " << count << (IsAvx2Supported() ? " (avx2)" : " (sse2)")
+			<< " : memcpy " << memcpyTime << " ms, stream " << streamTime << " ms" << std::endl;
+	}
+
+	TEST(CDescriptorAllocator, FreeListAndTransient)
+	{
+		CDescriptorAllocator allocator(10, 8);
+		DescriptorRange first{}, second{}, third{}, full{};
+		EXPECT_TRUE(allocator.Allocate(3, &first));
+		EXPECT_TRUE(allocator.Allocate(3, &second));
+		EXPECT_TRUE(allocator.Allocate(3, &third));
+		EXPECT_EQ(second.offset, 3u);
+		EXPECT_FALSE(allocator.Allocate(2, &full));
+
+		//지운 구간은 이웃과 합쳐져서 다시 통째로 쓸 수 있다.
+		allocator.Free(first);
+		allocator.Free(third);
+		EXPECT_EQ(allocator.GetFreeCount(), 7u);
+		allocator.Free(second);
+		EXPECT_TRUE(allocator.Allocate(10, &full));
+		EXPECT_EQ(full.offset, 0u);
+
+		//늘리면 늘어난 곳부터 주고, 임시 영역은 그 뒤로 밀린다.
+		allocator.Grow(16);
+		DescriptorRange grown{};
+		EXPECT_TRUE(allocator.Allocate(6, &grown));
+		EXPECT_EQ(grown.offset, 10u);
+		EXPECT_FALSE(allocator.Allocate(1, &full));
+
+		UINT transient{ 0u };
+		EXPECT_TRUE(allocator.AllocateTransient(5, &transient));
+		EXPECT_EQ(transient, 16u);
+		allocator.FinishFrame(1);
+		EXPECT_TRUE(allocator.AllocateTransient(2, &transient));
+		EXPECT_EQ(transient, 21u);
+		EXPECT_FALSE(allocator.AllocateTransient(2, &transient));
+		allocator.FinishFrame(2);
+
+		//1번 프레임이 끝나면 끝자리는 버리고 처음부터 다시 쓴다.
+		allocator.Recycle(1);
+		EXPECT_TRUE(allocator.AllocateTransient(4, &transient));
+		EXPECT_EQ(transient, 16u);
+		EXPECT_EQ(allocator.GetTransientUsed(), 7u);
+
+		allocator.FinishFrame(3);
+		allocator.Recycle(3);
+		EXPECT_EQ(allocator.GetTransientUsed(), 0u);
+	}
+
+	//장치 없이 작업 스레드에서 읽고 해석하는 단계만 돌린다.
+	TEST(CTextureLoader, ReadTexturesHeadless)
+	{
+		CTextureLoader loader(4);
+		std::vector<std::wstring> filenames{};
+		for (auto& entry : std::filesystem::recursive_directory_iterator(L"../Resource/Textures/"))
+		{
+			if (!entry.is_regular_file()) continue;
+			filenames.emplace_back(entry.path().wstring());
+			EXPECT_EQ(loader.Request(filenames.back()), filenames.size() - 1);
+		}
+		loader.Request(L"../Resource/Textures/NotExist.dds");
+		loader.WaitAll();
+		EXPECT_EQ(loader.GetPendingCount(), 0u);
+
+		std::vector<LoadedTexture> loadedTextures = loader.TakeLoaded();
+		ASSERT_EQ(loadedTextures.size(), filenames.size() + 1);
+		EXPECT_TRUE(loader.TakeLoaded().empty());
+
+		UINT boltFrameCount{ 0u };
+		for (auto& loaded : loadedTextures)
+		{
+			if (loaded.ticket == filenames.size())
+			{
+				EXPECT_EQ(loaded.data, nullptr);
+				continue;
+			}
+			ASSERT_NE(loaded.data, nullptr);
+
+			//밉과 배열 조각은 파일 끝까지 빈틈없이 이어진다.
+			const TextureData& data = *loaded.data;
+			EXPECT_EQ(data.subresources.size(), static_cast<size_t>(data.arraySize) * data.mipCount);
+			const TextureSubresource& last = data.subresources.back();
+			EXPECT_EQ(last.offset + last.slicePitch, data.bytes.size());
+
+			if (data.filename.find(L"BoltAnim") == std::wstring::npos) continue;
+			boltFrameCount++;
+			EXPECT_EQ(data.format, DXGI_FORMAT_R8G8B8A8_UNORM);
+			EXPECT_EQ(data.width, 512u);
+			EXPECT_EQ(data.height, 256u);
+		}
+		EXPECT_EQ(boltFrameCount, 60u);
+	}
+
+	TEST(TextureFile, ParseDds)
+	{
+		TextureData data{};
+		EXPECT_TRUE(ReadTextureFile(L"../Resource/Textures/WoodCrate01.dds", &data));
+		EXPECT_EQ(data.format, DXGI_FORMAT_BC3_UNORM);
+		EXPECT_EQ(data.mipCount, 10u);
+		EXPECT_EQ(data.subresources[1].width, 256u);
+		EXPECT_EQ(data.subresources[1].rowPitch, 64u * 16u);
+
+		TextureData tail{};
+		EXPECT_TRUE(MakeMipTail(data, 64, &tail));
+		EXPECT_EQ(tail.width, 64u);
+		EXPECT_EQ(tail.mipCount, 7u);
+		EXPECT_EQ(GetTextureBytes(tail), tail.bytes.size());
+		EXPECT_LT(GetTextureBytes(tail), GetTextureBytes(data) / 16);
+		EXPECT_EQ(GetMipTailStart(data, 0), data.mipCount);		//맞는 밉이 없다
+		EXPECT_FALSE(IsStreamable(data, 0));
+
+		EXPECT_TRUE(ReadTextureFile(L"../Resource/Textures/treearray.dds", &data));
+		EXPECT_EQ(data.arraySize, 3u);
+		EXPECT_EQ(data.subresources.size(), 30u);
+
+		//파일이 잘려 있으면 읽지 않는다.
+		std::vector<BYTE> truncated(data.bytes.begin(), data.bytes.begin() + data.bytes.size() / 2);
+		EXPECT_FALSE(ParseDds(std::move(truncated), &data));
+	}
+
+	//처음에는 작은 밉만 읽고, 남은 밉은 헤더를 다시 읽지 않고 파일의 그 구간만 읽는다.
+	TEST(TextureFile, StreamMips)
+	{
+		const std::wstring filename = L"../Resource/Textures/bricks_nmap.dds";
+		TextureData whole{};
+		EXPECT_TRUE(ReadTextureFile(filename, &whole));
+
+		TextureData streamed{};
+		EXPECT_TRUE(ReadTextureTail(filename, 64, &streamed));
+		EXPECT_EQ(streamed.firstLoadedMip, 3u);
+		EXPECT_EQ(streamed.firstLoadedMip + streamed.loadedMipCount, streamed.mipCount);
+		EXPECT_LT(streamed.bytes.size(), whole.bytes.size() / 32);
+
+		const TextureData layout = MakeLayout(streamed);
+		for (auto mip : std::views::iota(0u, streamed.firstLoadedMip) | std::views::reverse)
+		{
+			TextureData mipData = layout;
+			EXPECT_TRUE(ReadDdsMips(filename, mip, mip, &mipData));
+			EXPECT_EQ(mipData.bytes.size(), whole.subresources[mip].slicePitch);
+			EXPECT_EQ(0, std::memcmp(GetSubresourceData(mipData, mipData.subresources[mip]),
+				GetSubresourceData(whole, whole.subresources[mip]), mipData.bytes.size()));
+		}
+
+		//배열은 나눠 읽지 않고 통째로 읽는다.
+		EXPECT_TRUE(ReadTextureTail(L"../Resource/Textures/treearray.dds", 64, &streamed));
+		EXPECT_EQ(streamed.firstLoadedMip, 0u);
+		EXPECT_EQ(streamed.loadedMipCount, streamed.mipCount);
+	}
+
+	//GPU 대신 불린 순서만 적어 둔다.
+	class FakeResidencyBackend : public ITextureResidencyBackend
+	{
+	public:
+		virtual bool MakeResident(UINT textureId) override { m_resident.emplace_back(textureId); return true; }
+		virtual void Evict(UINT textureId) override { m_evicted.emplace_back(textureId); }
+
+		std::vector<UINT> m_resident{};
+		std::vector<UINT> m_evicted{};
+	};
+
+	TEST(CTextureResidency, BudgetAndLru)
+	{
+		FakeResidencyBackend backend{};
+		CTextureResidency residency(&backend, 1000);
+		residency.AddRef(0);
+		residency.AddRef(1);
+		residency.Admit(0, 400, 50);
+		residency.Admit(1, 400, 50);
+		residency.Admit(2, 100, 0);
+		EXPECT_EQ(residency.GetStats().residentBytes, 1000u);
+
+		//예산을 넘으면 참조가 없는 텍스쳐부터 내리고, 이번 프레임에 쓴 것은 남긴다.
+		residency.NextFrame();
+		residency.Use(0);
+		residency.Use(1);
+		residency.Admit(3, 200, 0);
+		EXPECT_EQ(backend.m_evicted, (std::vector<UINT>{ 2u }));
+		EXPECT_EQ(residency.GetStats().residentBytes, 1100u);
+
+		//그 다음은 가장 오래전에 쓴 텍스쳐. mip tail은 남는다.
+		residency.NextFrame();
+		residency.Use(1);
+		residency.Use(3);
+		residency.SetBudget(1000);
+		EXPECT_EQ(backend.m_evicted, (std::vector<UINT>{ 2u, 0u }));
+		EXPECT_FALSE(residency.IsResident(0));
+		EXPECT_EQ(residency.GetBytes(0), 50u);
+
+		//내린 텍스쳐를 다시 쓰면 한번만 올려 달라고 한다.
+		residency.NextFrame();
+		residency.Use(0);
+		residency.Use(0);
+		EXPECT_EQ(backend.m_resident, (std::vector<UINT>{ 0u }));
+		residency.Admit(0, 400, 50);
+		EXPECT_TRUE(residency.IsResident(0));
+		EXPECT_EQ(residency.GetStats().residentBytes, 900u);
+
+		const TextureResidencyStats& stats = residency.GetStats();
+		EXPECT_EQ(stats.hits, 4u);
+		EXPECT_EQ(stats.misses, 1u);
+		EXPECT_EQ(stats.evictions, 3u);
+		EXPECT_EQ(stats.peakBytes, 1200u);
+		EXPECT_EQ(residency.GetEvictionCount(0), 1u);
+	}
+
+	void WriteTextFile(const std::filesystem::path& filename, const std::string& contents)
+	{
+		std::ofstream fout(filename, std::ios::binary | std::ios::trunc);
+		fout << contents;
+	}
+
+	//include는 한번만 읽고, 키는 include 내용이나 컴파일 옵션이 바뀔 때만 바뀐다.
+	TEST(CShaderCache, KeyAndLookup)
+	{
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / L"ScribbleShaderCacheTest";
+		std::filesystem::remove_all(directory);
+		std::filesystem::create_directories(directory / L"Common");
+		WriteTextFile(directory / L"Common/Light.hlsli", "#include \"../Register.hlsli\"\nfloat3 Light() { return gColor; }\n");
+		WriteTextFile(directory / L"Register.hlsli", "float3 gColor : register(c0);\n");
+		WriteTextFile(directory / L"VS.hlsl", "#include \"Register.hlsli\"\n#include \"Common/Light.hlsli\"\nfloat4 main() : SV_POSITION { return float4(Light(), 1); }\n");
+
+		CIncludeCache includeCache{};
+		CShaderCache shaderCache((directory / L"Cache/").wstring());
+		ShaderCompileDesc desc{ (directory / L"VS.hlsl").wstring(), nullptr, "main", "vs_5_1", 0u };
+
+		std::string source{};
+		EXPECT_TRUE(includeCache.ExpandIncludes(desc.filename, &source));
+		EXPECT_EQ(std::ranges::count(source, '\n'), 4);
+		EXPECT_EQ(source.find("#include"), std::string::npos);
+
+		UINT64 key{ 0 }, sameKey{ 0 };
+		EXPECT_TRUE(shaderCache.MakeKey(&includeCache, desc, &key));
+		EXPECT_TRUE(shaderCache.MakeKey(&includeCache, desc, &sameKey));
+		EXPECT_EQ(key, sameKey);
+		EXPECT_EQ(includeCache.GetFileReadCount(), 3u);
+
+		auto KeyOf = [&shaderCache](CIncludeCache* cache, ShaderCompileDesc changed) {
+			UINT64 changedKey{ 0 };
+			EXPECT_TRUE(shaderCache.MakeKey(cache, changed, &changedKey));
+			return changedKey; };
+		const D3D_SHADER_MACRO defines[]{ { "SKINNED", "1" }, { nullptr, nullptr } };
+		EXPECT_NE(KeyOf(&includeCache, { desc.filename, nullptr, "main", "ps_5_1", 0u }), key);
+		EXPECT_NE(KeyOf(&includeCache, { desc.filename, nullptr, "main", "vs_5_1", 1u }), key);
+		EXPECT_NE(KeyOf(&includeCache, { desc.filename, defines, "main", "vs_5_1", 0u }), key);
+
+		//include 파일만 바뀌어도 새 키가 나온다.
+		WriteTextFile(directory / L"Register.hlsli", "float3 gColor : register(c1);\n");
+		CIncludeCache nextSession{};
+		EXPECT_NE(KeyOf(&nextSession, desc), key);
+
+		EXPECT_EQ(shaderCache.Load(key), nullptr);
+		const std::string byteCode{ "DXBC" };
+		EXPECT_TRUE(shaderCache.Store(key, byteCode.data(), byteCode.size()));
+		auto blob = shaderCache.Load(key);
+		EXPECT_NE(blob, nullptr);
+		EXPECT_EQ(blob->GetBufferSize(), byteCode.size());
+		EXPECT_EQ(std::memcmp(blob->GetBufferPointer(), byteCode.data(), byteCode.size()), 0);
+
+		//비어 있는 파일은 찾은 것으로 치지 않는다.
+		WriteTextFile(shaderCache.GetFilename(sameKey + 1), "");
+		EXPECT_EQ(shaderCache.Load(sameKey + 1), nullptr);
+		EXPECT_EQ(shaderCache.GetHitCount(), 1u);
+		EXPECT_EQ(shaderCache.GetMissCount(), 2u);
+		EXPECT_EQ(shaderCache.GetStoreCount(), 1u);
+
+		std::filesystem::remove_all(directory);
+	}
+
+	//컴파일 대신 잠깐 쉬고, 단계마다 몇 번째로 끝났는지 적어 둔다.
+	class FakePipelineCompiler : public IPipelineBuildSteps
+	{
+	public:
+		virtual bool BuildRootSignatures() override { return Step(m_rootSignature); }
+		virtual bool CompileShader(GraphicsPSO psoType, ShaderType shaderType) override
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			if (psoType == m_failPso && shaderType == ShaderType::PS) return false;
+			return Step(m_compiled[psoType][shaderType]);
+		}
+		virtual bool CreatePipelineState(GraphicsPSO psoType) override { return Step(m_created[psoType]); }
+
+		bool Step(UINT& outOrder)
+		{
+			std::lock_guard lock(m_mutex);
+			outOrder = ++m_order;
+			return true;
+		}
+
+		GraphicsPSO m_failPso{ GraphicsPSO::Debug };
+		std::mutex m_mutex{};
+		UINT m_order{ 0u };
+		UINT m_rootSignature{ 0u };
+		std::map<GraphicsPSO, std::map<ShaderType, UINT>> m_compiled{};
+		std::map<GraphicsPSO, UINT> m_created{};
+	};
+
+	TEST(CBuildGraph, PipelineDependencies)
+	{
+		std::map<GraphicsPSO, std::vector<ShaderType>> psoShaders{};
+		for (auto pso : { GraphicsPSO::Sky, GraphicsPSO::Opaque, GraphicsPSO::ShadowMap, GraphicsPSO::SsaoMap, GraphicsPSO::Debug })
+			psoShaders[pso] = { ShaderType::VS, ShaderType::PS };
+
+		FakePipelineCompiler compiler{};
+		CBuildGraph graph{};
+		AddPipelineTasks(&compiler, psoShaders, &graph);
+		EXPECT_FALSE(graph.Run(4));
+
+		//PSO는 루트 시그너쳐와 자기 셰이더가 다 끝난 뒤에 만든다.
+		for (auto& [pso, created] : compiler.m_created)
+		{
+			EXPECT_GT(created, compiler.m_rootSignature);
+			EXPECT_GT(created, compiler.m_compiled[pso][ShaderType::VS]);
+			EXPECT_GT(created, compiler.m_compiled[pso][ShaderType::PS]);
+		}
+
+		//컴파일이 실패한 PSO만 만들지 않는다.
+		EXPECT_EQ(compiler.m_created.size(), 4u);
+		EXPECT_FALSE(compiler.m_created.contains(GraphicsPSO::Debug));
+		EXPECT_EQ(graph.GetTimes().size(), 1u + 5u * 3u);
+		EXPECT_EQ(std::ranges::count_if(graph.GetTimes(), [](auto& time) { return !time.succeeded; }), 2);
+
+		//10번의 컴파일이 한 스레드에서 차례로 돌지 않는다.
+		EXPECT_GT(graph.GetMaxConcurrency(), 1u);
+	}
+
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC MakeTestPipelineDesc(const std::vector<BYTE>& vs, const std::vector<BYTE>& ps,
+		const std::vector<D3D12_INPUT_ELEMENT_DESC>& layout)
+	{
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC desc{};
+		desc.VS = { vs.data(), vs.size() };
+		desc.PS = { ps.data(), ps.size() };
+		desc.InputLayout = { layout.data(), static_cast<UINT>(layout.size()) };
+		desc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+		desc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+		desc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+		desc.SampleMask = UINT_MAX;
+		desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+		desc.NumRenderTargets = 1;
+		desc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
+		desc.DSVFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
+		desc.SampleDesc = { 1, 0 };
+		return desc;
+	}
+
+	//포인터가 달라도 내용이 같으면 같은 키, 결과가 달라지는 값이 하나라도 다르면 다른 키
+	TEST(PipelineKey, HashAndMerge)
+	{
+		const std::vector<BYTE> vs{ 1, 2, 3, 4 }, ps{ 5, 6, 7, 8 };
+		const std::vector<BYTE> vsCopy{ vs }, psCopy{ ps };
+		const std::vector<D3D12_INPUT_ELEMENT_DESC> layout{
+			{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 } };
+		const std::string semantic{ "POSITION" };
+		std::vector<D3D12_INPUT_ELEMENT_DESC> layoutCopy{ layout };
+		layoutCopy[0].SemanticName = semantic.c_str();
+
+		const D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = MakeTestPipelineDesc(vs, ps, layout);
+		const UINT64 key = HashPipelineDesc(desc, 0);
+		EXPECT_EQ(HashPipelineDesc(MakeTestPipelineDesc(vsCopy, psCopy, layoutCopy), 0), key);
+		EXPECT_NE(HashPipelineDesc(desc, 1), key);
+
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC changed = desc;
+		changed.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+		EXPECT_NE(HashPipelineDesc(changed, 0), key);
+		changed = desc;
+		changed.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;
+		EXPECT_NE(HashPipelineDesc(changed, 0), key);
+		changed = desc;
+		changed.RTVFormats[1] = DXGI_FORMAT_R16G16B16A16_FLOAT;	//쓰지 않는 렌더 타겟은 키에 들어가지 않는다
+		EXPECT_EQ(HashPipelineDesc(changed, 0), key);
+		const std::vector<BYTE> otherPs{ 5, 6, 7, 9 };
+		EXPECT_NE(HashPipelineDesc(MakeTestPipelineDesc(vs, otherPs, layout), 0), key);
+
+		//같은 키는 처음 요청한 쪽만 만들고 나머지는 그 결과를 기다린다.
+		CPipelineKeyTable keys{};
+		EXPECT_TRUE(keys.Claim(key));
+		bool waited{ false };
+		std::jthread waiter([&keys, &waited, key]() { waited = keys.Wait(key); });
+		EXPECT_FALSE(keys.Claim(key));
+		keys.Publish(key, true);
+		waiter.join();
+		EXPECT_TRUE(waited);
+		EXPECT_TRUE(keys.Claim(HashPipelineDesc(desc, 1)));
+		EXPECT_EQ(keys.GetKeyCount(), 2u);
+		EXPECT_EQ(keys.GetDuplicateCount(), 1u);
+	}
+
+	//다른 드라이버가 저장한 라이브러리는 읽지 않는다.
+	TEST(PipelineKey, LibraryFile)
+	{
+		const std::wstring filename = (std::filesystem::temp_directory_path() / L"ScribblePipelines.bin").wstring();
+		const DriverVersion driver{ 0x0001001e000d0000ull, 0x10de, 0x2484 };
+		const std::vector<BYTE> blob{ 9, 8, 7, 6, 5 };
+		EXPECT_TRUE(WritePipelineLibraryFile(filename, driver, blob.data(), blob.size()));
+
+		std::vector<BYTE> read{};
+		EXPECT_TRUE(ReadPipelineLibraryFile(filename, driver, &read));
+		EXPECT_EQ(read, blob);
+
+		DriverVersion updated{ driver };
+		updated.umdVersion++;
+		EXPECT_FALSE(ReadPipelineLibraryFile(filename, updated, &read));
+		EXPECT_FALSE(ReadPipelineLibraryFile(filename + L".missing", driver, &read));
+
+		std::filesystem::remove(filename);
+	}
+
+	//크기는 64KB 단위로 올려 계산하고, barrier는 ResourceBarrier 호출 단위로 모아 둔다.
+	class FakeFrameGraphBackend : public IFrameGraphBackend
+	{
+	public:
+		virtual UINT64 GetTextureSize(const FrameTextureDesc& desc) override
+		{
+			const UINT64 bytes = static_cast<UINT64>(desc.width) * desc.height * 4;
+			return (bytes + 65535) / 65536 * 65536;
+		}
+		virtual bool CreateTransients(UINT64 heapBytes, const std::vector<TransientPlacement>& placements) override
+		{
+			m_heapBytes = heapBytes;
+			m_placements = placements;
+			return true;
+		}
+		virtual void ResourceBarriers(const std::vector<FrameBarrier>& barriers) override { m_batches.emplace_back(barriers); }
+		virtual void Discard(UINT resource) override { m_discards.emplace_back(resource); }
+
+		UINT64 m_heapBytes{ 0 };
+		std::vector<TransientPlacement> m_placements{};
+		std::vector<std::vector<FrameBarrier>> m_batches{};
+		std::vector<UINT> m_discards{};
+	};
+
+	//CDraw와 같은 패스 구성. 손으로 걸던 20번보다 깊이 버퍼를 읽을 때 바꾸는 2번이 늘고, 호출은 11번으로 준다.
+	TEST(CFrameGraph, SsaoPasses)
+	{
+		CFrameGraph graph{};
+		std::vector<std::string> executed{};
+		auto Pass = [&graph, &executed](std::string name) {
+			return graph.AddPass(name, [&executed, name]() { executed.emplace_back(name); }); };
+
+		const D3D12_RESOURCE_STATES srv = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+		const D3D12_RESOURCE_STATES rt = D3D12_RESOURCE_STATE_RENDER_TARGET;
+		const D3D12_RESOURCE_STATES depthRead = D3D12_RESOURCE_STATE_DEPTH_READ | srv;
+		const UINT shadowMap = graph.ImportTexture("ShadowMap", D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_GENERIC_READ);
+		const UINT depth = graph.ImportTexture("Depth", D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+		const UINT backBuffer = graph.ImportTexture("BackBuffer", D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PRESENT);
+		const UINT normalMap = graph.CreateTexture("NormalMap", { 800, 600, DXGI_FORMAT_R16G16B16A16_FLOAT });
+		const UINT ambientMap0 = graph.CreateTexture("AmbientMap0", { 400, 300, DXGI_FORMAT_R16_UNORM });
+		const UINT ambientMap1 = graph.CreateTexture("AmbientMap1", { 400, 300, DXGI_FORMAT_R16_UNORM });
+		const UINT debugView = graph.CreateTexture("DebugView", { 800, 600, DXGI_FORMAT_R8G8B8A8_UNORM });
+
+		graph.Write(Pass("Shadow"), shadowMap, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+		const UINT normals = Pass("Normals");
+		graph.Write(normals, normalMap, rt);
+		graph.Write(normals, depth, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+		const UINT ssao = Pass("Ssao");
+		graph.Read(ssao, normalMap, srv);
+		graph.Read(ssao, depth, depthRead);
+		graph.Write(ssao, ambientMap0, rt);
+		for (auto i : std::views::iota(0, 3))
+		{
+			for (auto horzBlur : { true, false })
+			{
+				const UINT blur = Pass(horzBlur ? "BlurH" : "BlurV");
+				graph.Read(blur, normalMap, srv);
+				graph.Read(blur, depth, depthRead);
+				graph.Read(blur, horzBlur ? ambientMap0 : ambientMap1, srv);
+				graph.Write(blur, horzBlur ? ambientMap1 : ambientMap0, rt);
+			}
+		}
+		const UINT debug = Pass("Debug");	//아무도 읽지 않아서 빠진다
+		graph.Read(debug, normalMap, srv);
+		graph.Write(debug, debugView, rt);
+		const UINT main = Pass("Main");
+		graph.Read(main, shadowMap, D3D12_RESOURCE_STATE_GENERIC_READ);
+		graph.Read(main, ambientMap0, srv);
+		graph.Write(main, depth, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+		graph.Write(main, backBuffer, rt);
+
+		FakeFrameGraphBackend backend{};
+		EXPECT_TRUE(graph.Compile(&backend));
+		EXPECT_TRUE(graph.IsCulled(debug));
+		EXPECT_FALSE(graph.IsCulled(main));
+
+		const FrameGraphStats& stats = graph.GetStats();
+		EXPECT_EQ(stats.culledPassCount, 1u);
+		EXPECT_EQ(stats.barrierCount, 22u);
+		EXPECT_EQ(stats.barrierBatchCount, 11u);
+		EXPECT_EQ(stats.aliasingBarrierCount, 0u);
+		EXPECT_EQ(backend.m_placements.size(), 3u);
+		EXPECT_EQ(stats.heapBytes, stats.transientBytes);	//블러가 노멀맵까지 읽어서 세 텍스쳐가 다 같이 살아 있다
+
+		graph.Execute(&backend);
+		EXPECT_EQ(executed.size(), 10u);
+		EXPECT_EQ(executed.front(), "Shadow");
+		EXPECT_EQ(executed.back(), "Main");
+		EXPECT_EQ(backend.m_batches.size(), 11u);
+		EXPECT_EQ(backend.m_batches.back().size(), 1u);
+		EXPECT_EQ(backend.m_batches.back()[0].after, D3D12_RESOURCE_STATE_PRESENT);
+
+		//임시 텍스쳐는 프레임이 끝난 상태로 만들어 두어서 다음 프레임도 그대로 이어진다.
+		auto barriers = backend.m_batches | std::views::join;
+		for (auto& placement : backend.m_placements)
+		{
+			auto first = std::ranges::find_if(barriers, [&placement](auto& barrier) {
+				return barrier.resource == placement.resource; });
+			EXPECT_EQ(first->before, placement.initialState);
+		}
+	}
+
+	//T1과 T3는 살아 있는 구간이 겹치지 않아서 같은 메모리를 쓴다.
+	TEST(CFrameGraph, AliasTransients)
+	{
+		CFrameGraph graph{};
+		const D3D12_RESOURCE_STATES srv = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+		const D3D12_RESOURCE_STATES rt = D3D12_RESOURCE_STATE_RENDER_TARGET;
+		const FrameTextureDesc desc{ 256, 256, DXGI_FORMAT_R8G8B8A8_UNORM };
+		const UINT t1 = graph.CreateTexture("T1", desc);
+		const UINT t2 = graph.CreateTexture("T2", desc);
+		const UINT t3 = graph.CreateTexture("T3", desc);
+		const UINT backBuffer = graph.ImportTexture("BackBuffer", D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PRESENT);
+
+		const UINT a = graph.AddPass("A", []() {});
+		graph.Write(a, t1, rt);
+		const UINT b = graph.AddPass("B", []() {});
+		graph.Read(b, t1, srv);
+		graph.Write(b, t2, rt);
+		const UINT c = graph.AddPass("C", []() {});
+		graph.Read(c, t2, srv);
+		graph.Write(c, t3, rt);
+		const UINT d = graph.AddPass("D", []() {});
+		graph.Read(d, t3, srv);
+		graph.Write(d, backBuffer, rt);
+
+		FakeFrameGraphBackend backend{};
+		EXPECT_TRUE(graph.Compile(&backend));
+
+		const FrameGraphStats& stats = graph.GetStats();
+		const UINT64 size = 256 * 256 * 4;
+		EXPECT_EQ(stats.transientBytes, size * 3);
+		EXPECT_EQ(stats.heapBytes, size * 2);
+		EXPECT_EQ(stats.aliasingBarrierCount, 2u);
+		EXPECT_EQ(backend.m_placements[t1].offset, backend.m_placements[t3].offset);
+		EXPECT_NE(backend.m_placements[t1].offset, backend.m_placements[t2].offset);
+
+		//같은 메모리를 넘겨 받는 텍스쳐는 처음 쓸 때 내용을 버린다.
+		graph.Execute(&backend);
+		EXPECT_EQ(backend.m_discards, (std::vector<UINT>{ t1, t3 }));
+		EXPECT_EQ(backend.m_batches[0][0].type, FrameBarrier::Type::Aliasing);
+
+		//겹쳐 놓은 텍스쳐를 쓰기 전에 읽으면 컴파일하지 않는다.
+		CFrameGraph readFirst{};
+		const UINT r1 = readFirst.CreateTexture("R1", desc);
+		const UINT r2 = readFirst.CreateTexture("R2", desc);
+		readFirst.Write(readFirst.AddPass("A", []() {}), r1, rt);
+		readFirst.Read(readFirst.AddPass("B", []() {}, true), r1, srv);
+		readFirst.Read(readFirst.AddPass("C", []() {}, true), r2, srv);
+		readFirst.Write(readFirst.AddPass("D", []() {}, true), r2, rt);
+		EXPECT_FALSE(readFirst.Compile(&backend));
+	}
+
+	TEST(StreamCopy, Benchmark)
+	{
+		BenchmarkStreamCopy<PassConstants>("PassConstants", CoreUtil::CalcConstantBufferByteSize(sizeof(PassConstants)), 4096);
+		BenchmarkStreamCopy<InstanceBuffer>("InstanceBuffer", sizeof(InstanceBuffer), 65536);
+		BenchmarkStreamCopy<MaterialBuffer>("MaterialBuffer", sizeof(MaterialBuffer), 65536);
+	}
 }
@@ -21,7 +21,7 @@ namespace Render
 
 		void Excute(int a) override
 		{
-			//a ȭ鿡 Ѹ.
+			//a를 화면에 뿌린다.
 			return;
 		}
 	};
@@ -64,11 +64,11 @@ namespace Render
 	TEST(RendererTest, Excute)
 	{
 		UITest uiTest(5);
-		//ڷ CRenderer  óϰ
+		//자료는 CRenderer가 다 처리하고
 		CRenderer UI;
 		uiTest.Load(UI);
 
-		//Draw Լ ׽Ʈ ¥ GTestRenderer ä ׽ƮѴ.
+		//Draw 함수 테스트는 가짜 GTestRenderer가 가로채서 테스트한다.
 		GTestRenderer testUI;
 		uiTest.Draw(testUI);
 	}
@@ -113,7 +113,7 @@ namespace STD
 		std::map<int, int> mItems = { {1, 1}, {2, 2} };
 		auto tmItems = std::views::all(mItems) | std::views::filter([](auto& iter) { return iter.first == 1; });
 
-		//filter ΰ͸ ´.
+		//filter는 참인것만 담는다.
 		std::vector<int> vItems = { 1, 2, 3, 4, 5, 6 };
 		auto tvItems = vItems | std::ranges::views::filter([](auto n)
 			{
@@ -123,7 +123,7 @@ namespace STD
 		std::vector<int> v = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
 		auto rng = std::ranges::views::all(v)
 			| std::ranges::views::filter([](int a) {
-			return a % 2 == 0; }); // ¦ ͸
+			return a % 2 == 0; }); // 짝수만 필터링
 		for (auto& t : rng)
 		{
 			int a = 1;
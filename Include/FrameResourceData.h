@@ -21,7 +21,7 @@ enum class eBufferType : int
     NoType = 0,
     PassCB,
     SsaoCB,
-    SkinnedCB,
+    BonePalette,
     Instance,
     Material,
 };
@@ -67,17 +67,12 @@ struct SsaoConstants
     float surfaceEpsilon{ 0.05f };
 };
 
-struct SkinnedConstants
-{
-    DirectX::XMFLOAT4X4 boneTransforms[96]{};
-};
-
 struct InstanceBuffer
 {
     DirectX::XMFLOAT4X4 world{};
     DirectX::XMFLOAT4X4 texTransform{};
     UINT     materialIndex{ 0u };
-    UINT     objPad0{ 0u };
+    UINT     paletteOffset{ 0u };
     UINT     objPad1{ 0u };
     UINT     objPad2{ 0u };
 };
@@ -96,7 +91,7 @@ struct MaterialBuffer
     UINT materialPad2{ 0u };
 };
 
-//geometry  struct
+//geometry 관련 struct
 struct Vertex
 {
     Vertex() = default;
@@ -0,0 +1,55 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+constexpr std::uint32_t gInvalidId{ UINT32_MAX };
+
+//로드할 때 이름을 0부터 빈틈없이 이어지는 번호로 한번만 바꿔 둔다.
+//매 프레임 도는 쪽은 번호로 배열을 바로 찾고 문자열은 만지지 않는다.
+template<typename Name>
+class CIdRegistry
+{
+public:
+	std::uint32_t Register(const Name& name);
+	std::uint32_t Find(const Name& name) const;
+	void Clear();
+
+	inline const Name& GetName(std::uint32_t id) const;
+	inline std::uint32_t Count() const;
+
+private:
+	std::unordered_map<Name, std::uint32_t> m_ids{};
+	std::vector<Name> m_names{};
+};
+
+//이미 있는 이름이면 예전 번호를 돌려준다.
+template<typename Name>
+std::uint32_t CIdRegistry<Name>::Register(const Name& name)
+{
+	auto [iter, inserted] = m_ids.try_emplace(name, static_cast<std::uint32_t>(m_names.size()));
+	if (inserted) m_names.emplace_back(name);
+
+	return iter->second;
+}
+
+template<typename Name>
+std::uint32_t CIdRegistry<Name>::Find(const Name& name) const
+{
+	auto find = m_ids.find(name);
+	return (find != m_ids.end()) ? find->second : gInvalidId;
+}
+
+template<typename Name>
+void CIdRegistry<Name>::Clear()
+{
+	m_ids.clear();
+	m_names.clear();
+}
+
+template<typename Name>
+inline const Name& CIdRegistry<Name>::GetName(std::uint32_t id) const { return m_names[id]; }
+template<typename Name>
+inline std::uint32_t CIdRegistry<Name>::Count() const { return static_cast<std::uint32_t>(m_names.size()); }
@@ -0,0 +1,77 @@
+﻿#pragma once
+
+#include <DirectXMath.h>
+#include <span>
+#include <vector>
+#include "./IdRegistry.h"
+
+struct InstanceData
+{
+	DirectX::XMMATRIX world{};
+	DirectX::XMMATRIX texTransform{};
+	UINT materialId{ gInvalidId };	//머터리얼 버퍼에서의 위치. 로드할 때 이름에서 바꿔 둔다.
+	UINT paletteOffset{ 0u };	//스키닝 인스턴스의 본 행렬이 팔레트 버퍼에서 시작하는 위치
+};
+
+//지운 뒤에 같은 자리를 다시 쓰면 generation이 달라서 예전 핸들은 무효가 된다.
+struct InstanceHandle
+{
+	UINT slot{ gInvalidId };
+	UINT generation{ 0u };
+};
+
+//인스턴스 값을 항목별로 빈틈없는 배열에 나눠 둔다. 컬링과 업로드는 span을 그대로 돈다.
+//지울 때는 마지막 인스턴스를 빈 자리로 옮겨서 배열에 구멍이 생기지 않게 하고,
+//핸들은 slot을 거쳐서 옮겨진 위치를 찾는다.
+class CInstanceStore
+{
+	struct Slot
+	{
+		UINT index{ gInvalidId };
+		UINT generation{ 0u };
+	};
+
+public:
+	CInstanceStore();
+	~CInstanceStore();
+
+	InstanceHandle Add(const InstanceData& data);
+	bool Remove(InstanceHandle handle);
+	bool IsValid(InstanceHandle handle) const;
+	UINT GetIndex(InstanceHandle handle) const;
+	InstanceData Get(UINT index) const;
+	void Reserve(std::size_t count);
+	void Clear();
+
+	inline UINT Size() const;
+	inline bool Empty() const;
+	inline std::span<DirectX::XMMATRIX> GetWorlds();
+	inline std::span<const DirectX::XMMATRIX> GetWorlds() const;
+	inline std::span<DirectX::XMMATRIX> GetTexTransforms();
+	inline std::span<const DirectX::XMMATRIX> GetTexTransforms() const;
+	inline std::span<UINT> GetMaterialIds();
+	inline std::span<const UINT> GetMaterialIds() const;
+	inline std::span<UINT> GetPaletteOffsets();
+	inline std::span<const UINT> GetPaletteOffsets() const;
+
+private:
+	std::vector<DirectX::XMMATRIX> m_worlds;
+	std::vector<DirectX::XMMATRIX> m_texTransforms;
+	std::vector<UINT> m_materialIds;
+	std::vector<UINT> m_paletteOffsets;
+
+	std::vector<UINT> m_indexToSlot;
+	std::vector<Slot> m_slots;
+	std::vector<UINT> m_freeSlots;
+};
+
+inline UINT CInstanceStore::Size() const { return static_cast<UINT>(m_worlds.size()); }
+inline bool CInstanceStore::Empty() const { return m_worlds.empty(); }
+inline std::span<DirectX::XMMATRIX> CInstanceStore::GetWorlds() { return m_worlds; }
+inline std::span<const DirectX::XMMATRIX> CInstanceStore::GetWorlds() const { return m_worlds; }
+inline std::span<DirectX::XMMATRIX> CInstanceStore::GetTexTransforms() { return m_texTransforms; }
+inline std::span<const DirectX::XMMATRIX> CInstanceStore::GetTexTransforms() const { return m_texTransforms; }
+inline std::span<UINT> CInstanceStore::GetMaterialIds() { return m_materialIds; }
+inline std::span<const UINT> CInstanceStore::GetMaterialIds() const { return m_materialIds; }
+inline std::span<UINT> CInstanceStore::GetPaletteOffsets() { return m_paletteOffsets; }
+inline std::span<const UINT> CInstanceStore::GetPaletteOffsets() const { return m_paletteOffsets; }
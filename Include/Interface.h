@@ -1,10 +1,11 @@
-#pragma once
+﻿#pragma once
 
 #include <functional>
 #include <map>
 #include <string>
 #include <vector>
 #include <set>
+#include <span>
 #include <memory>
 #include <unordered_map>
 #include <combaseapi.h>
@@ -39,10 +40,27 @@ interface IRenderer
 	virtual bool LoadMesh(GraphicsPSO pso, const void* verticesData, const void* indicesData, RenderItem* renderItem) = 0;
 	virtual bool LoadTexture(const TextureList& textureList, std::vector<std::wstring>* srvFilename) = 0;
 	virtual bool SetUploadBuffer(eBufferType bufferType, const void* bufferData, size_t dataSize) = 0;
+	virtual bool MapUploadBuffer(eBufferType bufferType, size_t dataSize, void** outData) = 0;
+	virtual bool UpdateUploadBuffer(eBufferType bufferType, const void* bufferData, const UINT64* versions, size_t dataSize) = 0;
+	virtual UINT64 GetUploadedBytes() = 0;
+	virtual void AddTextureRefs(const std::vector<UINT>& srvIndices) = 0;
+	virtual void ReleaseTextureRefs(const std::vector<UINT>& srvIndices) = 0;
+	virtual void UseTextures(const std::vector<UINT>& srvIndices) = 0;
 	virtual bool PrepareFrame() = 0;
 	virtual bool Draw(AllRenderItems& renderItem) = 0;
 
 	virtual void Set4xMsaaState(HWND hwnd, int widht, int height, bool value) = 0;
 };
 
+//업로드 버퍼 안을 T 배열로 받아서 임시 배열 없이 그 자리에 바로 만든다.
+//매핑할 수 없는 버퍼(상수 버퍼처럼 원소 간격이 다른)면 빈 span을 돌려준다.
+template<typename T>
+std::span<T> MapUploadSpan(IRenderer* renderer, eBufferType bufferType, size_t count)
+{
+	void* mappedData{ nullptr };
+	if (!renderer->MapUploadBuffer(bufferType, count, &mappedData)) return {};
+
+	return std::span<T>(static_cast<T*>(mappedData), count);
+}
+
 std::unique_ptr<IRenderer> CreateRenderer(const std::wstring& resPath, HWND hwnd, int width, int height, const ShaderFileList& fileList);
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include <memory>
 #include <string>
 #include <d3d12.h>
+#include "./IdRegistry.h"
+#include "./InstanceStore.h"
 
 struct Material;
 struct Geometry;
@@ -16,15 +18,6 @@ struct InstanceBuffer;
 struct SubmeshGeometry;
 enum class GraphicsPSO : int;
 
-struct InstanceData
-{
-	DirectX::XMMATRIX world{};
-	DirectX::XMMATRIX texTransform{};
-	std::string matName{};
-};
-
-using InstanceDataList = std::vector<std::shared_ptr<InstanceData>>;
-
 struct SubItem
 {
 	UINT indexCount{ 0u };
@@ -41,13 +34,14 @@ struct SubRenderItem
 
 	SubItem subItem{};
 
-	InstanceDataList instanceDataList{};		//ġ ͸  
-	bool cullingFrustum{ false };		//ī޶ ø
-	UINT instanceCount{ 0 };			// νϽ
-	int startSubIndexInstance{ 0 };	//ȿ 󸶳  ִ 
+	CInstanceStore instances{};		//위치나 머터리얼 같은 정보들
+	bool cullingFrustum{ false };		//카메라 컬링여부
+	UINT instanceCount{ 0 };			//총 인스턴스
+	int startSubIndexInstance{ 0 };	//서브안에서 얼마나 떨어져 있는지 
+	float viewDepth{ 0.0f };			//보이는 인스턴스 중 카메라와 가장 가까운 거리. 그리는 순서를 정할 때 쓴다
 };
 
-using SubRenderItems = std::unordered_map<std::string, SubRenderItem>;
+using SubRenderItems = std::vector<SubRenderItem>;
 
 struct RenderItem
 {
@@ -66,6 +60,7 @@ struct RenderItem
 	int startIndexInstance{ 0 };
 
 	SubRenderItems subRenderItems{};
+	CIdRegistry<std::string> meshIds{};	//메쉬 이름으로 subRenderItems의 위치를 찾는다.
 
 	int NumFramesDirty{ 0 };
 
@@ -2,9 +2,9 @@
 #include <array>
 #include <wrl.h>
 
-//ٸ rootSignature ־ srv ϳ 迭 ϱ  ε ߺǾ ȵȴ.
-//rootSignature  srv  Ͱ register ޶  ε ϳ 迭 ε ̱
-//  .
+//다른 rootSignature에 있어도 srv는 하나의 배열을 사용하기 때문에 인덱스가 중복되어서는 안된다.
+//rootSignature에 같은 srv를 쓰는 데이터가 register가 달라도 이 인덱스는 하나의 배열에서의 인덱스 이기
+//때문에 같을수가 없다.
 enum class SrvOffset : int
 {
 	ShadowMap,
@@ -37,3 +37,9 @@ enum class GraphicsPSO : int
 	SsaoBlur,
 	Debug,
 };
+
+enum class RootSignature : int
+{
+	Common = 0,
+	Ssao,
+};
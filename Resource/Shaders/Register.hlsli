@@ -8,7 +8,7 @@ struct InstanceData
     float4x4 World;
     float4x4 TexTransform;
     uint MaterialIndex;
-    uint InstPad0;
+    uint PaletteOffset;
     uint InstPad1;
     uint InstPad2;
 };
@@ -48,18 +48,14 @@ cbuffer PassCB : register(b0)
     Light gLights[MaxLights];
 };
 
-cbuffer cbSkinned : register(b1)
-{
-    float4x4 gBoneTransforms[96];
-};
-
 StructuredBuffer<MaterialData> gMaterialData : register(t0, space1);
 StructuredBuffer<InstanceData> gInstanceData : register(t1, space1);
+StructuredBuffer<float4x4> gBoneTransforms : register(t2, space1);
 
 Texture2D gShadowMap : register(t0);
 Texture2D gSsaoMap : register(t1);
 TextureCube gCubeMap : register(t2);
-Texture2D gDiffuseMap[60] : register(t3); //t1...t7
+Texture2D gDiffuseMap[] : register(t3); //t3부터. 크기를 정하지 않아서 텍스쳐 구간이 늘어난 만큼 쓴다
 
 SamplerState gsamPointWrap : register(s0);
 SamplerState gsamPointClamp : register(s1);
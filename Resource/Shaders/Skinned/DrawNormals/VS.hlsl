@@ -29,9 +29,9 @@ VertexOut main(VertexIn vin, uint instanceID : SV_InstanceID)
         // Assume no nonuniform scaling when transforming normals, so 
         // that we do not have to use the inverse-transpose.
 
-        bonePosL += weights[i] * mul(float4(vin.PosL, 1.0f), gBoneTransforms[vin.BoneIndices[i]]).xyz;
-        boneNormalL += weights[i] * mul(vin.NormalL, (float3x3) gBoneTransforms[vin.BoneIndices[i]]);
-        boneTangentL += weights[i] * mul(vin.TangentL, (float3x3) gBoneTransforms[vin.BoneIndices[i]]);
+        bonePosL += weights[i] * mul(float4(vin.PosL, 1.0f), gBoneTransforms[instData.PaletteOffset + vin.BoneIndices[i]]).xyz;
+        boneNormalL += weights[i] * mul(vin.NormalL, (float3x3) gBoneTransforms[instData.PaletteOffset + vin.BoneIndices[i]]);
+        boneTangentL += weights[i] * mul(vin.TangentL, (float3x3) gBoneTransforms[instData.PaletteOffset + vin.BoneIndices[i]]);
     }
 
     vin.PosL = bonePosL;
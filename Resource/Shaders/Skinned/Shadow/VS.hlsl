@@ -26,7 +26,7 @@ VertexOut main(VertexIn vin, uint instanceID : SV_InstanceID)
         // Assume no nonuniform scaling when transforming normals, so 
         // that we do not have to use the inverse-transpose.
 
-        posL += weights[i] * mul(float4(vin.PosL, 1.0f), gBoneTransforms[vin.BoneIndices[i]]).xyz;
+        posL += weights[i] * mul(float4(vin.PosL, 1.0f), gBoneTransforms[instData.PaletteOffset + vin.BoneIndices[i]]).xyz;
     }
 
     vin.PosL = posL;
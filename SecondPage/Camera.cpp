@@ -1,8 +1,8 @@
 ﻿#include "pch.h"
 #include "./Camera.h"
 #include "../Include/FrameResourceData.h"
-#include "../Include/RenderItem.h"
 #include "./MathHelper.h"
+#include "./Culling.h"
 #include "./Utility.h"
 
 using namespace DirectX;
@@ -23,8 +23,7 @@ CCamera::CCamera()
 	SetSpeed(10.0f);
 }
 
-CCamera::~CCamera()
-{}
+CCamera::~CCamera() = default;
 
 void CCamera::PressedKey(std::vector<int> keyList)
 {
@@ -88,7 +87,6 @@ void CCamera::SetLens(float fovY, float aspect, float zn, float zf)
 	mFarWindowHeight  = 2.0f * mFarZ * tanf( 0.5f*mFovY );
 
 	XMMATRIX P = XMMatrixPerspectiveFovLH(mFovY, mAspect, mNearZ, mFarZ);
-	BoundingFrustum::CreateFromMatrix(m_camFrustum, P);
 	XMStoreFloat4x4(&mProj, P);
 }
 
@@ -288,42 +286,8 @@ void CCamera::UpdateViewMatrix()
 	mViewDirty = false;
 }
 
-bool CCamera::IsInsideFrustum(const DirectX::BoundingSphere& bSphere, const XMMATRIX& invView, const XMMATRIX& world)
+//컬링은 CModel이 작업 스레드로 나눠서 한다. 카메라는 월드 공간 평면만 만든다.
+void CCamera::GetFrustumPlanes(FrustumPlanes& outPlanes)
 {
-	BoundingFrustum frustum{};
-	XMMATRIX invWorld = XMMatrixInverse(&RvToLv(XMMatrixDeterminant(world)), world);
-	XMMATRIX viewToLocal = XMMatrixMultiply(invView, invWorld);
-
-	m_camFrustum.Transform(frustum, viewToLocal);
-
-	const bool isInside = (frustum.Contains(bSphere) != DirectX::DISJOINT);
-	return (isInside || !m_frustumCullingEnabled);
-}
-
-void CCamera::FindVisibleSubRenderItems(SubRenderItems& subRenderItems, InstanceDataList& visibleInstance)
-{
-	XMMATRIX view = GetView();
-	XMMATRIX invView = XMMatrixInverse(&RvToLv(XMMatrixDeterminant(view)), view);
-
-	int startSubIndex{ 0 };
-	for (auto& iterSubItem : subRenderItems)
-	{
-		InstanceDataList curVisible{};
-		auto& subRenderItem = iterSubItem.second;
-		auto& instanceList = subRenderItem.instanceDataList;
-		if (subRenderItem.cullingFrustum)
-		{
-			std::ranges::copy_if(instanceList, std::back_inserter(curVisible),
-				[this, &invView, &subRenderItem](auto& instance) {
-					return IsInsideFrustum(subRenderItem.subItem.boundingSphere, invView, instance->world);
-				});
-		}
-		else
-			std::ranges::copy(instanceList, std::back_inserter(curVisible));
-		subRenderItem.startSubIndexInstance = startSubIndex;
-		subRenderItem.instanceCount = static_cast<UINT>(curVisible.size());
-		startSubIndex += subRenderItem.instanceCount;
-
-		visibleInstance.insert(visibleInstance.end(), curVisible.begin(), curVisible.end()); 
-	}
+	ExtractFrustumPlanes(XMMatrixMultiply(GetView(), GetProj()), outPlanes);
 }
\ No newline at end of file
@@ -1,7 +1,5 @@
 ﻿#pragma once
 
-struct InstanceData;
-struct SubRenderItem;
 struct PassConstants;
 
 enum class eMove : int
@@ -19,13 +17,13 @@ enum class eMove : int
 
 class CCamera
 {
-	using SubRenderItems = std::unordered_map<std::string, SubRenderItem>;
-	using InstanceDataList = std::vector<std::shared_ptr<InstanceData>>;
-
 public:
 	CCamera();
 	~CCamera();
 
+	CCamera(const CCamera&) = delete;
+	CCamera& operator=(const CCamera&) = delete;
+
 	void PressedKey(std::vector<int> keyList);
 
 	DirectX::XMFLOAT3 GetPosition() const;
@@ -72,14 +70,11 @@ public:
 	void Update(float deltaTime);
 	void UpdateViewMatrix();
 
-	void FindVisibleSubRenderItems(SubRenderItems& subRenderItems, InstanceDataList& visibleInstance);
+	void GetFrustumPlanes(std::array<DirectX::XMFLOAT4, 6>& outPlanes);
+	inline bool IsFrustumCullingEnabled() const;
 
 private:
 	void SetLens(float fovY, float aspect, float zn, float zf);
-	bool IsInsideFrustum(
-		const DirectX::BoundingSphere& bSphere, 
-		const DirectX::XMMATRIX& invView, 
-		const DirectX::XMMATRIX& world);
 
 private:
 	DirectX::XMVECTOR m_position{ 0.0f, 0.0f, 0.0f };
@@ -102,6 +97,7 @@ private:
 	std::map<eMove, float> m_moveSpeed{};
 	std::vector<eMove> m_moveDirection{};
 
-	DirectX::BoundingFrustum m_camFrustum{};
 	bool m_frustumCullingEnabled{ true };
 };
+
+inline bool CCamera::IsFrustumCullingEnabled() const { return m_frustumCullingEnabled; }
@@ -0,0 +1,91 @@
+﻿#include "pch.h"
+#include "./Culling.h"
+#include <bit>
+
+using namespace DirectX;
+
+void CullingSpheres::Clear()
+{
+	for (auto channel : { &x, &y, &z, &radius })
+		channel->clear();
+}
+
+//비균등 스케일이면 가장 큰 축의 배율로 반지름을 늘린다.
+void CullingSpheres::Add(const BoundingSphere& localSphere, FXMMATRIX world)
+{
+	XMFLOAT3 center{};
+	XMStoreFloat3(&center, XMVector3Transform(XMLoadFloat3(&localSphere.Center), world));
+
+	XMVECTOR scale = XMVectorMax(XMVector3LengthSq(world.r[0]),
+		XMVectorMax(XMVector3LengthSq(world.r[1]), XMVector3LengthSq(world.r[2])));
+
+	x.emplace_back(center.x);
+	y.emplace_back(center.y);
+	z.emplace_back(center.z);
+	radius.emplace_back(localSphere.Radius * std::sqrt(XMVectorGetX(scale)));
+}
+
+//행벡터 기준 viewProj의 열로 클립 공간 경계 평면을 만든다. (z는 0 ~ w)
+void ExtractFrustumPlanes(FXMMATRIX viewProj, FrustumPlanes& outPlanes)
+{
+	XMMATRIX columns = XMMatrixTranspose(viewProj);
+	const std::array<XMVECTOR, 6> planes{
+		columns.r[3] + columns.r[0],	//left
+		columns.r[3] - columns.r[0],	//right
+		columns.r[3] + columns.r[1],	//bottom
+		columns.r[3] - columns.r[1],	//top
+		columns.r[2],					//near
+		columns.r[3] - columns.r[2] };	//far
+
+	for (auto i : std::views::iota(0u, static_cast<UINT>(planes.size())))
+		XMStoreFloat4(&outPlanes[i], XMPlaneNormalize(planes[i]));
+}
+
+inline XMVECTOR LoadFour(const std::vector<float>& channel, UINT index, UINT count)
+{
+	if (count == 4)
+		return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&channel[index]));
+
+	XMFLOAT4 values{ 0.0f, 0.0f, 0.0f, 0.0f };
+	std::copy_n(&channel[index], count, &values.x);
+	return XMLoadFloat4(&values);
+}
+
+//구 4개를 평면 6개에 한번에 비교해서 보이는 구의 인덱스만 앞에서부터 채운다.
+UINT CullSpheres(const FrustumPlanes& planes, const CullingSpheres& spheres, std::vector<UINT>& outVisible)
+{
+	std::array<XMVECTOR, 6> a{}, b{}, c{}, d{};
+	for (auto i : std::views::iota(0u, static_cast<UINT>(planes.size())))
+	{
+		a[i] = XMVectorReplicate(planes[i].x);
+		b[i] = XMVectorReplicate(planes[i].y);
+		c[i] = XMVectorReplicate(planes[i].z);
+		d[i] = XMVectorReplicate(planes[i].w);
+	}
+
+	const UINT sphereCount = spheres.Count();
+	outVisible.resize(sphereCount);
+	UINT visibleCount{ 0u };
+	for (UINT i = 0; i < sphereCount; i += 4)
+	{
+		const UINT laneCount = std::min(4u, sphereCount - i);
+		XMVECTOR x = LoadFour(spheres.x, i, laneCount);
+		XMVECTOR y = LoadFour(spheres.y, i, laneCount);
+		XMVECTOR z = LoadFour(spheres.z, i, laneCount);
+		XMVECTOR negRadius = -LoadFour(spheres.radius, i, laneCount);
+
+		XMVECTOR outside = XMVectorFalseInt();
+		for (auto p : std::views::iota(0u, static_cast<UINT>(planes.size())))
+		{
+			XMVECTOR distance = XMVectorMultiplyAdd(a[p], x, XMVectorMultiplyAdd(b[p], y, XMVectorMultiplyAdd(c[p], z, d[p])));
+			outside = XMVectorOrInt(outside, XMVectorLess(distance, negRadius));
+		}
+
+		unsigned int visibleMask = ~static_cast<unsigned int>(_mm_movemask_ps(outside)) & ((1u << laneCount) - 1u);
+		for (; visibleMask != 0; visibleMask &= visibleMask - 1u)
+			outVisible[visibleCount++] = i + static_cast<UINT>(std::countr_zero(visibleMask));
+	}
+	outVisible.resize(visibleCount);
+
+	return visibleCount;
+}
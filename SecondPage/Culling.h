@@ -0,0 +1,43 @@
+﻿#pragma once
+
+//월드 공간으로 옮긴 바운딩 구를 SoA로 모아 두고 절두체 평면 6개와 4개씩 비교한다.
+//인스턴스마다 역행렬을 구하고 절두체를 로컬로 옮기던 방식 대신 구만 한번 옮긴다.
+struct CullingSpheres
+{
+	void Clear();
+	void Add(const DirectX::BoundingSphere& localSphere, DirectX::FXMMATRIX world);
+	inline UINT Count() const;
+
+	std::vector<float> x{};
+	std::vector<float> y{};
+	std::vector<float> z{};
+	std::vector<float> radius{};
+};
+
+struct RenderItem;
+struct SubRenderItem;
+
+//작업 스레드 하나가 맡는 단위. 서브 아이템 하나의 [begin, end) 인스턴스를 컬링하고
+//보이는 인스턴스를 outputOffset부터 인스턴스 버퍼에 쓴다. 버퍼는 프레임마다 재사용한다.
+struct CullingJob
+{
+	RenderItem* renderItem{ nullptr };
+	SubRenderItem* subRenderItem{ nullptr };
+	UINT begin{ 0u };
+	UINT end{ 0u };
+	UINT outputOffset{ 0u };
+	CullingSpheres spheres{};
+	std::vector<UINT> visible{};
+	std::vector<UINT> materials{};	//보이는 인스턴스가 쓰는 머터리얼 번호. 겹치지 않는다
+	float nearestDepthSq{ FLT_MAX };	//보이는 인스턴스 중 카메라와 가장 가까운 거리의 제곱
+};
+
+constexpr UINT gCullingJobSize = 1024u;
+
+//평면의 법선은 절두체 안쪽을 향한다. ax + by + cz + d >= 0 이 안쪽
+using FrustumPlanes = std::array<DirectX::XMFLOAT4, 6>;
+
+void ExtractFrustumPlanes(DirectX::FXMMATRIX viewProj, FrustumPlanes& outPlanes);
+UINT CullSpheres(const FrustumPlanes& planes, const CullingSpheres& spheres, std::vector<UINT>& outVisible);
+
+inline UINT CullingSpheres::Count() const { return static_cast<UINT>(x.size()); }
@@ -54,12 +54,11 @@ RenderItem* MakeRenderItem(AllRenderItems& allRenderItems, GraphicsPSO pso)
 SubRenderItem* GetSubRenderItem(RenderItem* renderItem, const std::string& meshName)
 {
 	SubRenderItems& subRItems = renderItem->subRenderItems;
-	auto findSubRItems = subRItems.find(meshName);
+	const UINT meshId = renderItem->meshIds.Register(meshName);
+	if (meshId >= subRItems.size())
+		subRItems.resize(meshId + 1);
 
-	if (findSubRItems != subRItems.end())
-		return &findSubRItems->second;
-
-	return &subRItems[meshName];
+	return &subRItems[meshId];
 }
 
 SubRenderItem* MakeSubRenderItem(AllRenderItems& allRenderItems, GraphicsPSO pso, const std::string& meshName)
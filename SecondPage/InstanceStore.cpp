@@ -0,0 +1,118 @@
+﻿#include "pch.h"
+#include "../Include/InstanceStore.h"
+
+CInstanceStore::CInstanceStore()
+	: m_worlds{}
+	, m_texTransforms{}
+	, m_materialIds{}
+	, m_paletteOffsets{}
+	, m_indexToSlot{}
+	, m_slots{}
+	, m_freeSlots{}
+{}
+CInstanceStore::~CInstanceStore() = default;
+
+InstanceHandle CInstanceStore::Add(const InstanceData& data)
+{
+	UINT slot{ 0u };
+	if (m_freeSlots.empty())
+	{
+		slot = static_cast<UINT>(m_slots.size());
+		m_slots.emplace_back();
+	}
+	else
+	{
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+
+	const UINT index = Size();
+	m_worlds.emplace_back(data.world);
+	m_texTransforms.emplace_back(data.texTransform);
+	m_materialIds.emplace_back(data.materialId);
+	m_paletteOffsets.emplace_back(data.paletteOffset);
+	m_indexToSlot.emplace_back(slot);
+	m_slots[slot].index = index;
+
+	return InstanceHandle{ slot, m_slots[slot].generation };
+}
+
+bool CInstanceStore::Remove(InstanceHandle handle)
+{
+	if (!IsValid(handle)) return false;
+
+	Slot& removed = m_slots[handle.slot];
+	const UINT index = removed.index;
+	const UINT last = Size() - 1;
+	if (index != last)
+	{
+		m_worlds[index] = m_worlds[last];
+		m_texTransforms[index] = m_texTransforms[last];
+		m_materialIds[index] = m_materialIds[last];
+		m_paletteOffsets[index] = m_paletteOffsets[last];
+		m_indexToSlot[index] = m_indexToSlot[last];
+		m_slots[m_indexToSlot[index]].index = index;
+	}
+	m_worlds.pop_back();
+	m_texTransforms.pop_back();
+	m_materialIds.pop_back();
+	m_paletteOffsets.pop_back();
+	m_indexToSlot.pop_back();
+
+	removed.index = gInvalidId;
+	removed.generation++;
+	m_freeSlots.emplace_back(handle.slot);
+
+	return true;
+}
+
+bool CInstanceStore::IsValid(InstanceHandle handle) const
+{
+	if (handle.slot >= m_slots.size()) return false;
+
+	const Slot& slot = m_slots[handle.slot];
+	return slot.index != gInvalidId && slot.generation == handle.generation;
+}
+
+UINT CInstanceStore::GetIndex(InstanceHandle handle) const
+{
+	return IsValid(handle) ? m_slots[handle.slot].index : gInvalidId;
+}
+
+InstanceData CInstanceStore::Get(UINT index) const
+{
+	InstanceData data{};
+	data.world = m_worlds[index];
+	data.texTransform = m_texTransforms[index];
+	data.materialId = m_materialIds[index];
+	data.paletteOffset = m_paletteOffsets[index];
+
+	return data;
+}
+
+void CInstanceStore::Reserve(std::size_t count)
+{
+	m_worlds.reserve(count);
+	m_texTransforms.reserve(count);
+	m_materialIds.reserve(count);
+	m_paletteOffsets.reserve(count);
+	m_indexToSlot.reserve(count);
+	m_slots.reserve(count);
+}
+
+//핸들을 모두 무효로 만들어야 해서 slot은 남겨 두고 generation만 올린다.
+void CInstanceStore::Clear()
+{
+	for (auto slot : m_indexToSlot)
+	{
+		m_slots[slot].index = gInvalidId;
+		m_slots[slot].generation++;
+		m_freeSlots.emplace_back(slot);
+	}
+
+	m_worlds.clear();
+	m_texTransforms.clear();
+	m_materialIds.clear();
+	m_paletteOffsets.clear();
+	m_indexToSlot.clear();
+}
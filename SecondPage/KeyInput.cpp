@@ -52,7 +52,7 @@ void CKeyInput::DraggedMouse(float dx, float dy)
 
 void CKeyInput::CheckInput()
 {
-	//ӽ÷ GetAsyncKeyState Ű  ߴ. ߿ ٸ input ٲ 
+	//임시로 GetAsyncKeyState로 키 눌림을 구현했다. 나중에 다른 input으로 바꿀 예정
 	PressedKeyList([]()->std::vector<int> {
 		std::vector<int> keyList{ 'W', 'S', 'D', 'A', '1', '2' };
 		std::vector<int> pressedKeyList{};
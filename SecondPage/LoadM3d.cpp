@@ -3,16 +3,19 @@
 #include "SkinnedData.h"
 #include "../Include/FrameResourceData.h"
 #include "./SkinnedData.h"
+#include "./TextScanner.h"
+#include "./Utility.h"
 
 using namespace DirectX;
 
-bool CLoadM3D::Read(const std::wstring& filename, 
+bool CLoadM3D::Read(const std::wstring& filename,
 						std::vector<Vertex>& vertices,
 						std::vector<std::int32_t>& indices,
 						std::vector<Subset>& subsets,
 						std::vector<M3dMaterial>& mats)
 {
-	std::ifstream fin(filename);
+	CTextScanner scanner;
+	ReturnIfFalse(scanner.Open(filename));
 
 	UINT numMaterials = 0;
 	UINT numVertices  = 0;
@@ -20,25 +23,19 @@ bool CLoadM3D::Read(const std::wstring& filename,
 	UINT numBones     = 0;
 	UINT numAnimationClips = 0;
 
-	std::string ignore;
+	ReturnIfFalse(scanner.Skip()); // file header text
+	ReturnIfFalse(scanner.ReadLabeled(numMaterials));
+	ReturnIfFalse(scanner.ReadLabeled(numVertices));
+	ReturnIfFalse(scanner.ReadLabeled(numTriangles));
+	ReturnIfFalse(scanner.ReadLabeled(numBones));
+	ReturnIfFalse(scanner.ReadLabeled(numAnimationClips));
 
-	if( fin )
-	{
-		fin >> ignore; // file header text
-		fin >> ignore >> numMaterials;
-		fin >> ignore >> numVertices;
-		fin >> ignore >> numTriangles;
-		fin >> ignore >> numBones;
-		fin >> ignore >> numAnimationClips;
- 
-		ReadMaterials(fin, numMaterials, mats);
-		ReadSubsetTable(fin, numMaterials, subsets);
-	    ReadVertices(fin, numVertices, vertices);
-	    ReadTriangles(fin, numTriangles, indices);
- 
-		return true;
-	 }
-    return false;
+	ReturnIfFalse(ReadMaterials(scanner, numMaterials, mats));
+	ReturnIfFalse(ReadSubsetTable(scanner, numMaterials, subsets));
+	ReturnIfFalse(ReadVertices(scanner, numVertices, vertices));
+	ReturnIfFalse(ReadTriangles(scanner, numTriangles, indices));
+
+	return true;
 }
 
 bool CLoadM3D::Read(const std::wstring& filename,
@@ -48,7 +45,8 @@ bool CLoadM3D::Read(const std::wstring& filename,
 						std::vector<M3dMaterial>& mats,
 						CSkinnedData* skinInfo)
 {
-    std::ifstream fin(filename);
+	CTextScanner scanner;
+	ReturnIfFalse(scanner.Open(filename));
 
 	UINT numMaterials = 0;
 	UINT numVertices  = 0;
@@ -56,206 +54,192 @@ bool CLoadM3D::Read(const std::wstring& filename,
 	UINT numBones     = 0;
 	UINT numAnimationClips = 0;
 
-	std::string ignore;
+	ReturnIfFalse(scanner.Skip()); // file header text
+	ReturnIfFalse(scanner.ReadLabeled(numMaterials));
+	ReturnIfFalse(scanner.ReadLabeled(numVertices));
+	ReturnIfFalse(scanner.ReadLabeled(numTriangles));
+	ReturnIfFalse(scanner.ReadLabeled(numBones));
+	ReturnIfFalse(scanner.ReadLabeled(numAnimationClips));
 
-	if( fin )
-	{
-		fin >> ignore; // file header text
-		fin >> ignore >> numMaterials;
-		fin >> ignore >> numVertices;
-		fin >> ignore >> numTriangles;
-		fin >> ignore >> numBones;
-		fin >> ignore >> numAnimationClips;
- 
-		std::vector<XMFLOAT4X4> boneOffsets;
-		std::vector<int> boneIndexToParentIndex;
-		std::unordered_map<std::string, AnimationClip> animations;
-
-		ReadMaterials(fin, numMaterials, mats);
-		ReadSubsetTable(fin, numMaterials, subsets);
-	    ReadSkinnedVertices(fin, numVertices, vertices);
-	    ReadTriangles(fin, numTriangles, indices);
-		ReadBoneOffsets(fin, numBones, boneOffsets);
-	    ReadBoneHierarchy(fin, numBones, boneIndexToParentIndex);
-	    ReadAnimationClips(fin, numBones, numAnimationClips, animations);
- 
-		skinInfo->Set(boneIndexToParentIndex, boneOffsets, animations);
-
-	    return true;
-	}
-    return false;
+	std::vector<XMFLOAT4X4> boneOffsets;
+	std::vector<int> boneIndexToParentIndex;
+	std::unordered_map<std::string, AnimationClip> animations;
+
+	ReturnIfFalse(ReadMaterials(scanner, numMaterials, mats));
+	ReturnIfFalse(ReadSubsetTable(scanner, numMaterials, subsets));
+	ReturnIfFalse(ReadSkinnedVertices(scanner, numVertices, vertices));
+	ReturnIfFalse(ReadTriangles(scanner, numTriangles, indices));
+	ReturnIfFalse(ReadBoneOffsets(scanner, numBones, boneOffsets));
+	ReturnIfFalse(ReadBoneHierarchy(scanner, numBones, boneIndexToParentIndex));
+	ReturnIfFalse(ReadAnimationClips(scanner, numBones, numAnimationClips, animations));
+
+	skinInfo->Set(boneIndexToParentIndex, boneOffsets, animations);
+
+	return true;
 }
 
-void CLoadM3D::ReadMaterials(std::ifstream& fin, UINT numMaterials, std::vector<M3dMaterial>& mats)
+bool CLoadM3D::ReadMaterials(CTextScanner& scanner, UINT numMaterials, std::vector<M3dMaterial>& mats)
 {
-	 std::string ignore;
-     mats.resize(numMaterials);
-
-	 std::string diffuseMapName;
-	 std::string normalMapName;
-
-     fin >> ignore; // materials header text
-	 for(UINT i = 0; i < numMaterials; ++i)
-	 {
-         fin >> ignore >> mats[i].name;
-		 fin >> ignore >> mats[i].diffuseAlbedo.x  >> mats[i].diffuseAlbedo.y  >> mats[i].diffuseAlbedo.z;
-		 fin >> ignore >> mats[i].fresnelR0.x >> mats[i].fresnelR0.y >> mats[i].fresnelR0.z;
-         fin >> ignore >> mats[i].roughness;
-		 fin >> ignore >> mats[i].alphaClip;
-		 fin >> ignore >> mats[i].materialTypeName;
-		 fin >> ignore >> mats[i].diffuseMapName;
-		 fin >> ignore >> mats[i].normalMapName;
-		}
+	mats.resize(numMaterials);
+
+	ReturnIfFalse(scanner.Skip()); // materials header text
+	for (auto& mat : mats)
+	{
+		ReturnIfFalse(scanner.ReadLabeled(mat.name));
+		ReturnIfFalse(scanner.ReadLabeled(mat.diffuseAlbedo.x, mat.diffuseAlbedo.y, mat.diffuseAlbedo.z));
+		ReturnIfFalse(scanner.ReadLabeled(mat.fresnelR0.x, mat.fresnelR0.y, mat.fresnelR0.z));
+		ReturnIfFalse(scanner.ReadLabeled(mat.roughness));
+		ReturnIfFalse(scanner.ReadLabeled(mat.alphaClip));
+		ReturnIfFalse(scanner.ReadLabeled(mat.materialTypeName));
+		ReturnIfFalse(scanner.ReadLabeled(mat.diffuseMapName));
+		ReturnIfFalse(scanner.ReadLabeled(mat.normalMapName));
+	}
+
+	return true;
 }
 
-void CLoadM3D::ReadSubsetTable(std::ifstream& fin, UINT numSubsets, std::vector<Subset>& subsets)
+bool CLoadM3D::ReadSubsetTable(CTextScanner& scanner, UINT numSubsets, std::vector<Subset>& subsets)
 {
-    std::string ignore;
 	subsets.resize(numSubsets);
 
-	fin >> ignore; // subset header text
-	for(UINT i = 0; i < numSubsets; ++i)
+	ReturnIfFalse(scanner.Skip()); // subset header text
+	for (auto& subset : subsets)
 	{
-        fin >> ignore >> subsets[i].id;
-		fin >> ignore >> subsets[i].vertexStart;
-		fin >> ignore >> subsets[i].vertexCount;
-		fin >> ignore >> subsets[i].faceStart;
-		fin >> ignore >> subsets[i].faceCount;
-    }
+		ReturnIfFalse(scanner.ReadLabeled(subset.id));
+		ReturnIfFalse(scanner.ReadLabeled(subset.vertexStart));
+		ReturnIfFalse(scanner.ReadLabeled(subset.vertexCount));
+		ReturnIfFalse(scanner.ReadLabeled(subset.faceStart));
+		ReturnIfFalse(scanner.ReadLabeled(subset.faceCount));
+	}
+
+	return true;
 }
 
-void CLoadM3D::ReadVertices(std::ifstream& fin, UINT numVertices, std::vector<Vertex>& vertices)
+bool CLoadM3D::ReadVertices(CTextScanner& scanner, UINT numVertices, std::vector<Vertex>& vertices)
 {
-	std::string ignore;
-    vertices.resize(numVertices);
-
-    fin >> ignore; // vertices header text
-    for(UINT i = 0; i < numVertices; ++i)
-    {
-	    fin >> ignore >> vertices[i].pos.x      >> vertices[i].pos.y      >> vertices[i].pos.z;
-		fin >> ignore >> vertices[i].tangentU.x >> vertices[i].tangentU.y >> vertices[i].tangentU.z;// >> vertices[i].tangentU.w;
-	    fin >> ignore >> vertices[i].normal.x   >> vertices[i].normal.y   >> vertices[i].normal.z;
-	    fin >> ignore >> vertices[i].texC.x     >> vertices[i].texC.y;
-    }
+	vertices.resize(numVertices);
+
+	ReturnIfFalse(scanner.Skip()); // vertices header text
+	for (auto& vertex : vertices)
+	{
+		ReturnIfFalse(scanner.ReadLabeled(vertex.pos.x, vertex.pos.y, vertex.pos.z));
+		ReturnIfFalse(scanner.ReadLabeled(vertex.tangentU.x, vertex.tangentU.y, vertex.tangentU.z));
+		ReturnIfFalse(scanner.ReadLabeled(vertex.normal.x, vertex.normal.y, vertex.normal.z));
+		ReturnIfFalse(scanner.ReadLabeled(vertex.texC.x, vertex.texC.y));
+	}
+
+	return true;
 }
 
-void CLoadM3D::ReadSkinnedVertices(std::ifstream& fin, UINT numVertices, std::vector<SkinnedVertex>& vertices)
+bool CLoadM3D::ReadSkinnedVertices(CTextScanner& scanner, UINT numVertices, std::vector<SkinnedVertex>& vertices)
 {
-	std::string ignore;
-    vertices.resize(numVertices);
+	vertices.resize(numVertices);
 
-    fin >> ignore; // vertices header text
+	ReturnIfFalse(scanner.Skip()); // vertices header text
 	int boneIndices[4];
 	float weights[4];
-    for(UINT i = 0; i < numVertices; ++i)
-    {
-        float blah;
-	    fin >> ignore >> vertices[i].Pos.x        >> vertices[i].Pos.y          >> vertices[i].Pos.z;
-		fin >> ignore >> vertices[i].TangentU.x   >> vertices[i].TangentU.y     >> vertices[i].TangentU.z >> blah /*vertices[i].TangentU.w*/;
-	    fin >> ignore >> vertices[i].Normal.x     >> vertices[i].Normal.y       >> vertices[i].Normal.z;
-	    fin >> ignore >> vertices[i].TexC.x       >> vertices[i].TexC.y;
-		fin >> ignore >> weights[0]     >> weights[1]     >> weights[2]     >> weights[3];
-		fin >> ignore >> boneIndices[0] >> boneIndices[1] >> boneIndices[2] >> boneIndices[3];
-
-		vertices[i].BoneWeights.x = weights[0];
-		vertices[i].BoneWeights.y = weights[1];
-		vertices[i].BoneWeights.z = weights[2];
-
-		vertices[i].BoneIndices[0] = (BYTE)boneIndices[0]; 
-		vertices[i].BoneIndices[1] = (BYTE)boneIndices[1]; 
-		vertices[i].BoneIndices[2] = (BYTE)boneIndices[2]; 
-		vertices[i].BoneIndices[3] = (BYTE)boneIndices[3]; 
-    }
-}
+	for (auto& vertex : vertices)
+	{
+		float blah;
+		ReturnIfFalse(scanner.ReadLabeled(vertex.Pos.x, vertex.Pos.y, vertex.Pos.z));
+		ReturnIfFalse(scanner.ReadLabeled(vertex.TangentU.x, vertex.TangentU.y, vertex.TangentU.z, blah /*vertex.TangentU.w*/));
+		ReturnIfFalse(scanner.ReadLabeled(vertex.Normal.x, vertex.Normal.y, vertex.Normal.z));
+		ReturnIfFalse(scanner.ReadLabeled(vertex.TexC.x, vertex.TexC.y));
+		ReturnIfFalse(scanner.ReadLabeled(weights[0], weights[1], weights[2], weights[3]));
+		ReturnIfFalse(scanner.ReadLabeled(boneIndices[0], boneIndices[1], boneIndices[2], boneIndices[3]));
+
+		vertex.BoneWeights.x = weights[0];
+		vertex.BoneWeights.y = weights[1];
+		vertex.BoneWeights.z = weights[2];
+
+		vertex.BoneIndices[0] = (BYTE)boneIndices[0];
+		vertex.BoneIndices[1] = (BYTE)boneIndices[1];
+		vertex.BoneIndices[2] = (BYTE)boneIndices[2];
+		vertex.BoneIndices[3] = (BYTE)boneIndices[3];
+	}
 
-void CLoadM3D::ReadTriangles(std::ifstream& fin, UINT numTriangles, std::vector<std::int32_t>& indices)
-{
-	std::string ignore;
-    indices.resize(numTriangles*3);
-
-    fin >> ignore; // triangles header text
-    for(UINT i = 0; i < numTriangles; ++i)
-    {
-        fin >> indices[i*3+0] >> indices[i*3+1] >> indices[i*3+2];
-    }
+	return true;
 }
- 
-void CLoadM3D::ReadBoneOffsets(std::ifstream& fin, UINT numBones, std::vector<XMFLOAT4X4>& boneOffsets)
+
+bool CLoadM3D::ReadTriangles(CTextScanner& scanner, UINT numTriangles, std::vector<std::int32_t>& indices)
 {
-	std::string ignore;
-    boneOffsets.resize(numBones);
-
-    fin >> ignore; // BoneOffsets header text
-    for(UINT i = 0; i < numBones; ++i)
-    {
-        fin >> ignore >> 
-            boneOffsets[i](0,0) >> boneOffsets[i](0,1) >> boneOffsets[i](0,2) >> boneOffsets[i](0,3) >>
-            boneOffsets[i](1,0) >> boneOffsets[i](1,1) >> boneOffsets[i](1,2) >> boneOffsets[i](1,3) >>
-            boneOffsets[i](2,0) >> boneOffsets[i](2,1) >> boneOffsets[i](2,2) >> boneOffsets[i](2,3) >>
-            boneOffsets[i](3,0) >> boneOffsets[i](3,1) >> boneOffsets[i](3,2) >> boneOffsets[i](3,3);
-    }
+	indices.resize(numTriangles * 3);
+
+	ReturnIfFalse(scanner.Skip()); // triangles header text
+	for (auto& index : indices)
+		ReturnIfFalse(scanner.Read(index));
+
+	return true;
 }
 
-void CLoadM3D::ReadBoneHierarchy(std::ifstream& fin, UINT numBones, std::vector<int>& boneIndexToParentIndex)
+bool CLoadM3D::ReadBoneOffsets(CTextScanner& scanner, UINT numBones, std::vector<XMFLOAT4X4>& boneOffsets)
 {
-	std::string ignore;
-    boneIndexToParentIndex.resize(numBones);
+	boneOffsets.resize(numBones);
 
-    fin >> ignore; // BoneHierarchy header text
-	for(UINT i = 0; i < numBones; ++i)
+	ReturnIfFalse(scanner.Skip()); // BoneOffsets header text
+	for (auto& offset : boneOffsets)
 	{
-	    fin >> ignore >> boneIndexToParentIndex[i];
+		ReturnIfFalse(scanner.ReadLabeled(
+			offset(0, 0), offset(0, 1), offset(0, 2), offset(0, 3),
+			offset(1, 0), offset(1, 1), offset(1, 2), offset(1, 3),
+			offset(2, 0), offset(2, 1), offset(2, 2), offset(2, 3),
+			offset(3, 0), offset(3, 1), offset(3, 2), offset(3, 3)));
 	}
+
+	return true;
+}
+
+bool CLoadM3D::ReadBoneHierarchy(CTextScanner& scanner, UINT numBones, std::vector<int>& boneIndexToParentIndex)
+{
+	boneIndexToParentIndex.resize(numBones);
+
+	ReturnIfFalse(scanner.Skip()); // BoneHierarchy header text
+	for (auto& parentIndex : boneIndexToParentIndex)
+		ReturnIfFalse(scanner.ReadLabeled(parentIndex));
+
+	return true;
 }
 
-void CLoadM3D::ReadAnimationClips(std::ifstream& fin, UINT numBones, UINT numAnimationClips, 
+bool CLoadM3D::ReadAnimationClips(CTextScanner& scanner, UINT numBones, UINT numAnimationClips,
 								   std::unordered_map<std::string, AnimationClip>& animations)
 {
-	std::string ignore;
-    fin >> ignore; // AnimationClips header text
-    for(UINT clipIndex = 0; clipIndex < numAnimationClips; ++clipIndex)
-    {
-        std::string clipName;
-        fin >> ignore >> clipName;
-        fin >> ignore; // {
-
-		AnimationClip clip;
+	ReturnIfFalse(scanner.Skip()); // AnimationClips header text
+	for (UINT clipIndex = 0; clipIndex < numAnimationClips; ++clipIndex)
+	{
+		std::string clipName;
+		ReturnIfFalse(scanner.ReadLabeled(clipName));
+		ReturnIfFalse(scanner.Skip()); // {
+
+		AnimationClip& clip = animations[clipName];
 		clip.BoneAnimations.resize(numBones);
 
-        for(UINT boneIndex = 0; boneIndex < numBones; ++boneIndex)
-        {
-            ReadBoneKeyframes(fin, numBones, clip.BoneAnimations[boneIndex]);
-        }
-        fin >> ignore; // }
+		for (auto& boneAnimation : clip.BoneAnimations)
+			ReturnIfFalse(ReadBoneKeyframes(scanner, numBones, boneAnimation));
 
-        animations[clipName] = clip;
-    }
+		ReturnIfFalse(scanner.Skip()); // }
+	}
+
+	return true;
 }
 
-void CLoadM3D::ReadBoneKeyframes(std::ifstream& fin, UINT numBones, BoneAnimation& boneAnimation)
+bool CLoadM3D::ReadBoneKeyframes(CTextScanner& scanner, UINT numBones, BoneAnimation& boneAnimation)
 {
-	std::string ignore;
-    UINT numKeyframes = 0;
-    fin >> ignore >> ignore >> numKeyframes;
-    fin >> ignore; // {
-
-    boneAnimation.Keyframes.resize(numKeyframes);
-    for(UINT i = 0; i < numKeyframes; ++i)
-    {
-        float t    = 0.0f;
-        XMFLOAT3 p(0.0f, 0.0f, 0.0f);
-        XMFLOAT3 s(1.0f, 1.0f, 1.0f);
-        XMFLOAT4 q(0.0f, 0.0f, 0.0f, 1.0f);
-        fin >> ignore >> t;
-        fin >> ignore >> p.x >> p.y >> p.z;
-        fin >> ignore >> s.x >> s.y >> s.z;
-        fin >> ignore >> q.x >> q.y >> q.z >> q.w;
-
-	    boneAnimation.Keyframes[i].TimePos      = t;
-        boneAnimation.Keyframes[i].Translation  = p;
-	    boneAnimation.Keyframes[i].Scale        = s;
-	    boneAnimation.Keyframes[i].RotationQuat = q;
-    }
-
-    fin >> ignore; // }
-}
\ No newline at end of file
+	UINT numKeyframes = 0;
+	ReturnIfFalse(scanner.Skip()); // BoneN
+	ReturnIfFalse(scanner.ReadLabeled(numKeyframes));
+	ReturnIfFalse(scanner.Skip()); // {
+
+	boneAnimation.Keyframes.resize(numKeyframes);
+	for (auto& keyframe : boneAnimation.Keyframes)
+	{
+		ReturnIfFalse(scanner.ReadLabeled(keyframe.TimePos));
+		ReturnIfFalse(scanner.ReadLabeled(keyframe.Translation.x, keyframe.Translation.y, keyframe.Translation.z));
+		ReturnIfFalse(scanner.ReadLabeled(keyframe.Scale.x, keyframe.Scale.y, keyframe.Scale.z));
+		ReturnIfFalse(scanner.ReadLabeled(
+			keyframe.RotationQuat.x, keyframe.RotationQuat.y, keyframe.RotationQuat.z, keyframe.RotationQuat.w));
+	}
+
+	ReturnIfFalse(scanner.Skip()); // }
+
+	return true;
+}
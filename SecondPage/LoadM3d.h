@@ -7,6 +7,7 @@ struct M3dMaterial;
 struct SkinnedVertex;
 struct AnimationClip;
 struct BoneAnimation;
+class CTextScanner;
 
 class CLoadM3D
 {
@@ -24,13 +25,13 @@ public:
 		CSkinnedData* skinInfo);
 
 private:
-	void ReadMaterials(std::ifstream& fin, UINT numMaterials, std::vector<M3dMaterial>& mats);
-	void ReadSubsetTable(std::ifstream& fin, UINT numSubsets, std::vector<Subset>& subsets);
-	void ReadVertices(std::ifstream& fin, UINT numVertices, std::vector<Vertex>& vertices);
-	void ReadSkinnedVertices(std::ifstream& fin, UINT numVertices, std::vector<SkinnedVertex>& vertices);
-	void ReadTriangles(std::ifstream& fin, UINT numTriangles, std::vector<std::int32_t>& indices);
-	void ReadBoneOffsets(std::ifstream& fin, UINT numBones, std::vector<DirectX::XMFLOAT4X4>& boneOffsets);
-	void ReadBoneHierarchy(std::ifstream& fin, UINT numBones, std::vector<int>& boneIndexToParentIndex);
-	void ReadAnimationClips(std::ifstream& fin, UINT numBones, UINT numAnimationClips, std::unordered_map<std::string, AnimationClip>& animations);
-	void ReadBoneKeyframes(std::ifstream& fin, UINT numBones, BoneAnimation& boneAnimation);
+	bool ReadMaterials(CTextScanner& scanner, UINT numMaterials, std::vector<M3dMaterial>& mats);
+	bool ReadSubsetTable(CTextScanner& scanner, UINT numSubsets, std::vector<Subset>& subsets);
+	bool ReadVertices(CTextScanner& scanner, UINT numVertices, std::vector<Vertex>& vertices);
+	bool ReadSkinnedVertices(CTextScanner& scanner, UINT numVertices, std::vector<SkinnedVertex>& vertices);
+	bool ReadTriangles(CTextScanner& scanner, UINT numTriangles, std::vector<std::int32_t>& indices);
+	bool ReadBoneOffsets(CTextScanner& scanner, UINT numBones, std::vector<DirectX::XMFLOAT4X4>& boneOffsets);
+	bool ReadBoneHierarchy(CTextScanner& scanner, UINT numBones, std::vector<int>& boneIndexToParentIndex);
+	bool ReadAnimationClips(CTextScanner& scanner, UINT numBones, UINT numAnimationClips, std::unordered_map<std::string, AnimationClip>& animations);
+	bool ReadBoneKeyframes(CTextScanner& scanner, UINT numBones, BoneAnimation& boneAnimation);
 };
@@ -48,6 +48,11 @@ CMainLoop::CMainLoop()
 	, m_ssao{ nullptr }
 	, m_model{ nullptr }
 	, m_AllRenderItems{}
+	, m_passCBs{}
+	, m_passVersions{}
+	, m_ssaoCB{ std::make_unique<SsaoConstants>() }
+	, m_ssaoVersion{ 0 }
+	, m_uploadVersion{ 0 }
 {}
 CMainLoop::~CMainLoop() = default;
 
@@ -56,13 +61,13 @@ bool CMainLoop::Initialize(const std::wstring& resourcePath, CWindow* window, IR
 	m_window = window;
 	m_iRenderer = renderer;
 
-	ReturnIfFalse(InitializeClass(resourcePath));	//ʱȭ
+	ReturnIfFalse(InitializeClass(resourcePath));	//초기화
 
-	AddKeyListener();	//Ű  
+	AddKeyListener();	//키 리스너 등록
 
-	//local ۾ ͵
+	//local에서 작업할 것들
 	ReturnIfFalse(OnResize(m_window->GetWidth(), m_window->GetHeight()));
-	ReturnIfFalse(m_model->LoadMemory(m_iRenderer, m_AllRenderItems));	//͸ ram, vram ø
+	ReturnIfFalse(m_model->LoadMemory(m_iRenderer, m_AllRenderItems));	//데이터를 ram, vram에 올리기
 
 	return true;
 }
@@ -98,19 +103,36 @@ void CMainLoop::AddKeyListener()
 		cam->Move(dx, dy);	 });
 }
 
+//값이 달라졌을 때만 저장하고 버전을 올린다. 버전 0은 아직 한번도 올리지 않은 값이다.
+template<typename T>
+void StoreIfChanged(const T& value, T& stored, UINT64& version, UINT64& lastVersion)
+{
+	if (version != 0 && std::memcmp(&value, &stored, sizeof(T)) == 0)
+		return;
+
+	stored = value;
+	version = ++lastVersion;
+}
+
 void CMainLoop::UpdatePassCB()
 {	
-	std::vector<PassConstants> passCBList{};
-	passCBList.emplace_back(UpdateMainPassCB());
-	passCBList.emplace_back(m_shadow->UpdatePassCB());
+	std::array<PassConstants, 2> passCBList{ UpdateMainPassCB(), m_shadow->UpdatePassCB() };
+	if (m_passCBs.size() != passCBList.size())
+	{
+		m_passCBs.resize(passCBList.size());
+		m_passVersions.resize(passCBList.size(), 0);
+	}
+	for (auto i : std::views::iota(0u, static_cast<UINT>(passCBList.size())))
+		StoreIfChanged(passCBList[i], m_passCBs[i], m_passVersions[i], m_uploadVersion);
 
-	m_iRenderer->SetUploadBuffer(eBufferType::PassCB, passCBList.data(), passCBList.size());
+	m_iRenderer->UpdateUploadBuffer(eBufferType::PassCB, m_passCBs.data(), m_passVersions.data(), m_passCBs.size());
 
 	SsaoConstants ssaoCB{};
 	ssaoCB.proj = passCBList[0].proj;
 	ssaoCB.invProj = passCBList[0].invProj;
 	m_ssao->UpdatePassCB(m_camera.get(), &ssaoCB);
-	m_iRenderer->SetUploadBuffer(eBufferType::SsaoCB, &ssaoCB, 1);
+	StoreIfChanged(ssaoCB, *m_ssaoCB, m_ssaoVersion, m_uploadVersion);
+	m_iRenderer->UpdateUploadBuffer(eBufferType::SsaoCB, m_ssaoCB.get(), &m_ssaoVersion, 1);
 }
 
 PassConstants CMainLoop::UpdateMainPassCB()
@@ -144,13 +166,14 @@ bool CMainLoop::OnResize(int width, int height)
 	return true;
 }
 
-std::wstring SetWindowCaption(std::size_t visibleCount, std::size_t totalCount)
+std::wstring SetWindowCaption(std::size_t visibleCount, std::size_t totalCount, UINT64 uploadedBytes)
 {
 	std::wostringstream outs;
 	outs.precision(6);
 	outs << L"Instancing and Culling Demo" <<
 		L"    " << visibleCount <<
-		L" objects visible out of " << totalCount;
+		L" objects visible out of " << totalCount <<
+		L"    upload: " << uploadedBytes / 1024 << L"KB";
 	return outs.str();
 }
 
@@ -179,7 +202,7 @@ bool CMainLoop::Run(IRenderer* renderer)
 				SubRenderItem* renderItem = GetSubRenderItem(m_AllRenderItems, GraphicsPSO::Opaque, "skull");
 				if (renderItem != nullptr)
 				{
-					std::wstring caption = SetWindowCaption(renderItem->instanceCount, renderItem->instanceDataList.size());
+					std::wstring caption = SetWindowCaption(renderItem->instanceCount, renderItem->instances.Size(), m_iRenderer->GetUploadedBytes());
 					m_window->SetText(caption + fps);
 				}
 			}
@@ -9,14 +9,13 @@ class CModel;
 class CKeyInput;
 class CGameTimer;
 struct RenderItem;
-struct InstanceData;
 struct PassConstants;
+struct SsaoConstants;
 enum class GraphicsPSO : int;
 
 class CMainLoop
 {
 	using AllRenderItems = std::map<GraphicsPSO, std::unique_ptr<RenderItem>>;
-	using InstanceDataList = std::vector<std::shared_ptr<InstanceData>>;
 
 public:
 	CMainLoop();
@@ -49,9 +48,16 @@ private:
 	std::unique_ptr<CShadow> m_shadow;
 	std::unique_ptr<CSsao> m_ssao;
 	
-	//͸ ҷͼ   ͸  κ
+	//데이터를 불러와서 렌더링에 보여줄 데이터를 만드는 부분
 	std::unique_ptr<CModel> m_model;
 
-	// ʿ ͵
+	//랜더링시 필요한 데이터들
 	AllRenderItems m_AllRenderItems;
+
+	//지난번에 올린 상수 값과 버전. 값이 같으면 버전이 그대로라서 렌더러가 복사하지 않는다.
+	std::vector<PassConstants> m_passCBs;
+	std::vector<UINT64> m_passVersions;
+	std::unique_ptr<SsaoConstants> m_ssaoCB;
+	UINT64 m_ssaoVersion;
+	UINT64 m_uploadVersion;
 };
\ No newline at end of file
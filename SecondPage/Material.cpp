@@ -1,20 +1,28 @@
-#include "pch.h"
+﻿#include "pch.h"
 #include "./Material.h"
 #include "../Include/FrameResourceData.h"
 #include "../Include/RendererDefine.h"
 #include "../Include/Interface.h"
 #include "../Include/Types.h"
+#include "./Utility.h"
 
 using namespace DirectX;
 
 Material::Material()
-	: numFramesDirty{ gFrameResourceCount }
-	, type{}
+	: type{}
 {}
 
 CMaterial::CMaterial()
 	: m_materialList{}
 	, m_textureList{}
+	, m_materialIds{}
+	, m_srvTextureIds{}
+	, m_textureRefs{}
+	, m_usedTextures{}
+	, m_materialBuffers{}
+	, m_versions{}
+	, m_version{ 0 }
+	, m_builtVersion{ 0 }
 {}
 CMaterial::~CMaterial() = default;
 
@@ -29,12 +37,18 @@ void CMaterial::InsertTexture(SrvOffset type, const std::wstring& filename)
 	m_textureList.emplace_back(std::make_pair(type, filename));
 }
 
-void CMaterial::SetMaterialList(const MaterialList& materialList)
+//같은 이름은 처음 들어온 머터리얼을 쓴다. 번호는 머터리얼 버퍼에서의 위치와 같다.
+void CMaterial::SetMaterialList(const MaterialList& materialList, std::vector<UINT>* outMaterialIds)
 {
-	std::ranges::copy_if(materialList, std::back_inserter(m_materialList), [this](auto& mat) {
-		auto find = std::ranges::find_if(m_materialList, [&mat](auto& mMat) {
-			return mMat->name == mat->name; });
-		return (find == m_materialList.end()); });
+	if (outMaterialIds != nullptr) outMaterialIds->clear();
+	std::ranges::for_each(materialList, [this, outMaterialIds](auto& mat) {
+		const UINT id = m_materialIds.Register(mat->name);
+		if (id == m_materialList.size())
+		{
+			m_materialList.emplace_back(mat);
+			m_versions.emplace_back(++m_version);
+		}
+		if (outMaterialIds != nullptr) outMaterialIds->emplace_back(id); });
 
 	std::ranges::for_each(m_materialList, [this](auto& mat) {
 		InsertTexture(mat->type, mat->diffuseName);
@@ -43,38 +57,73 @@ void CMaterial::SetMaterialList(const MaterialList& materialList)
 
 bool CMaterial::LoadTextureIntoVRAM(IRenderer* renderer)
 {
-	return renderer->LoadTexture(m_textureList, &m_srvTextureList);
+	std::vector<std::wstring> srvTextureList{};
+	ReturnIfFalse(renderer->LoadTexture(m_textureList, &srvTextureList));
+
+	ReleaseTextures(renderer);
+	m_srvTextureIds.Clear();
+	std::ranges::for_each(srvTextureList, [this](auto& filename) {
+		m_srvTextureIds.Register(filename); });
+
+	std::ranges::for_each(m_materialList, [this](auto& mat) {
+		mat->diffuseMapId = GetSrvTextureIndex(mat->diffuseName);
+		mat->normalMapId = GetSrvTextureIndex(mat->normalName); });
+
+	//머터리얼 하나가 텍스쳐 하나를 참조한다. 참조가 없는 텍스쳐는 예산이 모자랄 때 먼저 내려간다.
+	std::ranges::for_each(m_materialList, [this](auto& mat) {
+		for (auto srvIndex : { mat->diffuseMapId, mat->normalMapId })
+			if (srvIndex != gInvalidId) m_textureRefs.emplace_back(srvIndex); });
+	renderer->AddTextureRefs(m_textureRefs);
+
+	//텍스쳐 번호가 바뀌었으니 모두 다시 올린다.
+	for (auto id : std::views::iota(0u, static_cast<UINT>(m_materialList.size())))
+		MarkDirty(id);
+
+	return true;
 }
 
-int CMaterial::GetSrvTextureIndex(const std::wstring& filename)
+void CMaterial::ReleaseTextures(IRenderer* renderer)
 {
-	auto find = std::ranges::find(m_srvTextureList, filename);
-	if (find == m_srvTextureList.end())
-		return -1;
+	if (m_textureRefs.empty()) return;
 
-	return static_cast<int>(std::distance(m_srvTextureList.begin(), find));
+	renderer->ReleaseTextureRefs(m_textureRefs);
+	m_textureRefs.clear();
 }
 
-int CMaterial::GetMaterialIndex(const std::string& matName)
+void CMaterial::UseTextures(IRenderer* renderer, const std::vector<UINT>& materialIds)
 {
-	if (matName.empty()) return -1;
-
-	auto find = std::ranges::find_if(m_materialList, [&matName](auto& mat) {
-		return mat->name == matName; });
-	if (find == m_materialList.end())
+	m_usedTextures.clear();
+	for (auto id : materialIds)
 	{
-		assert(false && "material index error!");
-		return -1;
+		if (id >= m_materialList.size()) continue;
+
+		const Material* material = m_materialList[id].get();
+		for (auto srvIndex : { material->diffuseMapId, material->normalMapId })
+			if (srvIndex != gInvalidId) m_usedTextures.emplace_back(srvIndex);
 	}
+	renderer->UseTextures(m_usedTextures);
+}
+
+UINT CMaterial::GetSrvTextureIndex(const std::wstring& filename) const
+{
+	return m_srvTextureIds.Find(filename);
+}
+
+UINT CMaterial::GetMaterialIndex(const std::string& matName) const
+{
+	if (matName.empty()) return gInvalidId;
+
+	const UINT id = m_materialIds.Find(matName);
+	assert(id != gInvalidId && "material index error!");
 
-	return static_cast<int>(std::distance(m_materialList.begin(), find));
+	return id;
 }
 
 MaterialBuffer CMaterial::ConvertUploadBuffer(Material* material)
 {
 	MaterialBuffer matData;
-	matData.diffuseMapIndex = GetSrvTextureIndex(material->diffuseName);
-	matData.NormalMapIndex = GetSrvTextureIndex(material->normalName);
+	matData.diffuseMapIndex = material->diffuseMapId;
+	matData.NormalMapIndex = material->normalMapId;
 	matData.diffuseAlbedo = material->diffuseAlbedo;
 	matData.fresnelR0 = material->fresnelR0;
 	matData.roughness = material->roughness;
@@ -83,18 +132,24 @@ MaterialBuffer CMaterial::ConvertUploadBuffer(Material* material)
 	return matData;
 }
 
-void CMaterial::MakeMaterialBuffer(IRenderer* renderer)
+void CMaterial::MarkDirty(UINT materialId)
 {
-	std::vector<MaterialBuffer> materialBufferDatas{};
-	std::ranges::for_each(m_materialList, [this, &materialBufferDatas](auto& m) {
-		Material* mat = m.get();
-		if (mat->numFramesDirty <= 0) return;
+	m_versions[materialId] = ++m_version;
+}
 
-		materialBufferDatas.emplace_back(ConvertUploadBuffer(mat));
-		mat->numFramesDirty--; });
+//머터리얼 번호와 버퍼 위치가 같아야 해서 바뀐 것만 앞으로 모으지 않고 자리를 지켜서 쓴다.
+void CMaterial::MakeMaterialBuffer(IRenderer* renderer)
+{
+	if (m_materialList.empty())
+		return;
 
-	if (materialBufferDatas.empty())
-		return; 
+	m_materialBuffers.resize(m_materialList.size());
+	for (auto id : std::views::iota(0u, static_cast<UINT>(m_materialList.size())))
+	{
+		if (m_versions[id] <= m_builtVersion) continue;
+		m_materialBuffers[id] = ConvertUploadBuffer(m_materialList[id].get());
+	}
+	m_builtVersion = m_version;
 
-	renderer->SetUploadBuffer(eBufferType::Material, materialBufferDatas.data(), materialBufferDatas.size());
+	renderer->UpdateUploadBuffer(eBufferType::Material, m_materialBuffers.data(), m_versions.data(), m_materialBuffers.size());
 }
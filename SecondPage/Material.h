@@ -1,4 +1,6 @@
-#pragma once
+﻿#pragma once
+
+#include "../Include/IdRegistry.h"
 
 interface IRenderer;
 struct MaterialBuffer;
@@ -19,7 +21,9 @@ struct Material
 
 	DirectX::XMMATRIX transform = DirectX::XMMatrixIdentity();
 
-	int numFramesDirty;
+	//텍스쳐를 올린 뒤 srv 번호로 한번 바꿔 둔다.
+	UINT diffuseMapId{ gInvalidId };
+	UINT normalMapId{ gInvalidId };
 };
 
 using MaterialList = std::vector<std::shared_ptr<Material>>;
@@ -35,12 +39,15 @@ public:
 	CMaterial(const CMaterial&) = delete;
 	CMaterial& operator=(const CMaterial&) = delete;
 
-	void SetMaterialList(const MaterialList& materialList);
+	void SetMaterialList(const MaterialList& materialList, std::vector<UINT>* outMaterialIds);
 	bool LoadTextureIntoVRAM(IRenderer* renderer);
 	void MakeMaterialBuffer(IRenderer* renderer);
+	void MarkDirty(UINT materialId);
+	void UseTextures(IRenderer* renderer, const std::vector<UINT>& materialIds);
+	void ReleaseTextures(IRenderer* renderer);
 
-	int GetSrvTextureIndex(const std::wstring& filename);
-	int GetMaterialIndex(const std::string& matName);
+	UINT GetSrvTextureIndex(const std::wstring& filename) const;
+	UINT GetMaterialIndex(const std::string& matName) const;
 
 private:
 	MaterialBuffer ConvertUploadBuffer(Material* material);
@@ -49,5 +56,14 @@ private:
 private:
 	MaterialList m_materialList;
 	TextureList m_textureList;
-	std::vector<std::wstring> m_srvTextureList{};
+	CIdRegistry<std::string> m_materialIds;
+	CIdRegistry<std::wstring> m_srvTextureIds;
+	std::vector<UINT> m_textureRefs;		//머터리얼마다 쓰는 텍스쳐 srv 번호. 렌더러에 참조로 센 그대로다
+	std::vector<UINT> m_usedTextures;
+
+	//값이 바뀐 머터리얼은 버전을 올린다. 렌더러는 버퍼마다 올린 버전과 비교해서 바뀐 것만 복사한다.
+	std::vector<MaterialBuffer> m_materialBuffers;
+	std::vector<UINT64> m_versions;
+	UINT64 m_version;
+	UINT64 m_builtVersion;		//m_materialBuffers를 이 버전까지 만들어 두었다.
 };
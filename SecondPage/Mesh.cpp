@@ -10,6 +10,10 @@
 #include "./Helper.h"
 #include "./LoadM3D.h"
 #include "./SkinnedData.h"
+#include "./MeshCache.h"
+#include "./TextScanner.h"
+#include <execution>
+#include <thread>
 
 using namespace DirectX;
 
@@ -51,34 +55,58 @@ std::unique_ptr<MeshData> CMesh::ReadMeshType(GraphicsPSO pso, const std::wstrin
 	return std::move(meshData);
 }
 
-#include <filesystem>
 bool CMesh::ReadFile(const std::wstring& filename, MeshData** outMeshData)
 {
-	auto path = std::filesystem::current_path();
-	
 	std::wstring fullFilename = m_resPath + m_filePath + filename;
-	std::ifstream fin(fullFilename);
-	if (fin.fail())
-		return false;
-	
-	UINT vCount = 0;
-	UINT iCount = 0;
-	std::string ignore;
-	fin >> ignore >> vCount;
-	fin >> ignore >> iCount;
-	fin >> ignore >> ignore >> ignore >> ignore;
+	CMeshCache meshCache;
+	if (meshCache.Load(fullFilename, *outMeshData))
+		return true;
 
-	XMFLOAT3 vMinf3(+MathHelper::Infinity, +MathHelper::Infinity, +MathHelper::Infinity);
-	XMFLOAT3 vMaxf3(-MathHelper::Infinity, -MathHelper::Infinity, -MathHelper::Infinity);
+	ReturnIfFalse(ReadVertexNormalList(fullFilename, std::thread::hardware_concurrency(), *outMeshData));
 
-	XMVECTOR vMin = XMLoadFloat3(&vMinf3);
-	XMVECTOR vMax = XMLoadFloat3(&vMaxf3);
+	//캐시 저장에 실패해도 다음 실행 때 텍스트를 다시 읽으면 되므로 결과는 무시한다.
+	meshCache.Save(fullFilename, **outMeshData);
+
+	return true;
+}
+
+template<typename T>
+struct TextChunk
+{
+	TextChunk(const std::pair<const char*, const char*>& range)
+		: begin{ range.first }, end{ range.second }
+	{}
+
+	const char* begin{ nullptr };
+	const char* end{ nullptr };
+	std::vector<T> list{};
+	std::size_t offset{ 0 };
+	bool result{ false };
+};
+
+struct VertexChunk : public TextChunk<Vertex>
+{
+	using TextChunk::TextChunk;
 
-	for (auto i{ 0u }; i < vCount; ++i)
+	XMFLOAT3 vMin{ +MathHelper::Infinity, +MathHelper::Infinity, +MathHelper::Infinity };
+	XMFLOAT3 vMax{ -MathHelper::Infinity, -MathHelper::Infinity, -MathHelper::Infinity };
+};
+using IndexChunk = TextChunk<std::int32_t>;
+
+void ParseVertexChunk(VertexChunk& chunk)
+{
+	CTextScanner scanner(chunk.begin, chunk.end);
+	//한 줄에 float 6개, 한 줄이 대략 60바이트
+	chunk.list.reserve(static_cast<std::size_t>(chunk.end - chunk.begin) / 48 + 1);
+
+	XMVECTOR vMin = XMLoadFloat3(&chunk.vMin);
+	XMVECTOR vMax = XMLoadFloat3(&chunk.vMax);
+	while (!scanner.IsEnd())
 	{
 		Vertex curVertex{};
-		fin >> curVertex.pos.x >> curVertex.pos.y >> curVertex.pos.z;
-		fin >> curVertex.normal.x >> curVertex.normal.y >> curVertex.normal.z;
+		if (!scanner.Read(
+			curVertex.pos.x, curVertex.pos.y, curVertex.pos.z,
+			curVertex.normal.x, curVertex.normal.y, curVertex.normal.z)) return;
 
 		XMVECTOR P = XMLoadFloat3(&curVertex.pos);
 
@@ -99,24 +127,99 @@ bool CMesh::ReadFile(const std::wstring& filename, MeshData** outMeshData)
 		vMin = XMVectorMin(vMin, P);
 		vMax = XMVectorMax(vMax, P);
 
-		(*outMeshData)->vertices.emplace_back(std::move(curVertex));
+		chunk.list.emplace_back(std::move(curVertex));
+	}
+	XMStoreFloat3(&chunk.vMin, vMin);
+	XMStoreFloat3(&chunk.vMax, vMax);
+	chunk.result = true;
+}
+
+void ParseIndexChunk(IndexChunk& chunk)
+{
+	CTextScanner scanner(chunk.begin, chunk.end);
+	chunk.list.reserve(static_cast<std::size_t>(chunk.end - chunk.begin) / 4 + 1);
+
+	while (!scanner.IsEnd())
+	{
+		std::int32_t readIdx{ 0 };
+		if (!scanner.Read(readIdx)) return;
+		chunk.list.emplace_back(readIdx);
+	}
+	chunk.result = true;
+}
+
+//청크별 결과를 순서대로 이어 붙인다. 각 청크의 시작 위치는 앞 청크 크기의 누적합이다.
+template<typename T, typename Chunk>
+bool MergeChunks(std::vector<Chunk>& chunks, std::size_t expectedCount, std::vector<T>& outList)
+{
+	std::size_t offset{ 0 };
+	for (auto& chunk : chunks)
+	{
+		ReturnIfFalse(chunk.result);
+		chunk.offset = offset;
+		offset += chunk.list.size();
 	}
+	if (offset != expectedCount) return false;
+
+	outList.resize(expectedCount);
+	std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&outList](auto& chunk) {
+		std::ranges::copy(chunk.list, outList.begin() + chunk.offset); });
+
+	return true;
+}
+
+template<typename Chunk>
+std::vector<Chunk> MakeChunks(const char* begin, const char* end, UINT chunkCount)
+{
+	auto ranges = CTextScanner::SplitLines(begin, end, chunkCount);
+	return std::vector<Chunk>(ranges.begin(), ranges.end());
+}
+
+bool ReadVertexNormalList(const std::wstring& filename, UINT chunkCount, MeshData* outMeshData)
+{
+	CTextScanner scanner;
+	ReturnIfFalse(scanner.Open(filename));
 
-	XMStoreFloat3(&(*outMeshData)->boundingBox.Center, 0.5f * (vMin + vMax));
-	XMStoreFloat3(&(*outMeshData)->boundingBox.Extents, 0.5f * (vMax - vMin));
+	UINT vCount = 0;
+	UINT iCount = 0;
+	ReturnIfFalse(scanner.ReadLabeled(vCount));
+	ReturnIfFalse(scanner.ReadLabeled(iCount));
+	ReturnIfFalse(scanner.Skip(4));	//VertexList (pos, normal) {
+
+	const char* vertexBegin = scanner.GetCursor();
+	const char* vertexEnd = std::find(vertexBegin, scanner.GetEnd(), '}');
+	scanner.SetCursor(vertexEnd);
+	ReturnIfFalse(scanner.Skip(3));	//} TriangleList {
 
-	XMStoreFloat3(&(*outMeshData)->boundingSphere.Center, 0.5f * (vMin + vMax));
-	(*outMeshData)->boundingSphere.Radius = XMVectorGetX(XMVector3Length(0.5f * (vMax - vMin)));
+	const char* indexBegin = scanner.GetCursor();
+	const char* indexEnd = std::find(indexBegin, scanner.GetEnd(), '}');
 
-	fin >> ignore >> ignore >> ignore;
+	//줄 단위로 나눈 청크를 스레드 풀에서 파싱하고 합친다.
+	auto vertexChunks = MakeChunks<VertexChunk>(vertexBegin, vertexEnd, chunkCount);
+	auto indexChunks = MakeChunks<IndexChunk>(indexBegin, indexEnd, chunkCount);
+	std::for_each(std::execution::par, vertexChunks.begin(), vertexChunks.end(), ParseVertexChunk);
+	std::for_each(std::execution::par, indexChunks.begin(), indexChunks.end(), ParseIndexChunk);
+
+	ReturnIfFalse(MergeChunks(vertexChunks, vCount, outMeshData->vertices));
+	ReturnIfFalse(MergeChunks(indexChunks, static_cast<std::size_t>(iCount) * 3, outMeshData->indices));
+
+	//min, max는 순서와 상관없이 같은 값이 나오므로 청크별 결과를 합쳐도 직렬 결과와 같다.
+	XMFLOAT3 vMinf3(+MathHelper::Infinity, +MathHelper::Infinity, +MathHelper::Infinity);
+	XMFLOAT3 vMaxf3(-MathHelper::Infinity, -MathHelper::Infinity, -MathHelper::Infinity);
 
-	for (auto iter{ 0u }; iter < iCount * 3; ++iter)
+	XMVECTOR vMin = XMLoadFloat3(&vMinf3);
+	XMVECTOR vMax = XMLoadFloat3(&vMaxf3);
+	for (auto& chunk : vertexChunks)
 	{
-		std::int32_t readIdx{ 0 };
-		fin >> readIdx;
-		(*outMeshData)->indices.emplace_back(std::move(readIdx));
+		vMin = XMVectorMin(vMin, XMLoadFloat3(&chunk.vMin));
+		vMax = XMVectorMax(vMax, XMLoadFloat3(&chunk.vMax));
 	}
-	fin.close();
+
+	XMStoreFloat3(&outMeshData->boundingBox.Center, 0.5f * (vMin + vMax));
+	XMStoreFloat3(&outMeshData->boundingBox.Extents, 0.5f * (vMax - vMin));
+
+	XMStoreFloat3(&outMeshData->boundingSphere.Center, 0.5f * (vMin + vMax));
+	outMeshData->boundingSphere.Radius = XMVectorGetX(XMVector3Length(0.5f * (vMax - vMin)));
 
 	return true;
 }
@@ -175,7 +278,7 @@ bool CMesh::LoadMeshIntoVRAM(IRenderer* renderer, AllRenderItems* outRenderItems
 		std::vector<std::int32_t> totalIndices{};
 		ReturnIfFalse(Convert(iter.second, totalVertices, totalIndices, pRenderItem));
 
-		//׷ ޸𸮿 ø.
+		//그래픽 메모리에 올린다.
 		ReturnIfFalse(renderer->LoadMesh(pso, totalVertices.data(), totalIndices.data(), pRenderItem));
 
 		return true;	}); 	
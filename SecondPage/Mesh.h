@@ -1,4 +1,4 @@
-#pragma once
+﻿#pragma once
 
 interface IRenderer;
 class CGeometry;
@@ -49,6 +49,9 @@ struct MeshData
 	DirectX::BoundingSphere boundingSphere{};
 };
 
+//skull.txt 형식(pos, normal 목록과 삼각형 목록)을 chunkCount개로 나눠서 병렬로 읽는다.
+bool ReadVertexNormalList(const std::wstring& filename, UINT chunkCount, MeshData* outMeshData);
+
 class CMesh
 {
 	using AllRenderItems = std::map<GraphicsPSO, std::unique_ptr<RenderItem>>;
@@ -0,0 +1,342 @@
+﻿#include "pch.h"
+#include "./MeshCache.h"
+#include <filesystem>
+#include "../Include/FrameResourceData.h"
+#include "./Mesh.h"
+#include "./SkinnedData.h"
+#include "./Utility.h"
+
+constexpr std::uint32_t MeshCacheMagic{ 0x3143534D };	//'MSC1'
+constexpr std::uint32_t MeshCacheVersion{ 1u };
+
+enum class MeshCacheKind : std::uint32_t
+{
+	Static = 1,
+	Skinned,
+};
+
+struct MeshCacheHeader
+{
+	std::uint32_t magic{ MeshCacheMagic };
+	std::uint32_t version{ MeshCacheVersion };
+	std::uint64_t sourceHash{ 0u };
+	std::uint32_t kind{ 0u };
+	std::uint32_t payloadSize{ 0u };
+};
+
+constexpr std::uint64_t Fnv1a64(const void* data, std::size_t size, std::uint64_t hash = 14695981039346656037ull)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+//원본 파일이 바뀌거나 구조체 레이아웃이 바뀌면 해시가 달라져서 캐시를 다시 만든다.
+bool MakeSourceHash(const std::wstring& srcFilename, std::uint64_t* outHash)
+{
+	std::error_code ec{};
+	const auto fileSize = std::filesystem::file_size(srcFilename, ec);
+	if (ec) return false;
+	const auto writeTime = std::filesystem::last_write_time(srcFilename, ec).time_since_epoch().count();
+	if (ec) return false;
+
+	const std::uint64_t layout[] = {
+		MeshCacheVersion, sizeof(Vertex), sizeof(SkinnedVertex), sizeof(Keyframe), sizeof(Subset) };
+
+	std::uint64_t hash = Fnv1a64(&fileSize, sizeof(fileSize));
+	hash = Fnv1a64(&writeTime, sizeof(writeTime), hash);
+	hash = Fnv1a64(layout, sizeof(layout), hash);
+	(*outHash) = hash;
+
+	return true;
+}
+
+template<typename T>
+void WriteValue(std::vector<char>& buffer, const T& value)
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	const char* src = reinterpret_cast<const char*>(&value);
+	buffer.insert(buffer.end(), src, src + sizeof(T));
+}
+
+template<typename T>
+void WriteArray(std::vector<char>& buffer, const std::vector<T>& values)
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	WriteValue(buffer, static_cast<std::uint32_t>(values.size()));
+	const char* src = reinterpret_cast<const char*>(values.data());
+	buffer.insert(buffer.end(), src, src + values.size() * sizeof(T));
+}
+
+void WriteString(std::vector<char>& buffer, const std::string& str)
+{
+	WriteValue(buffer, static_cast<std::uint32_t>(str.size()));
+	buffer.insert(buffer.end(), str.begin(), str.end());
+}
+
+template<typename T>
+bool ReadValue(const std::vector<char>& buffer, std::size_t& offset, T& outValue)
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	if (offset + sizeof(T) > buffer.size()) return false;
+
+	std::memcpy(&outValue, &buffer[offset], sizeof(T));
+	offset += sizeof(T);
+	return true;
+}
+
+//원소 하나씩 파싱하지 않고 resize 후에 한번에 복사한다.
+template<typename T>
+bool ReadArray(const std::vector<char>& buffer, std::size_t& offset, std::vector<T>& outValues)
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	std::uint32_t count{ 0u };
+	ReturnIfFalse(ReadValue(buffer, offset, count));
+
+	const std::size_t byteSize = static_cast<std::size_t>(count) * sizeof(T);
+	if (offset + byteSize > buffer.size()) return false;
+
+	outValues.resize(count);
+	if (byteSize != 0)
+		std::memcpy(outValues.data(), &buffer[offset], byteSize);
+	offset += byteSize;
+	return true;
+}
+
+bool ReadString(const std::vector<char>& buffer, std::size_t& offset, std::string& outStr)
+{
+	std::uint32_t length{ 0u };
+	ReturnIfFalse(ReadValue(buffer, offset, length));
+	if (offset + length > buffer.size()) return false;
+
+	outStr.assign(&buffer[offset], length);
+	offset += length;
+	return true;
+}
+
+void WriteMaterial(std::vector<char>& buffer, const M3dMaterial& mat)
+{
+	WriteString(buffer, mat.name);
+	WriteValue(buffer, mat.diffuseAlbedo);
+	WriteValue(buffer, mat.fresnelR0);
+	WriteValue(buffer, mat.roughness);
+	WriteValue(buffer, static_cast<std::uint32_t>(mat.alphaClip));
+	WriteString(buffer, mat.materialTypeName);
+	WriteString(buffer, mat.diffuseMapName);
+	WriteString(buffer, mat.normalMapName);
+}
+
+bool ReadMaterial(const std::vector<char>& buffer, std::size_t& offset, M3dMaterial& outMat)
+{
+	std::uint32_t alphaClip{ 0u };
+	ReturnIfFalse(ReadString(buffer, offset, outMat.name));
+	ReturnIfFalse(ReadValue(buffer, offset, outMat.diffuseAlbedo));
+	ReturnIfFalse(ReadValue(buffer, offset, outMat.fresnelR0));
+	ReturnIfFalse(ReadValue(buffer, offset, outMat.roughness));
+	ReturnIfFalse(ReadValue(buffer, offset, alphaClip));
+	ReturnIfFalse(ReadString(buffer, offset, outMat.materialTypeName));
+	ReturnIfFalse(ReadString(buffer, offset, outMat.diffuseMapName));
+	ReturnIfFalse(ReadString(buffer, offset, outMat.normalMapName));
+	outMat.alphaClip = (alphaClip != 0u);
+
+	return true;
+}
+
+CMeshCache::CMeshCache() = default;
+CMeshCache::~CMeshCache() = default;
+
+std::wstring CMeshCache::GetCacheFilename(const std::wstring& srcFilename)
+{
+	return srcFilename + L".mcache";
+}
+
+bool CMeshCache::ReadCacheFile(const std::wstring& srcFilename, std::uint32_t kind,
+	std::vector<char>& outBuffer, std::size_t& outOffset)
+{
+	std::uint64_t sourceHash{ 0u };
+	ReturnIfFalse(MakeSourceHash(srcFilename, &sourceHash));
+
+	const std::wstring cacheFilename = GetCacheFilename(srcFilename);
+	std::error_code ec{};
+	const auto fileSize = std::filesystem::file_size(cacheFilename, ec);
+	if (ec || fileSize < sizeof(MeshCacheHeader)) return false;
+
+	std::ifstream fin(cacheFilename, std::ios::binary);
+	if (fin.fail()) return false;
+
+	outBuffer.resize(static_cast<std::size_t>(fileSize));
+	fin.read(outBuffer.data(), static_cast<std::streamsize>(fileSize));
+	if (fin.gcount() != static_cast<std::streamsize>(fileSize)) return false;
+
+	outOffset = 0;
+	MeshCacheHeader header{};
+	ReturnIfFalse(ReadValue(outBuffer, outOffset, header));
+
+	if (header.magic != MeshCacheMagic) return false;
+	if (header.version != MeshCacheVersion) return false;
+	if (header.sourceHash != sourceHash) return false;
+	if (header.kind != kind) return false;
+	if (header.payloadSize != outBuffer.size() - outOffset) return false;
+
+	return true;
+}
+
+bool CMeshCache::WriteCacheFile(const std::wstring& srcFilename, std::uint32_t kind, const std::vector<char>& payload)
+{
+	MeshCacheHeader header{};
+	ReturnIfFalse(MakeSourceHash(srcFilename, &header.sourceHash));
+	header.kind = kind;
+	header.payloadSize = static_cast<std::uint32_t>(payload.size());
+
+	//쓰다가 실패한 파일이 남지 않도록 임시 파일에 쓰고 이름을 바꾼다.
+	const std::wstring cacheFilename = GetCacheFilename(srcFilename);
+	const std::wstring tempFilename = cacheFilename + L".tmp";
+	{
+		std::ofstream fout(tempFilename, std::ios::binary | std::ios::trunc);
+		if (fout.fail()) return false;
+
+		fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		fout.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+		if (fout.fail()) return false;
+	}
+
+	std::error_code ec{};
+	std::filesystem::rename(tempFilename, cacheFilename, ec);
+	if (ec)
+	{
+		std::filesystem::remove(tempFilename, ec);
+		return false;
+	}
+
+	return true;
+}
+
+bool CMeshCache::Load(const std::wstring& srcFilename, MeshData* outMeshData)
+{
+	std::vector<char> buffer{};
+	std::size_t offset{ 0 };
+	ReturnIfFalse(ReadCacheFile(srcFilename, EtoV(MeshCacheKind::Static), buffer, offset));
+
+	MeshData meshData{};
+	ReturnIfFalse(ReadArray(buffer, offset, meshData.vertices));
+	ReturnIfFalse(ReadArray(buffer, offset, meshData.indices));
+	ReturnIfFalse(ReadValue(buffer, offset, meshData.boundingBox));
+	ReturnIfFalse(ReadValue(buffer, offset, meshData.boundingSphere));
+
+	outMeshData->vertices = std::move(meshData.vertices);
+	outMeshData->indices = std::move(meshData.indices);
+	outMeshData->boundingBox = meshData.boundingBox;
+	outMeshData->boundingSphere = meshData.boundingSphere;
+
+	return true;
+}
+
+bool CMeshCache::Save(const std::wstring& srcFilename, const MeshData& meshData)
+{
+	std::vector<char> payload{};
+	payload.reserve(
+		meshData.vertices.size() * sizeof(Vertex) + meshData.indices.size() * sizeof(std::int32_t) + 256);
+
+	WriteArray(payload, meshData.vertices);
+	WriteArray(payload, meshData.indices);
+	WriteValue(payload, meshData.boundingBox);
+	WriteValue(payload, meshData.boundingSphere);
+
+	return WriteCacheFile(srcFilename, EtoV(MeshCacheKind::Static), payload);
+}
+
+bool CMeshCache::Load(const std::wstring& srcFilename,
+	SkinnedVertices& vertices,
+	Indices& indices,
+	std::vector<Subset>& subsets,
+	std::vector<M3dMaterial>& mats,
+	CSkinnedData* skinInfo)
+{
+	std::vector<char> buffer{};
+	std::size_t offset{ 0 };
+	ReturnIfFalse(ReadCacheFile(srcFilename, EtoV(MeshCacheKind::Skinned), buffer, offset));
+
+	SkinnedVertices curVertices{};
+	Indices curIndices{};
+	std::vector<Subset> curSubsets{};
+	std::vector<M3dMaterial> curMats{};
+	std::vector<int> boneHierarchy{};
+	std::vector<DirectX::XMFLOAT4X4> boneOffsets{};
+	std::unordered_map<std::string, AnimationClip> animations{};
+
+	ReturnIfFalse(ReadArray(buffer, offset, curVertices));
+	ReturnIfFalse(ReadArray(buffer, offset, curIndices));
+	ReturnIfFalse(ReadArray(buffer, offset, curSubsets));
+
+	std::uint32_t matCount{ 0u };
+	ReturnIfFalse(ReadValue(buffer, offset, matCount));
+	curMats.resize(matCount);
+	for (auto& mat : curMats)
+		ReturnIfFalse(ReadMaterial(buffer, offset, mat));
+
+	ReturnIfFalse(ReadArray(buffer, offset, boneHierarchy));
+	ReturnIfFalse(ReadArray(buffer, offset, boneOffsets));
+
+	std::uint32_t clipCount{ 0u };
+	ReturnIfFalse(ReadValue(buffer, offset, clipCount));
+	for (auto clipIdx{ 0u }; clipIdx < clipCount; ++clipIdx)
+	{
+		std::string clipName{};
+		std::uint32_t boneCount{ 0u };
+		ReturnIfFalse(ReadString(buffer, offset, clipName));
+		ReturnIfFalse(ReadValue(buffer, offset, boneCount));
+
+		AnimationClip& clip = animations[clipName];
+		clip.BoneAnimations.resize(boneCount);
+		for (auto& boneAnimation : clip.BoneAnimations)
+			ReturnIfFalse(ReadArray(buffer, offset, boneAnimation.Keyframes));
+	}
+
+	if (offset != buffer.size()) return false;
+
+	vertices = std::move(curVertices);
+	indices = std::move(curIndices);
+	subsets = std::move(curSubsets);
+	mats = std::move(curMats);
+	skinInfo->Set(boneHierarchy, boneOffsets, animations);
+
+	return true;
+}
+
+bool CMeshCache::Save(const std::wstring& srcFilename,
+	const SkinnedVertices& vertices,
+	const Indices& indices,
+	const std::vector<Subset>& subsets,
+	const std::vector<M3dMaterial>& mats,
+	const CSkinnedData* skinInfo)
+{
+	std::vector<char> payload{};
+	payload.reserve(vertices.size() * sizeof(SkinnedVertex) + indices.size() * sizeof(std::int32_t));
+
+	WriteArray(payload, vertices);
+	WriteArray(payload, indices);
+	WriteArray(payload, subsets);
+
+	WriteValue(payload, static_cast<std::uint32_t>(mats.size()));
+	for (auto& mat : mats)
+		WriteMaterial(payload, mat);
+
+	WriteArray(payload, skinInfo->GetBoneHierarchy());
+	WriteArray(payload, skinInfo->GetBoneOffsets());
+
+	const auto& animations = skinInfo->GetAnimations();
+	WriteValue(payload, static_cast<std::uint32_t>(animations.size()));
+	for (auto& [clipName, clip] : animations)
+	{
+		WriteString(payload, clipName);
+		WriteValue(payload, static_cast<std::uint32_t>(clip.BoneAnimations.size()));
+		for (auto& boneAnimation : clip.BoneAnimations)
+			WriteArray(payload, boneAnimation.Keyframes);
+	}
+
+	return WriteCacheFile(srcFilename, EtoV(MeshCacheKind::Skinned), payload);
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+
+class CSkinnedData;
+struct MeshData;
+struct Subset;
+struct M3dMaterial;
+struct SkinnedVertex;
+
+//텍스트 메쉬(skull.txt, soldier.m3d)를 한번 파싱한 뒤 바이너리로 저장해 두고,
+//다음 실행부터는 파일을 통째로 읽어서 vector에 바로 복사한다.
+//원본 파일의 크기, 수정시간, 포맷 버전으로 만든 해시가 다르면 Load가 false를 반환하고
+//호출하는 쪽은 텍스트 로더로 돌아간다.
+class CMeshCache
+{
+	using SkinnedVertices = std::vector<SkinnedVertex>;
+	using Indices = std::vector<std::int32_t>;
+
+public:
+	CMeshCache();
+	~CMeshCache();
+
+	CMeshCache(const CMeshCache&) = delete;
+	CMeshCache& operator=(const CMeshCache&) = delete;
+
+	bool Load(const std::wstring& srcFilename, MeshData* outMeshData);
+	bool Save(const std::wstring& srcFilename, const MeshData& meshData);
+
+	bool Load(const std::wstring& srcFilename,
+		SkinnedVertices& vertices,
+		Indices& indices,
+		std::vector<Subset>& subsets,
+		std::vector<M3dMaterial>& mats,
+		CSkinnedData* skinInfo);
+	bool Save(const std::wstring& srcFilename,
+		const SkinnedVertices& vertices,
+		const Indices& indices,
+		const std::vector<Subset>& subsets,
+		const std::vector<M3dMaterial>& mats,
+		const CSkinnedData* skinInfo);
+
+	static std::wstring GetCacheFilename(const std::wstring& srcFilename);
+
+private:
+	bool ReadCacheFile(const std::wstring& srcFilename, std::uint32_t kind, std::vector<char>& outBuffer, std::size_t& outOffset);
+	bool WriteCacheFile(const std::wstring& srcFilename, std::uint32_t kind, const std::vector<char>& payload);
+};
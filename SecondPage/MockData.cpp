@@ -58,12 +58,11 @@ std::unique_ptr<MeshData> Generator(std::string&& meshName)
 	return std::move(meshData);
 }
 
-InstanceDataList CreateSkullInstanceData(const std::vector<std::string>& materialNameList)
+CInstanceStore CreateSkullInstanceData(UINT matCount)
 {
-	InstanceDataList instances{};
+	CInstanceStore instances{};
 
 	const int n = 5;
-	int matCount = static_cast<int>(materialNameList.size());
 
 	float width = 200.0f;
 	float height = 200.0f;
@@ -82,19 +81,19 @@ InstanceDataList CreateSkullInstanceData(const std::vector<std::string>& materia
 		{
 			for (int j = 0; j < n; ++j)
 			{
-				auto instance = std::make_unique<InstanceData>();
+				InstanceData instance{};
 				const DirectX::XMFLOAT3 pos(x + j * dx, y + i * dy, z + k * dz);
-				instance->world = DirectX::XMMATRIX(
+				instance.world = DirectX::XMMATRIX(
 					1.0f, 0.0f, 0.0f, 0.0f,
 					0.0f, 1.0f, 0.0f, 0.0f,
 					0.0f, 0.0f, 1.0f, 0.0f,
 					pos.x, pos.y, pos.z, 1.0f);
 
 				int index = k * n * n + i * n + j;
-				instance->texTransform = DirectX::XMMatrixScaling(2.0f, 2.0f, 1.0f);
+				instance.texTransform = DirectX::XMMatrixScaling(2.0f, 2.0f, 1.0f);
 
-				instance->matName = materialNameList[index % matCount];
-				instances.emplace_back(std::move(instance));
+				instance.materialId = index % matCount;
+				instances.Add(instance);
 			}
 		}
 	}
@@ -102,97 +101,99 @@ InstanceDataList CreateSkullInstanceData(const std::vector<std::string>& materia
 	return instances;
 }
 
-InstanceDataList CreateSoldierInstanceData(const std::vector<std::string>& materialNameList)
+CInstanceStore CreateSoldierInstanceData(UINT matCount)
 {
-	InstanceDataList instances{};
+	CInstanceStore instances{};
+
+	DirectX::XMMATRIX modelScale = DirectX::XMMatrixScaling(0.05f, 0.05f, -0.05f);
+	DirectX::XMMATRIX modelRot = DirectX::XMMatrixRotationY(static_cast<float>(std::numbers::pi));
+	for (auto x : { -3.0f, 0.0f, 3.0f })
+	{
+		InstanceData instance{};
+		instance.world = modelScale * modelRot * DirectX::XMMatrixTranslation(x, 0.0f, -5.0f);
+		instances.Add(instance);
+	}
 
 	return instances;
 }
 
-InstanceDataList CreateCylinderInstanceData(const std::vector<std::string>& materialNameList)
+CInstanceStore CreateCylinderInstanceData(UINT matCount)
 {
-	InstanceDataList instances{};
-	
-	for(auto i : std::views::iota(0, 8))
+	CInstanceStore instances{};
+	InstanceData instance{};
+	instance.texTransform = DirectX::XMMatrixScaling(1.5f, 2.0f, 1.0f);
+	instance.materialId = 0u;
+
+	for (auto i : std::views::iota(0, 8))
 	{
-		auto instance = std::make_unique<InstanceData>();
-		instance->world = DirectX::XMMatrixTranslation(-3.0f, 1.5f, -10.0f + i * 3.0f);
-		instances.emplace_back(std::move(instance));
+		instance.world = DirectX::XMMatrixTranslation(-3.0f, 1.5f, -10.0f + i * 3.0f);
+		instances.Add(instance);
 	}
 
 	for (auto i : std::views::iota(0, 8))
 	{
-		auto instance = std::make_unique<InstanceData>();
-		instance->world = DirectX::XMMatrixTranslation(+3.0f, 1.5f, -10.0f + i * 3.0f);
-		instances.emplace_back(std::move(instance));
+		instance.world = DirectX::XMMatrixTranslation(+3.0f, 1.5f, -10.0f + i * 3.0f);
+		instances.Add(instance);
 	}
-	
-	std::ranges::for_each(instances, [&materialNameList](auto& instance) {
-		instance->texTransform = DirectX::XMMatrixScaling(1.5f, 2.0f, 1.0f);
-		instance->matName = *materialNameList.begin(); });
-	
+
 	return instances;
 }
 
-InstanceDataList CreateSkyCubeInstanceData(const std::vector<std::string>& materialNameList)
+CInstanceStore CreateSkyCubeInstanceData(UINT matCount)
 {
-	//ϴø material texTransform  ʰ shader ̷ 
+	//하늘맵은 material과 texTransform을 쓰지 않고 shader에서 이렇게 사용
 	// return gCubeMap.Sample(gsamLinearWrap, pin.PosL);
-	InstanceDataList instances{};
-	auto instance = std::make_unique<InstanceData>();
-	instance->world = DirectX::XMMatrixIdentity();
-	instance->texTransform = DirectX::XMMatrixIdentity();
-	instance->matName = *materialNameList.begin();
-	instances.emplace_back(std::move(instance));
+	CInstanceStore instances{};
+	InstanceData instance{};
+	instance.world = DirectX::XMMatrixIdentity();
+	instance.texTransform = DirectX::XMMatrixIdentity();
+	instance.materialId = 0u;
+	instances.Add(instance);
 
 	return instances;
 }
 
-InstanceDataList CreateGridInstanceData(const std::vector<std::string>& materialNameList)
+CInstanceStore CreateGridInstanceData(UINT matCount)
 {
-	InstanceDataList instances{};
-	auto instance = std::make_unique<InstanceData>();
-	instance->world = DirectX::XMMatrixIdentity();
-	instance->texTransform = DirectX::XMMatrixScaling(8.0f, 8.0f, 1.0f);
-	instance->matName = *materialNameList.begin();
-	instances.emplace_back(std::move(instance));
+	CInstanceStore instances{};
+	InstanceData instance{};
+	instance.world = DirectX::XMMatrixIdentity();
+	instance.texTransform = DirectX::XMMatrixScaling(8.0f, 8.0f, 1.0f);
+	instance.materialId = 0u;
+	instances.Add(instance);
 
 	return instances;
 }
 
-InstanceDataList CreateSphereInstanceData(const std::vector<std::string>& materialNameList)
+CInstanceStore CreateSphereInstanceData(UINT matCount)
 {
-	InstanceDataList instances{};
+	CInstanceStore instances{};
+	InstanceData instance{};
+	instance.texTransform = DirectX::XMMatrixIdentity();
+	instance.materialId = 0u;
 
 	for (auto i : std::views::iota(0, 8))
 	{
-		auto instance = std::make_unique<InstanceData>();
-		instance->world = DirectX::XMMatrixTranslation(-3.0f, 3.5f, -10.0f + i * 3.0f);
-		instances.emplace_back(std::move(instance));
+		instance.world = DirectX::XMMatrixTranslation(-3.0f, 3.5f, -10.0f + i * 3.0f);
+		instances.Add(instance);
 	}
 
 	for (auto i : std::views::iota(0, 8))
 	{
-		auto instance = std::make_unique<InstanceData>();
-		instance->world = DirectX::XMMatrixTranslation(+3.0f, 3.5f, -10.0f + i * 3.0f);
-		instances.emplace_back(std::move(instance));
+		instance.world = DirectX::XMMatrixTranslation(+3.0f, 3.5f, -10.0f + i * 3.0f);
+		instances.Add(instance);
 	}
 
-	std::ranges::for_each(instances, [&materialNameList](auto& instance) {
-		instance->texTransform = DirectX::XMMatrixIdentity();
-		instance->matName = *materialNameList.begin(); });
-
 	return instances;
 }
 
-InstanceDataList CreateDebugInstanceData()
+CInstanceStore CreateDebugInstanceData()
 {
-	InstanceDataList instances{};
-	auto instance = std::make_unique<InstanceData>();
-	instance->world = DirectX::XMMatrixIdentity();
-	instance->texTransform = DirectX::XMMatrixIdentity();
-	instance->matName = {};
-	instances.emplace_back(std::move(instance));
+	CInstanceStore instances{};
+	InstanceData instance{};
+	instance.world = DirectX::XMMatrixIdentity();
+	instance.texTransform = DirectX::XMMatrixIdentity();
+	instances.Add(instance);
 
 	return instances;
 }
@@ -203,16 +204,12 @@ ModelProperty CreateCubeMock()
 	materialList.emplace_back(MakeMaterial("sky", SrvOffset::TextureCube, { L"grasscube1024.dds" },
 		{ 1.0f, 1.0f, 1.0f, 1.0f }, { 0.1f, 0.1f, 0.1f }, 1.0f));
 
-	std::vector<std::string> materialNameList{};
-	std::ranges::transform(materialList, std::back_inserter(materialNameList), [](auto& mat) {
-		return mat->name; });
-
 	ModelProperty  modelProp{};
 	modelProp.createType = ModelProperty::CreateType::Generator;
 	modelProp.meshData = Generator("cube");
 	modelProp.cullingFrustum = false;
 	modelProp.filename = {};
-	modelProp.instanceDataList = CreateSkyCubeInstanceData(materialNameList);
+	modelProp.instances = CreateSkyCubeInstanceData(static_cast<UINT>(materialList.size()));
 	modelProp.materialList = materialList;
 
 	return modelProp;
@@ -229,16 +226,12 @@ ModelProperty CreateSkullMock()
 	materialList.emplace_back(MakeMaterial("grass0", SrvOffset::Texture2D, { L"grass.dds" }, { 1.0f, 1.0f, 1.0f, 1.0f }, { 0.05f, 0.05f, 0.05f }, 0.2f));
 	materialList.emplace_back(MakeMaterial("skullMat", SrvOffset::Texture2D, { L"white1x1.dds" }, { 1.0f, 1.0f, 1.0f, 1.0f }, { 0.05f, 0.05f, 0.05f }, 0.5f));
 
-	std::vector<std::string> materialNameList{};
-	std::ranges::transform(materialList, std::back_inserter(materialNameList), [](auto& mat) {
-		return mat->name; });
-
 	ModelProperty  modelProp{};
 	modelProp.createType = ModelProperty::CreateType::ReadFile;
 	modelProp.meshData = nullptr;
 	modelProp.cullingFrustum = true;
 	modelProp.filename = L"skull.txt";
-	modelProp.instanceDataList = CreateSkullInstanceData(materialNameList);
+	modelProp.instances = CreateSkullInstanceData(static_cast<UINT>(materialList.size()));
 	modelProp.materialList = materialList;
 
 	return modelProp;
@@ -251,7 +244,7 @@ ModelProperty CreateSoldierMock()
 	modelProp.meshData = nullptr;
 	modelProp.cullingFrustum = false;
 	modelProp.filename = L"soldier.m3d";
-	modelProp.instanceDataList = {};
+	modelProp.instances = CreateSoldierInstanceData(0u);
 	modelProp.materialList = {};
 
 	return modelProp;
@@ -262,16 +255,12 @@ ModelProperty CreateGridMock()
 	MaterialList materialList;
 	materialList.emplace_back(MakeMaterial("nTile", SrvOffset::Texture2D, { L"tile.dds", L"tile_nmap.dds" }, { 0.9f, 0.9f, 0.9f, 1.0f }, { 0.2f, 0.2f, 0.2f }, 0.1f));
 
-	std::vector<std::string> materialNameList{};
-	std::ranges::transform(materialList, std::back_inserter(materialNameList), [](auto& mat) {
-		return mat->name; });
-
 	ModelProperty  modelProp{};
 	modelProp.createType = ModelProperty::CreateType::Generator;
 	modelProp.meshData = Generator("grid");
 	modelProp.cullingFrustum = false;
 	modelProp.filename = {};
-	modelProp.instanceDataList = CreateGridInstanceData(materialNameList);
+	modelProp.instances = CreateGridInstanceData(static_cast<UINT>(materialList.size()));
 	modelProp.materialList = materialList;
 
 	return modelProp;
@@ -282,16 +271,12 @@ ModelProperty CreateCylinderMock()
 	MaterialList materialList;
 	materialList.emplace_back(MakeMaterial("nBricks2", SrvOffset::Texture2D, { L"bricks.dds", L"bricks_nmap.dds" }, { 1.0f, 1.0f, 1.0f, 1.0f }, { 0.1f, 0.1f, 0.1f }, 0.3f));
 
-	std::vector<std::string> materialNameList{};
-	std::ranges::transform(materialList, std::back_inserter(materialNameList), [](auto& mat) {
-		return mat->name; });
-
 	ModelProperty  modelProp{};
 	modelProp.createType = ModelProperty::CreateType::Generator;
 	modelProp.meshData = Generator("cylinder");
 	modelProp.cullingFrustum = false;
 	modelProp.filename = {};
-	modelProp.instanceDataList = CreateCylinderInstanceData(materialNameList);
+	modelProp.instances = CreateCylinderInstanceData(static_cast<UINT>(materialList.size()));
 	modelProp.materialList = materialList;
 
 	return modelProp;
@@ -303,16 +288,12 @@ ModelProperty CreateSphereMock()
 	materialList.emplace_back(MakeMaterial("mirror0", SrvOffset::Texture2D, { L"white1x1.dds", L"default_nmap.dds" },
 		{ 0.0f, 0.0f, 0.0f, 1.0f }, { 0.98f, 0.97f, 0.95f }, 0.1f));
 
-	std::vector<std::string> materialNameList{};
-	std::ranges::transform(materialList, std::back_inserter(materialNameList), [](auto& mat) {
-		return mat->name; });
-
 	ModelProperty  modelProp{};
 	modelProp.createType = ModelProperty::CreateType::Generator;
 	modelProp.meshData = Generator("sphere");
 	modelProp.cullingFrustum = false;
 	modelProp.filename = {};
-	modelProp.instanceDataList = CreateSphereInstanceData(materialNameList);
+	modelProp.instances = CreateSphereInstanceData(static_cast<UINT>(materialList.size()));
 	modelProp.materialList = materialList;
 
 	return modelProp;
@@ -325,7 +306,7 @@ ModelProperty CreateDebugMock()
 	modelProp.meshData = Generator("debug");
 	modelProp.cullingFrustum = false;
 	modelProp.filename = {};
-	modelProp.instanceDataList = CreateDebugInstanceData();
+	modelProp.instances = CreateDebugInstanceData();
 	modelProp.materialList = {};
 
 	return modelProp;
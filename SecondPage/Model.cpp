@@ -10,13 +10,19 @@
 #include "./Material.h"
 #include "./MockData.h"
 #include "./Camera.h"
+#include "./Culling.h"
 #include "./Utility.h"
+#include <execution>
+#include <numeric>
 
 CModel::CModel()
 	: m_material{ nullptr }
 	, m_mesh{ nullptr }
 	, m_skinnedMesh{ nullptr }
 	, m_setupData{ nullptr }
+	, m_cullingJobs{}
+	, m_instanceBuffers{}
+	, m_usedMaterials{}
 {}
 CModel::~CModel() = default;
 
@@ -47,36 +53,166 @@ bool CModel::LoadMemory(IRenderer* renderer, AllRenderItems& allRenderItems)
 	return true;
 }
 
-void CModel::UpdateRenderItems(IRenderer* renderer, CCamera* camera, AllRenderItems& allRenderItems)
+//서브 아이템을 gCullingJobSize개씩 잘라서 작업을 만든다. 인스턴스가 없는 서브 아이템도
+//시작 위치를 정해야 해서 빈 작업을 하나 둔다.
+void CModel::MakeCullingJobs(AllRenderItems& allRenderItems)
 {
-	//ó Ұ  󳽴.
-	InstanceDataList totalVisibleInstance{};
-	int instanceStartIndex{ 0 };
+	std::size_t jobCount{ 0 };
 	for (auto& e : allRenderItems)
 	{
-		InstanceDataList visibleInstance{};
 		auto renderItem = e.second.get();
-		renderItem->startIndexInstance = instanceStartIndex;
-		//   ãƳ.
-		camera->FindVisibleSubRenderItems(renderItem->subRenderItems, visibleInstance);
-		instanceStartIndex += static_cast<int>(visibleInstance.size());
+		for (auto& subRenderItem : renderItem->subRenderItems)
+		{
+			const UINT instanceCount = subRenderItem.instances.Size();
+			UINT begin{ 0u };
+			do
+			{
+				if (m_cullingJobs.size() <= jobCount) m_cullingJobs.emplace_back();
+				CullingJob& job = m_cullingJobs[jobCount++];
+				job.renderItem = renderItem;
+				job.subRenderItem = &subRenderItem;
+				job.begin = begin;
+				job.end = std::min(begin + gCullingJobSize, instanceCount);
+				begin = job.end;
+			} while (begin < instanceCount);
+		}
+	}
+	m_cullingJobs.resize(jobCount);
+}
+
+void CullInstances(const FrustumPlanes& planes, bool cullingEnabled, CullingJob& job)
+{
+	SubRenderItem* subRenderItem = job.subRenderItem;
+	job.materials.clear();
+	if (!cullingEnabled || !subRenderItem->cullingFrustum)
+	{
+		job.visible.resize(job.end - job.begin);
+		std::iota(job.visible.begin(), job.visible.end(), job.begin);
+		return;
+	}
+
+	const auto worlds = subRenderItem->instances.GetWorlds().subspan(job.begin, job.end - job.begin);
+	job.spheres.Clear();
+	for (auto& world : worlds)
+		job.spheres.Add(subRenderItem->subItem.boundingSphere, world);
+
+	CullSpheres(planes, job.spheres, job.visible);
+	for (auto& index : job.visible)
+		index += job.begin;
+}
 
-		std::ranges::move(visibleInstance, std::back_inserter(totalVisibleInstance));
+//작업 순서가 곧 인스턴스 버퍼 순서다. 보이는 개수를 누적해서 각 작업이 쓸 위치와
+//RenderItem, SubRenderItem의 시작 위치를 정한다.
+UINT CModel::AssignInstanceOffsets()
+{
+	UINT total{ 0u };
+	RenderItem* renderItem{ nullptr };
+	SubRenderItem* subRenderItem{ nullptr };
+	for (auto& job : m_cullingJobs)
+	{
+		if (job.renderItem != renderItem)
+		{
+			renderItem = job.renderItem;
+			renderItem->startIndexInstance = static_cast<int>(total);
+		}
+		if (job.subRenderItem != subRenderItem)
+		{
+			subRenderItem = job.subRenderItem;
+			subRenderItem->startSubIndexInstance = static_cast<int>(total) - renderItem->startIndexInstance;
+			subRenderItem->instanceCount = 0u;
+			subRenderItem->viewDepth = FLT_MAX;
+		}
+
+		const UINT visibleCount = static_cast<UINT>(job.visible.size());
+		job.outputOffset = total;
+		subRenderItem->instanceCount += visibleCount;
+		total += visibleCount;
 	}
-	UpdateInstanceBuffer(renderer, totalVisibleInstance);
+
+	return total;
+}
+
+void CModel::UpdateRenderItems(IRenderer* renderer, CCamera* camera, AllRenderItems& allRenderItems)
+{
+	MakeCullingJobs(allRenderItems);
+
+	//처리 안할것을 먼저 골라낸다. 작업마다 버퍼가 따로 있어서 병렬로 돌려도 겹치지 않는다.
+	FrustumPlanes planes{};
+	camera->GetFrustumPlanes(planes);
+	const bool cullingEnabled = camera->IsFrustumCullingEnabled();
+	std::for_each(std::execution::par, m_cullingJobs.begin(), m_cullingJobs.end(), [&planes, cullingEnabled](auto& job) {
+		CullInstances(planes, cullingEnabled, job); });
+
+	UpdateInstanceBuffer(renderer, camera->GetPosition(), AssignInstanceOffsets());
+	UpdateViewDepths();
 }
 
-void CModel::UpdateInstanceBuffer(IRenderer* renderer, const InstanceDataList& visibleInstance)
+//업로드 버퍼를 바로 쓸 수 있으면 거기에, 아니면 임시 배열에 쓰고 복사한다.
+void CModel::UpdateInstanceBuffer(IRenderer* renderer, const DirectX::XMFLOAT3& eyePos, UINT visibleCount)
 {
-	std::vector<InstanceBuffer> instanceBufferDatas{};
-	std::ranges::transform(visibleInstance, std::back_inserter(instanceBufferDatas), [this](auto& visibleData) {
+	if (visibleCount == 0) return;
+
+	std::span<InstanceBuffer> mappedBuffer = MapUploadSpan<InstanceBuffer>(renderer, eBufferType::Instance, visibleCount);
+	const bool isMapped = !mappedBuffer.empty();
+	if (!isMapped) m_instanceBuffers.resize(visibleCount);
+	InstanceBuffer* outBuffer = isMapped ? mappedBuffer.data() : m_instanceBuffers.data();
+
+	const DirectX::XMVECTOR eye = XMLoadFloat3(&eyePos);
+	std::for_each(std::execution::par, m_cullingJobs.begin(), m_cullingJobs.end(), [this, eye, outBuffer](auto& job) {
+		WriteInstanceBuffer(job, eye, outBuffer + job.outputOffset); });
+
+	if (!isMapped)
+		renderer->SetUploadBuffer(eBufferType::Instance, m_instanceBuffers.data(), m_instanceBuffers.size());
+}
+
+//업로드 힙은 write-combined라서 스택에서 다 만든 뒤 한번에 순서대로 쓴다.
+void CModel::WriteInstanceBuffer(CullingJob& job, DirectX::FXMVECTOR eyePos, InstanceBuffer* outBuffer)
+{
+	const CInstanceStore& instances = job.subRenderItem->instances;
+	const auto worlds = instances.GetWorlds();
+	const auto texTransforms = instances.GetTexTransforms();
+	const auto materialIds = instances.GetMaterialIds();
+	const auto paletteOffsets = instances.GetPaletteOffsets();
+	job.nearestDepthSq = FLT_MAX;
+	for (auto index : job.visible)
+	{
 		InstanceBuffer curInsBuf{};
-		XMStoreFloat4x4(&curInsBuf.world, DirectX::XMMatrixTranspose(visibleData->world));
-		XMStoreFloat4x4(&curInsBuf.texTransform, XMMatrixTranspose(visibleData->texTransform));
-		curInsBuf.materialIndex = m_material->GetMaterialIndex(visibleData->matName);
-		return std::move(curInsBuf); });
+		XMStoreFloat4x4(&curInsBuf.world, DirectX::XMMatrixTranspose(worlds[index]));
+		XMStoreFloat4x4(&curInsBuf.texTransform, DirectX::XMMatrixTranspose(texTransforms[index]));
+		curInsBuf.materialIndex = materialIds[index];
+		curInsBuf.paletteOffset = paletteOffsets[index];
+		(*outBuffer++) = curInsBuf;
+
+		const float depthSq = DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(DirectX::XMVectorSubtract(worlds[index].r[3], eyePos)));
+		job.nearestDepthSq = std::min(job.nearestDepthSq, depthSq);
+
+		if (job.materials.empty() || job.materials.back() != materialIds[index])
+			job.materials.emplace_back(materialIds[index]);
+	}
+	std::ranges::sort(job.materials);
+	job.materials.erase(std::ranges::unique(job.materials).begin(), job.materials.end());
+}
+
+//작업마다 구한 가까운 거리를 서브 아이템으로 모은다. 보이는 것이 없는 작업은 FLT_MAX라서 영향이 없다.
+void CModel::UpdateViewDepths()
+{
+	for (auto& job : m_cullingJobs)
+	{
+		if (job.visible.empty()) continue;
+		job.subRenderItem->viewDepth = std::min(job.subRenderItem->viewDepth, std::sqrt(job.nearestDepthSq));
+	}
+}
+
+//보이는 인스턴스가 쓰는 머터리얼의 텍스쳐만 이번 프레임에 썼다고 알린다.
+void CModel::UseTextures(IRenderer* renderer)
+{
+	m_usedMaterials.clear();
+	for (auto& job : m_cullingJobs)
+		m_usedMaterials.insert(m_usedMaterials.end(), job.materials.begin(), job.materials.end());
+	std::ranges::sort(m_usedMaterials);
+	m_usedMaterials.erase(std::ranges::unique(m_usedMaterials).begin(), m_usedMaterials.end());
 
-	renderer->SetUploadBuffer(eBufferType::Instance, instanceBufferDatas.data(), instanceBufferDatas.size());
+	m_material->UseTextures(renderer, m_usedMaterials);
 }
 
 void CModel::Update(IRenderer* renderer, CCamera* camera, float deltaTime, AllRenderItems& allRenderItems)
@@ -84,5 +220,6 @@ void CModel::Update(IRenderer* renderer, CCamera* camera, float deltaTime, AllRe
 	m_material->MakeMaterialBuffer(renderer);
 	m_skinnedMesh->UpdateAnimation(renderer, deltaTime);
 	UpdateRenderItems(renderer, camera, allRenderItems);
+	UseTextures(renderer);
 }
 
@@ -8,13 +8,14 @@ class CSetupData;
 class CCamera;
 struct RenderItem;
 struct InstanceData;
+struct InstanceBuffer;
 struct PassConstants;
+struct CullingJob;
 enum class GraphicsPSO : int;
 
 class CModel
 {
 	using AllRenderItems = std::map<GraphicsPSO, std::unique_ptr<RenderItem>>;
-	using InstanceDataList = std::vector<std::shared_ptr<InstanceData>>;
 	using CreateModelNames = std::map<GraphicsPSO, std::vector<std::string>>;
 	
 public:
@@ -30,12 +31,20 @@ public:
 
 private:
 	void UpdateRenderItems(IRenderer* renderer, CCamera* camera, AllRenderItems& allRenderItems);
-	void UpdateInstanceBuffer(IRenderer* renderer, const InstanceDataList& visibleInstance);
+	void MakeCullingJobs(AllRenderItems& allRenderItems);
+	UINT AssignInstanceOffsets();
+	void UpdateInstanceBuffer(IRenderer* renderer, const DirectX::XMFLOAT3& eyePos, UINT visibleCount);
+	void WriteInstanceBuffer(CullingJob& job, DirectX::FXMVECTOR eyePos, InstanceBuffer* outBuffer);
+	void UpdateViewDepths();
+	void UseTextures(IRenderer* renderer);
 
 private:
 	std::unique_ptr<CMaterial> m_material;
 	std::unique_ptr<CMesh> m_mesh;
 	std::unique_ptr<CSkinnedMesh> m_skinnedMesh;
 	std::unique_ptr<CSetupData> m_setupData;
+	std::vector<CullingJob> m_cullingJobs;
+	std::vector<InstanceBuffer> m_instanceBuffers;
+	std::vector<UINT> m_usedMaterials;
 };
 
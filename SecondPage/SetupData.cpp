@@ -1,4 +1,4 @@
-#include "pch.h"
+﻿#include "pch.h"
 #include "./SetupData.h"
 #include "../Include/RenderItem.h"
 #include "../Include/FrameResourceData.h"
@@ -25,7 +25,7 @@ bool CSetupData::FillRenderItems(AllRenderItems* renderItems)
 
 		std::ranges::for_each(geoProp.second, [renderItems, &geoProp](auto& meshProp) {
 			SubRenderItem* subRenderItem = MakeSubRenderItem((*renderItems), geoProp.first, meshProp.first);
-			subRenderItem->instanceDataList = meshProp.second.instanceDataList;
+			subRenderItem->instances = meshProp.second.instances;
 			subRenderItem->cullingFrustum = meshProp.second.cullingFrustum;
 			});
 		});
@@ -37,7 +37,14 @@ bool CSetupData::InsertModelProperty(GraphicsPSO pso, const std::string& meshNam
 {
 	if (mProperty.meshData != nullptr && mProperty.meshData->vertices.empty()) return false;
 
-	material->SetMaterialList(mProperty.materialList);
+	//인스턴스는 자기 머터리얼 목록에서의 위치를 들고 오고, 여기서 전체 번호로 바꾼다.
+	std::vector<UINT> materialIds{};
+	material->SetMaterialList(mProperty.materialList, &materialIds);
+	for (auto& materialId : mProperty.instances.GetMaterialIds())
+	{
+		if (materialId < materialIds.size())
+			materialId = materialIds[materialId];
+	}
 
 	auto& mesh = m_allModelProperty[pso];
 	if (mesh.find(meshName) != mesh.end())
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../Include/InstanceStore.h"
+
 interface IRenderer;
 class CMaterial;
 class CMesh;
@@ -7,12 +9,10 @@ class CSkinnedMesh;
 struct MeshData;
 struct Material;
 struct RenderItem;
-struct InstanceData;
 struct PassConstants;
 enum class SrvOffset : int;
 enum class GraphicsPSO : int; 
 
-using InstanceDataList = std::vector<std::shared_ptr<InstanceData>>;
 using MaterialList = std::vector<std::shared_ptr<Material>>;
 
 struct ModelProperty
@@ -27,7 +27,7 @@ struct ModelProperty
 	CreateType createType{ CreateType::None };
 	std::unique_ptr<MeshData> meshData{ nullptr };
 	std::wstring filename{};
-	InstanceDataList instanceDataList{};
+	CInstanceStore instances{};
 	bool cullingFrustum{ false };
 	MaterialList materialList{};
 };
@@ -48,7 +48,7 @@ void CShadow::UpdateTransform()
 	m_lightFarZ = f;
 	XMMATRIX lightProj = XMMatrixOrthographicOffCenterLH(l, r, b, t, n, f);
 
-	XMMATRIX ndcToTexture(	//-1, 1 => 0, 1 ȯ
+	XMMATRIX ndcToTexture(	//-1, 1 => 0, 1로 변환
 		0.5f, 0.0f, 0.0f, 0.0f,
 		0.0f, -0.5f, 0.0f, 0.0f,
 		0.0f, 0.0f, 1.0f, 0.0f,
@@ -1,5 +1,8 @@
-#include "pch.h"
+﻿#include "pch.h"
 #include "SkinnedData.h"
+#include <numeric>
+#include <execution>
+#include "./Utility.h"
 
 using namespace DirectX;
 
@@ -15,76 +18,493 @@ constexpr T MaxValue(const T& a, const T& b)
 	return a > b ? a : b;
 }
 
-void SkinnedModelInstance::UpdateSkinnedAnimation(float dt)
+inline XMVECTOR LoadLanes(const std::vector<float>& channel, UINT index)
+{
+	return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&channel[index]));
+}
+
+inline void StoreLanes(std::vector<float>& channel, UINT index, FXMVECTOR value)
+{
+	XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&channel[index]), value);
+}
+
+void LocalPose::Resize(UINT count)
+{
+	boneCount = count;
+	const UINT paddedCount = (count + 3u) & ~3u;
+
+	//남는 칸은 항등 변환으로 채워서 SIMD 연산이 NaN을 만들지 않게 한다.
+	for (auto channel : { &tx, &ty, &tz, &qx, &qy, &qz })
+		channel->assign(paddedCount, 0.0f);
+	for (auto channel : { &qw, &sx, &sy, &sz })
+		channel->assign(paddedCount, 1.0f);
+}
+
+void LocalPose::Set(UINT bone, const Keyframe& keyframe)
+{
+	tx[bone] = keyframe.Translation.x;
+	ty[bone] = keyframe.Translation.y;
+	tz[bone] = keyframe.Translation.z;
+	qx[bone] = keyframe.RotationQuat.x;
+	qy[bone] = keyframe.RotationQuat.y;
+	qz[bone] = keyframe.RotationQuat.z;
+	qw[bone] = keyframe.RotationQuat.w;
+	sx[bone] = keyframe.Scale.x;
+	sy[bone] = keyframe.Scale.y;
+	sz[bone] = keyframe.Scale.z;
+}
+
+//XMQuaternionSlerp와 같은 식을 4개 본에 대해 한번에 계산한다.
+void BlendLocalPose(const LocalPose& a, const LocalPose& b, const float* weights, LocalPose& out)
+{
+	const XMVECTOR one = XMVectorSplatOne();
+	const XMVECTOR zero = XMVectorZero();
+	const XMVECTOR oneMinusEpsilon = XMVectorReplicate(1.0f - 0.00001f);
+
+	for (UINT i = 0; i < out.PaddedCount(); i += 4)
+	{
+		XMVECTOR t = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&weights[i]));
+
+		StoreLanes(out.tx, i, XMVectorLerpV(LoadLanes(a.tx, i), LoadLanes(b.tx, i), t));
+		StoreLanes(out.ty, i, XMVectorLerpV(LoadLanes(a.ty, i), LoadLanes(b.ty, i), t));
+		StoreLanes(out.tz, i, XMVectorLerpV(LoadLanes(a.tz, i), LoadLanes(b.tz, i), t));
+		StoreLanes(out.sx, i, XMVectorLerpV(LoadLanes(a.sx, i), LoadLanes(b.sx, i), t));
+		StoreLanes(out.sy, i, XMVectorLerpV(LoadLanes(a.sy, i), LoadLanes(b.sy, i), t));
+		StoreLanes(out.sz, i, XMVectorLerpV(LoadLanes(a.sz, i), LoadLanes(b.sz, i), t));
+
+		XMVECTOR ax = LoadLanes(a.qx, i), ay = LoadLanes(a.qy, i), az = LoadLanes(a.qz, i), aw = LoadLanes(a.qw, i);
+		XMVECTOR bx = LoadLanes(b.qx, i), by = LoadLanes(b.qy, i), bz = LoadLanes(b.qz, i), bw = LoadLanes(b.qw, i);
+
+		XMVECTOR cosOmega = ax * bx + ay * by + az * bz + aw * bw;
+		XMVECTOR sign = XMVectorSelect(one, -one, XMVectorLess(cosOmega, zero));
+		cosOmega *= sign;
+
+		XMVECTOR omega = XMVectorACos(cosOmega);
+		XMVECTOR sinOmega = XMVectorSin(omega);
+		XMVECTOR s0 = XMVectorSin((one - t) * omega) / sinOmega;
+		XMVECTOR s1 = XMVectorSin(t * omega) / sinOmega;
+
+		//두 회전이 거의 같으면 lerp로 대신한다.
+		XMVECTOR useLerp = XMVectorGreater(cosOmega, oneMinusEpsilon);
+		s0 = XMVectorSelect(s0, one - t, useLerp);
+		s1 = XMVectorSelect(s1, t, useLerp) * sign;
+
+		StoreLanes(out.qx, i, s0 * ax + s1 * bx);
+		StoreLanes(out.qy, i, s0 * ay + s1 * by);
+		StoreLanes(out.qz, i, s0 * az + s1 * bz);
+		StoreLanes(out.qw, i, s0 * aw + s1 * bw);
+	}
+}
+
+//reference의 켤레 회전에 additive를 곱한 차이 회전을 weight만큼 줄여서(nlerp) base 뒤에 곱한다.
+//reference와 additive가 같으면 차이가 항등이라 base가 그대로 나온다.
+void AddLocalPose(const LocalPose& base, const LocalPose& additive, const LocalPose& reference,
+	const float* weights, LocalPose& out)
+{
+	const XMVECTOR one = XMVectorSplatOne();
+	const XMVECTOR zero = XMVectorZero();
+
+	for (UINT i = 0; i < out.PaddedCount(); i += 4)
+	{
+		XMVECTOR t = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&weights[i]));
+
+		StoreLanes(out.tx, i, XMVectorMultiplyAdd(LoadLanes(additive.tx, i) - LoadLanes(reference.tx, i), t, LoadLanes(base.tx, i)));
+		StoreLanes(out.ty, i, XMVectorMultiplyAdd(LoadLanes(additive.ty, i) - LoadLanes(reference.ty, i), t, LoadLanes(base.ty, i)));
+		StoreLanes(out.tz, i, XMVectorMultiplyAdd(LoadLanes(additive.tz, i) - LoadLanes(reference.tz, i), t, LoadLanes(base.tz, i)));
+		StoreLanes(out.sx, i, LoadLanes(base.sx, i) * XMVectorMultiplyAdd(LoadLanes(additive.sx, i) / LoadLanes(reference.sx, i) - one, t, one));
+		StoreLanes(out.sy, i, LoadLanes(base.sy, i) * XMVectorMultiplyAdd(LoadLanes(additive.sy, i) / LoadLanes(reference.sy, i) - one, t, one));
+		StoreLanes(out.sz, i, LoadLanes(base.sz, i) * XMVectorMultiplyAdd(LoadLanes(additive.sz, i) / LoadLanes(reference.sz, i) - one, t, one));
+
+		XMVECTOR rx = LoadLanes(reference.qx, i), ry = LoadLanes(reference.qy, i), rz = LoadLanes(reference.qz, i), rw = LoadLanes(reference.qw, i);
+		XMVECTOR ax = LoadLanes(additive.qx, i), ay = LoadLanes(additive.qy, i), az = LoadLanes(additive.qz, i), aw = LoadLanes(additive.qw, i);
+
+		XMVECTOR dx = rw * ax - rx * aw - ry * az + rz * ay;
+		XMVECTOR dy = rw * ay + rx * az - ry * aw - rz * ax;
+		XMVECTOR dz = rw * az - rx * ay + ry * ax - rz * aw;
+		XMVECTOR dw = rw * aw + rx * ax + ry * ay + rz * az;
+
+		//짧은 쪽으로 돌도록 w를 양수로 맞추고 항등 회전과 nlerp 한다.
+		XMVECTOR sign = XMVectorSelect(one, -one, XMVectorLess(dw, zero));
+		dx *= sign * t;
+		dy *= sign * t;
+		dz *= sign * t;
+		dw = XMVectorMultiplyAdd(dw * sign - one, t, one);
+		XMVECTOR invLength = XMVectorReciprocalSqrt(dx * dx + dy * dy + dz * dz + dw * dw);
+		dx *= invLength;
+		dy *= invLength;
+		dz *= invLength;
+		dw *= invLength;
+
+		XMVECTOR bx = LoadLanes(base.qx, i), by = LoadLanes(base.qy, i), bz = LoadLanes(base.qz, i), bw = LoadLanes(base.qw, i);
+		StoreLanes(out.qx, i, bw * dx + bx * dw + by * dz - bz * dy);
+		StoreLanes(out.qy, i, bw * dy - bx * dz + by * dw + bz * dx);
+		StoreLanes(out.qz, i, bw * dz + bx * dy - by * dx + bz * dw);
+		StoreLanes(out.qw, i, bw * dw - bx * dx - by * dy - bz * dz);
+	}
+}
+
+void AnimationScratch::Resize(UINT boneCount)
+{
+	key0.Resize(boneCount);
+	key1.Resize(boneCount);
+	local.Resize(boneCount);
+	layer.Resize(boneCount);
+	fraction.assign(local.PaddedCount(), 0.0f);
+	weights.assign(local.PaddedCount(), 0.0f);
+	cursors.assign(boneCount, 0u);
+	toRoot.resize(boneCount);
+}
+
+bool ClipPlayback::Set(const CSkinnedData* skinnedInfo, const std::string& name)
+{
+	//Set으로 애니메이션을 바꾸면 핸들이 무효가 되므로 다시 불러야 한다.
+	ClipHandle handle = skinnedInfo->GetClipHandle(name);
+	if (handle == nullptr) return false;
+
+	clipName = name;
+	clip = handle;
+	clipEndTime = clip->GetClipEndTime();
+	timePos = 0.0f;
+	cursors.assign(skinnedInfo->BoneCount(), 0u);
+
+	return true;
+}
+
+void ClipPlayback::Advance(float dt)
 {
 	timePos += dt;
 
-	if (timePos > skinnedInfo->GetClipEndTime(clipName))
+	if (timePos > clipEndTime)
 		timePos = 0.0f;
+}
 
-	skinnedInfo->GetFinalTransforms(clipName, timePos, finalTransforms);
+bool SkinnedModelInstance::SetClip(const std::string& name)
+{
+	ReturnIfFalse(current.Set(skinnedInfo, name));
+	next.clip = nullptr;
+	scratch.Resize(skinnedInfo->BoneCount());
+
+	return true;
 }
 
-Keyframe::Keyframe()
-	: TimePos(0.0f),
-	Translation(0.0f, 0.0f, 0.0f),
-	Scale(1.0f, 1.0f, 1.0f),
-	RotationQuat(0.0f, 0.0f, 0.0f, 1.0f)
-{}
+//페이드 중에 다시 부르면 목표 클립만 바뀌고 지금 클립에서 새로 페이드한다.
+bool SkinnedModelInstance::CrossFade(const std::string& name, float duration)
+{
+	if (current.clip == nullptr || duration <= 0.0f)
+		return SetClip(name);
+
+	ReturnIfFalse(next.Set(skinnedInfo, name));
+	fadeDuration = duration;
+	fadeElapsed = 0.0f;
 
-Keyframe::~Keyframe()
-{}
+	return true;
+}
+
+bool SkinnedModelInstance::AddLayer(LayerBlend blend, const std::string& name, float weight, const std::vector<float>& boneMask)
+{
+	const UINT boneCount = skinnedInfo->BoneCount();
+	if (current.clip == nullptr) return false;
+	if (!boneMask.empty() && boneMask.size() != boneCount) return false;
+
+	AnimationLayer layer{};
+	layer.blend = blend;
+	ReturnIfFalse(layer.playback.Set(skinnedInfo, name));
+	if (blend == LayerBlend::Additive)
+	{
+		layer.reference.Resize(boneCount);
+		layer.playback.clip->Sample(layer.playback.clip->GetClipStartTime(), layer.playback.cursors, scratch, layer.reference);
+	}
+	layer.boneMask = boneMask;
+	layer.boneWeights.assign(scratch.local.PaddedCount(), 0.0f);
+
+	layers.emplace_back(std::move(layer));
+	SetLayerWeight(static_cast<UINT>(layers.size()) - 1u, weight);
+
+	return true;
+}
+
+void SkinnedModelInstance::SetLayerWeight(UINT layerIndex, float weight)
+{
+	AnimationLayer& layer = layers[layerIndex];
+	for (auto bone : std::views::iota(0u, skinnedInfo->BoneCount()))
+		layer.boneWeights[bone] = layer.boneMask.empty() ? weight : weight * layer.boneMask[bone];
+}
+
+//기본 클립 -> 크로스페이드 -> 레이어 순으로 로컬 SRT를 섞은 뒤 계층 계산은 한번만 한다.
+void SkinnedModelInstance::UpdateSkinnedAnimation(float dt, XMFLOAT4X4* outFinalTransforms)
+{
+	const float step = dt * playbackRate;
+	current.Advance(step);
+	current.clip->Sample(current.timePos, current.cursors, scratch, scratch.local);
+
+	if (next.clip != nullptr)
+	{
+		next.Advance(step);
+		fadeElapsed += step;
+		const float weight = std::min(fadeElapsed / fadeDuration, 1.0f);
+
+		next.clip->Sample(next.timePos, next.cursors, scratch, scratch.layer);
+		std::ranges::fill(scratch.weights, weight);
+		BlendLocalPose(scratch.local, scratch.layer, scratch.weights.data(), scratch.local);
+
+		//버퍼째 맞바꾸므로 할당이 일어나지 않는다.
+		if (weight >= 1.0f)
+		{
+			std::swap(current, next);
+			next.clip = nullptr;
+		}
+	}
+
+	for (auto& layer : layers)
+	{
+		layer.playback.Advance(step);
+		layer.playback.clip->Sample(layer.playback.timePos, layer.playback.cursors, scratch, scratch.layer);
+		if (layer.blend == LayerBlend::Additive)
+			AddLocalPose(scratch.local, scratch.layer, layer.reference, layer.boneWeights.data(), scratch.local);
+		else
+			BlendLocalPose(scratch.local, scratch.layer, layer.boneWeights.data(), scratch.local);
+	}
+
+	skinnedInfo->ComposeFinalTransforms(scratch.local, scratch, outFinalTransforms);
+}
 
 float BoneAnimation::GetStartTime() const
 {
-	return Keyframes.front().TimePos;
+	return KeyTime(0u);
 }
 
 float BoneAnimation::GetEndTime() const
 {
-	return Keyframes.back().TimePos;
+	return KeyTime(KeyCount() - 1u);
 }
 
-void BoneAnimation::Interpolate(float t, XMFLOAT4X4& M) const
+//cursor는 지난번에 찾은 구간의 시작 키. 시간이 조금씩 늘어나는 보통의 재생에서는
+//같은 구간이거나 바로 다음 구간이므로 O(1)이고, 되감기나 건너뛰기일 때만 이진 탐색을 한다.
+void BoneAnimation::FindKeys(float t, UINT& cursor, UINT& outKey0, UINT& outKey1, float& outFraction) const
 {
-	auto AffineTransformation = [](const Keyframe& keyframe) {
-		XMVECTOR S = XMLoadFloat3(&keyframe.Scale);
-		XMVECTOR P = XMLoadFloat3(&keyframe.Translation);
-		XMVECTOR Q = XMLoadFloat4(&keyframe.RotationQuat);
-		XMVECTOR zero = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
-		return XMMatrixAffineTransformation(S, zero, Q, P); };
+	outFraction = 0.0f;
+	if (t <= KeyTime(0u))
+	{
+		outKey0 = outKey1 = cursor = 0u;
+		return;
+	}
 
-	if (t <= Keyframes.front().TimePos)
-		XMStoreFloat4x4(&M, AffineTransformation(Keyframes.front()));
-	else if (t >= Keyframes.back().TimePos)
-		XMStoreFloat4x4(&M, AffineTransformation(Keyframes.back()));
-	else
+	const UINT lastKey = KeyCount() - 1u;
+	if (t >= KeyTime(lastKey))
 	{
-		for (auto i : std::views::iota(0, (int)Keyframes.size() - 1))
+		outKey0 = outKey1 = lastKey;
+		return;
+	}
+
+	auto InSegment = [this, t, lastKey](UINT key) {
+		return key < lastKey && KeyTime(key) < t && t <= KeyTime(key + 1u); };
+
+	if (!InSegment(cursor))
+	{
+		if (InSegment(cursor + 1u))
+			++cursor;
+		else
 		{
-			if (Keyframes[i].TimePos > t) continue;
-			if (Keyframes[i + 1].TimePos < t) continue;
+			auto next = std::ranges::partition_point(std::views::iota(1u, lastKey + 1u),
+				[this, t](UINT key) { return KeyTime(key) < t; });
+			cursor = *next - 1u;
+		}
+	}
 
-			float lerpPercent = (t - Keyframes[i].TimePos) / (Keyframes[i + 1].TimePos - Keyframes[i].TimePos);
+	outKey0 = cursor;
+	outKey1 = cursor + 1u;
+	outFraction = (t - KeyTime(cursor)) / (KeyTime(cursor + 1u) - KeyTime(cursor));
+}
 
-			XMVECTOR s0 = XMLoadFloat3(&Keyframes[i].Scale);
-			XMVECTOR s1 = XMLoadFloat3(&Keyframes[i + 1].Scale);
+void BoneAnimation::Interpolate(float t, XMFLOAT4X4& M) const
+{
+	UINT cursor{ 0u }, key0{ 0u }, key1{ 0u };
+	float lerpPercent{ 0.0f };
+	FindKeys(t, cursor, key0, key1, lerpPercent);
 
-			XMVECTOR p0 = XMLoadFloat3(&Keyframes[i].Translation);
-			XMVECTOR p1 = XMLoadFloat3(&Keyframes[i + 1].Translation);
+	Keyframe keyframe0{}, keyframe1{};
+	DecodeKey(key0, keyframe0);
+	DecodeKey(key1, keyframe1);
 
-			XMVECTOR q0 = XMLoadFloat4(&Keyframes[i].RotationQuat);
-			XMVECTOR q1 = XMLoadFloat4(&Keyframes[i + 1].RotationQuat);
+	XMVECTOR s0 = XMLoadFloat3(&keyframe0.Scale);
+	XMVECTOR s1 = XMLoadFloat3(&keyframe1.Scale);
 
-			XMVECTOR S = XMVectorLerp(s0, s1, lerpPercent);
-			XMVECTOR P = XMVectorLerp(p0, p1, lerpPercent);
-			XMVECTOR Q = XMQuaternionSlerp(q0, q1, lerpPercent);
-			XMVECTOR zero = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
-			XMStoreFloat4x4(&M, XMMatrixAffineTransformation(S, zero, Q, P));
+	XMVECTOR p0 = XMLoadFloat3(&keyframe0.Translation);
+	XMVECTOR p1 = XMLoadFloat3(&keyframe1.Translation);
 
-			break;
-		}
+	XMVECTOR q0 = XMLoadFloat4(&keyframe0.RotationQuat);
+	XMVECTOR q1 = XMLoadFloat4(&keyframe1.RotationQuat);
+
+	XMVECTOR S = XMVectorLerp(s0, s1, lerpPercent);
+	XMVECTOR P = XMVectorLerp(p0, p1, lerpPercent);
+	XMVECTOR Q = XMQuaternionSlerp(q0, q1, lerpPercent);
+	XMVECTOR zero = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
+	XMStoreFloat4x4(&M, XMMatrixAffineTransformation(S, zero, Q, P));
+}
+
+UINT BoneAnimation::KeyCount() const
+{
+	return static_cast<UINT>(IsCompressed() ? Times.size() : Keyframes.size());
+}
+
+float BoneAnimation::KeyTime(UINT key) const
+{
+	return IsCompressed() ? Times[key] : Keyframes[key].TimePos;
+}
+
+constexpr float QuatComponentRange = std::numbers::sqrt2_v<float> * 0.5f;
+constexpr float QuatComponentSteps = 32767.0f;
+
+inline std::uint16_t QuantizeQuatComponent(float value)
+{
+	const float unit = std::clamp((value / QuatComponentRange + 1.0f) * 0.5f, 0.0f, 1.0f);
+	return static_cast<std::uint16_t>(unit * QuatComponentSteps + 0.5f);
+}
+
+inline float DequantizeQuatComponent(std::uint16_t value)
+{
+	return (static_cast<float>(value & 0x7FFF) / QuatComponentSteps * 2.0f - 1.0f) * QuatComponentRange;
+}
+
+//q와 -q는 같은 회전이라 빠지는 성분을 양수로 맞추면 나머지 셋으로 복원할 수 있다.
+PackedQuaternion PackQuaternion(const XMFLOAT4& quat)
+{
+	std::array<float, 4> q{ quat.x, quat.y, quat.z, quat.w };
+	const auto largest = static_cast<std::uint16_t>(std::distance(q.begin(),
+		std::ranges::max_element(q, {}, [](float v) { return std::abs(v); })));
+	const float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+
+	std::array<std::uint16_t, 3> packed{};
+	for (UINT src = 0, dst = 0; src < 4; ++src)
+	{
+		if (src == largest) continue;
+		packed[dst++] = QuantizeQuatComponent(q[src] * sign);
+	}
+
+	return { static_cast<std::uint16_t>(packed[0] | ((largest >> 1) << 15)),
+		static_cast<std::uint16_t>(packed[1] | ((largest & 1) << 15)),
+		packed[2] };
+}
+
+XMFLOAT4 UnpackQuaternion(const PackedQuaternion& packed)
+{
+	const UINT largest = ((packed.a >> 15) << 1) | (packed.b >> 15);
+	const std::array<float, 3> small{
+		DequantizeQuatComponent(packed.a), DequantizeQuatComponent(packed.b), DequantizeQuatComponent(packed.c) };
+
+	std::array<float, 4> q{};
+	for (UINT dst = 0, src = 0; dst < 4; ++dst)
+	{
+		if (dst == largest) continue;
+		q[dst] = small[src++];
+	}
+	q[largest] = std::sqrt(std::max(0.0f, 1.0f - small[0] * small[0] - small[1] * small[1] - small[2] * small[2]));
+
+	return { q[0], q[1], q[2], q[3] };
+}
+
+//두 회전 사이의 각. acos는 1 근처에서 정밀도가 떨어져서 현의 길이로 구한다.
+float RotationError(const XMFLOAT4& a, const XMFLOAT4& b)
+{
+	XMVECTOR qa = XMLoadFloat4(&a);
+	XMVECTOR qb = XMLoadFloat4(&b);
+	if (XMVectorGetX(XMVector4Dot(qa, qb)) < 0.0f) qb = -qb;
+	const float chord = XMVectorGetX(XMVector4Length(qa - qb));
+	return 4.0f * std::asin(std::min(chord * 0.5f, 1.0f));
+}
+
+float TranslationError(const XMFLOAT3& a, const XMFLOAT3& b)
+{
+	return XMVectorGetX(XMVector3Length(XMLoadFloat3(&a) - XMLoadFloat3(&b)));
+}
+
+Keyframe LerpKeyframe(const Keyframe& key0, const Keyframe& key1, float t)
+{
+	const float fraction = (t - key0.TimePos) / (key1.TimePos - key0.TimePos);
+
+	Keyframe result{};
+	result.TimePos = t;
+	XMStoreFloat3(&result.Translation, XMVectorLerp(XMLoadFloat3(&key0.Translation), XMLoadFloat3(&key1.Translation), fraction));
+	XMStoreFloat3(&result.Scale, XMVectorLerp(XMLoadFloat3(&key0.Scale), XMLoadFloat3(&key1.Scale), fraction));
+	XMStoreFloat4(&result.RotationQuat, XMQuaternionSlerp(XMLoadFloat4(&key0.RotationQuat), XMLoadFloat4(&key1.RotationQuat), fraction));
+	return result;
+}
+
+bool WithinError(const Keyframe& expected, const Keyframe& actual, const AnimationCompression& settings)
+{
+	return TranslationError(expected.Translation, actual.Translation) <= settings.translationError &&
+		TranslationError(expected.Scale, actual.Scale) <= settings.scaleError &&
+		RotationError(expected.RotationQuat, actual.RotationQuat) <= settings.rotationError;
+}
+
+//anchor부터 구간을 늘려가다가 사이의 원래 키 중 하나라도 오차를 넘으면 바로 앞 키를 남긴다.
+//원래 키 사이는 양쪽 모두 선형이라 오차는 원래 키 위치에서 가장 크다.
+std::vector<UINT> ReduceKeys(const std::vector<Keyframe>& keyframes, const AnimationCompression& settings)
+{
+	const UINT lastKey = static_cast<UINT>(keyframes.size()) - 1u;
+	std::vector<UINT> keptKeys{ 0u };
+	UINT anchor = 0u;
+	for (UINT key = 2u; key <= lastKey; ++key)
+	{
+		bool fits = std::ranges::all_of(std::views::iota(anchor + 1u, key), [&](UINT middle) {
+			return WithinError(keyframes[middle],
+				LerpKeyframe(keyframes[anchor], keyframes[key], keyframes[middle].TimePos), settings); });
+		if (fits) continue;
+
+		anchor = key - 1u;
+		keptKeys.emplace_back(anchor);
+	}
+	if (lastKey > 0u) keptKeys.emplace_back(lastKey);
+
+	return keptKeys;
+}
+
+void BoneAnimation::Compress(const AnimationCompression& settings)
+{
+	if (Keyframes.empty() || IsCompressed()) return;
+
+	const std::vector<UINT> keptKeys = ReduceKeys(Keyframes, settings);
+	const Keyframe& first = Keyframes.front();
+	auto IsConstant = [this](auto isSame) { return std::ranges::all_of(Keyframes, isSame); };
+	const bool constantTranslation = IsConstant([&](const Keyframe& key) {
+		return TranslationError(first.Translation, key.Translation) <= settings.translationError; });
+	const bool constantScale = IsConstant([&](const Keyframe& key) {
+		return TranslationError(first.Scale, key.Scale) <= settings.scaleError; });
+	const bool constantRotation = IsConstant([&](const Keyframe& key) {
+		return RotationError(first.RotationQuat, key.RotationQuat) <= settings.rotationError; });
+
+	for (auto key : keptKeys)
+	{
+		const Keyframe& keyframe = Keyframes[key];
+		Times.emplace_back(keyframe.TimePos);
+		if (!constantTranslation || Translations.empty()) Translations.emplace_back(keyframe.Translation);
+		if (!constantScale || Scales.empty()) Scales.emplace_back(keyframe.Scale);
+		if (!constantRotation || Rotations.empty()) Rotations.emplace_back(PackQuaternion(keyframe.RotationQuat));
+	}
+
+	Keyframes.clear();
+	Keyframes.shrink_to_fit();
+}
+
+void BoneAnimation::DecodeKey(UINT key, Keyframe& outKeyframe) const
+{
+	if (!IsCompressed())
+	{
+		outKeyframe = Keyframes[key];
+		return;
 	}
+
+	outKeyframe.TimePos = Times[key];
+	outKeyframe.Translation = Translations[Translations.size() == 1 ? 0 : key];
+	outKeyframe.Scale = Scales[Scales.size() == 1 ? 0 : key];
+	outKeyframe.RotationQuat = UnpackQuaternion(Rotations[Rotations.size() == 1 ? 0 : key]);
+}
+
+std::size_t BoneAnimation::GetByteSize() const
+{
+	return Keyframes.size() * sizeof(Keyframe) + Times.size() * sizeof(float) +
+		Translations.size() * sizeof(XMFLOAT3) + Scales.size() * sizeof(XMFLOAT3) +
+		Rotations.size() * sizeof(PackedQuaternion);
 }
 
 float AnimationClip::GetClipStartTime() const
@@ -109,6 +529,23 @@ float AnimationClip::GetClipEndTime() const
 	return t;
 }
 
+void AnimationClip::Sample(float t, std::vector<UINT>& cursors, AnimationScratch& scratch, LocalPose& outPose) const
+{
+	for (UINT bone = 0; bone < BoneAnimations.size(); ++bone)
+	{
+		UINT key0{ 0u }, key1{ 0u };
+		Keyframe keyframe{};
+		const BoneAnimation& boneAnimation = BoneAnimations[bone];
+		boneAnimation.FindKeys(t, cursors[bone], key0, key1, scratch.fraction[bone]);
+		boneAnimation.DecodeKey(key0, keyframe);
+		scratch.key0.Set(bone, keyframe);
+		boneAnimation.DecodeKey(key1, keyframe);
+		scratch.key1.Set(bone, keyframe);
+	}
+
+	BlendLocalPose(scratch.key0, scratch.key1, scratch.fraction.data(), outPose);
+}
+
 void AnimationClip::Interpolate(float t, std::vector<XMFLOAT4X4>& boneTransforms) const
 {
 	for (UINT i = 0; i < BoneAnimations.size(); ++i)
@@ -117,6 +554,12 @@ void AnimationClip::Interpolate(float t, std::vector<XMFLOAT4X4>& boneTransforms
 	}
 }
 
+std::size_t AnimationClip::GetByteSize() const
+{
+	return std::accumulate(BoneAnimations.begin(), BoneAnimations.end(), std::size_t{ 0 },
+		[](std::size_t size, const BoneAnimation& boneAnimation) { return size + boneAnimation.GetByteSize(); });
+}
+
 float CSkinnedData::GetClipStartTime(const std::string& clipName) const
 {
 	auto clip = mAnimations.find(clipName);
@@ -142,36 +585,107 @@ void CSkinnedData::Set(
 	mBoneHierarchy = boneHierarchy;
 	mBoneOffsets = boneOffsets;
 	mAnimations = animations;
+
+	//부모가 자식보다 먼저 계산되도록 깊이 순으로 정렬해 둔다.
+	std::vector<UINT> depths(mBoneHierarchy.size(), 0u);
+	for (auto i : std::views::iota(0u, static_cast<UINT>(mBoneHierarchy.size())))
+	{
+		for (int parent = mBoneHierarchy[i]; parent >= 0; parent = mBoneHierarchy[parent])
+			++depths[i];
+	}
+
+	mEvaluationOrder.resize(mBoneHierarchy.size());
+	std::iota(mEvaluationOrder.begin(), mEvaluationOrder.end(), 0u);
+	std::ranges::stable_sort(mEvaluationOrder, {}, [&depths](UINT bone) { return depths[bone]; });
+}
+
+//MeshCache는 Keyframes를 저장하므로 캐시를 쓴 다음에 불러야 한다.
+void CSkinnedData::CompressAnimations(const AnimationCompression& settings)
+{
+	for (auto& [clipName, clip] : mAnimations)
+	{
+		std::for_each(std::execution::par, clip.BoneAnimations.begin(), clip.BoneAnimations.end(),
+			[&settings](BoneAnimation& boneAnimation) { boneAnimation.Compress(settings); });
+	}
+}
+
+ClipHandle CSkinnedData::GetClipHandle(const std::string& clipName) const
+{
+	auto clip = mAnimations.find(clipName);
+	if (clip == mAnimations.end()) return nullptr;
+
+	return &clip->second;
+}
+
+//rootBone과 그 아래 본들만 1인 마스크. 부모가 먼저 나오는 순서로 돌아서 한번에 채운다.
+void CSkinnedData::MakeBoneMask(UINT rootBone, std::vector<float>& outMask) const
+{
+	outMask.assign(BoneCount(), 0.0f);
+	for (auto bone : mEvaluationOrder)
+	{
+		int parentIndex = mBoneHierarchy[bone];
+		if (bone == rootBone || (parentIndex >= 0 && outMask[parentIndex] > 0.0f))
+			outMask[bone] = 1.0f;
+	}
 }
 
 void CSkinnedData::GetFinalTransforms(
 	const std::string& clipName, float timePos, std::vector<XMFLOAT4X4>& finalTransforms) const
 {
-	UINT numBones = static_cast<UINT>(mBoneOffsets.size());
-
-	std::vector<XMFLOAT4X4> toParentTransforms(numBones);
+	AnimationScratch scratch{};
+	scratch.Resize(BoneCount());
+	GetFinalTransforms(GetClipHandle(clipName), timePos, scratch, finalTransforms.data());
+}
 
-	auto clip = mAnimations.find(clipName);
-	clip->second.Interpolate(timePos, toParentTransforms);
+void CSkinnedData::GetFinalTransforms(
+	ClipHandle clip, float timePos, AnimationScratch& scratch, XMFLOAT4X4* finalTransforms) const
+{
+	clip->Sample(timePos, scratch.cursors, scratch, scratch.local);
+	ComposeFinalTransforms(scratch.local, scratch, finalTransforms);
+}
 
-	std::vector<XMFLOAT4X4> toRootTransforms(numBones);
-	toRootTransforms[0] = toParentTransforms[0];
+void CSkinnedData::ComposeFinalTransforms(
+	const LocalPose& pose, AnimationScratch& scratch, XMFLOAT4X4* finalTransforms) const
+{
+	const XMVECTOR one = XMVectorSplatOne();
+	const XMVECTOR two = XMVectorReplicate(2.0f);
+	const XMVECTOR zero = XMVectorZero();
 
-	for (auto i : std::views::iota(1, static_cast<int>(numBones)))
+	//4개 본의 SRT로 로컬 행렬을 SoA 상태에서 만들고, 전치해서 본별 행렬로 되돌린다.
+	for (UINT i = 0; i < pose.PaddedCount(); i += 4)
 	{
-		XMMATRIX toParent = XMLoadFloat4x4(&toParentTransforms[i]);
-		int parentIndex = mBoneHierarchy[i];
-		XMMATRIX parentToRoot = XMLoadFloat4x4(&toRootTransforms[parentIndex]);
-		XMMATRIX toRoot = XMMatrixMultiply(toParent, parentToRoot);
+		XMVECTOR x = LoadLanes(pose.qx, i), y = LoadLanes(pose.qy, i), z = LoadLanes(pose.qz, i), w = LoadLanes(pose.qw, i);
+		XMVECTOR sx = LoadLanes(pose.sx, i), sy = LoadLanes(pose.sy, i), sz = LoadLanes(pose.sz, i);
+
+		XMVECTOR xx = x * x, yy = y * y, zz = z * z;
+		XMVECTOR xy = x * y, xz = x * z, yz = y * z;
+		XMVECTOR xw = x * w, yw = y * w, zw = z * w;
+
+		XMMATRIX row0 = XMMatrixTranspose(XMMATRIX(
+			(one - two * (yy + zz)) * sx, two * (xy + zw) * sx, two * (xz - yw) * sx, zero));
+		XMMATRIX row1 = XMMatrixTranspose(XMMATRIX(
+			two * (xy - zw) * sy, (one - two * (xx + zz)) * sy, two * (yz + xw) * sy, zero));
+		XMMATRIX row2 = XMMatrixTranspose(XMMATRIX(
+			two * (xz + yw) * sz, two * (yz - xw) * sz, (one - two * (xx + yy)) * sz, zero));
+		XMMATRIX row3 = XMMatrixTranspose(XMMATRIX(
+			LoadLanes(pose.tx, i), LoadLanes(pose.ty, i), LoadLanes(pose.tz, i), one));
+
+		const UINT laneCount = std::min(4u, pose.boneCount - i);
+		for (UINT lane = 0; lane < laneCount; ++lane)
+			scratch.toRoot[i + lane] = XMMATRIX(row0.r[lane], row1.r[lane], row2.r[lane], row3.r[lane]);
+	}
 
-		XMStoreFloat4x4(&toRootTransforms[i], toRoot);
+	//부모가 먼저 계산되어 있으므로 로컬 행렬 자리에 그대로 루트 기준 행렬을 덮어쓴다.
+	for (auto bone : mEvaluationOrder)
+	{
+		int parentIndex = mBoneHierarchy[bone];
+		if (parentIndex < 0) continue;
+		scratch.toRoot[bone] = XMMatrixMultiply(scratch.toRoot[bone], scratch.toRoot[parentIndex]);
 	}
 
-	for (auto i : std::views::iota(0, static_cast<int>(numBones)))
+	for (auto i : std::views::iota(0u, pose.boneCount))
 	{
 		XMMATRIX offset = XMLoadFloat4x4(&mBoneOffsets[i]);
-		XMMATRIX toRoot = XMLoadFloat4x4(&toRootTransforms[i]);
-		XMMATRIX finalTransform = XMMatrixMultiply(offset, toRoot);
-		XMStoreFloat4x4(&finalTransforms[i], XMMatrixTranspose(finalTransform));
+		XMStoreFloat4x4(&finalTransforms[i], XMMatrixTranspose(XMMatrixMultiply(offset, scratch.toRoot[i])));
 	}
 }
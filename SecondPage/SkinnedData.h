@@ -1,4 +1,4 @@
-#pragma once
+﻿#pragma once
 
 class CSkinnedData;
 
@@ -27,13 +27,61 @@ struct M3dMaterial
 
 struct Keyframe
 {
-	Keyframe();
-	~Keyframe();
-
 	float TimePos{ 0.0f };
-	DirectX::XMFLOAT3 Translation{};
-	DirectX::XMFLOAT3 Scale{};
-	DirectX::XMFLOAT4 RotationQuat{};
+	DirectX::XMFLOAT3 Translation{ 0.0f, 0.0f, 0.0f };
+	DirectX::XMFLOAT3 Scale{ 1.0f, 1.0f, 1.0f };
+	DirectX::XMFLOAT4 RotationQuat{ 0.0f, 0.0f, 0.0f, 1.0f };
+};
+
+//smallest-three로 양자화한 회전. 절대값이 가장 큰 성분은 나머지로 복원하고 셋만 15비트씩 저장한다.
+//a, b의 최상위 비트에 빠진 성분의 번호를 넣는다.
+struct PackedQuaternion
+{
+	std::uint16_t a{ 0u };
+	std::uint16_t b{ 0u };
+	std::uint16_t c{ 0u };
+};
+
+//키를 지울 때 허용하는 오차. 회전은 라디안
+struct AnimationCompression
+{
+	float translationError{ 0.001f };
+	float rotationError{ 0.001f };
+	float scaleError{ 0.0001f };
+};
+
+//본별 로컬 SRT를 SoA로 저장한다. SIMD로 4개씩 처리하도록 배열 길이를 4의 배수로 맞춘다.
+struct LocalPose
+{
+	void Resize(UINT count);
+	void Set(UINT bone, const Keyframe& keyframe);
+	inline UINT PaddedCount() const;
+
+	UINT boneCount{ 0u };
+	std::vector<float> tx, ty, tz;
+	std::vector<float> qx, qy, qz, qw;
+	std::vector<float> sx, sy, sz;
+};
+
+//두 포즈를 본별 weight로 섞는다. 이동, 스케일은 lerp, 회전은 slerp
+void BlendLocalPose(const LocalPose& a, const LocalPose& b, const float* weights, LocalPose& out);
+//additive가 reference에서 벗어난 만큼을 본별 weight 비율로 base에 더한다.
+void AddLocalPose(const LocalPose& base, const LocalPose& additive, const LocalPose& reference,
+	const float* weights, LocalPose& out);
+
+//매 프레임 할당하지 않도록 인스턴스가 들고 있는 작업 버퍼
+struct AnimationScratch
+{
+	void Resize(UINT boneCount);
+
+	LocalPose key0{};
+	LocalPose key1{};
+	LocalPose local{};
+	LocalPose layer{};
+	std::vector<float> fraction{};
+	std::vector<float> weights{};
+	std::vector<UINT> cursors{};
+	std::vector<DirectX::XMMATRIX> toRoot{};
 };
 
 struct BoneAnimation
@@ -41,9 +89,23 @@ struct BoneAnimation
 	float GetStartTime() const;
 	float GetEndTime() const;
 
+	void FindKeys(float t, UINT& cursor, UINT& outKey0, UINT& outKey1, float& outFraction) const;
 	void Interpolate(float t, DirectX::XMFLOAT4X4& M) const;
 
+	void Compress(const AnimationCompression& settings);
+	UINT KeyCount() const;
+	float KeyTime(UINT key) const;
+	void DecodeKey(UINT key, Keyframe& outKeyframe) const;
+	std::size_t GetByteSize() const;
+	inline bool IsCompressed() const;
+
 	std::vector<Keyframe> Keyframes;
+
+	//Compress 후에는 Keyframes를 비우고 아래 값만 쓴다. 원소가 하나인 채널은 상수 트랙이다.
+	std::vector<float> Times;
+	std::vector<DirectX::XMFLOAT3> Translations;
+	std::vector<DirectX::XMFLOAT3> Scales;
+	std::vector<PackedQuaternion> Rotations;
 };
 
 struct AnimationClip
@@ -51,19 +113,62 @@ struct AnimationClip
 	float GetClipStartTime() const;
 	float GetClipEndTime() const;
 
+	void Sample(float t, std::vector<UINT>& cursors, AnimationScratch& scratch, LocalPose& outPose) const;
 	void Interpolate(float t, std::vector<DirectX::XMFLOAT4X4>& boneTransforms) const;
+	std::size_t GetByteSize() const;
 
 	std::vector<BoneAnimation> BoneAnimations;
 };
 
-struct SkinnedModelInstance
+//문자열로 찾는 비용을 매 프레임 내지 않도록 한번 찾아 둔 클립
+using ClipHandle = const AnimationClip*;
+
+//클립 하나의 재생 위치. 키 탐색 커서를 재생하는 쪽마다 따로 가진다.
+struct ClipPlayback
 {
-	CSkinnedData* skinnedInfo = nullptr;
-	std::vector<DirectX::XMFLOAT4X4> finalTransforms;
-	std::string clipName;
+	bool Set(const CSkinnedData* skinnedInfo, const std::string& name);
+	void Advance(float dt);
+
+	std::string clipName{};
+	ClipHandle clip{ nullptr };
+	float clipEndTime{ 0.0f };
 	float timePos{ 0.0f };
+	std::vector<UINT> cursors{};
+};
 
-	void UpdateSkinnedAnimation(float dt);
+enum class LayerBlend : int
+{
+	Override,	//레이어 포즈로 덮어쓴다(상체만 다른 동작 등)
+	Additive,	//클립 첫 프레임과의 차이만 더한다
+};
+
+struct AnimationLayer
+{
+	LayerBlend blend{ LayerBlend::Override };
+	ClipPlayback playback{};
+	LocalPose reference{};
+	std::vector<float> boneMask{};
+	std::vector<float> boneWeights{};
+};
+
+//본 마스크는 본 개수만큼의 0~1 값. 비어 있으면 모든 본에 적용한다.
+//클립, 레이어를 바꿀 때만 버퍼를 잡고 UpdateSkinnedAnimation에서는 할당하지 않는다.
+struct SkinnedModelInstance
+{
+	CSkinnedData* skinnedInfo = nullptr;
+	ClipPlayback current{};
+	ClipPlayback next{};
+	float fadeDuration{ 0.0f };
+	float fadeElapsed{ 0.0f };
+	float playbackRate{ 1.0f };
+	std::vector<AnimationLayer> layers{};
+	AnimationScratch scratch{};
+
+	bool SetClip(const std::string& name);
+	bool CrossFade(const std::string& name, float duration);
+	bool AddLayer(LayerBlend blend, const std::string& name, float weight, const std::vector<float>& boneMask = {});
+	void SetLayerWeight(UINT layerIndex, float weight);
+	void UpdateSkinnedAnimation(float dt, DirectX::XMFLOAT4X4* outFinalTransforms);
 };
 
 class CSkinnedData
@@ -79,11 +184,30 @@ public:
 		std::vector<DirectX::XMFLOAT4X4>& boneOffsets,
 		std::unordered_map<std::string, AnimationClip>& animations);
 
+	ClipHandle GetClipHandle(const std::string& clipName) const;
+	void MakeBoneMask(UINT rootBone, std::vector<float>& outMask) const;
+	void CompressAnimations(const AnimationCompression& settings);
+
 	void GetFinalTransforms(const std::string& clipName, float timePos,
 		std::vector<DirectX::XMFLOAT4X4>& finalTransforms) const;
+	void GetFinalTransforms(ClipHandle clip, float timePos,
+		AnimationScratch& scratch, DirectX::XMFLOAT4X4* finalTransforms) const;
+	void ComposeFinalTransforms(const LocalPose& pose,
+		AnimationScratch& scratch, DirectX::XMFLOAT4X4* finalTransforms) const;
+
+	inline const std::vector<int>& GetBoneHierarchy() const;
+	inline const std::vector<DirectX::XMFLOAT4X4>& GetBoneOffsets() const;
+	inline const std::unordered_map<std::string, AnimationClip>& GetAnimations() const;
 
 private:
 	std::vector<int> mBoneHierarchy;
 	std::vector<DirectX::XMFLOAT4X4> mBoneOffsets;
 	std::unordered_map<std::string, AnimationClip> mAnimations;
-};
\ No newline at end of file
+	std::vector<UINT> mEvaluationOrder;
+};
+
+inline const std::vector<int>& CSkinnedData::GetBoneHierarchy() const { return mBoneHierarchy; }
+inline const std::vector<DirectX::XMFLOAT4X4>& CSkinnedData::GetBoneOffsets() const { return mBoneOffsets; }
+inline const std::unordered_map<std::string, AnimationClip>& CSkinnedData::GetAnimations() const { return mAnimations; }
+inline bool BoneAnimation::IsCompressed() const { return !Times.empty(); }
+inline UINT LocalPose::PaddedCount() const { return static_cast<UINT>(tx.size()); }
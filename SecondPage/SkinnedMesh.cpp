@@ -10,6 +10,8 @@
 #include "./Material.h"
 #include "./Helper.h"
 #include "./Utility.h"
+#include "./MeshCache.h"
+#include <execution>
 
 CSkinnedMesh::~CSkinnedMesh() = default;
 CSkinnedMesh::CSkinnedMesh(const std::wstring& resPath)
@@ -19,7 +21,10 @@ CSkinnedMesh::CSkinnedMesh(const std::wstring& resPath)
 	, m_skinnedInfo{ std::make_unique<CSkinnedData>() }
 	, m_skinnedSubsets{}
 	, m_skinnedMats{}
-	, m_skinnedModelInst{ std::make_unique<SkinnedModelInstance>() }
+	, m_materialIds{}
+	, m_skinnedModelInsts{}
+	, m_instanceWorlds{}
+	, m_bonePalette{}
 {}
 
 bool CSkinnedMesh::Read(const std::string& meshName, ModelProperty* mProperty)
@@ -28,14 +33,44 @@ bool CSkinnedMesh::Read(const std::string& meshName, ModelProperty* mProperty)
 
 	std::wstring fullFilename = m_resPath + m_filePath + filename;
 
-	CLoadM3D loadM3d;
-	loadM3d.Read(fullFilename, m_skinnedVertices, m_indices,
-		m_skinnedSubsets, m_skinnedMats, m_skinnedInfo.get());
+	CMeshCache meshCache;
+	if (!meshCache.Load(fullFilename, m_skinnedVertices, m_indices,
+		m_skinnedSubsets, m_skinnedMats, m_skinnedInfo.get()))
+	{
+		CLoadM3D loadM3d;
+		ReturnIfFalse(loadM3d.Read(fullFilename, m_skinnedVertices, m_indices,
+			m_skinnedSubsets, m_skinnedMats, m_skinnedInfo.get()));
+		meshCache.Save(fullFilename, m_skinnedVertices, m_indices,
+			m_skinnedSubsets, m_skinnedMats, m_skinnedInfo.get());
+	}
+	//캐시에는 원래 키를 두고 읽을 때마다 압축한다. 허용 오차를 바꿔도 캐시를 다시 만들 필요가 없다.
+	m_skinnedInfo->CompressAnimations(AnimationCompression{});
+
+	if (mProperty->instances.Empty())
+	{
+		DirectX::XMMATRIX modelScale = DirectX::XMMatrixScaling(0.05f, 0.05f, -0.05f);
+		DirectX::XMMATRIX modelRot = DirectX::XMMatrixRotationY(static_cast<float>(std::numbers::pi));
+		DirectX::XMMATRIX modelOffset = DirectX::XMMatrixTranslation(0.0f, 0.0f, -5.0f);
+		ReturnIfFalse(AddInstance("Take1", modelScale * modelRot * modelOffset));
+	}
+
+	for (auto& world : mProperty->instances.GetWorlds())
+		ReturnIfFalse(AddInstance("Take1", world));
 
-	m_skinnedModelInst->skinnedInfo = m_skinnedInfo.get();
-	m_skinnedModelInst->finalTransforms.resize(m_skinnedInfo->BoneCount());
-	m_skinnedModelInst->clipName = "Take1";
-	m_skinnedModelInst->timePos = 0.0f;
+	return true;
+}
+
+//LoadMeshIntoVRAM 전에 불러야 서브셋의 인스턴스 목록에 들어간다.
+bool CSkinnedMesh::AddInstance(const std::string& clipName, const DirectX::XMMATRIX& world, float playbackRate)
+{
+	SkinnedModelInstance instance{};
+	instance.skinnedInfo = m_skinnedInfo.get();
+	instance.playbackRate = playbackRate;
+	ReturnIfFalse(instance.SetClip(clipName));
+
+	m_skinnedModelInsts.emplace_back(std::move(instance));
+	m_instanceWorlds.emplace_back(world);
+	m_bonePalette.resize(m_skinnedModelInsts.size() * m_skinnedInfo->BoneCount());
 
 	return true;
 }
@@ -47,22 +82,24 @@ bool CSkinnedMesh::LoadMeshIntoVRAM(IRenderer* renderer, CMaterial* material, Al
 	auto renderItem = MakeRenderItem(*outRenderItems, GraphicsPSO::SkinnedOpaque);
 
 	ReturnIfFalse(LoadVRAM(renderer, renderItem));
-	ReturnIfFalse(InsertSubmesh(renderItem));
 	ReturnIfFalse(InsertMaterial(material));
+	ReturnIfFalse(InsertSubmesh(renderItem));
 
 	return true;
 }
 
 void CSkinnedMesh::UpdateAnimation(IRenderer* renderer, float deltaTime)
 {
-	if (m_skinnedModelInst->skinnedInfo == nullptr) return;
-
-	m_skinnedModelInst->UpdateSkinnedAnimation(deltaTime);
+	if (m_skinnedModelInsts.empty()) return;
 
-	SkinnedConstants skinnedConstants;
-	std::ranges::copy( m_skinnedModelInst->finalTransforms, &skinnedConstants.boneTransforms[0]);
+	//인스턴스마다 작업 버퍼와 팔레트 구간이 따로 있어서 병렬로 갱신해도 겹치지 않는다.
+	const UINT boneCount = m_skinnedInfo->BoneCount();
+	std::for_each(std::execution::par, m_skinnedModelInsts.begin(), m_skinnedModelInsts.end(),
+		[this, deltaTime, boneCount](auto& instance) {
+			const std::size_t index = &instance - m_skinnedModelInsts.data();
+			instance.UpdateSkinnedAnimation(deltaTime, &m_bonePalette[index * boneCount]); });
 
-	renderer->SetUploadBuffer(eBufferType::SkinnedCB, &skinnedConstants, 1);
+	renderer->SetUploadBuffer(eBufferType::BonePalette, m_bonePalette.data(), m_bonePalette.size());
 }
 
 bool CSkinnedMesh::LoadVRAM(IRenderer* renderer, RenderItem* renderItem)
@@ -76,7 +113,7 @@ bool CSkinnedMesh::LoadVRAM(IRenderer* renderer, RenderItem* renderItem)
 	renderItem->indexBufferView.SizeInBytes = ibByteSize;
 	renderItem->indexBufferView.Format = DXGI_FORMAT_R32_UINT;
 
-	//׷ ޸𸮿 ø.
+	//그래픽 메모리에 올린다.
 	ReturnIfFalse(renderer->LoadMesh(GraphicsPSO::SkinnedOpaque, m_skinnedVertices.data(), m_indices.data(), renderItem));
 
 	return true;
@@ -94,7 +131,7 @@ bool CSkinnedMesh::InsertSubmesh(RenderItem* renderItem)
 		subItem.startIndexLocation = static_cast<UINT>(subset.faceStart) * 3;
 		subItem.baseVertexLocation = 0;
 
-		renderItem->subRenderItems.insert(std::make_pair(subMeshName, subRenderItem)); 
+		(*GetSubRenderItem(renderItem, subMeshName)) = std::move(subRenderItem); 
 		});
 
 	return true;
@@ -102,18 +139,19 @@ bool CSkinnedMesh::InsertSubmesh(RenderItem* renderItem)
 
 bool CSkinnedMesh::SetTransform(int matIndex, SubRenderItem& subRItem)
 {
-	subRItem.instanceCount = 1;
-	std::shared_ptr<InstanceData> instanceData = std::make_shared<InstanceData>();
-	
-	DirectX::XMMATRIX modelScale = DirectX::XMMatrixScaling(0.05f, 0.05f, -0.05f);
-	DirectX::XMMATRIX modelRot = DirectX::XMMatrixRotationY(static_cast<float>(std::numbers::pi));
-	DirectX::XMMATRIX modelOffset = DirectX::XMMatrixTranslation(0.0f, 0.0f, -5.0f);
-
-	instanceData->matName = m_skinnedMats[matIndex].name;
-	instanceData->world = modelScale * modelRot * modelOffset;
-	instanceData->texTransform = DirectX::XMMatrixIdentity();
-
-	subRItem.instanceDataList.emplace_back(std::move(instanceData));
+	const UINT boneCount = m_skinnedInfo->BoneCount();
+	subRItem.instanceCount = GetInstanceCount();
+	subRItem.instances.Reserve(GetInstanceCount());
+	for (auto i : std::views::iota(0u, GetInstanceCount()))
+	{
+		InstanceData instanceData{};
+		instanceData.materialId = m_materialIds[matIndex];
+		instanceData.world = m_instanceWorlds[i];
+		instanceData.texTransform = DirectX::XMMatrixIdentity();
+		instanceData.paletteOffset = i * boneCount;
+
+		subRItem.instances.Add(instanceData);
+	}
 
 	return true;
 }
@@ -132,7 +170,7 @@ bool CSkinnedMesh::InsertMaterial(CMaterial* material)
 		mat->roughness = skinnedMat.roughness; 
 		materialList.emplace_back(std::move(mat)); });
 
-	material->SetMaterialList(materialList);
+	material->SetMaterialList(materialList, &m_materialIds);
 
 	return true;
 }
\ No newline at end of file
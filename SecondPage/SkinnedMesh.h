@@ -1,4 +1,4 @@
-#pragma once
+﻿#pragma once
 
 interface IRenderer;
 class CSkinnedData;
@@ -28,9 +28,12 @@ public:
 	CSkinnedMesh& operator=(const CSkinnedMesh&) = delete;
 
 	bool Read(const std::string& meshName, ModelProperty* mProperty);
+	bool AddInstance(const std::string& clipName, const DirectX::XMMATRIX& world, float playbackRate = 1.0f);
 	bool LoadMeshIntoVRAM(IRenderer* renderer, CMaterial* material, AllRenderItems* outRenderItems);
 	void UpdateAnimation(IRenderer* renderer, float deltaTime);
 
+	inline UINT GetInstanceCount() const;
+
 private:
 	bool LoadVRAM(IRenderer* renderer, RenderItem* outRenderItems);
 	bool InsertSubmesh(RenderItem* outRenderItems);
@@ -47,5 +50,11 @@ private:
 	std::unique_ptr<CSkinnedData> m_skinnedInfo;
 	std::vector<Subset> m_skinnedSubsets;
 	std::vector<M3dMaterial> m_skinnedMats;
-	std::unique_ptr<SkinnedModelInstance> m_skinnedModelInst;
-};
\ No newline at end of file
+	std::vector<UINT> m_materialIds;	//m_skinnedMats 순서대로 CMaterial에 등록된 번호
+	//인스턴스마다 클립, 시간, 재생 속도가 따로 있고 팔레트는 인스턴스 순서대로 이어져 있다.
+	std::vector<SkinnedModelInstance> m_skinnedModelInsts;
+	std::vector<DirectX::XMMATRIX> m_instanceWorlds;
+	std::vector<DirectX::XMFLOAT4X4> m_bonePalette;
+};
+
+inline UINT CSkinnedMesh::GetInstanceCount() const { return static_cast<UINT>(m_skinnedModelInsts.size()); }
\ No newline at end of file
@@ -0,0 +1,171 @@
+﻿#include "pch.h"
+#include "./TextScanner.h"
+#include <bit>
+#include <charconv>
+#include <filesystem>
+#include <emmintrin.h>
+
+constexpr bool IsSpace(char c)
+{
+	return static_cast<unsigned char>(c) <= ' ';
+}
+
+//16바이트를 한번에 비교해서 ' ' 이하(공백, 탭, 개행)인 바이트의 비트를 켠다.
+inline int SpaceMask(const char* cur)
+{
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(chars, space), space));
+}
+
+CTextScanner::CTextScanner()
+	: m_buffer{}
+	, m_begin{ nullptr }
+	, m_cur{ nullptr }
+	, m_end{ nullptr }
+{}
+
+CTextScanner::CTextScanner(const char* begin, const char* end)
+	: m_buffer{}
+	, m_begin{ begin }
+	, m_cur{ begin }
+	, m_end{ end }
+{}
+
+CTextScanner::~CTextScanner() = default;
+
+bool CTextScanner::Open(const std::wstring& filename)
+{
+	std::error_code ec{};
+	const auto fileSize = std::filesystem::file_size(filename, ec);
+	if (ec) return false;
+
+	std::ifstream fin(filename, std::ios::binary);
+	if (fin.fail()) return false;
+
+	m_buffer.resize(static_cast<std::size_t>(fileSize));
+	fin.read(m_buffer.data(), static_cast<std::streamsize>(fileSize));
+	if (fin.gcount() != static_cast<std::streamsize>(fileSize)) return false;
+
+	m_begin = m_buffer.data();
+	m_cur = m_begin;
+	m_end = m_begin + m_buffer.size();
+
+	return true;
+}
+
+//줄 중간에서 잘리지 않도록 각 경계를 다음 줄의 시작으로 민다.
+std::vector<std::pair<const char*, const char*>> CTextScanner::SplitLines(const char* begin, const char* end, UINT chunkCount)
+{
+	std::vector<std::pair<const char*, const char*>> chunks{};
+	chunks.reserve(chunkCount);
+
+	const std::size_t chunkSize = static_cast<std::size_t>(end - begin) / std::max(chunkCount, 1u) + 1;
+	const char* chunkBegin = begin;
+	while (chunkBegin != end)
+	{
+		const char* chunkEnd = chunkBegin + std::min(chunkSize, static_cast<std::size_t>(end - chunkBegin));
+		chunkEnd = std::find(chunkEnd, end, '\n');
+		if (chunkEnd != end) ++chunkEnd;
+
+		chunks.emplace_back(chunkBegin, chunkEnd);
+		chunkBegin = chunkEnd;
+	}
+
+	return chunks;
+}
+
+void CTextScanner::SkipSpace()
+{
+	while (m_end - m_cur >= 16)
+	{
+		const int mask = SpaceMask(m_cur);
+		if (mask != 0xFFFF)
+		{
+			m_cur += std::countr_one(static_cast<unsigned int>(mask));
+			return;
+		}
+		m_cur += 16;
+	}
+	while (m_cur != m_end && IsSpace(*m_cur)) ++m_cur;
+}
+
+const char* CTextScanner::FindSpace(const char* cur) const
+{
+	while (m_end - cur >= 16)
+	{
+		const int mask = SpaceMask(cur);
+		if (mask != 0)
+			return cur + std::countr_zero(static_cast<unsigned int>(mask));
+		cur += 16;
+	}
+	while (cur != m_end && !IsSpace(*cur)) ++cur;
+	return cur;
+}
+
+std::string_view CTextScanner::NextToken()
+{
+	SkipSpace();
+	const char* tokenEnd = FindSpace(m_cur);
+	std::string_view token(m_cur, static_cast<std::size_t>(tokenEnd - m_cur));
+	m_cur = tokenEnd;
+
+	return token;
+}
+
+bool CTextScanner::Skip(UINT count)
+{
+	for (auto i{ 0u }; i < count; ++i)
+	{
+		if (NextToken().empty()) return false;
+	}
+	return true;
+}
+
+bool CTextScanner::Read(float& outValue)
+{
+	SkipSpace();
+	auto [ptr, ec] = std::from_chars(m_cur, m_end, outValue);
+	if (ec != std::errc{}) return false;
+
+	m_cur = ptr;
+	return true;
+}
+
+bool CTextScanner::Read(int& outValue)
+{
+	SkipSpace();
+	auto [ptr, ec] = std::from_chars(m_cur, m_end, outValue);
+	if (ec != std::errc{}) return false;
+
+	m_cur = ptr;
+	return true;
+}
+
+bool CTextScanner::Read(UINT& outValue)
+{
+	//Subset id처럼 -1이 들어있는 값이 있어서 부호 있는 값으로 읽고 바꾼다.
+	int value{ 0 };
+	if (!Read(value)) return false;
+
+	outValue = static_cast<UINT>(value);
+	return true;
+}
+
+bool CTextScanner::Read(bool& outValue)
+{
+	int value{ 0 };
+	if (!Read(value)) return false;
+
+	outValue = (value != 0);
+	return true;
+}
+
+bool CTextScanner::Read(std::string& outValue)
+{
+	std::string_view token = NextToken();
+	if (token.empty()) return false;
+
+	outValue.assign(token);
+	return true;
+}
@@ -0,0 +1,71 @@
+﻿#pragma once
+
+//텍스트 리소스를 한번에 읽어 놓고 토큰 단위로 잘라서 읽는다.
+//istream의 operator>>와 달리 로케일을 타지 않고, 라벨을 건너뛸 때 string을 만들지 않는다.
+//숫자는 std::from_chars로 바로 변환한다.
+class CTextScanner
+{
+public:
+	CTextScanner();
+	CTextScanner(const char* begin, const char* end);
+	~CTextScanner();
+
+	CTextScanner(const CTextScanner&) = delete;
+	CTextScanner& operator=(const CTextScanner&) = delete;
+
+	bool Open(const std::wstring& filename);
+	static std::vector<std::pair<const char*, const char*>> SplitLines(const char* begin, const char* end, UINT chunkCount);
+
+	std::string_view NextToken();
+	bool Skip(UINT count = 1);
+
+	bool Read(float& outValue);
+	bool Read(int& outValue);
+	bool Read(UINT& outValue);
+	bool Read(bool& outValue);
+	bool Read(std::string& outValue);
+
+	template<typename... Ts>
+	bool Read(Ts&... outValues);
+	template<typename... Ts>
+	bool ReadLabeled(Ts&... outValues);
+
+	inline bool IsEnd();
+	inline const char* GetCursor() const;
+	inline const char* GetBegin() const;
+	inline const char* GetEnd() const;
+	inline void SetCursor(const char* cur);
+
+private:
+	void SkipSpace();
+	const char* FindSpace(const char* cur) const;
+
+	std::vector<char> m_buffer;
+	const char* m_begin;
+	const char* m_cur;
+	const char* m_end;
+};
+
+template<typename... Ts>
+bool CTextScanner::Read(Ts&... outValues)
+{
+	return (Read(outValues) && ...);
+}
+
+//"Pos: 1 2 3" 처럼 라벨 하나 뒤에 값이 오는 줄
+template<typename... Ts>
+bool CTextScanner::ReadLabeled(Ts&... outValues)
+{
+	return Skip() && (Read(outValues) && ...);
+}
+
+inline bool CTextScanner::IsEnd()
+{
+	SkipSpace();
+	return m_cur == m_end;
+}
+
+inline const char* CTextScanner::GetCursor() const { return m_cur; }
+inline const char* CTextScanner::GetBegin() const { return m_begin; }
+inline const char* CTextScanner::GetEnd() const { return m_end; }
+inline void CTextScanner::SetCursor(const char* cur) { m_cur = cur; }
@@ -3,7 +3,7 @@
 
 LRESULT CALLBACK CWindow::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
-	//for_each ٰ ǹǷ return ص WndProcԼ  ν ʴ´ ׷ for
+	//for_each는 람다가 사용되므로 return을 해도 WndProc함수의 리턴으로 인식하지 않는다 그래서 for를사용
 	for (auto Iter = m_wndProcListeners.begin(); Iter != m_wndProcListeners.end(); ++Iter)
 	{
 		WndProcListener& listener = (*Iter);
@@ -16,7 +16,7 @@ LRESULT CALLBACK CWindow::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPa
 	return DefWindowProc(hwnd, msg, wParam, lParam);
 }
 
-//̻ óҰ  true , óҰ  false, óҰ ִµ ýۿ ļ ó ʿϸ LRESULT  ִ´.
+//더이상 처리할게 없으면 true를 리턴, 처리할게 있으면 false, 처리할게 있는데 시스템에서 후속 처리가 필요하면 LRESULT에 값을 넣는다.
 bool CWindow::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam, LRESULT& result)
 {
 	switch (msg)
@@ -130,7 +130,7 @@ CWindow* gWindow = nullptr;
 bool CWindow::Initialize(bool bShow)
 {
 	gWindow = this;
-	//ĸİ  WNDPROC ȯ  ʴ´. ׷ Ȱ
+	//캡쳐가 있으면 WNDPROC으로 변환이 되지 않는다. 그래서 정적변수활용
 	auto windowProc = [](HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)->LRESULT {
 		return gWindow->WndProc(hwnd, msg, wParam, lParam);
 		};
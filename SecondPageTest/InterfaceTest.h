@@ -11,6 +11,12 @@ interface ITestRenderer : public IRenderer
 	virtual bool LoadMesh(GraphicsPSO pso, const void* verticesData, const void* indicesData, RenderItem* renderItem) { return true; };
 	virtual bool LoadTexture(const TextureList& textureList, std::vector<std::wstring>* srvFilename) { return true; };
 	virtual bool SetUploadBuffer(eBufferType bufferType, const void* bufferData, size_t dataSize) { return true; };
+	virtual bool MapUploadBuffer(eBufferType bufferType, size_t dataSize, void** outData) { return false; };
+	virtual bool UpdateUploadBuffer(eBufferType bufferType, const void* bufferData, const UINT64* versions, size_t dataSize) { return true; };
+	virtual UINT64 GetUploadedBytes() { return 0; };
+	virtual void AddTextureRefs(const std::vector<UINT>& srvIndices) {};
+	virtual void ReleaseTextureRefs(const std::vector<UINT>& srvIndices) {};
+	virtual void UseTextures(const std::vector<UINT>& srvIndices) {};
 	virtual bool PrepareFrame() { return true; };
 	virtual bool Draw(AllRenderItems& renderItem) { return true; };
 
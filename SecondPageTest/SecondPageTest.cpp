@@ -16,6 +16,17 @@
 #include "../SecondPage/MockData.h"
 #include "../SecondPage/Helper.h"
 #include "../SecondPage/Utility.h"
+#include "../SecondPage/MeshCache.h"
+#include "../SecondPage/LoadM3d.h"
+#include "../SecondPage/SkinnedData.h"
+#include "../SecondPage/SkinnedMesh.h"
+#include "../SecondPage/TextScanner.h"
+#include "../SecondPage/Culling.h"
+#include <filesystem>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
 
 using enum GraphicsPSO;
 using enum ShaderType;
@@ -115,7 +126,7 @@ namespace MainLoop
 		camera.SetSpeed(eMove::Forward, 10.0f);
 		keyInput.AddKeyListener([&camera](std::vector<int> keyList) {
 			camera.PressedKey(keyList); });
-		//mock ó  غ
+		//mock으로 처리 가능할지 생각해보자
 		//keyInput.PressedKeyList([]() {
 		//	return std::vector<int>{'W'};
 		//	});
@@ -151,7 +162,7 @@ namespace MainLoop
 		modelProp.meshData = nullptr;
 		modelProp.cullingFrustum = false;
 		modelProp.filename = L"";
-		modelProp.instanceDataList = {};
+		modelProp.instances = {};
 		modelProp.materialList = materialList;
 		
 		return modelProp;
@@ -165,11 +176,29 @@ namespace MainLoop
 		virtual bool LoadTexture(const TextureList& textureList, std::vector<std::wstring>* srvFilename) override
 		{
 			EXPECT_EQ(textureList.size(), 4);
-			std::vector<std::wstring> curtexIndexList;
-			//m_originRenderer->LoadTexture(textureList, &curtexIndexList);
+			std::ranges::transform(textureList, std::back_inserter(*srvFilename), [](auto& tex) {
+				return tex.second; });
 
 			return true;
 		}
+		virtual bool UpdateUploadBuffer(eBufferType bufferType, const void* bufferData, const UINT64* versions, size_t dataSize) override
+		{
+			if (bufferType != eBufferType::Material) return true;
+
+			const MaterialBuffer* matBuffer = static_cast<const MaterialBuffer*>(bufferData);
+			m_materialBuffers.assign(matBuffer, matBuffer + dataSize);
+			m_versions.assign(versions, versions + dataSize);
+			return true;
+		}
+		virtual void UseTextures(const std::vector<UINT>& srvIndices) override
+		{
+			m_usedTextures = srvIndices;
+		}
+
+		std::vector<MaterialBuffer> m_materialBuffers{};
+		std::vector<UINT64> m_versions{};
+		std::vector<UINT> m_usedTextures{};
+
 	private:
 		IRenderer* m_originRenderer{ nullptr };
 	};
@@ -178,17 +207,84 @@ namespace MainLoop
 	{
 		std::unique_ptr<CMaterial> material = std::make_unique<CMaterial>();
 		std::unique_ptr<CSetupData> setupData = std::make_unique<CSetupData>();
-		setupData->InsertModelProperty(Opaque, "cube1", TestCreateMock(), material.get());
-		setupData->InsertModelProperty(Opaque, "cube2", TestCreateMock(), material.get());
 
-		std::unique_ptr<IRenderer> mockRenderer = std::make_unique<GMockTestRenderer>(m_renderer.get());
+		EXPECT_TRUE(setupData->InsertModelProperty(Opaque, "cube1", TestCreateMock(), material.get()));
+		EXPECT_TRUE(setupData->InsertModelProperty(Opaque, "cube2", TestCreateMock(), material.get()));
+
+		//같은 이름은 처음 등록된 번호를 돌려받는다.
+		std::vector<UINT> materialIds{};
+		material->SetMaterialList(TestCreateMock().materialList, &materialIds);
+		EXPECT_EQ(materialIds, (std::vector<UINT>{ 0u, 1u, 0u, 2u, 3u }));
+
+		auto mockRenderer = std::make_unique<GMockTestRenderer>(m_renderer.get());
 		EXPECT_TRUE(material->LoadTextureIntoVRAM(mockRenderer.get()));
 
-		//EXPECT_EQ(material->GetTextureIndex(L"bricks.dds"), 0);
-		//EXPECT_EQ(material->GetTextureIndex(L"brickddddd"), -1);
-		//EXPECT_EQ(material->GetTextureIndex(L"bricks2_nmap.dds"), 3);
-		//EXPECT_EQ(material->GetMaterialIndex("bricks1"), 2);
-		//EXPECT_EQ(material->GetMaterialIndex("bricks2"), 3);
+		EXPECT_EQ(material->GetSrvTextureIndex(L"bricks.dds"), 0u);
+		EXPECT_EQ(material->GetSrvTextureIndex(L"brickddddd"), gInvalidId);
+		EXPECT_EQ(material->GetSrvTextureIndex(L"bricks2_nmap.dds"), 3u);
+		EXPECT_EQ(material->GetMaterialIndex("bricks1"), 2u);
+		EXPECT_EQ(material->GetMaterialIndex("bricks2"), 3u);
+
+		//머터리얼 버퍼에는 미리 바꿔 둔 텍스쳐 번호가 들어간다.
+		material->MakeMaterialBuffer(mockRenderer.get());
+		const auto& matBuffers = mockRenderer->m_materialBuffers;
+		ASSERT_EQ(matBuffers.size(), 4u);
+		EXPECT_EQ(matBuffers[0].diffuseMapIndex, 0u);
+		EXPECT_EQ(matBuffers[0].NormalMapIndex, gInvalidId);
+		EXPECT_EQ(matBuffers[3].diffuseMapIndex, 2u);
+		EXPECT_EQ(matBuffers[3].NormalMapIndex, 3u);
+
+		//그리는 머터리얼의 텍스쳐만 썼다고 알린다.
+		material->UseTextures(mockRenderer.get(), { 3u });
+		EXPECT_EQ(mockRenderer->m_usedTextures, (std::vector<UINT>{ 2u, 3u }));
+
+		//바뀐게 없으면 버전이 그대로라서 렌더러는 복사할 구간이 없다.
+		const std::vector<UINT64> versions = mockRenderer->m_versions;
+		material->MakeMaterialBuffer(mockRenderer.get());
+		EXPECT_EQ(mockRenderer->m_versions, versions);
+
+		material->MarkDirty(2u);
+		material->MakeMaterialBuffer(mockRenderer.get());
+		for (auto id : std::views::iota(0u, 4u))
+		{
+			if (id == 2u) EXPECT_GT(mockRenderer->m_versions[id], versions[id]);
+			else EXPECT_EQ(mockRenderer->m_versions[id], versions[id]);
+		}
+	}
+
+	TEST(InstanceStore, GenerationalHandle)
+	{
+		CInstanceStore store{};
+		std::vector<InstanceHandle> handles{};
+		for (auto materialId : { 10u, 11u, 12u })
+		{
+			InstanceData instance{};
+			instance.materialId = materialId;
+			handles.emplace_back(store.Add(instance));
+		}
+
+		//지우면 마지막 인스턴스가 빈 자리로 옮겨 오고 배열은 빈틈없이 유지된다.
+		EXPECT_TRUE(store.Remove(handles[0]));
+		EXPECT_FALSE(store.Remove(handles[0]));
+		EXPECT_FALSE(store.IsValid(handles[0]));
+		EXPECT_EQ(store.Size(), 2u);
+		EXPECT_EQ(store.GetIndex(handles[2]), 0u);
+		EXPECT_EQ(store.GetMaterialIds()[0], 12u);
+		EXPECT_EQ(store.Get(store.GetIndex(handles[1])).materialId, 11u);
+
+		//같은 slot을 다시 써도 예전 핸들로는 찾을 수 없다.
+		InstanceData instance{};
+		instance.materialId = 13u;
+		InstanceHandle reused = store.Add(instance);
+		EXPECT_EQ(reused.slot, handles[0].slot);
+		EXPECT_NE(reused.generation, handles[0].generation);
+		EXPECT_EQ(store.GetIndex(handles[0]), gInvalidId);
+		EXPECT_EQ(store.GetIndex(reused), 2u);
+
+		store.Clear();
+		EXPECT_TRUE(store.Empty());
+		EXPECT_FALSE(store.IsValid(reused));
+		EXPECT_FALSE(store.IsValid(handles[1]));
 	}
 	
 	class GInstanceRenderer : public ITestRenderer
@@ -232,6 +328,104 @@ namespace MainLoop
 		EXPECT_EQ(subItem->startSubIndexInstance, 0);
 	}
 
+	//업로드 버퍼를 직접 쓰는 경로와 SetUploadBuffer로 복사하는 경로를 모두 받는다.
+	class MappedInstanceRenderer : public ITestRenderer
+	{
+	public:
+		virtual bool MapUploadBuffer(eBufferType bufferType, size_t dataSize, void** outData) override
+		{
+			if (!m_useMapping || bufferType != eBufferType::Instance) return false;
+			m_instances.resize(dataSize);
+			(*outData) = m_instances.data();
+			return true;
+		}
+		virtual bool SetUploadBuffer(eBufferType bufferType, const void* bufferData, size_t dataSize) override
+		{
+			if (bufferType != eBufferType::Instance) return true;
+			const InstanceBuffer* start = static_cast<const InstanceBuffer*>(bufferData);
+			m_instances.assign(start, start + dataSize);
+			return true;
+		}
+
+		bool m_useMapping{ true };
+		std::vector<InstanceBuffer> m_instances{};
+	};
+
+	//예전처럼 서브 아이템을 하나씩 컬링해서 이어 붙인 결과
+	std::vector<DirectX::XMFLOAT4X4> ReferenceVisibleWorlds(CCamera& camera, AllRenderItems& allRenderItems)
+	{
+		using namespace DirectX;
+		FrustumPlanes planes{};
+		camera.GetFrustumPlanes(planes);
+
+		std::vector<XMFLOAT4X4> worlds{};
+		for (auto& e : allRenderItems)
+		{
+			RenderItem* renderItem = e.second.get();
+			EXPECT_EQ(renderItem->startIndexInstance, static_cast<int>(worlds.size()));
+			for (auto& subRenderItem : renderItem->subRenderItems)
+			{
+				EXPECT_EQ(subRenderItem.startSubIndexInstance, static_cast<int>(worlds.size()) - renderItem->startIndexInstance);
+
+				CullingSpheres spheres{};
+				for (auto& world : subRenderItem.instances.GetWorlds())
+					spheres.Add(subRenderItem.subItem.boundingSphere, world);
+				std::vector<UINT> visible(spheres.Count());
+				std::iota(visible.begin(), visible.end(), 0u);
+				if (subRenderItem.cullingFrustum)
+					CullSpheres(planes, spheres, visible);
+
+				EXPECT_EQ(subRenderItem.instanceCount, visible.size());
+				for (auto index : visible)
+					XMStoreFloat4x4(&worlds.emplace_back(), XMMatrixTranspose(subRenderItem.instances.GetWorlds()[index]));
+			}
+		}
+		return worlds;
+	}
+
+	TEST(Model, ParallelInstanceBuffer)
+	{
+		using namespace DirectX;
+		AllRenderItems allRenderItems{};
+		CModel model{};
+		MappedInstanceRenderer renderer{};
+		EXPECT_TRUE(model.Initialize(L"../Resource/", MakeTestMockData()));
+		EXPECT_TRUE(model.LoadMemory(&renderer, allRenderItems));
+
+		//작업 하나(gCullingJobSize)보다 훨씬 많게 skull을 늘린다.
+		SubRenderItem* skull = GetSubRenderItem(allRenderItems, Opaque, "skull");
+		InstanceData instance = skull->instances.Get(0u);
+		skull->instances.Reserve(skull->instances.Size() + 150 * 150);
+		for (auto x : std::views::iota(-75, 75))
+		{
+			for (auto z : std::views::iota(-75, 75))
+			{
+				instance.world = XMMatrixTranslation(x * 3.0f, 0.0f, z * 3.0f);
+				skull->instances.Add(instance);
+			}
+		}
+
+		CCamera camera{};
+		camera.OnResize(800, 600);
+		camera.Update(0.1f);
+
+		for (bool useMapping : { true, false })
+		{
+			renderer.m_useMapping = useMapping;
+			auto start = std::chrono::steady_clock::now();
+			model.Update(&renderer, &camera, 0.1f, allRenderItems);
+			std::chrono::duration<double, std::milli> updateTime = std::chrono::steady_clock::now() - start;
+
+			std::vector<XMFLOAT4X4> expected = ReferenceVisibleWorlds(camera, allRenderItems);
+			EXPECT_EQ(renderer.m_instances.size(), expected.size());
+			for (auto i : std::views::iota(0u, static_cast<UINT>(std::min(expected.size(), renderer.m_instances.size()))))
+				EXPECT_EQ(0, std::memcmp(&expected[i], &renderer.m_instances[i].world, sizeof(XMFLOAT4X4)));
+
+			std::cout << (useMapping ? "mapped" : "copied") << " : " << skull->instances.Size() << " skulls, "
+				<< expected.size() << " visible, " << updateTime.count() << " ms" << std::endl;
+		}
+	}
+
 	TEST_F(MainLoopClassTest, Shadow)
 	{
 		std::unique_ptr<CShadow> shadow = std::make_unique<CShadow>();
@@ -291,6 +485,611 @@ namespace MainLoop
 
 } //SecondPage
 
-namespace Utility
+namespace Loader
 {
+	std::wstring CopyToTemp(const std::wstring& srcFilename, const std::wstring& tempName)
+	{
+		std::filesystem::path tempFilename = std::filesystem::temp_directory_path() / tempName;
+		std::filesystem::copy_file(srcFilename, tempFilename, std::filesystem::copy_options::overwrite_existing);
+		std::filesystem::remove(CMeshCache::GetCacheFilename(tempFilename.wstring()));
+		return tempFilename.wstring();
+	}
+
+	TEST(MeshCache, SkinnedRoundTrip)
+	{
+		std::wstring filename = CopyToTemp(L"../Resource/Meshes/soldier.m3d", L"soldier_cache_test.m3d");
+
+		std::vector<SkinnedVertex> vertices{};
+		std::vector<std::int32_t> indices{};
+		std::vector<Subset> subsets{};
+		std::vector<M3dMaterial> mats{};
+		CSkinnedData skinInfo{};
+		CLoadM3D loadM3d;
+		EXPECT_TRUE(loadM3d.Read(filename, vertices, indices, subsets, mats, &skinInfo));
+
+		CMeshCache meshCache;
+		EXPECT_FALSE(meshCache.Load(filename, vertices, indices, subsets, mats, &skinInfo));
+		EXPECT_TRUE(meshCache.Save(filename, vertices, indices, subsets, mats, &skinInfo));
+
+		std::vector<SkinnedVertex> cacheVertices{};
+		std::vector<std::int32_t> cacheIndices{};
+		std::vector<Subset> cacheSubsets{};
+		std::vector<M3dMaterial> cacheMats{};
+		CSkinnedData cacheSkinInfo{};
+		EXPECT_TRUE(meshCache.Load(filename, cacheVertices, cacheIndices, cacheSubsets, cacheMats, &cacheSkinInfo));
+
+		EXPECT_EQ(vertices.size(), cacheVertices.size());
+		EXPECT_EQ(0, std::memcmp(vertices.data(), cacheVertices.data(), vertices.size() * sizeof(SkinnedVertex)));
+		EXPECT_EQ(indices, cacheIndices);
+		EXPECT_EQ(subsets.size(), cacheSubsets.size());
+		EXPECT_EQ(mats.size(), cacheMats.size());
+		EXPECT_EQ(mats[0].diffuseMapName, cacheMats[0].diffuseMapName);
+		EXPECT_EQ(skinInfo.BoneCount(), cacheSkinInfo.BoneCount());
+		EXPECT_EQ(skinInfo.GetBoneHierarchy(), cacheSkinInfo.GetBoneHierarchy());
+
+		std::vector<DirectX::XMFLOAT4X4> transforms(skinInfo.BoneCount());
+		std::vector<DirectX::XMFLOAT4X4> cacheTransforms(cacheSkinInfo.BoneCount());
+		skinInfo.GetFinalTransforms("Take1", 0.5f, transforms);
+		cacheSkinInfo.GetFinalTransforms("Take1", 0.5f, cacheTransforms);
+		EXPECT_EQ(0, std::memcmp(transforms.data(), cacheTransforms.data(), transforms.size() * sizeof(DirectX::XMFLOAT4X4)));
+
+		std::filesystem::remove(CMeshCache::GetCacheFilename(filename));
+		std::filesystem::remove(filename);
+	}
+
+	TEST(MeshCache, StaleSource)
+	{
+		std::wstring filename = CopyToTemp(L"../Resource/Meshes/skull.txt", L"skull_cache_test.txt");
+
+		MeshData meshData{};
+		meshData.vertices.resize(3);
+		meshData.indices = { 0, 1, 2 };
+
+		CMeshCache meshCache;
+		EXPECT_TRUE(meshCache.Save(filename, meshData));
+
+		MeshData cacheData{};
+		EXPECT_TRUE(meshCache.Load(filename, &cacheData));
+		EXPECT_EQ(meshData.indices, cacheData.indices);
+
+		//원본이 바뀌면 캐시를 쓰지 않는다.
+		{
+			std::ofstream fout(filename, std::ios::app);
+			fout << " ";
+		}
+		MeshData staleData{};
+		EXPECT_FALSE(meshCache.Load(filename, &staleData));
+		EXPECT_TRUE(staleData.vertices.empty());
+
+		std::filesystem::remove(CMeshCache::GetCacheFilename(filename));
+		std::filesystem::remove(filename);
+	}
+
+	TEST(TextScanner, Token)
+	{
+		std::string text = "Position: -0.9983482 67.88861 4.354969\r\n\tBlendIndices: 7 9 0 0\nName: soldier_head";
+		CTextScanner scanner(text.data(), text.data() + text.size());
+
+		DirectX::XMFLOAT3 pos{};
+		EXPECT_TRUE(scanner.ReadLabeled(pos.x, pos.y, pos.z));
+		EXPECT_EQ(pos.x, -0.9983482f);
+		EXPECT_EQ(pos.z, 4.354969f);
+
+		int indices[4]{};
+		EXPECT_TRUE(scanner.ReadLabeled(indices[0], indices[1], indices[2], indices[3]));
+		EXPECT_EQ(indices[1], 9);
+
+		std::string name{};
+		EXPECT_TRUE(scanner.ReadLabeled(name));
+		EXPECT_EQ(name, "soldier_head");
+		EXPECT_TRUE(scanner.IsEnd());
+		EXPECT_FALSE(scanner.Read(indices[0]));
+	}
+
+	TEST(M3dLoader, ParseThroughput)
+	{
+		const std::wstring filename = L"../Resource/Meshes/soldier.m3d";
+		const double fileMB = static_cast<double>(std::filesystem::file_size(filename)) / (1024.0 * 1024.0);
+		constexpr int loopCount = 5;
+
+		auto start = std::chrono::steady_clock::now();
+		std::vector<SkinnedVertex> vertices{};
+		std::vector<std::int32_t> indices{};
+		std::vector<Subset> subsets{};
+		std::vector<M3dMaterial> mats{};
+		CSkinnedData skinInfo{};
+		for (auto i{ 0 }; i < loopCount; ++i)
+		{
+			CLoadM3D loadM3d;
+			EXPECT_TRUE(loadM3d.Read(filename, vertices, indices, subsets, mats, &skinInfo));
+		}
+		std::chrono::duration<double> scannerTime = std::chrono::steady_clock::now() - start;
+
+		EXPECT_EQ(vertices.size(), 13748);
+		EXPECT_EQ(indices.size(), 22507 * 3);
+		EXPECT_EQ(vertices[0].Pos.x, -0.9983482f);
+		EXPECT_EQ(vertices[0].BoneIndices[1], 9);
+		EXPECT_EQ(skinInfo.BoneCount(), 58);
+		EXPECT_EQ(skinInfo.GetBoneHierarchy()[0], -1);
+		EXPECT_EQ(skinInfo.GetAnimations().at("Take1").BoneAnimations[0].Keyframes.size(), 76);
+
+		//이전 로더는 모든 토큰을 istream >> string으로 읽었으므로 그 비용을 하한선으로 잰다.
+		start = std::chrono::steady_clock::now();
+		for (auto i{ 0 }; i < loopCount; ++i)
+		{
+			std::ifstream fin(filename);
+			std::string token{};
+			while (fin >> token) {}
+		}
+		std::chrono::duration<double> streamTime = std::chrono::steady_clock::now() - start;
+
+		std::cout << "soldier.m3d scanner : " << fileMB * loopCount / scannerTime.count() << " MB/s" << std::endl;
+		std::cout << "soldier.m3d istream : " << fileMB * loopCount / streamTime.count() << " MB/s" << std::endl;
+	}
+
+	TEST(MeshLoader, ParallelChunks)
+	{
+		const std::wstring filename = L"../Resource/Meshes/skull.txt";
+
+		MeshData serialData{};
+		auto start = std::chrono::steady_clock::now();
+		EXPECT_TRUE(ReadVertexNormalList(filename, 1, &serialData));
+		std::chrono::duration<double> serialTime = std::chrono::steady_clock::now() - start;
+
+		MeshData parallelData{};
+		start = std::chrono::steady_clock::now();
+		EXPECT_TRUE(ReadVertexNormalList(filename, 8, &parallelData));
+		std::chrono::duration<double> parallelTime = std::chrono::steady_clock::now() - start;
+
+		EXPECT_EQ(serialData.vertices.size(), 31076);
+		EXPECT_EQ(serialData.indices.size(), 60339 * 3);
+		EXPECT_EQ(serialData.vertices.size(), parallelData.vertices.size());
+		EXPECT_EQ(0, std::memcmp(serialData.vertices.data(), parallelData.vertices.data(), serialData.vertices.size() * sizeof(Vertex)));
+		EXPECT_EQ(serialData.indices, parallelData.indices);
+		EXPECT_EQ(0, std::memcmp(&serialData.boundingBox, &parallelData.boundingBox, sizeof(DirectX::BoundingBox)));
+		EXPECT_EQ(0, std::memcmp(&serialData.boundingSphere, &parallelData.boundingSphere, sizeof(DirectX::BoundingSphere)));
+
+		std::cout << "skull.txt 1 chunk : " << serialTime.count() * 1000.0 << " ms" << std::endl;
+		std::cout << "skull.txt 8 chunks : " << parallelTime.count() * 1000.0 << " ms" << std::endl;
+	}
+}
+
+namespace Animation
+{
+	using namespace DirectX;
+
+	void LoadSoldier(CSkinnedData& skinInfo)
+	{
+		std::vector<SkinnedVertex> vertices{};
+		std::vector<std::int32_t> indices{};
+		std::vector<Subset> subsets{};
+		std::vector<M3dMaterial> mats{};
+		CLoadM3D loadM3d;
+		EXPECT_TRUE(loadM3d.Read(L"../Resource/Meshes/soldier.m3d", vertices, indices, subsets, mats, &skinInfo));
+	}
+
+	//예전 방식대로 본마다 행렬을 보간하고 한 본씩 루트까지 곱한다.
+	void ReferenceFinalTransforms(const CSkinnedData& skinInfo, const AnimationClip& clip, float t,
+		std::vector<XMFLOAT4X4>& finalTransforms)
+	{
+		UINT numBones = skinInfo.BoneCount();
+		std::vector<XMFLOAT4X4> toParent(numBones);
+		std::vector<XMFLOAT4X4> toRoot(numBones);
+		clip.Interpolate(t, toParent);
+
+		toRoot[0] = toParent[0];
+		for (auto i : std::views::iota(1u, numBones))
+		{
+			int parentIndex = skinInfo.GetBoneHierarchy()[i];
+			XMStoreFloat4x4(&toRoot[i], XMLoadFloat4x4(&toParent[i]) * XMLoadFloat4x4(&toRoot[parentIndex]));
+		}
+		for (auto i : std::views::iota(0u, numBones))
+		{
+			XMMATRIX finalTransform = XMLoadFloat4x4(&skinInfo.GetBoneOffsets()[i]) * XMLoadFloat4x4(&toRoot[i]);
+			XMStoreFloat4x4(&finalTransforms[i], XMMatrixTranspose(finalTransform));
+		}
+	}
+
+	TEST(SkinnedData, BatchedFinalTransforms)
+	{
+		CSkinnedData skinInfo{};
+		LoadSoldier(skinInfo);
+
+		SkinnedModelInstance instance{};
+		instance.skinnedInfo = &skinInfo;
+		EXPECT_TRUE(instance.SetClip("Take1"));
+		EXPECT_FALSE(instance.SetClip("NoClip"));
+
+		std::vector<XMFLOAT4X4> expected(skinInfo.BoneCount());
+		std::vector<XMFLOAT4X4> finalTransforms(skinInfo.BoneCount());
+		for (float t : { 0.0f, 0.01f, 0.37f, 0.5f, 1.2f, instance.current.clipEndTime, instance.current.clipEndTime + 1.0f })
+		{
+			ReferenceFinalTransforms(skinInfo, *instance.current.clip, t, expected);
+			skinInfo.GetFinalTransforms(instance.current.clip, t, instance.scratch, finalTransforms.data());
+
+			for (auto bone : std::views::iota(0u, skinInfo.BoneCount()))
+				for (auto row : std::views::iota(0, 4))
+					for (auto col : std::views::iota(0, 4))
+						EXPECT_NEAR(expected[bone](row, col), finalTransforms[bone](row, col), 1e-3f);
+		}
+	}
+
+	//Take1을 repeat번 이어 붙여서 키 개수만 늘린 클립
+	AnimationClip MakeLongClip(const AnimationClip& clip, int repeat)
+	{
+		const float clipLength = clip.GetClipEndTime();
+		AnimationClip longClip{ clip };
+		for (auto& boneAnimation : longClip.BoneAnimations)
+		{
+			std::vector<Keyframe> keyframes{};
+			for (auto i : std::views::iota(0, repeat))
+			{
+				for (auto keyframe : boneAnimation.Keyframes)
+				{
+					keyframe.TimePos += clipLength * i + 0.001f * i;
+					keyframes.emplace_back(keyframe);
+				}
+			}
+			boneAnimation.Keyframes = std::move(keyframes);
+		}
+		return longClip;
+	}
+
+	UINT LinearFindKey(const BoneAnimation& boneAnimation, float t)
+	{
+		const auto& keyframes = boneAnimation.Keyframes;
+		if (t <= keyframes.front().TimePos) return 0u;
+		if (t >= keyframes.back().TimePos) return static_cast<UINT>(keyframes.size()) - 1u;
+
+		UINT key = 0u;
+		while (keyframes[key + 1u].TimePos < t) ++key;
+		return key;
+	}
+
+	TEST(SkinnedData, KeyframeCursor)
+	{
+		CSkinnedData skinInfo{};
+		LoadSoldier(skinInfo);
+		const AnimationClip& take1 = *skinInfo.GetClipHandle("Take1");
+		const float frameTime = 1.0f / 60.0f;
+
+		for (int repeat : { 1, 10, 100 })
+		{
+			AnimationClip clip = MakeLongClip(take1, repeat);
+			const float endTime = clip.GetClipEndTime();
+			const UINT boneCount = static_cast<UINT>(clip.BoneAnimations.size());
+			std::vector<UINT> cursors(boneCount, 0u);
+
+			UINT key0{ 0u }, key1{ 0u };
+			float fraction{ 0.0f };
+			for (float t = 0.0f; t < endTime; t += frameTime)
+			{
+				for (auto bone : std::views::iota(0u, boneCount))
+				{
+					clip.BoneAnimations[bone].FindKeys(t, cursors[bone], key0, key1, fraction);
+					EXPECT_EQ(key0, LinearFindKey(clip.BoneAnimations[bone], t));
+				}
+			}
+
+			//되감기와 건너뛰기는 이진 탐색으로 찾는다.
+			for (float t : { endTime * 0.5f, endTime * 0.1f, endTime * 0.9f, 0.0f })
+			{
+				clip.BoneAnimations[0].FindKeys(t, cursors[0], key0, key1, fraction);
+				EXPECT_EQ(key0, LinearFindKey(clip.BoneAnimations[0], t));
+			}
+
+			auto Measure = [&](auto findKey) {
+				auto start = std::chrono::steady_clock::now();
+				UINT frameCount{ 0u };
+				for (float t = 0.0f; t < endTime; t += frameTime, ++frameCount)
+					for (auto bone : std::views::iota(0u, boneCount))
+						findKey(bone, t);
+				std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+				return elapsed.count() / frameCount; };
+
+			std::ranges::fill(cursors, 0u);
+			double cursorTime = Measure([&](UINT bone, float t) {
+				clip.BoneAnimations[bone].FindKeys(t, cursors[bone], key0, key1, fraction); });
+			double linearTime = Measure([&](UINT bone, float t) {
+				key0 = LinearFindKey(clip.BoneAnimations[bone], t); });
+
+			std::cout << "Take1 x" << repeat << " (" << clip.BoneAnimations[0].Keyframes.size() << " keys/bone) cursor : "
+				<< cursorTime << " us/frame, linear : " << linearTime << " us/frame" << std::endl;
+		}
+	}
+
+	//Take1에 정지 포즈(Still)와 y로 1만큼 올라가는 가산 클립(Lift)을 더한 데이터
+	void MakeBlendClips(CSkinnedData& skinInfo)
+	{
+		LoadSoldier(skinInfo);
+		auto animations = skinInfo.GetAnimations();
+		const AnimationClip& take1 = animations["Take1"];
+
+		AnimationClip& still = animations["Still"];
+		AnimationClip& lift = animations["Lift"];
+		for (const auto& boneAnimation : take1.BoneAnimations)
+		{
+			const auto& keyframes = boneAnimation.Keyframes;
+			still.BoneAnimations.emplace_back().Keyframes = { keyframes[keyframes.size() / 2] };
+
+			Keyframe key0 = keyframes.front(), key1 = keyframes.front();
+			key0.TimePos = 0.0f;
+			key1.TimePos = 1.0f;
+			key1.Translation.y += 1.0f;
+			lift.BoneAnimations.emplace_back().Keyframes = { key0, key1 };
+		}
+
+		auto hierarchy = skinInfo.GetBoneHierarchy();
+		auto offsets = skinInfo.GetBoneOffsets();
+		skinInfo.Set(hierarchy, offsets, animations);
+	}
+
+	void SamplePose(const CSkinnedData& skinInfo, const std::string& clipName, float t, LocalPose& outPose)
+	{
+		AnimationScratch scratch{};
+		scratch.Resize(skinInfo.BoneCount());
+		outPose.Resize(skinInfo.BoneCount());
+		skinInfo.GetClipHandle(clipName)->Sample(t, scratch.cursors, scratch, outPose);
+	}
+
+	void ExpectBoneNear(const LocalPose& expected, const LocalPose& actual, UINT bone, float yOffset = 0.0f)
+	{
+		EXPECT_NEAR(expected.tx[bone], actual.tx[bone], 1e-4f);
+		EXPECT_NEAR(expected.ty[bone] + yOffset, actual.ty[bone], 1e-4f);
+		EXPECT_NEAR(expected.tz[bone], actual.tz[bone], 1e-4f);
+		EXPECT_NEAR(expected.sx[bone], actual.sx[bone], 1e-4f);
+		//q와 -q는 같은 회전이다.
+		float dot = expected.qx[bone] * actual.qx[bone] + expected.qy[bone] * actual.qy[bone] +
+			expected.qz[bone] * actual.qz[bone] + expected.qw[bone] * actual.qw[bone];
+		EXPECT_NEAR(std::abs(dot), 1.0f, 1e-4f);
+	}
+
+	TEST(SkinnedData, BlendLayers)
+	{
+		CSkinnedData skinInfo{};
+		MakeBlendClips(skinInfo);
+		const UINT boneCount = skinInfo.BoneCount();
+		std::vector<XMFLOAT4X4> finalTransforms(boneCount);
+		LocalPose take1{}, still{};
+
+		//크로스페이드: 시작은 Take1, duration이 지나면 Still로 넘어간다.
+		SkinnedModelInstance instance{};
+		instance.skinnedInfo = &skinInfo;
+		EXPECT_TRUE(instance.SetClip("Take1"));
+		EXPECT_TRUE(instance.CrossFade("Still", 0.5f));
+		EXPECT_FALSE(instance.CrossFade("NoClip", 0.5f));
+		instance.UpdateSkinnedAnimation(0.0f, finalTransforms.data());
+		SamplePose(skinInfo, "Take1", 0.0f, take1);
+		for (auto bone : std::views::iota(0u, boneCount))
+			ExpectBoneNear(take1, instance.scratch.local, bone);
+
+		instance.UpdateSkinnedAnimation(0.6f, finalTransforms.data());
+		SamplePose(skinInfo, "Still", 0.6f, still);
+		for (auto bone : std::views::iota(0u, boneCount))
+			ExpectBoneNear(still, instance.scratch.local, bone);
+		EXPECT_EQ(instance.current.clipName, "Still");
+		EXPECT_EQ(instance.next.clip, nullptr);
+
+		//마스크 밖의 본은 기본 클립, 안쪽 본은 Still, Lift는 weight 0.5만큼 y가 올라간다.
+		const UINT maskRoot = boneCount / 2;
+		std::vector<float> mask{};
+		skinInfo.MakeBoneMask(maskRoot, mask);
+		EXPECT_EQ(mask[maskRoot], 1.0f);
+		EXPECT_EQ(mask[0], 0.0f);
+
+		SkinnedModelInstance layered{};
+		layered.skinnedInfo = &skinInfo;
+		EXPECT_TRUE(layered.SetClip("Take1"));
+		EXPECT_TRUE(layered.AddLayer(LayerBlend::Override, "Still", 1.0f, mask));
+		EXPECT_TRUE(layered.AddLayer(LayerBlend::Additive, "Lift", 0.5f));
+		EXPECT_FALSE(layered.AddLayer(LayerBlend::Additive, "Lift", 0.5f, { 1.0f }));
+		layered.UpdateSkinnedAnimation(0.5f, finalTransforms.data());
+
+		SamplePose(skinInfo, "Take1", 0.5f, take1);
+		for (auto bone : std::views::iota(0u, boneCount))
+			ExpectBoneNear(mask[bone] > 0.0f ? still : take1, layered.scratch.local, bone, 0.25f);
+
+		layered.SetLayerWeight(1, 0.0f);
+		layered.UpdateSkinnedAnimation(0.0f, finalTransforms.data());
+		for (auto bone : std::views::iota(0u, boneCount))
+			ExpectBoneNear(mask[bone] > 0.0f ? still : take1, layered.scratch.local, bone);
+
+#if defined(DEBUG) || defined(_DEBUG)
+		//페이드와 레이어가 모두 켜진 상태에서도 프레임마다 힙 할당이 없어야 한다.
+		EXPECT_TRUE(layered.CrossFade("Still", 1.0f));
+		_CrtMemState before{}, after{};
+		_CrtMemCheckpoint(&before);
+		for (auto frame : std::views::iota(0, 120))
+			layered.UpdateSkinnedAnimation(1.0f / 60.0f, finalTransforms.data());
+		_CrtMemCheckpoint(&after);
+		EXPECT_EQ(before.lTotalCount, after.lTotalCount);
+#endif
+	}
+
+	TEST(SkinnedData, CompressedClip)
+	{
+		CSkinnedData rawInfo{};
+		LoadSoldier(rawInfo);
+		CSkinnedData compressedInfo{};
+		LoadSoldier(compressedInfo);
+
+		const AnimationCompression settings{};
+		compressedInfo.CompressAnimations(settings);
+		const AnimationClip& rawClip = *rawInfo.GetClipHandle("Take1");
+		const AnimationClip& compressedClip = *compressedInfo.GetClipHandle("Take1");
+		EXPECT_EQ(rawClip.GetClipEndTime(), compressedClip.GetClipEndTime());
+		EXPECT_LT(compressedClip.GetByteSize() * 4, rawClip.GetByteSize());
+
+		//원래 키 사이 아무 시간에서도 채널별 오차가 허용치(와 양자화 오차) 안에 있어야 한다.
+		const UINT boneCount = rawInfo.BoneCount();
+		LocalPose rawPose{}, compressedPose{};
+		for (float t = 0.0f; t <= rawClip.GetClipEndTime(); t += 0.007f)
+		{
+			SamplePose(rawInfo, "Take1", t, rawPose);
+			SamplePose(compressedInfo, "Take1", t, compressedPose);
+			for (auto bone : std::views::iota(0u, boneCount))
+			{
+				XMVECTOR rawT = XMVectorSet(rawPose.tx[bone], rawPose.ty[bone], rawPose.tz[bone], 0.0f);
+				XMVECTOR compressedT = XMVectorSet(compressedPose.tx[bone], compressedPose.ty[bone], compressedPose.tz[bone], 0.0f);
+				EXPECT_LE(XMVectorGetX(XMVector3Length(rawT - compressedT)), settings.translationError * 1.01f);
+
+				XMVECTOR rawQ = XMVectorSet(rawPose.qx[bone], rawPose.qy[bone], rawPose.qz[bone], rawPose.qw[bone]);
+				XMVECTOR compressedQ = XMVectorSet(compressedPose.qx[bone], compressedPose.qy[bone], compressedPose.qz[bone], compressedPose.qw[bone]);
+				if (XMVectorGetX(XMVector4Dot(rawQ, compressedQ)) < 0.0f) compressedQ = -compressedQ;
+				float angle = 4.0f * std::asin(std::min(XMVectorGetX(XMVector4Length(rawQ - compressedQ)) * 0.5f, 1.0f));
+				EXPECT_LE(angle, settings.rotationError * 1.5f);
+			}
+		}
+
+		const UINT rawKeys = std::accumulate(rawClip.BoneAnimations.begin(), rawClip.BoneAnimations.end(), 0u,
+			[](UINT count, const BoneAnimation& boneAnimation) { return count + boneAnimation.KeyCount(); });
+		const UINT compressedKeys = std::accumulate(compressedClip.BoneAnimations.begin(), compressedClip.BoneAnimations.end(), 0u,
+			[](UINT count, const BoneAnimation& boneAnimation) { return count + boneAnimation.KeyCount(); });
+		std::cout << "Take1 keys : " << rawKeys << " -> " << compressedKeys
+			<< ", bytes : " << rawClip.GetByteSize() << " -> " << compressedClip.GetByteSize() << std::endl;
+	}
+
+	class PaletteTestRenderer : public ITestRenderer
+	{
+	public:
+		virtual bool SetUploadBuffer(eBufferType bufferType, const void* bufferData, size_t dataSize) override
+		{
+			if (bufferType != eBufferType::BonePalette) return true;
+
+			const XMFLOAT4X4* palette = static_cast<const XMFLOAT4X4*>(bufferData);
+			m_palette.assign(palette, palette + dataSize);
+			return true;
+		}
+
+		std::vector<XMFLOAT4X4> m_palette{};
+	};
+
+	TEST(SkinnedMesh, MultiInstance)
+	{
+		ModelProperty mProperty = CreateMock("soldier");
+		const UINT instanceCount = mProperty.instances.Size();
+
+		CSkinnedMesh skinnedMesh(L"../Resource/");
+		EXPECT_TRUE(skinnedMesh.Read("soldier", &mProperty));
+		EXPECT_TRUE(skinnedMesh.AddInstance("Take1", XMMatrixIdentity(), 2.0f));
+		EXPECT_FALSE(skinnedMesh.AddInstance("NoClip", XMMatrixIdentity()));
+		EXPECT_EQ(skinnedMesh.GetInstanceCount(), instanceCount + 1);
+
+		CMaterial material{};
+		AllRenderItems allRenderItems{};
+		PaletteTestRenderer renderer{};
+		EXPECT_TRUE(skinnedMesh.LoadMeshIntoVRAM(&renderer, &material, &allRenderItems));
+
+		//서브셋마다 모든 인스턴스를 한번에 그리고, 인스턴스마다 팔레트 위치가 다르다.
+		CSkinnedData skinInfo{};
+		LoadSoldier(skinInfo);
+		skinInfo.CompressAnimations(AnimationCompression{});
+		const UINT boneCount = skinInfo.BoneCount();
+		for (auto& subRenderItem : allRenderItems[GraphicsPSO::SkinnedOpaque]->subRenderItems)
+		{
+			EXPECT_EQ(subRenderItem.instanceCount, instanceCount + 1);
+			EXPECT_EQ(subRenderItem.instances.GetPaletteOffsets().back(), instanceCount * boneCount);
+		}
+
+		skinnedMesh.UpdateAnimation(&renderer, 0.1f);
+		EXPECT_EQ(renderer.m_palette.size(), (instanceCount + 1) * boneCount);
+
+		//재생 속도가 2배인 마지막 인스턴스는 0.2초 위치의 포즈가 나온다.
+		std::vector<XMFLOAT4X4> expected(boneCount);
+		skinInfo.GetFinalTransforms("Take1", 0.2f, expected);
+		EXPECT_EQ(0, std::memcmp(expected.data(), &renderer.m_palette[instanceCount * boneCount], boneCount * sizeof(XMFLOAT4X4)));
+	}
+}
+
+
+namespace Culling
+{
+	using namespace DirectX;
+
+	struct CullingScene
+	{
+		BoundingSphere localSphere{ XMFLOAT3(0.3f, 1.0f, -0.2f), 2.5f };
+		std::vector<XMMATRIX> worlds{};
+	};
+
+	CullingScene MakeCullingScene(UINT instanceCount)
+	{
+		CullingScene scene{};
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+		std::uniform_real_distribution<float> scale(0.2f, 3.0f);
+		std::uniform_real_distribution<float> angle(0.0f, XM_2PI);
+		for ([[maybe_unused]] auto i : std::views::iota(0u, instanceCount))
+		{
+			scene.worlds.emplace_back(
+				XMMatrixScaling(scale(random), scale(random), scale(random)) *
+				XMMatrixRotationRollPitchYaw(angle(random), angle(random), angle(random)) *
+				XMMatrixTranslation(position(random), position(random) * 0.1f, position(random)));
+		}
+		return scene;
+	}
+
+	//예전 방식: 인스턴스마다 역행렬로 절두체를 로컬 공간으로 옮겨서 비교한다.
+	bool ReferenceIsInside(const BoundingFrustum& viewFrustum, const XMMATRIX& invView,
+		const BoundingSphere& localSphere, const XMMATRIX& world)
+	{
+		BoundingFrustum frustum{};
+		XMMATRIX invWorld = XMMatrixInverse(nullptr, world);
+		viewFrustum.Transform(frustum, XMMatrixMultiply(invView, invWorld));
+		return frustum.Contains(localSphere) != DirectX::DISJOINT;
+	}
+
+	TEST(FrustumCulling, SoASpheres)
+	{
+		CCamera camera{};
+		camera.OnResize(800, 600);
+		camera.LookAt(XMFLOAT3(0.0f, 2.0f, -15.0f), XMFLOAT3(10.0f, 0.0f, 30.0f), XMFLOAT3(0.0f, 1.0f, 0.0f));
+		camera.UpdateViewMatrix();
+
+		BoundingFrustum viewFrustum{};
+		BoundingFrustum::CreateFromMatrix(viewFrustum, camera.GetProj());
+		XMMATRIX invView = XMMatrixInverse(nullptr, camera.GetView());
+		FrustumPlanes planes{};
+		ExtractFrustumPlanes(XMMatrixMultiply(camera.GetView(), camera.GetProj()), planes);
+
+		//개수가 4의 배수가 아닐 때 마지막 묶음도 확인한다.
+		for (UINT instanceCount : { 1u, 7u, 125u, 20003u })
+		{
+			CullingScene scene = MakeCullingScene(instanceCount);
+			CullingSpheres spheres{};
+			std::vector<UINT> visible{};
+
+			auto start = std::chrono::steady_clock::now();
+			for (auto& world : scene.worlds)
+				spheres.Add(scene.localSphere, world);
+			UINT visibleCount = CullSpheres(planes, spheres, visible);
+			std::chrono::duration<double, std::nano> soaTime = std::chrono::steady_clock::now() - start;
+
+			start = std::chrono::steady_clock::now();
+			std::vector<UINT> expected{};
+			for (auto i : std::views::iota(0u, instanceCount))
+				if (ReferenceIsInside(viewFrustum, invView, scene.localSphere, scene.worlds[i]))
+					expected.emplace_back(i);
+			std::chrono::duration<double, std::nano> referenceTime = std::chrono::steady_clock::now() - start;
+
+			//평면만 보는 검사는 모서리 근처에서 조금 더 보수적이다. 보여야 할 것은 빠지면 안 된다.
+			EXPECT_EQ(visibleCount, visible.size());
+			EXPECT_TRUE(std::ranges::is_sorted(visible));
+			EXPECT_TRUE(std::ranges::includes(visible, expected));
+
+			//SIMD 결과는 같은 평면 식을 구 하나씩 계산한 것과 같아야 한다.
+			std::vector<UINT> scalarVisible{};
+			for (auto i : std::views::iota(0u, instanceCount))
+			{
+				bool inside = std::ranges::all_of(planes, [&](const XMFLOAT4& plane) {
+					return plane.x * spheres.x[i] + (plane.y * spheres.y[i] + (plane.z * spheres.z[i] + plane.w)) >= -spheres.radius[i]; });
+				if (inside) scalarVisible.emplace_back(i);
+			}
+			EXPECT_EQ(visible, scalarVisible);
+
+			std::cout << instanceCount << " instances, visible " << visibleCount << " (reference " << expected.size()
+				<< ") SoA : " << soaTime.count() / instanceCount << " ns/instance, reference : "
+				<< referenceTime.count() / instanceCount << " ns/instance" << std::endl;
+		}
+	}
 }